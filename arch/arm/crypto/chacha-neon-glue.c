@@ -63,10 +63,13 @@ static void chacha_doneon(u32 *state, u8 *dst, const u8 *src,
 }
 
 static int chacha_neon_stream_xor(struct skcipher_request *req,
-				  const struct chacha_ctx *ctx, const u8 *iv)
+				  const struct chacha_ctx *ctx, const u8 *iv,
+				  bool xchacha)
 {
 	struct skcipher_walk walk;
+	struct chacha_ctx subctx;
 	u32 state[16];
+	u8 real_iv[16];
 	int err;
 
 	err = skcipher_walk_virt(&walk, req, false);
@@ -80,6 +83,21 @@ static int chacha_neon_stream_xor(struct skcipher_request *req,
 			nbytes = round_down(nbytes, walk.stride);
 
 		kernel_neon_begin();
+		if (xchacha) {
+			/*
+			 * Derive the XChaCha subkey in the same NEON section
+			 * as the first chunk of keystream. Adiantum does this
+			 * once per sector, so a separate section just for one
+			 * HChaCha block is a noticeable part of the cost.
+			 */
+			hchacha_block_neon(state, subctx.key, ctx->nrounds);
+			subctx.nrounds = ctx->nrounds;
+
+			memcpy(&real_iv[0], iv + 24, 8);
+			memcpy(&real_iv[8], iv + 16, 8);
+			crypto_chacha_init(state, &subctx, real_iv);
+			xchacha = false;
+		}
 		chacha_doneon(state, walk.dst.virt.addr, walk.src.virt.addr,
 			      nbytes, ctx->nrounds);
 		kernel_neon_end();
@@ -97,30 +115,18 @@ static int chacha_neon(struct skcipher_request *req)
 	if (req->cryptlen <= CHACHA_BLOCK_SIZE || !crypto_simd_usable())
 		return crypto_chacha_crypt(req);
 
-	return chacha_neon_stream_xor(req, ctx, req->iv);
+	return chacha_neon_stream_xor(req, ctx, req->iv, false);
 }
 
 static int xchacha_neon(struct skcipher_request *req)
 {
 	struct crypto_skcipher *tfm = crypto_skcipher_reqtfm(req);
 	struct chacha_ctx *ctx = crypto_skcipher_ctx(tfm);
-	struct chacha_ctx subctx;
-	u32 state[16];
-	u8 real_iv[16];
 
 	if (req->cryptlen <= CHACHA_BLOCK_SIZE || !crypto_simd_usable())
 		return crypto_xchacha_crypt(req);
 
-	crypto_chacha_init(state, ctx, req->iv);
-
-	kernel_neon_begin();
-	hchacha_block_neon(state, subctx.key, ctx->nrounds);
-	kernel_neon_end();
-	subctx.nrounds = ctx->nrounds;
-
-	memcpy(&real_iv[0], req->iv + 24, 8);
-	memcpy(&real_iv[8], req->iv + 16, 8);
-	return chacha_neon_stream_xor(req, &subctx, real_iv);
+	return chacha_neon_stream_xor(req, ctx, req->iv, true);
 }
 
 static struct skcipher_alg algs[] = {
@@ -72,6 +72,17 @@ static bool __kprobes aarch64_insn_is_steppable(u32 insn)
 enum probe_insn __kprobes
 arm_probe_decode_insn(probe_opcode_t insn, struct arch_probe_insn *api)
 {
+	/*
+	 * A nop needs neither the slot nor the single-step trap; this is
+	 * the common case for USDT probes. Only match the real NOP here:
+	 * aarch64_insn_is_nop() also covers hints such as PACIASP and BTI,
+	 * which must still be executed.
+	 */
+	if (insn == aarch64_insn_gen_nop()) {
+		api->handler = simulate_nop;
+		return INSN_GOOD_NO_SLOT;
+	}
+
 	/*
 	 * Instructions reading or modifying the PC won't work from the XOL
 	 * slot.
@@ -1703,12 +1703,26 @@ static void __intel_pmu_pebs_event(struct perf_event *event,
 	} else if (!intel_pmu_save_and_restart(event))
 		return;
 
-	while (count > 1) {
-		setup_sample(event, iregs, at, &data, regs);
-		perf_event_output(event, &data, regs);
-		at += cpuc->pebs_record_size;
-		at = get_next_pebs_record_by_bit(at, top, bit);
-		count--;
+	if (count > 1) {
+		struct perf_output_handle batch;
+		bool batched;
+
+		/*
+		 * Publish the records of a drain all at once rather than
+		 * one at a time.
+		 */
+		batched = perf_output_batch_begin(&batch, event);
+
+		while (count > 1) {
+			setup_sample(event, iregs, at, &data, regs);
+			perf_event_output(event, &data, regs);
+			at += cpuc->pebs_record_size;
+			at = get_next_pebs_record_by_bit(at, top, bit);
+			count--;
+		}
+
+		if (batched)
+			perf_output_batch_end(&batch);
 	}
 
 	setup_sample(event, iregs, at, &data, regs);
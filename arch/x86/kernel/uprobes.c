@@ -727,6 +727,14 @@ static int branch_setup_xol_ops(struct arch_uprobe *auprobe, struct insn *insn)
 	case 0x0f:
 		if (insn->opcode.nbytes != 2)
 			return -ENOSYS;
+		/*
+		 * 0f 1f /0 is the multi-byte nop, as emitted for USDT probes
+		 * and function padding; emulate it like the one-byte 0x90.
+		 */
+		if (OPCODE2(insn) == 0x1f) {
+			opc1 = 0x90;
+			break;
+		}
 		/*
 		 * If it is a "near" conditional jmp, OPCODE2() - 0x10 matches
 		 * OPCODE1() of the "short" jmp which checks the same condition.
@@ -742,8 +750,9 @@ static int branch_setup_xol_ops(struct arch_uprobe *auprobe, struct insn *insn)
 	 * 16-bit overrides such as CALLW (66 e8 nn nn) are not supported.
 	 * Intel and AMD behavior differ in 64-bit mode: Intel ignores 66 prefix.
 	 * No one uses these insns, reject any branch insns with such prefix.
+	 * A nop is not affected, and "66 0f 1f ..." is a common padding form.
 	 */
-	for (i = 0; i < insn->prefixes.nbytes; i++) {
+	for (i = 0; opc1 != 0x90 && i < insn->prefixes.nbytes; i++) {
 		if (insn->prefixes.bytes[i] == 0x66)
 			return -ENOTSUPP;
 	}
@@ -47,6 +47,7 @@
 #include <linux/freezer.h>
 #include <linux/fs.h>
 #include <linux/list.h>
+#include <linux/memfd.h>
 #include <linux/miscdevice.h>
 #include <linux/module.h>
 #include <linux/mutex.h>
@@ -56,6 +57,8 @@
 #include <linux/rbtree.h>
 #include <linux/sched/signal.h>
 #include <linux/sched/mm.h>
+#include <linux/sched/rt.h>
+#include <uapi/linux/sched/types.h>
 #include <linux/seq_file.h>
 #include <linux/uaccess.h>
 #include <linux/pid_namespace.h>
@@ -163,6 +166,9 @@ module_param_call(stop_on_user_error, binder_set_stop_on_user_error,
 #define to_binder_buffer_object(hdr) \
 	container_of(hdr, struct binder_buffer_object, hdr)
 
+#define to_binder_file_pages_object(hdr) \
+	container_of(hdr, struct binder_file_pages_object, hdr)
+
 #define to_binder_fd_array_object(hdr) \
 	container_of(hdr, struct binder_fd_array_object, hdr)
 
@@ -186,6 +192,42 @@ struct binder_stats {
 
 static struct binder_stats binder_stats;
 
+/*
+ * Transaction latencies are kept in log2 buckets of microseconds; the
+ * last bucket collects everything from 2^(BINDER_LATENCY_BUCKETS - 1)us
+ * (about 16ms) up.
+ */
+#define BINDER_LATENCY_BUCKETS 15
+
+struct binder_latency_hist {
+	atomic_t buckets[BINDER_LATENCY_BUCKETS];
+};
+
+static void binder_latency_record(struct binder_latency_hist *hist,
+				  ktime_t start)
+{
+	s64 us = ktime_us_delta(ktime_get(), start);
+	int bucket = us > 0 ? fls64(us) : 0;
+
+	atomic_inc(&hist->buckets[min(bucket, BINDER_LATENCY_BUCKETS - 1)]);
+}
+
+/**
+ * struct binder_priority - scheduler policy and priority
+ * @sched_policy:         scheduler policy
+ * @prio:                 [100..139] for SCHED_NORMAL, [0..99] for FIFO/RT
+ *
+ * The binder driver supports inheriting the following scheduler policies:
+ * SCHED_NORMAL
+ * SCHED_BATCH
+ * SCHED_FIFO
+ * SCHED_RR
+ */
+struct binder_priority {
+	unsigned int sched_policy;
+	int prio;
+};
+
 static inline void binder_stats_deleted(enum binder_stat_types type)
 {
 	atomic_inc(&binder_stats.obj_deleted[type]);
@@ -320,6 +362,8 @@ struct binder_error {
  *                        (invariant after initialized)
  * @min_priority:         minimum scheduling priority
  *                        (invariant after initialized)
+ * @inherit_rt:           inherit real-time scheduling policy from caller
+ *                        (invariant after initialized)
  * @txn_security_ctx:     require sender's security context
  *                        (invariant after initialized)
  * @async_todo:           list of async work items
@@ -359,6 +403,7 @@ struct binder_node {
 		 */
 		u8 accept_fds:1;
 		u8 txn_security_ctx:1;
+		u8 inherit_rt:1;
 		u8 min_priority;
 	};
 	bool has_async_transaction;
@@ -473,6 +518,10 @@ enum binder_deferred_state {
  *                        (protected by @inner_lock)
  * @default_priority:     default scheduler priority
  *                        (invariant after initialized)
+ * @wakeup_latency:       time from queueing a transaction to a thread
+ *                        picking it up (atomics, no lock needed)
+ * @reply_latency:        time from queueing a transaction to its reply
+ *                        (atomics, no lock needed)
  * @debugfs_entry:        debugfs node
  * @alloc:                binder allocator bookkeeping
  * @context:              binder_context for this proc
@@ -503,7 +552,9 @@ struct binder_proc {
 	int requested_threads;
 	int requested_threads_started;
 	int tmp_ref;
-	long default_priority;
+	struct binder_priority default_priority;
+	struct binder_latency_hist wakeup_latency;
+	struct binder_latency_hist reply_latency;
 	struct dentry *debugfs_entry;
 	struct binder_alloc alloc;
 	struct binder_context *context;
@@ -530,6 +581,8 @@ enum {
  *                        (protected by @proc->inner_lock)
  * @pid:                  PID for this thread
  *                        (invariant after initialization)
+ * @task:                 struct task_struct for this thread
+ *                        (invariant after initialization)
  * @looper:               bitmap of looping state
  *                        (only accessed by this thread)
  * @looper_needs_return:  looping thread needs to exit driver
@@ -561,6 +614,7 @@ struct binder_thread {
 	struct rb_node rb_node;
 	struct list_head waiting_thread_node;
 	int pid;
+	struct task_struct *task;
 	int looper;              /* only modified by this thread */
 	bool looper_need_return; /* can be written by other thread */
 	struct binder_transaction *transaction_stack;
@@ -605,8 +659,10 @@ struct binder_transaction {
 	struct binder_buffer *buffer;
 	unsigned int	code;
 	unsigned int	flags;
-	long	priority;
-	long	saved_priority;
+	struct binder_priority	priority;
+	struct binder_priority	saved_priority;
+	bool    set_priority_called;
+	ktime_t enqueue_ts;
 	kuid_t	sender_euid;
 	struct list_head fd_fixups;
 	binder_uintptr_t security_ctx;
@@ -636,6 +692,7 @@ struct binder_object {
 		struct binder_fd_object fdo;
 		struct binder_buffer_object bbo;
 		struct binder_fd_array_object fdao;
+		struct binder_file_pages_object fpo;
 	};
 };
 
@@ -1065,22 +1122,111 @@ static void binder_wakeup_proc_ilocked(struct binder_proc *proc)
 	binder_wakeup_thread_ilocked(proc, thread, /* sync = */false);
 }
 
-static void binder_set_nice(long nice)
+static bool is_rt_policy(int policy)
+{
+	return policy == SCHED_FIFO || policy == SCHED_RR;
+}
+
+static struct binder_priority binder_get_priority(struct task_struct *task)
+{
+	struct binder_priority prio = {
+		.sched_policy = task->policy,
+		.prio = task->normal_prio,
+	};
+
+	return prio;
+}
+
+static void binder_set_nice(struct task_struct *task, long nice)
 {
 	long min_nice;
 
-	if (can_nice(current, nice)) {
-		set_user_nice(current, nice);
+	if (can_nice(task, nice)) {
+		set_user_nice(task, nice);
 		return;
 	}
-	min_nice = rlimit_to_nice(rlimit(RLIMIT_NICE));
+	min_nice = rlimit_to_nice(task_rlimit(task, RLIMIT_NICE));
 	binder_debug(BINDER_DEBUG_PRIORITY_CAP,
 		     "%d: nice value %ld not allowed use %ld instead\n",
-		      current->pid, nice, min_nice);
-	set_user_nice(current, min_nice);
+		      task->pid, nice, min_nice);
+	set_user_nice(task, min_nice);
 	if (min_nice <= MAX_NICE)
 		return;
-	binder_user_error("%d RLIMIT_NICE not set\n", current->pid);
+	binder_user_error("%d RLIMIT_NICE not set\n", task->pid);
+}
+
+/**
+ * binder_set_priority() - switch a task to a binder priority
+ * @task:	task to change
+ * @desired:	policy and priority to switch to
+ *
+ * Real-time policies are only ever requested on behalf of a real-time
+ * caller of a node that asked for inheritance, so they are applied
+ * without the usual permission checks. Normal priorities keep honouring
+ * RLIMIT_NICE as before.
+ */
+static void binder_set_priority(struct task_struct *task,
+				struct binder_priority desired)
+{
+	struct sched_param params = { 0 };
+
+	if (task->policy == desired.sched_policy &&
+	    task->normal_prio == desired.prio)
+		return;
+
+	if (is_rt_policy(desired.sched_policy)) {
+		params.sched_priority = MAX_USER_RT_PRIO - 1 - desired.prio;
+		sched_setscheduler_nocheck(task,
+					   desired.sched_policy |
+					   SCHED_RESET_ON_FORK, &params);
+		return;
+	}
+
+	if (task->policy != desired.sched_policy)
+		sched_setscheduler_nocheck(task,
+					   desired.sched_policy |
+					   SCHED_RESET_ON_FORK, &params);
+	binder_set_nice(task, PRIO_TO_NICE(desired.prio));
+}
+
+/**
+ * binder_transaction_priority() - apply a transaction's priority to a task
+ * @task:	task that will handle @t
+ * @t:		transaction being handled
+ * @node:	target node of @t
+ *
+ * Synchronous transactions run at the caller's priority, including its
+ * real-time policy if @node inherits it, but never below the node's
+ * minimum priority. The task's previous priority is saved in @t and
+ * restored when the reply is sent.
+ */
+static void binder_transaction_priority(struct task_struct *task,
+					struct binder_transaction *t,
+					struct binder_node *node)
+{
+	struct binder_priority desired = t->priority;
+	struct binder_priority node_prio = {
+		.sched_policy = SCHED_NORMAL,
+		.prio = NICE_TO_PRIO(node->min_priority),
+	};
+	bool oneway = !!(t->flags & TF_ONE_WAY);
+
+	if (t->set_priority_called)
+		return;
+
+	t->set_priority_called = true;
+	t->saved_priority = binder_get_priority(task);
+
+	if (!node->inherit_rt && is_rt_policy(desired.sched_policy)) {
+		desired.sched_policy = SCHED_NORMAL;
+		desired.prio = NICE_TO_PRIO(0);
+	}
+
+	if (!oneway && (is_rt_policy(desired.sched_policy) ||
+			desired.prio < node_prio.prio))
+		binder_set_priority(task, desired);
+	else if (!oneway || t->saved_priority.prio > node_prio.prio)
+		binder_set_priority(task, node_prio);
 }
 
 static struct binder_node *binder_get_node_ilocked(struct binder_proc *proc,
@@ -1168,6 +1314,7 @@ static struct binder_node *binder_init_node_ilocked(
 	node->min_priority = flags & FLAT_BINDER_FLAG_PRIORITY_MASK;
 	node->accept_fds = !!(flags & FLAT_BINDER_FLAG_ACCEPTS_FDS);
 	node->txn_security_ctx = !!(flags & FLAT_BINDER_FLAG_TXN_SECURITY_CTX);
+	node->inherit_rt = !!(flags & FLAT_BINDER_FLAG_INHERIT_RT);
 	spin_lock_init(&node->lock);
 	INIT_LIST_HEAD(&node->work.entry);
 	INIT_LIST_HEAD(&node->async_todo);
@@ -2081,6 +2228,9 @@ static size_t binder_get_object(struct binder_proc *proc,
 	case BINDER_TYPE_FDA:
 		object_size = sizeof(struct binder_fd_array_object);
 		break;
+	case BINDER_TYPE_FILE_PAGES:
+		object_size = sizeof(struct binder_file_pages_object);
+		break;
 	default:
 		return 0;
 	}
@@ -2373,6 +2523,7 @@ static void binder_transaction_buffer_release(struct binder_proc *proc,
 				proc->tsk == current->group_leader);
 		} break;
 		case BINDER_TYPE_PTR:
+		case BINDER_TYPE_FILE_PAGES:
 			/*
 			 * Nothing to do here, this will get cleaned up when the
 			 * transaction buffer gets freed
@@ -2644,6 +2795,69 @@ static int binder_translate_fd(u32 fd, binder_size_t fd_offset,
 	return ret;
 }
 
+static int binder_translate_file_pages(struct binder_file_pages_object *fpo,
+				       binder_size_t *sg_buf_offset,
+				       binder_size_t sg_buf_end_offset,
+				       struct binder_transaction *t,
+				       struct binder_thread *thread)
+{
+	struct binder_proc *proc = thread->proc;
+	struct binder_proc *target_proc = t->to_proc;
+	binder_size_t buf_offset, buf_len;
+	struct file *file;
+	long seals;
+	int ret;
+
+	buf_offset = PAGE_ALIGN((uintptr_t)t->buffer->user_data +
+				*sg_buf_offset) -
+		     (uintptr_t)t->buffer->user_data;
+	buf_len = PAGE_ALIGN(fpo->length);
+	if (!fpo->length || buf_len < fpo->length ||
+	    buf_offset > sg_buf_end_offset ||
+	    buf_len > sg_buf_end_offset - buf_offset) {
+		binder_user_error("%d:%d got transaction with too large file pages object\n",
+				  proc->pid, thread->pid);
+		return -EINVAL;
+	}
+
+	file = fget(fpo->fd);
+	if (!file) {
+		binder_user_error("%d:%d got transaction with invalid fd, %d\n",
+				  proc->pid, thread->pid, fpo->fd);
+		return -EBADF;
+	}
+	seals = memfd_fcntl(file, F_GET_SEALS, 0);
+	if (seals < 0 ||
+	    (seals & (F_SEAL_WRITE | F_SEAL_SHRINK)) !=
+	    (F_SEAL_WRITE | F_SEAL_SHRINK) ||
+	    fpo->offset > i_size_read(file_inode(file)) ||
+	    fpo->length > i_size_read(file_inode(file)) - fpo->offset) {
+		binder_user_error("%d:%d got transaction with unsealed or short memfd, %d\n",
+				  proc->pid, thread->pid, fpo->fd);
+		ret = -EINVAL;
+		goto err;
+	}
+	ret = security_binder_transfer_file(proc->tsk, target_proc->tsk, file);
+	if (ret < 0) {
+		ret = -EPERM;
+		goto err;
+	}
+
+	ret = binder_alloc_share_file_pages(&target_proc->alloc, t->buffer,
+					    buf_offset, file, fpo->offset,
+					    fpo->length);
+	if (ret)
+		goto err;
+
+	/* Fixup buffer pointer to target proc address space */
+	fpo->buffer = (uintptr_t)t->buffer->user_data + buf_offset;
+	*sg_buf_offset = buf_offset + buf_len;
+err:
+	/* the shared pages hold their own references */
+	fput(file);
+	return ret;
+}
+
 static int binder_translate_fd_array(struct binder_fd_array_object *fda,
 				     struct binder_buffer_object *parent,
 				     struct binder_transaction *t,
@@ -2802,6 +3016,13 @@ static bool binder_proc_transaction(struct binder_transaction *t,
 	if (!thread && !pending_async)
 		thread = binder_select_thread_ilocked(proc);
 
+	/*
+	 * Raise the thread before waking it, so an RT caller's request
+	 * doesn't wait behind normal tasks for the wakeup.
+	 */
+	if (thread && !oneway)
+		binder_transaction_priority(thread->task, t, node);
+
 	if (thread)
 		binder_enqueue_thread_work_ilocked(thread, &t->work);
 	else if (!pending_async)
@@ -2928,7 +3149,7 @@ static void binder_transaction(struct binder_proc *proc,
 		}
 		thread->transaction_stack = in_reply_to->to_parent;
 		binder_inner_proc_unlock(proc);
-		binder_set_nice(in_reply_to->saved_priority);
+		binder_set_priority(current, in_reply_to->saved_priority);
 		target_thread = binder_get_txn_from_and_acq_inner(in_reply_to);
 		if (target_thread == NULL) {
 			/* annotation for sparse */
@@ -3127,7 +3348,7 @@ static void binder_transaction(struct binder_proc *proc,
 	t->to_thread = target_thread;
 	t->code = tr->code;
 	t->flags = tr->flags;
-	t->priority = task_nice(current);
+	t->priority = binder_get_priority(current);
 
 	if (target_node && target_node->txn_security_ctx) {
 		u32 secid;
@@ -3430,6 +3651,24 @@ static void binder_transaction(struct binder_proc *proc,
 			last_fixup_obj_off = object_offset;
 			last_fixup_min_off = 0;
 		} break;
+		case BINDER_TYPE_FILE_PAGES: {
+			struct binder_file_pages_object *fpo =
+				to_binder_file_pages_object(hdr);
+
+			ret = binder_translate_file_pages(fpo, &sg_buf_offset,
+							  sg_buf_end_offset,
+							  t, thread);
+			if (ret < 0 ||
+			    binder_alloc_copy_to_buffer(&target_proc->alloc,
+							t->buffer,
+							object_offset,
+							fpo, sizeof(*fpo))) {
+				return_error = BR_FAILED_REPLY;
+				return_error_param = ret;
+				return_error_line = __LINE__;
+				goto err_translate_failed;
+			}
+		} break;
 		default:
 			binder_user_error("%d:%d got transaction with invalid object type, %x\n",
 				proc->pid, thread->pid, hdr->type);
@@ -3441,6 +3680,7 @@ static void binder_transaction(struct binder_proc *proc,
 	}
 	tcomplete->type = BINDER_WORK_TRANSACTION_COMPLETE;
 	t->work.type = BINDER_WORK_TRANSACTION;
+	t->enqueue_ts = ktime_get();
 
 	if (reply) {
 		binder_enqueue_thread_work(thread, tcomplete);
@@ -3454,6 +3694,8 @@ static void binder_transaction(struct binder_proc *proc,
 		binder_enqueue_thread_work_ilocked(target_thread, &t->work);
 		binder_inner_proc_unlock(target_proc);
 		wake_up_interruptible_sync(&target_thread->wait);
+		binder_latency_record(&proc->reply_latency,
+				      in_reply_to->enqueue_ts);
 		binder_free_transaction(in_reply_to);
 	} else if (!(t->flags & TF_ONE_WAY)) {
 		BUG_ON(t->buffer->async_transaction != 0);
@@ -4230,7 +4472,7 @@ static int binder_thread_read(struct binder_proc *proc,
 			wait_event_interruptible(binder_user_error_wait,
 						 binder_stop_on_user_error < 2);
 		}
-		binder_set_nice(proc->default_priority);
+		binder_set_priority(current, proc->default_priority);
 	}
 
 	if (non_block) {
@@ -4455,13 +4697,9 @@ static int binder_thread_read(struct binder_proc *proc,
 
 			trd->target.ptr = target_node->ptr;
 			trd->cookie =  target_node->cookie;
-			t->saved_priority = task_nice(current);
-			if (t->priority < target_node->min_priority &&
-			    !(t->flags & TF_ONE_WAY))
-				binder_set_nice(t->priority);
-			else if (!(t->flags & TF_ONE_WAY) ||
-				 t->saved_priority > target_node->min_priority)
-				binder_set_nice(target_node->min_priority);
+			binder_transaction_priority(current, t, target_node);
+			binder_latency_record(&proc->wakeup_latency,
+					      t->enqueue_ts);
 			cmd = BR_TRANSACTION;
 		} else {
 			trd->target.ptr = 0;
@@ -4673,6 +4911,8 @@ static struct binder_thread *binder_get_thread_ilocked(
 	binder_stats_created(BINDER_STAT_THREAD);
 	thread->proc = proc;
 	thread->pid = current->pid;
+	get_task_struct(current);
+	thread->task = current;
 	atomic_set(&thread->tmp_ref, 0);
 	init_waitqueue_head(&thread->wait);
 	INIT_LIST_HEAD(&thread->todo);
@@ -4723,6 +4963,7 @@ static void binder_free_thread(struct binder_thread *thread)
 	BUG_ON(!list_empty(&thread->todo));
 	binder_stats_deleted(BINDER_STAT_THREAD);
 	binder_proc_dec_tmpref(thread->proc);
+	put_task_struct(thread->task);
 	kfree(thread);
 }
 
@@ -5242,7 +5483,7 @@ static int binder_open(struct inode *nodp, struct file *filp)
 	get_task_struct(current->group_leader);
 	proc->tsk = current->group_leader;
 	INIT_LIST_HEAD(&proc->todo);
-	proc->default_priority = task_nice(current);
+	proc->default_priority = binder_get_priority(current);
 	/* binderfs stashes devices in i_private */
 	if (is_binderfs_device(nodp))
 		binder_dev = nodp->i_private;
@@ -5525,13 +5766,14 @@ static void print_binder_transaction_ilocked(struct seq_file *m,
 	spin_lock(&t->lock);
 	to_proc = t->to_proc;
 	seq_printf(m,
-		   "%s %d: %pK from %d:%d to %d:%d code %x flags %x pri %ld r%d",
+		   "%s %d: %pK from %d:%d to %d:%d code %x flags %x pri %d:%d r%d",
 		   prefix, t->debug_id, t,
 		   t->from ? t->from->proc->pid : 0,
 		   t->from ? t->from->pid : 0,
 		   to_proc ? to_proc->pid : 0,
 		   t->to_thread ? t->to_thread->pid : 0,
-		   t->code, t->flags, t->priority, t->need_reply);
+		   t->code, t->flags, t->priority.sched_policy,
+		   t->priority.prio, t->need_reply);
 	spin_unlock(&t->lock);
 
 	if (proc != to_proc) {
@@ -5842,6 +6084,17 @@ static void print_binder_stats(struct seq_file *m, const char *prefix,
 	}
 }
 
+static void print_binder_latency_hist(struct seq_file *m, const char *prefix,
+				      struct binder_latency_hist *hist)
+{
+	int i;
+
+	seq_puts(m, prefix);
+	for (i = 0; i < BINDER_LATENCY_BUCKETS; i++)
+		seq_printf(m, " %d", atomic_read(&hist->buckets[i]));
+	seq_puts(m, "\n");
+}
+
 static void print_binder_proc_stats(struct seq_file *m,
 				    struct binder_proc *proc)
 {
@@ -5893,6 +6146,9 @@ static void print_binder_proc_stats(struct seq_file *m,
 	seq_printf(m, "  buffers: %d\n", count);
 
 	binder_alloc_print_pages(m, &proc->alloc);
+	binder_alloc_print_cache_stats(m, &proc->alloc);
+	print_binder_latency_hist(m, "  wakeup latency:", &proc->wakeup_latency);
+	print_binder_latency_hist(m, "  reply latency:", &proc->reply_latency);
 
 	count = 0;
 	binder_inner_proc_lock(proc);
@@ -22,6 +22,7 @@
 #include <asm/cacheflush.h>
 #include <linux/uaccess.h>
 #include <linux/highmem.h>
+#include <linux/shmem_fs.h>
 #include "binder_alloc.h"
 #include "binder_trace.h"
 
@@ -284,6 +285,10 @@ static int binder_update_page_range(struct binder_alloc *alloc, int allocate,
 		index = (page_addr - alloc->buffer) / PAGE_SIZE;
 		page = &alloc->pages[index];
 
+		/* shared pages were already given back to their file */
+		if (!page->page_ptr)
+			continue;
+
 		trace_binder_free_lru_start(alloc, index);
 
 		ret = list_lru_add(&binder_alloc_lru, &page->lru);
@@ -336,6 +341,154 @@ static inline struct vm_area_struct *binder_alloc_get_vma(
 	return vma;
 }
 
+static void binder_free_buf_locked(struct binder_alloc *alloc,
+				   struct binder_buffer *buffer);
+
+/**
+ * binder_alloc_cache_get() - take a cached buffer for a sync transaction
+ * @alloc:              binder_alloc for this proc
+ * @data_size:          size of user data buffer
+ * @offsets_size:       user specified buffer offset
+ * @extra_buffers_size: size of extra space for meta-data (eg, security context)
+ *
+ * Cached buffers are still allocated and have all their pages mapped, so
+ * they can be handed out again without @alloc->mutex. A buffer in size
+ * class N is at least (1 << (N + BINDER_ALLOC_CACHE_MIN_SHIFT)) bytes;
+ * only the first class that fits and the one above it are searched to
+ * bound the waste.
+ *
+ * Return:	a buffer or %NULL if the cache can't satisfy the request
+ */
+static struct binder_buffer *binder_alloc_cache_get(struct binder_alloc *alloc,
+						    size_t data_size,
+						    size_t offsets_size,
+						    size_t extra_buffers_size)
+{
+	struct binder_buffer *buffer;
+	size_t size, data_offsets_size;
+	int class, last, i;
+
+	/* Invalid sizes are reported by binder_alloc_new_buf_locked() */
+	data_offsets_size = ALIGN(data_size, sizeof(void *)) +
+		ALIGN(offsets_size, sizeof(void *));
+	if (data_offsets_size < data_size || data_offsets_size < offsets_size)
+		return NULL;
+	size = data_offsets_size + ALIGN(extra_buffers_size, sizeof(void *));
+	if (size < data_offsets_size || size < extra_buffers_size)
+		return NULL;
+	size = max(size, sizeof(void *));
+
+	if (size > 1UL << (BINDER_ALLOC_CACHE_MIN_SHIFT +
+			   BINDER_ALLOC_CACHE_CLASSES - 1))
+		return NULL;
+
+	if (!binder_alloc_get_vma(alloc))
+		return NULL;
+
+	if (size <= 1UL << BINDER_ALLOC_CACHE_MIN_SHIFT)
+		class = 0;
+	else
+		class = order_base_2(size) - BINDER_ALLOC_CACHE_MIN_SHIFT;
+	last = min(class + 1, BINDER_ALLOC_CACHE_CLASSES - 1);
+
+	for (; class <= last; class++) {
+		for (i = 0; i < BINDER_ALLOC_CACHE_SLOTS; i++) {
+			buffer = xchg(&alloc->cache[class][i], NULL);
+			if (buffer)
+				goto found;
+		}
+	}
+	return NULL;
+
+found:
+	buffer->data_size = data_size;
+	buffer->offsets_size = offsets_size;
+	buffer->async_transaction = 0;
+	buffer->extra_buffers_size = extra_buffers_size;
+	atomic_inc(&alloc->cache_hits);
+	binder_alloc_debug(BINDER_DEBUG_BUFFER_ALLOC,
+		     "%d: binder_alloc_buf size %zd got cached %pK\n",
+		      alloc->pid, size, buffer);
+	return buffer;
+}
+
+/**
+ * binder_alloc_cache_put() - cache a buffer instead of freeing it
+ * @alloc:	binder_alloc for this proc
+ * @buffer:	buffer being freed
+ *
+ * The extent of an allocated buffer can't change, so its size can be
+ * computed without @alloc->mutex.
+ *
+ * Return:	%true if the buffer was cached
+ */
+static bool binder_alloc_cache_put(struct binder_alloc *alloc,
+				   struct binder_buffer *buffer)
+{
+	size_t buffer_size;
+	int class, i;
+
+	BUG_ON(buffer->free);
+	BUG_ON(buffer->transaction != NULL);
+
+	/*
+	 * async buffers need @alloc->free_async_space to be updated and
+	 * shared pages must go back to their file
+	 */
+	if (buffer->async_transaction || buffer->shared_pages)
+		return false;
+
+	buffer_size = binder_alloc_buffer_size(alloc, buffer);
+	if (buffer_size < 1UL << BINDER_ALLOC_CACHE_MIN_SHIFT)
+		return false;
+	class = ilog2(buffer_size) - BINDER_ALLOC_CACHE_MIN_SHIFT;
+	if (class >= BINDER_ALLOC_CACHE_CLASSES)
+		return false;
+
+	if (!binder_alloc_get_vma(alloc))
+		return false;
+
+	for (i = 0; i < BINDER_ALLOC_CACHE_SLOTS; i++) {
+		if (!cmpxchg(&alloc->cache[class][i], NULL, buffer))
+			return true;
+	}
+	return false;
+}
+
+/**
+ * binder_alloc_cache_flush_locked() - free all cached buffers
+ * @alloc:	binder_alloc for this proc
+ *
+ * Return:	number of buffers freed
+ */
+static int binder_alloc_cache_flush_locked(struct binder_alloc *alloc)
+{
+	struct binder_buffer *buffer;
+	int class, i, count = 0;
+
+	for (class = 0; class < BINDER_ALLOC_CACHE_CLASSES; class++) {
+		for (i = 0; i < BINDER_ALLOC_CACHE_SLOTS; i++) {
+			buffer = xchg(&alloc->cache[class][i], NULL);
+			if (!buffer)
+				continue;
+			binder_free_buf_locked(alloc, buffer);
+			count++;
+		}
+	}
+	return count;
+}
+
+/**
+ * binder_alloc_cache_flush() - free all cached buffers
+ * @alloc:	binder_alloc for this proc
+ */
+void binder_alloc_cache_flush(struct binder_alloc *alloc)
+{
+	mutex_lock(&alloc->mutex);
+	binder_alloc_cache_flush_locked(alloc);
+	mutex_unlock(&alloc->mutex);
+}
+
 static struct binder_buffer *binder_alloc_new_buf_locked(
 				struct binder_alloc *alloc,
 				size_t data_size,
@@ -386,6 +539,7 @@ static struct binder_buffer *binder_alloc_new_buf_locked(
 	/* Pad 0-size buffers so they get assigned unique addresses */
 	size = max(size, sizeof(void *));
 
+retry:
 	while (n) {
 		buffer = rb_entry(n, struct binder_buffer, rb_node);
 		BUG_ON(!buffer->free);
@@ -401,6 +555,11 @@ static struct binder_buffer *binder_alloc_new_buf_locked(
 			break;
 		}
 	}
+	if (best_fit == NULL && binder_alloc_cache_flush_locked(alloc)) {
+		/* cached buffers were holding the space, try again */
+		n = alloc->free_buffers.rb_node;
+		goto retry;
+	}
 	if (best_fit == NULL) {
 		size_t allocated_buffers = 0;
 		size_t largest_alloc_size = 0;
@@ -483,6 +642,7 @@ static struct binder_buffer *binder_alloc_new_buf_locked(
 	buffer->data_size = data_size;
 	buffer->offsets_size = offsets_size;
 	buffer->async_transaction = is_async;
+	buffer->shared_pages = 0;
 	buffer->extra_buffers_size = extra_buffers_size;
 	if (is_async) {
 		alloc->free_async_space -= size + sizeof(struct binder_buffer);
@@ -522,6 +682,14 @@ struct binder_buffer *binder_alloc_new_buf(struct binder_alloc *alloc,
 {
 	struct binder_buffer *buffer;
 
+	if (!is_async) {
+		buffer = binder_alloc_cache_get(alloc, data_size, offsets_size,
+						extra_buffers_size);
+		if (buffer)
+			return buffer;
+		atomic_inc(&alloc->cache_misses);
+	}
+
 	mutex_lock(&alloc->mutex);
 	buffer = binder_alloc_new_buf_locked(alloc, data_size, offsets_size,
 					     extra_buffers_size, is_async);
@@ -588,6 +756,51 @@ static void binder_delete_free_buffer(struct binder_alloc *alloc,
 	kfree(buffer);
 }
 
+/**
+ * binder_alloc_unshare_pages() - drop shmem pages lent to a buffer
+ * @alloc:	binder_alloc for this proc
+ * @start:	start of the page range
+ * @end:	end of the page range
+ *
+ * Unmaps and releases every shared page in [@start, @end). The pages are
+ * left empty rather than on the lru, so the next allocation of that range
+ * gets a fresh zeroed page of our own. Called with @alloc->mutex held.
+ */
+static void binder_alloc_unshare_pages(struct binder_alloc *alloc,
+				       void __user *start, void __user *end)
+{
+	struct vm_area_struct *vma = NULL;
+	struct mm_struct *mm = NULL;
+	void __user *page_addr;
+
+	if (mmget_not_zero(alloc->vma_vm_mm)) {
+		mm = alloc->vma_vm_mm;
+		down_read(&mm->mmap_sem);
+		vma = alloc->vma;
+	}
+
+	for (page_addr = start; page_addr < end; page_addr += PAGE_SIZE) {
+		struct binder_lru_page *page;
+		size_t index;
+
+		index = (page_addr - alloc->buffer) / PAGE_SIZE;
+		page = &alloc->pages[index];
+		if (!page->shared)
+			continue;
+
+		if (vma)
+			zap_page_range(vma, (uintptr_t)page_addr, PAGE_SIZE);
+		put_page(page->page_ptr);
+		page->page_ptr = NULL;
+		page->shared = false;
+	}
+
+	if (mm) {
+		up_read(&mm->mmap_sem);
+		mmput(mm);
+	}
+}
+
 static void binder_free_buf_locked(struct binder_alloc *alloc,
 				   struct binder_buffer *buffer)
 {
@@ -617,6 +830,14 @@ static void binder_free_buf_locked(struct binder_alloc *alloc,
 			      alloc->pid, size, alloc->free_async_space);
 	}
 
+	if (buffer->shared_pages) {
+		binder_alloc_unshare_pages(alloc,
+			(void __user *)PAGE_ALIGN((uintptr_t)buffer->user_data),
+			(void __user *)(((uintptr_t)
+				  buffer->user_data + buffer_size) & PAGE_MASK));
+		buffer->shared_pages = 0;
+	}
+
 	binder_update_page_range(alloc, 0,
 		(void __user *)PAGE_ALIGN((uintptr_t)buffer->user_data),
 		(void __user *)(((uintptr_t)
@@ -649,11 +870,15 @@ static void binder_free_buf_locked(struct binder_alloc *alloc,
  * @alloc:	binder_alloc for this proc
  * @buffer:	kernel pointer to buffer
  *
- * Free the buffer allocated via binder_alloc_new_buffer()
+ * Free the buffer allocated via binder_alloc_new_buffer(). Small
+ * synchronous buffers are cached for the next transaction instead.
  */
 void binder_alloc_free_buf(struct binder_alloc *alloc,
 			    struct binder_buffer *buffer)
 {
+	if (binder_alloc_cache_put(alloc, buffer))
+		return;
+
 	mutex_lock(&alloc->mutex);
 	binder_free_buf_locked(alloc, buffer);
 	mutex_unlock(&alloc->mutex);
@@ -742,6 +967,8 @@ void binder_alloc_deferred_release(struct binder_alloc *alloc)
 	mutex_lock(&alloc->mutex);
 	BUG_ON(alloc->vma);
 
+	buffers += binder_alloc_cache_flush_locked(alloc);
+
 	while ((n = rb_first(&alloc->allocated_buffers))) {
 		buffer = rb_entry(n, struct binder_buffer, rb_node);
 
@@ -853,6 +1080,19 @@ void binder_alloc_print_pages(struct seq_file *m,
 	seq_printf(m, "  pages high watermark: %zu\n", alloc->pages_high);
 }
 
+/**
+ * binder_alloc_print_cache_stats() - print buffer cache hit/miss counters
+ * @m:     seq_file for output via seq_printf()
+ * @alloc: binder_alloc for this proc
+ */
+void binder_alloc_print_cache_stats(struct seq_file *m,
+				    struct binder_alloc *alloc)
+{
+	seq_printf(m, "  buffer cache: hits %d misses %d\n",
+		   atomic_read(&alloc->cache_hits),
+		   atomic_read(&alloc->cache_misses));
+}
+
 /**
  * binder_alloc_get_allocated_count() - return count of buffers
  * @alloc: binder_alloc for this proc
@@ -1179,3 +1419,88 @@ int binder_alloc_copy_from_buffer(struct binder_alloc *alloc,
 					   dest, bytes);
 }
 
+/**
+ * binder_alloc_share_file_pages() - map shmem file pages into a buffer
+ * @alloc: binder_alloc for this proc
+ * @buffer: binder buffer to be accessed
+ * @buffer_offset: page aligned offset into @buffer data
+ * @file: shmem file providing the pages
+ * @file_offset: page aligned offset into @file
+ * @bytes: bytes to share, rounded up to whole pages
+ *
+ * Replaces the pages backing [@buffer_offset, @buffer_offset + @bytes)
+ * with the page cache pages of @file, so that a large payload reaches
+ * the target without being copied. The whole page range must lie
+ * inside @buffer. The pages are released again when @buffer is freed.
+ *
+ * Return: 0 on success, negative errno otherwise
+ */
+int binder_alloc_share_file_pages(struct binder_alloc *alloc,
+				  struct binder_buffer *buffer,
+				  binder_size_t buffer_offset,
+				  struct file *file,
+				  loff_t file_offset,
+				  size_t bytes)
+{
+	size_t len = PAGE_ALIGN(bytes);
+	void __user *start = buffer->user_data + buffer_offset;
+	void __user *page_addr;
+	struct vm_area_struct *vma = NULL;
+	struct mm_struct *mm = NULL;
+	pgoff_t pgoff = file_offset >> PAGE_SHIFT;
+	int ret = 0;
+
+	if (!shmem_file(file) || !PAGE_ALIGNED(start) ||
+	    !PAGE_ALIGNED(file_offset) || len < bytes ||
+	    !check_buffer(alloc, buffer, buffer_offset, len))
+		return -EINVAL;
+
+	mutex_lock(&alloc->mutex);
+	if (mmget_not_zero(alloc->vma_vm_mm)) {
+		mm = alloc->vma_vm_mm;
+		down_read(&mm->mmap_sem);
+		vma = alloc->vma;
+	}
+	if (!vma) {
+		ret = -ESRCH;
+		goto out;
+	}
+
+	buffer->shared_pages = 1;
+	for (page_addr = start; page_addr < start + len;
+	     page_addr += PAGE_SIZE, pgoff++) {
+		struct binder_lru_page *page;
+		struct page *file_page;
+		size_t index;
+
+		file_page = shmem_read_mapping_page(file->f_mapping, pgoff);
+		if (IS_ERR(file_page)) {
+			ret = PTR_ERR(file_page);
+			break;
+		}
+
+		index = (page_addr - alloc->buffer) / PAGE_SIZE;
+		page = &alloc->pages[index];
+		zap_page_range(vma, (uintptr_t)page_addr, PAGE_SIZE);
+		if (page->shared)
+			put_page(page->page_ptr);
+		else
+			__free_page(page->page_ptr);
+		page->page_ptr = file_page;
+		page->shared = true;
+
+		ret = vm_insert_page(vma, (uintptr_t)page_addr, file_page);
+		if (ret) {
+			pr_err("%d: failed to map shared page at %pK in userspace\n",
+			       alloc->pid, page_addr);
+			break;
+		}
+	}
+out:
+	if (mm) {
+		up_read(&mm->mmap_sem);
+		mmput(mm);
+	}
+	mutex_unlock(&alloc->mutex);
+	return ret;
+}
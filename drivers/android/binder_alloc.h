@@ -42,7 +42,8 @@ struct binder_buffer {
 	unsigned free:1;
 	unsigned allow_user_free:1;
 	unsigned async_transaction:1;
-	unsigned debug_id:29;
+	unsigned shared_pages:1;
+	unsigned debug_id:28;
 
 	struct binder_transaction *transaction;
 
@@ -58,13 +59,24 @@ struct binder_buffer {
  * @page_ptr: pointer to physical page in mmap'd space
  * @lru:      entry in binder_alloc_lru
  * @alloc:    binder_alloc for a proc
+ * @shared:   @page_ptr is a shmem page lent by the sender, not our own
  */
 struct binder_lru_page {
 	struct list_head lru;
 	struct page *page_ptr;
 	struct binder_alloc *alloc;
+	bool shared;
 };
 
+/*
+ * Recently freed synchronous transaction buffers are kept, still allocated,
+ * in a small per-proc cache indexed by size class (128 bytes to 4K), so the
+ * next transaction of a similar size can skip @mutex and the rbtree walk.
+ */
+#define BINDER_ALLOC_CACHE_MIN_SHIFT	7
+#define BINDER_ALLOC_CACHE_CLASSES	6
+#define BINDER_ALLOC_CACHE_SLOTS	2
+
 /**
  * struct binder_alloc - per-binder proc state for binder allocator
  * @vma:                vm_area_struct passed to mmap_handler
@@ -83,6 +95,10 @@ struct binder_lru_page {
  * @buffer_size:        size of address space specified via mmap
  * @pid:                pid for associated binder_proc (invariant after init)
  * @pages_high:         high watermark of offset in @pages
+ * @cache:              recently freed buffers by size class, taken and
+ *                      refilled with xchg()/cmpxchg() without @mutex
+ * @cache_hits:         allocations satisfied from @cache
+ * @cache_misses:       synchronous allocations that had to take @mutex
  *
  * Bookkeeping structure for per-proc address space management for binder
  * buffers. It is normally initialized during binder_init() and binder_mmap()
@@ -103,6 +119,10 @@ struct binder_alloc {
 	uint32_t buffer_free;
 	int pid;
 	size_t pages_high;
+	struct binder_buffer *cache[BINDER_ALLOC_CACHE_CLASSES]
+				   [BINDER_ALLOC_CACHE_SLOTS];
+	atomic_t cache_hits;
+	atomic_t cache_misses;
 };
 
 #ifdef CONFIG_ANDROID_BINDER_IPC_SELFTEST
@@ -134,6 +154,9 @@ extern void binder_alloc_print_allocated(struct seq_file *m,
 					 struct binder_alloc *alloc);
 void binder_alloc_print_pages(struct seq_file *m,
 			      struct binder_alloc *alloc);
+void binder_alloc_print_cache_stats(struct seq_file *m,
+				    struct binder_alloc *alloc);
+void binder_alloc_cache_flush(struct binder_alloc *alloc);
 
 /**
  * binder_alloc_get_free_async_space() - get free space available for async
@@ -171,5 +194,12 @@ int binder_alloc_copy_from_buffer(struct binder_alloc *alloc,
 				  binder_size_t buffer_offset,
 				  size_t bytes);
 
+int binder_alloc_share_file_pages(struct binder_alloc *alloc,
+				  struct binder_buffer *buffer,
+				  binder_size_t buffer_offset,
+				  struct file *file,
+				  loff_t file_offset,
+				  size_t bytes);
+
 #endif /* _LINUX_BINDER_ALLOC_H */
 
@@ -137,6 +137,8 @@ static void binder_selftest_free_buf(struct binder_alloc *alloc,
 
 	for (i = 0; i < BUFFER_NUM; i++)
 		binder_alloc_free_buf(alloc, buffers[seq[i]]);
+	/* the pages of cached buffers are not expected to be on the lru */
+	binder_alloc_cache_flush(alloc);
 
 	for (i = 0; i < end / PAGE_SIZE; i++) {
 		/**
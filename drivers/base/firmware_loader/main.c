@@ -28,12 +28,14 @@
 #include <linux/list.h>
 #include <linux/fs.h>
 #include <linux/async.h>
+#include <linux/initrd.h>
 #include <linux/pm.h>
 #include <linux/suspend.h>
 #include <linux/syscore_ops.h>
 #include <linux/reboot.h>
 #include <linux/security.h>
 #include <linux/xz.h>
+#include <linux/zstd.h>
 
 #include <generated/utsrelease.h>
 
@@ -433,6 +435,110 @@ static int fw_decompress_xz(struct device *dev, struct fw_priv *fw_priv,
 	else
 		return fw_decompress_xz_pages(dev, fw_priv, in_size, in_buffer);
 }
+
+#ifdef CONFIG_FW_LOADER_COMPRESS_ZSTD
+/*
+ * ZSTD-compressed firmware support
+ *
+ * The whole input is in memory, so the streaming decoder is only used to
+ * be able to decompress onto pages one at a time.
+ */
+
+/* the window comes from the file, don't let it size a huge workspace */
+#define FW_ZSTD_WINDOW_MAX	(1U << 23)
+
+static int fw_decompress_zstd(struct device *dev, struct fw_priv *fw_priv,
+			      size_t in_size, const void *in_buffer)
+{
+	ZSTD_frameParams params;
+	ZSTD_inBuffer in = { in_buffer, in_size, 0 };
+	ZSTD_outBuffer out;
+	ZSTD_DStream *zds;
+	size_t wksp_size, ret;
+	struct page *page;
+	void *wksp;
+	int err = 0;
+
+	ret = ZSTD_getFrameParams(&params, in_buffer, in_size);
+	if (ret) {
+		dev_warn(dev, "zstd: invalid frame header\n");
+		return -EINVAL;
+	}
+
+	/* a skippable frame reports no window, and carries no firmware */
+	if (!params.windowSize) {
+		dev_warn(dev, "zstd: no data frame\n");
+		return -EINVAL;
+	}
+
+	if (params.windowSize > FW_ZSTD_WINDOW_MAX) {
+		dev_warn(dev, "zstd: window size %u too large\n",
+			 params.windowSize);
+		return -EINVAL;
+	}
+
+	wksp_size = ZSTD_DStreamWorkspaceBound(params.windowSize);
+	wksp = kvmalloc(wksp_size, GFP_KERNEL);
+	if (!wksp)
+		return -ENOMEM;
+
+	zds = ZSTD_initDStream(params.windowSize, wksp, wksp_size);
+	if (!zds) {
+		err = -EINVAL;
+		goto out;
+	}
+
+	fw_priv->size = 0;
+
+	/* pre-allocated buffer: decompress in one go */
+	if (fw_priv->data) {
+		out.dst = fw_priv->data;
+		out.size = fw_priv->allocated_size;
+		out.pos = 0;
+		ret = ZSTD_decompressStream(zds, &out, &in);
+		fw_priv->size = out.pos;
+		goto check;
+	}
+
+	fw_priv->is_paged_buf = true;
+	do {
+		if (fw_grow_paged_buf(fw_priv, fw_priv->nr_pages + 1)) {
+			err = -ENOMEM;
+			goto out;
+		}
+
+		page = fw_priv->pages[fw_priv->nr_pages - 1];
+		out.dst = kmap(page);
+		out.size = PAGE_SIZE;
+		out.pos = 0;
+		ret = ZSTD_decompressStream(zds, &out, &in);
+		kunmap(page);
+		fw_priv->size += out.pos;
+		/* a page that is not filled up means the end or an error */
+	} while (!ZSTD_isError(ret) && ret && out.pos == PAGE_SIZE);
+
+check:
+	if (ZSTD_isError(ret) || ret) {
+		dev_warn(dev, "zstd decompression failed (%s)\n",
+			 ZSTD_isError(ret) ? "corrupt data" : "incomplete frame");
+		err = -EINVAL;
+		goto out;
+	}
+
+	/* only a single frame is decompressed, don't ignore what follows */
+	if (in.pos != in_size) {
+		dev_warn(dev, "zstd: trailing data after frame\n");
+		err = -EINVAL;
+		goto out;
+	}
+
+	if (fw_priv->is_paged_buf)
+		err = fw_map_paged_buf(fw_priv);
+out:
+	kvfree(wksp);
+	return err;
+}
+#endif /* CONFIG_FW_LOADER_COMPRESS_ZSTD */
 #endif /* CONFIG_FW_LOADER_COMPRESS */
 
 /* direct firmware loading support */
@@ -480,6 +586,7 @@ fw_get_filesystem_firmware(struct device *device, struct fw_priv *fw_priv,
 	if (!path)
 		return -ENOMEM;
 
+	wait_for_initramfs();
 	for (i = 0; i < ARRAY_SIZE(fw_path); i++) {
 		/* skip the unset customized path */
 		if (!fw_path[i][0])
@@ -774,6 +881,11 @@ _request_firmware(const struct firmware **firmware_p, const char *name,
 		ret = fw_get_filesystem_firmware(device, fw->priv, ".xz",
 						 fw_decompress_xz);
 #endif
+#ifdef CONFIG_FW_LOADER_COMPRESS_ZSTD
+	if (ret == -ENOENT)
+		ret = fw_get_filesystem_firmware(device, fw->priv, ".zst",
+						 fw_decompress_zstd);
+#endif
 
 	if (ret) {
 		if (!(opt_flags & FW_OPT_NO_WARN))
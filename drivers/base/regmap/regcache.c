@@ -291,8 +291,8 @@ static bool regcache_reg_needs_sync(struct regmap *map, unsigned int reg,
 	return true;
 }
 
-static int regcache_default_sync(struct regmap *map, unsigned int min,
-				 unsigned int max)
+static int regcache_default_sync_single(struct regmap *map, unsigned int min,
+					unsigned int max)
 {
 	unsigned int reg;
 
@@ -325,6 +325,106 @@ static int regcache_default_sync(struct regmap *map, unsigned int min,
 	return 0;
 }
 
+static int regcache_default_sync_flush(struct regmap *map, void *buf,
+				       unsigned int min, unsigned int base,
+				       unsigned int *count)
+{
+	size_t val_bytes = map->format.val_bytes;
+	unsigned int idx = (base - min) / map->reg_stride;
+	int ret;
+
+	if (!*count)
+		return 0;
+
+	dev_dbg(map->dev, "Writing %zu bytes for %d registers from 0x%x-0x%x\n",
+		*count * val_bytes, *count, base,
+		base + (*count - 1) * map->reg_stride);
+
+	map->cache_bypass = true;
+	ret = _regmap_raw_write(map, base, buf + idx * val_bytes,
+				*count * val_bytes);
+	map->cache_bypass = false;
+	if (ret)
+		dev_err(map->dev, "Unable to sync registers %#x-%#x. %d\n",
+			base, base + (*count - 1) * map->reg_stride, ret);
+
+	*count = 0;
+
+	return ret;
+}
+
+/*
+ * Caches without a sync operation of their own don't keep the values in
+ * wire format, so format them into a buffer and write each run of adjacent
+ * registers that need syncing as one block. Every run has its own part of
+ * the buffer, which must stay around until any async writes have completed.
+ */
+static int regcache_default_sync_raw(struct regmap *map, unsigned int min,
+				     unsigned int max)
+{
+	size_t val_bytes = map->format.val_bytes;
+	unsigned int reg, val, base = 0, count = 0;
+	void *buf;
+	int ret = 0;
+
+	buf = kmalloc_array((max - min) / map->reg_stride + 1, val_bytes,
+			    map->alloc_flags);
+	if (!buf)
+		return regcache_default_sync_single(map, min, max);
+
+	for (reg = min; reg <= max; reg += map->reg_stride) {
+		if (regmap_volatile(map, reg) ||
+		    !regmap_writeable(map, reg)) {
+			ret = regcache_default_sync_flush(map, buf, min, base,
+							  &count);
+			if (ret)
+				break;
+			continue;
+		}
+
+		ret = regcache_read(map, reg, &val);
+		if (ret)
+			break;
+
+		if (!regcache_reg_needs_sync(map, reg, val)) {
+			ret = regcache_default_sync_flush(map, buf, min, base,
+							  &count);
+			if (ret)
+				break;
+			continue;
+		}
+
+		if (!count)
+			base = reg;
+		map->format.format_val(buf + (reg - min) / map->reg_stride *
+				       val_bytes, val, 0);
+		count++;
+	}
+
+	if (!ret)
+		ret = regcache_default_sync_flush(map, buf, min, base, &count);
+
+	regmap_async_complete(map);
+	kfree(buf);
+
+	return ret;
+}
+
+static int regcache_default_sync(struct regmap *map, unsigned int min,
+				 unsigned int max)
+{
+	/*
+	 * Block writes rely on the device auto-incrementing the register
+	 * address, only use them where the driver said it copes with bulk
+	 * writes; _regmap_raw_write() splits them by max_raw_write.
+	 */
+	if (map->can_multi_write && regmap_can_raw_write(map) &&
+	    !map->use_single_write)
+		return regcache_default_sync_raw(map, min, max);
+
+	return regcache_default_sync_single(map, min, max);
+}
+
 /**
  * regcache_sync - Sync the register cache with the hardware.
  *
@@ -11,6 +11,9 @@
 #include <linux/sched.h>
 #include <linux/cpu.h>
 #include <linux/crypto.h>
+#include <linux/highmem.h>
+#include <linux/scatterlist.h>
+#include <crypto/acompress.h>
 
 #include "zcomp.h"
 
@@ -36,27 +39,68 @@ static void zcomp_strm_free(struct zcomp_strm *zstrm)
 {
 	if (!IS_ERR_OR_NULL(zstrm->tfm))
 		crypto_free_comp(zstrm->tfm);
+	if (zstrm->req)
+		acomp_request_free(zstrm->req);
+	if (!IS_ERR_OR_NULL(zstrm->acomp))
+		crypto_free_acomp(zstrm->acomp);
+	free_page((unsigned long)zstrm->src_buf);
 	free_pages((unsigned long)zstrm->buffer, 1);
 	kfree(zstrm);
 }
 
+static int zcomp_strm_init_async(struct zcomp *comp, struct zcomp_strm *zstrm)
+{
+	zstrm->acomp = crypto_alloc_acomp(comp->name, 0, 0);
+	if (IS_ERR(zstrm->acomp))
+		return PTR_ERR(zstrm->acomp);
+
+	zstrm->req = acomp_request_alloc(zstrm->acomp);
+	zstrm->src_buf = (void *)__get_free_page(GFP_KERNEL);
+	if (!zstrm->req || !zstrm->src_buf)
+		return -ENOMEM;
+
+	crypto_init_wait(&zstrm->wait);
+	/*
+	 * Streams which can't sleep have to poll the engine. Prefer a
+	 * synchronous implementation of the same algorithm for them, if
+	 * there is one; the compressed format is the same.
+	 */
+	if (!zstrm->may_sleep) {
+		const char *alg = crypto_tfm_alg_name(
+					crypto_acomp_tfm(zstrm->acomp));
+
+		zstrm->tfm = crypto_alloc_comp(alg, 0, 0);
+		if (IS_ERR(zstrm->tfm))
+			zstrm->tfm = NULL;
+	}
+	return 0;
+}
+
 /*
- * allocate new zcomp_strm structure with ->tfm initialized by
- * backend, return NULL on error
+ * allocate new zcomp_strm structure with ->tfm (or ->acomp) initialized
+ * by backend, return NULL on error
  */
-static struct zcomp_strm *zcomp_strm_alloc(struct zcomp *comp)
+static struct zcomp_strm *zcomp_strm_alloc(struct zcomp *comp, bool may_sleep)
 {
-	struct zcomp_strm *zstrm = kmalloc(sizeof(*zstrm), GFP_KERNEL);
+	struct zcomp_strm *zstrm = kzalloc(sizeof(*zstrm), GFP_KERNEL);
+	int ret;
+
 	if (!zstrm)
 		return NULL;
 
-	zstrm->tfm = crypto_alloc_comp(comp->name, 0, 0);
+	zstrm->may_sleep = may_sleep;
+	if (comp->async) {
+		ret = zcomp_strm_init_async(comp, zstrm);
+	} else {
+		zstrm->tfm = crypto_alloc_comp(comp->name, 0, 0);
+		ret = IS_ERR_OR_NULL(zstrm->tfm) ? -EINVAL : 0;
+	}
 	/*
 	 * allocate 2 pages. 1 for compressed data, plus 1 extra for the
 	 * case when compressed size is larger than the original one
 	 */
 	zstrm->buffer = (void *)__get_free_pages(GFP_KERNEL | __GFP_ZERO, 1);
-	if (IS_ERR_OR_NULL(zstrm->tfm) || !zstrm->buffer) {
+	if (ret || !zstrm->buffer) {
 		zcomp_strm_free(zstrm);
 		zstrm = NULL;
 	}
@@ -78,7 +122,11 @@ bool zcomp_available_algorithm(const char *comp)
 	 * This also means that we permit zcomp initialisation
 	 * with any compressing algorithm known to crypto api.
 	 */
-	return crypto_has_comp(comp, 0, 0) == 1;
+	if (crypto_has_comp(comp, 0, 0) == 1)
+		return true;
+
+	/* or with an asynchronous (e.g. hardware offload) implementation */
+	return crypto_has_acomp(comp, 0, 0) == 1;
 }
 
 /* show available compressors */
@@ -103,7 +151,8 @@ ssize_t zcomp_available_show(const char *comp, char *buf)
 	 * Out-of-tree module known to crypto api or a missing
 	 * entry in `backends'.
 	 */
-	if (!known_algorithm && crypto_has_comp(comp, 0, 0) == 1)
+	if (!known_algorithm && (crypto_has_comp(comp, 0, 0) == 1 ||
+				crypto_has_acomp(comp, 0, 0) == 1))
 		sz += scnprintf(buf + sz, PAGE_SIZE - sz - 2,
 				"[%s] ", comp);
 
@@ -121,9 +170,93 @@ void zcomp_stream_put(struct zcomp *comp)
 	put_cpu_ptr(comp->stream);
 }
 
+/*
+ * Streams for the write path. For acomp backends these come from a pool,
+ * the caller may sleep on the stream while the request is processed by
+ * the engine. Otherwise they are the per-cpu streams.
+ */
+struct zcomp_strm *zcomp_compress_stream_get(struct zcomp *comp)
+{
+	struct zcomp_strm *zstrm;
+
+	if (!comp->async)
+		return zcomp_stream_get(comp);
+
+	spin_lock(&comp->strm_lock);
+	while (list_empty(&comp->idle_strm)) {
+		spin_unlock(&comp->strm_lock);
+		wait_event(comp->strm_wait, !list_empty(&comp->idle_strm));
+		spin_lock(&comp->strm_lock);
+	}
+	zstrm = list_first_entry(&comp->idle_strm, struct zcomp_strm, list);
+	list_del(&zstrm->list);
+	spin_unlock(&comp->strm_lock);
+
+	return zstrm;
+}
+
+void zcomp_compress_stream_put(struct zcomp *comp, struct zcomp_strm *zstrm)
+{
+	if (!comp->async) {
+		zcomp_stream_put(comp);
+		return;
+	}
+
+	spin_lock(&comp->strm_lock);
+	list_add(&zstrm->list, &comp->idle_strm);
+	spin_unlock(&comp->strm_lock);
+	wake_up(&comp->strm_wait);
+}
+
+/*
+ * Run an acomp request. Streams that may sleep wait for the completion
+ * callback, the others (used in atomic context) poll for it.
+ */
+static int zcomp_acomp_run(struct zcomp_strm *zstrm, bool compress)
+{
+	int ret;
+
+	if (zstrm->may_sleep) {
+		acomp_request_set_callback(zstrm->req,
+				CRYPTO_TFM_REQ_MAY_SLEEP |
+				CRYPTO_TFM_REQ_MAY_BACKLOG,
+				crypto_req_done, &zstrm->wait);
+		ret = compress ? crypto_acomp_compress(zstrm->req) :
+				crypto_acomp_decompress(zstrm->req);
+		return crypto_wait_req(ret, &zstrm->wait);
+	}
+
+	acomp_request_set_callback(zstrm->req, 0, crypto_req_done,
+				&zstrm->wait);
+	ret = compress ? crypto_acomp_compress(zstrm->req) :
+			crypto_acomp_decompress(zstrm->req);
+	if (ret == -EINPROGRESS) {
+		while (!try_wait_for_completion(&zstrm->wait.completion))
+			cpu_relax();
+		ret = zstrm->wait.err;
+	}
+	return ret;
+}
+
+static int zcomp_acomp_compress(struct zcomp_strm *zstrm,
+		struct scatterlist *src, unsigned int *dst_len)
+{
+	struct scatterlist dst;
+	int ret;
+
+	sg_init_one(&dst, zstrm->buffer, *dst_len);
+	acomp_request_set_params(zstrm->req, src, &dst, PAGE_SIZE, *dst_len);
+	ret = zcomp_acomp_run(zstrm, true);
+	if (!ret)
+		*dst_len = zstrm->req->dlen;
+	return ret;
+}
+
 int zcomp_compress(struct zcomp_strm *zstrm,
 		const void *src, unsigned int *dst_len)
 {
+	struct scatterlist sg;
+
 	/*
 	 * Our dst memory (zstrm->buffer) is always `2 * PAGE_SIZE' sized
 	 * because sometimes we can endup having a bigger compressed data
@@ -140,19 +273,63 @@ int zcomp_compress(struct zcomp_strm *zstrm,
 	 */
 	*dst_len = PAGE_SIZE * 2;
 
-	return crypto_comp_compress(zstrm->tfm,
-			src, PAGE_SIZE,
-			zstrm->buffer, dst_len);
+	if (zstrm->tfm)
+		return crypto_comp_compress(zstrm->tfm,
+				src, PAGE_SIZE,
+				zstrm->buffer, dst_len);
+
+	/* src may be a kmap_atomic() address, not usable in a scatterlist */
+	memcpy(zstrm->src_buf, src, PAGE_SIZE);
+	sg_init_one(&sg, zstrm->src_buf, PAGE_SIZE);
+	return zcomp_acomp_compress(zstrm, &sg, dst_len);
+}
+
+/* compress a page, sleeping on the engine if the stream allows it */
+int zcomp_compress_page(struct zcomp_strm *zstrm,
+		struct page *page, unsigned int *dst_len)
+{
+	struct scatterlist sg;
+	void *src;
+	int ret;
+
+	if (!zstrm->may_sleep) {
+		src = kmap_atomic(page);
+		ret = zcomp_compress(zstrm, src, dst_len);
+		kunmap_atomic(src);
+		return ret;
+	}
+
+	*dst_len = PAGE_SIZE * 2;
+	sg_init_table(&sg, 1);
+	sg_set_page(&sg, page, PAGE_SIZE, 0);
+	return zcomp_acomp_compress(zstrm, &sg, dst_len);
 }
 
 int zcomp_decompress(struct zcomp_strm *zstrm,
 		const void *src, unsigned int src_len, void *dst)
 {
 	unsigned int dst_len = PAGE_SIZE;
+	struct scatterlist sg_src, sg_dst;
+	int ret;
+
+	if (zstrm->tfm)
+		return crypto_comp_decompress(zstrm->tfm,
+				src, src_len,
+				dst, &dst_len);
 
-	return crypto_comp_decompress(zstrm->tfm,
-			src, src_len,
-			dst, &dst_len);
+	/*
+	 * Neither src (a zsmalloc mapping) nor dst (a kmap_atomic() address)
+	 * can be put in a scatterlist, bounce through the stream buffers.
+	 */
+	memcpy(zstrm->src_buf, src, src_len);
+	sg_init_one(&sg_src, zstrm->src_buf, src_len);
+	sg_init_one(&sg_dst, zstrm->buffer, dst_len);
+	acomp_request_set_params(zstrm->req, &sg_src, &sg_dst,
+				src_len, dst_len);
+	ret = zcomp_acomp_run(zstrm, false);
+	if (!ret)
+		memcpy(dst, zstrm->buffer, PAGE_SIZE);
+	return ret;
 }
 
 int zcomp_cpu_up_prepare(unsigned int cpu, struct hlist_node *node)
@@ -163,7 +340,7 @@ int zcomp_cpu_up_prepare(unsigned int cpu, struct hlist_node *node)
 	if (WARN_ON(*per_cpu_ptr(comp->stream, cpu)))
 		return 0;
 
-	zstrm = zcomp_strm_alloc(comp);
+	zstrm = zcomp_strm_alloc(comp, false);
 	if (IS_ERR_OR_NULL(zstrm)) {
 		pr_err("Can't allocate a compression stream\n");
 		return -ENOMEM;
@@ -184,10 +361,44 @@ int zcomp_cpu_dead(unsigned int cpu, struct hlist_node *node)
 	return 0;
 }
 
+static void zcomp_free_idle_streams(struct zcomp *comp)
+{
+	struct zcomp_strm *zstrm, *tmp;
+
+	list_for_each_entry_safe(zstrm, tmp, &comp->idle_strm, list) {
+		list_del(&zstrm->list);
+		zcomp_strm_free(zstrm);
+	}
+}
+
+/*
+ * Allocate the write path streams of an acomp backend; two per online
+ * cpu to keep the engine busy while the submitters handle completions.
+ */
+static int zcomp_init_idle_streams(struct zcomp *comp)
+{
+	struct zcomp_strm *zstrm;
+	int i;
+
+	for (i = 0; i < 2 * num_online_cpus(); i++) {
+		zstrm = zcomp_strm_alloc(comp, true);
+		if (!zstrm) {
+			zcomp_free_idle_streams(comp);
+			return -ENOMEM;
+		}
+		list_add(&zstrm->list, &comp->idle_strm);
+	}
+	return 0;
+}
+
 static int zcomp_init(struct zcomp *comp)
 {
 	int ret;
 
+	spin_lock_init(&comp->strm_lock);
+	INIT_LIST_HEAD(&comp->idle_strm);
+	init_waitqueue_head(&comp->strm_wait);
+
 	comp->stream = alloc_percpu(struct zcomp_strm *);
 	if (!comp->stream)
 		return -ENOMEM;
@@ -195,8 +406,16 @@ static int zcomp_init(struct zcomp *comp)
 	ret = cpuhp_state_add_instance(CPUHP_ZCOMP_PREPARE, &comp->node);
 	if (ret < 0)
 		goto cleanup;
+
+	if (comp->async) {
+		ret = zcomp_init_idle_streams(comp);
+		if (ret)
+			goto remove_instance;
+	}
 	return 0;
 
+remove_instance:
+	cpuhp_state_remove_instance(CPUHP_ZCOMP_PREPARE, &comp->node);
 cleanup:
 	free_percpu(comp->stream);
 	return ret;
@@ -204,6 +423,7 @@ static int zcomp_init(struct zcomp *comp)
 
 void zcomp_destroy(struct zcomp *comp)
 {
+	zcomp_free_idle_streams(comp);
 	cpuhp_state_remove_instance(CPUHP_ZCOMP_PREPARE, &comp->node);
 	free_percpu(comp->stream);
 	kfree(comp);
@@ -230,6 +450,11 @@ struct zcomp *zcomp_create(const char *compress)
 		return ERR_PTR(-ENOMEM);
 
 	comp->name = compress;
+	/*
+	 * Algorithms known only as acomp (e.g. a hardware engine driver
+	 * selected by its driver name) go through the asynchronous path.
+	 */
+	comp->async = crypto_has_comp(compress, 0, 0) != 1;
 	error = zcomp_init(comp);
 	if (error) {
 		kfree(comp);
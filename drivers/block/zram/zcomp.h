@@ -6,10 +6,28 @@
 #ifndef _ZCOMP_H_
 #define _ZCOMP_H_
 
+#include <linux/crypto.h>
+#include <linux/list.h>
+#include <linux/spinlock.h>
+#include <linux/wait.h>
+
+struct crypto_acomp;
+struct acomp_req;
+struct page;
+
 struct zcomp_strm {
 	/* compression/decompression buffer */
 	void *buffer;
 	struct crypto_comp *tfm;
+	/* asynchronous (acomp) backend, NULL for crypto_comp backends */
+	struct crypto_acomp *acomp;
+	struct acomp_req *req;
+	struct crypto_wait wait;
+	/* linear copy of the source, acomp needs a scatterlist-able buffer */
+	void *src_buf;
+	/* stream may sleep waiting for the acomp request to complete */
+	bool may_sleep;
+	struct list_head list;
 };
 
 /* dynamic per-device compression frontend */
@@ -17,6 +35,14 @@ struct zcomp {
 	struct zcomp_strm * __percpu *stream;
 	const char *name;
 	struct hlist_node node;
+	/*
+	 * acomp backends compress on a pool of streams that can sleep while
+	 * the request is queued, instead of the per-cpu streams
+	 */
+	bool async;
+	spinlock_t strm_lock;
+	struct list_head idle_strm;
+	wait_queue_head_t strm_wait;
 };
 
 int zcomp_cpu_up_prepare(unsigned int cpu, struct hlist_node *node);
@@ -30,9 +56,15 @@ void zcomp_destroy(struct zcomp *comp);
 struct zcomp_strm *zcomp_stream_get(struct zcomp *comp);
 void zcomp_stream_put(struct zcomp *comp);
 
+struct zcomp_strm *zcomp_compress_stream_get(struct zcomp *comp);
+void zcomp_compress_stream_put(struct zcomp *comp, struct zcomp_strm *zstrm);
+
 int zcomp_compress(struct zcomp_strm *zstrm,
 		const void *src, unsigned int *dst_len);
 
+int zcomp_compress_page(struct zcomp_strm *zstrm,
+		struct page *page, unsigned int *dst_len);
+
 int zcomp_decompress(struct zcomp_strm *zstrm,
 		const void *src, unsigned int src_len, void *dst);
 
@@ -33,6 +33,7 @@
 #include <linux/sysfs.h>
 #include <linux/debugfs.h>
 #include <linux/cpuhotplug.h>
+#include <linux/llist.h>
 
 #include "zram_drv.h"
 
@@ -56,18 +57,46 @@ static int zram_bvec_read(struct zram *zram, struct bio_vec *bvec,
 				u32 index, int offset, struct bio *bio);
 
 
+#ifdef CONFIG_ZRAM_LOCKLESS_READ
+/*
+ * Every slot lock holder may modify the slot, so the slot lock doubles
+ * as the write side of the per-slot sequence count which lockless
+ * readers use to validate their snapshot of the slot.
+ */
+static inline void zram_slot_seq_begin(struct zram *zram, u32 index)
+{
+	zram->table[index].seq++;
+	smp_wmb();
+}
+
+static inline void zram_slot_seq_end(struct zram *zram, u32 index)
+{
+	smp_wmb();
+	zram->table[index].seq++;
+}
+#else
+static inline void zram_slot_seq_begin(struct zram *zram, u32 index) {}
+static inline void zram_slot_seq_end(struct zram *zram, u32 index) {}
+#endif
+
 static int zram_slot_trylock(struct zram *zram, u32 index)
 {
-	return bit_spin_trylock(ZRAM_LOCK, &zram->table[index].flags);
+	if (!bit_spin_trylock(ZRAM_LOCK, &zram->table[index].flags))
+		return 0;
+
+	zram_slot_seq_begin(zram, index);
+	return 1;
 }
 
 static void zram_slot_lock(struct zram *zram, u32 index)
 {
 	bit_spin_lock(ZRAM_LOCK, &zram->table[index].flags);
+	zram_slot_seq_begin(zram, index);
 }
 
 static void zram_slot_unlock(struct zram *zram, u32 index)
 {
+	zram_slot_seq_end(zram, index);
 	bit_spin_unlock(ZRAM_LOCK, &zram->table[index].flags);
 }
 
@@ -141,6 +170,21 @@ static inline bool zram_allocated(struct zram *zram, u32 index)
 			zram_test_flag(zram, index, ZRAM_WB);
 }
 
+#ifdef CONFIG_ZRAM_MULTI_COMP
+/* returns the backend the object in the slot was compressed with */
+static inline struct zcomp *zram_slot_comp(struct zram *zram, u32 index)
+{
+	if (zram_test_flag(zram, index, ZRAM_RECOMP))
+		return zram->recomp;
+	return zram->comp;
+}
+#else
+static inline struct zcomp *zram_slot_comp(struct zram *zram, u32 index)
+{
+	return zram->comp;
+}
+#endif
+
 #if PAGE_SIZE != 4096
 static inline bool is_partial_io(struct bio_vec *bvec)
 {
@@ -616,18 +660,281 @@ static int read_from_bdev_async(struct zram *zram, struct bio_vec *bvec,
 #define HUGE_WRITEBACK 1
 #define IDLE_WRITEBACK 2
 
+/*
+ * Writeback gathers pages bound for contiguous backing device blocks
+ * into one bio of up to ZRAM_WB_BATCH_PAGES pages and keeps at most
+ * ZRAM_WB_MAX_INFLIGHT such bios in flight.
+ */
+#define ZRAM_WB_BATCH_PAGES	32
+#define ZRAM_WB_MAX_INFLIGHT	8
+
+struct zram_wb_batch {
+	struct zram *zram;
+	struct list_head list;		/* on zram_wb_ctl.free */
+	struct llist_node node;		/* on zram_wb_ctl.done */
+	struct llist_head *done;
+	blk_status_t status;
+	unsigned long blk_idx;		/* first block of the batch */
+	unsigned int nr;		/* no. of pages in the batch */
+	u32 index[ZRAM_WB_BATCH_PAGES];
+	struct page *pages[ZRAM_WB_BATCH_PAGES];
+};
+
+struct zram_wb_ctl {
+	struct list_head free;
+	struct llist_head done;
+	unsigned int inflight;
+};
+
+static void zram_wb_batch_free(struct zram_wb_batch *batch)
+{
+	int i;
+
+	for (i = 0; i < ZRAM_WB_BATCH_PAGES; i++) {
+		if (batch->pages[i])
+			__free_page(batch->pages[i]);
+	}
+	kfree(batch);
+}
+
+static struct zram_wb_batch *zram_wb_batch_alloc(struct zram *zram,
+				struct zram_wb_ctl *ctl)
+{
+	struct zram_wb_batch *batch;
+	int i;
+
+	batch = kzalloc(sizeof(*batch), GFP_KERNEL);
+	if (!batch)
+		return NULL;
+
+	for (i = 0; i < ZRAM_WB_BATCH_PAGES; i++) {
+		batch->pages[i] = alloc_page(GFP_KERNEL);
+		if (!batch->pages[i]) {
+			zram_wb_batch_free(batch);
+			return NULL;
+		}
+	}
+	batch->zram = zram;
+	batch->done = &ctl->done;
+	return batch;
+}
+
+/* Reserve writeback budget for one page, returns false if exhausted */
+static bool zram_wb_limit_get(struct zram *zram)
+{
+	bool ret = true;
+
+	spin_lock(&zram->wb_limit_lock);
+	if (zram->wb_limit_enable) {
+		if (!zram->bd_wb_limit)
+			ret = false;
+		else
+			zram->bd_wb_limit -= min_t(u64, zram->bd_wb_limit,
+						1UL << (PAGE_SHIFT - 12));
+	}
+	spin_unlock(&zram->wb_limit_lock);
+
+	return ret;
+}
+
+static void zram_wb_limit_put(struct zram *zram)
+{
+	spin_lock(&zram->wb_limit_lock);
+	if (zram->wb_limit_enable)
+		zram->bd_wb_limit += 1UL << (PAGE_SHIFT - 12);
+	spin_unlock(&zram->wb_limit_lock);
+}
+
+/* Undo the ZRAM_UNDER_WB marking of a slot which was not written back */
+static void zram_wb_abort_slot(struct zram *zram, u32 index)
+{
+	zram_slot_lock(zram, index);
+	zram_clear_flag(zram, index, ZRAM_UNDER_WB);
+	zram_clear_flag(zram, index, ZRAM_IDLE);
+	zram_slot_unlock(zram, index);
+	zram_wb_limit_put(zram);
+}
+
+/*
+ * Called from bio completion context, which can't take the slot locks.
+ * Hand the batch back to writeback_store() which finishes the slots.
+ */
+static void zram_writeback_end_io(struct bio *bio)
+{
+	struct zram_wb_batch *batch = bio->bi_private;
+	struct zram *zram = batch->zram;
+
+	batch->status = bio->bi_status;
+	bio_put(bio);
+
+	/* the batch may be reaped and reused as soon as it is on the list */
+	llist_add(&batch->node, batch->done);
+	wake_up(&zram->wb_wait);
+}
+
+static void zram_wb_submit_batch(struct zram *zram, struct zram_wb_ctl *ctl,
+				struct zram_wb_batch *batch)
+{
+	struct bio *bio;
+	unsigned int i;
+
+	bio = bio_alloc(GFP_KERNEL, batch->nr);
+	bio_set_dev(bio, zram->bdev);
+	bio->bi_iter.bi_sector = batch->blk_idx * (PAGE_SIZE >> 9);
+	bio->bi_opf = REQ_OP_WRITE;
+	bio->bi_private = batch;
+	bio->bi_end_io = zram_writeback_end_io;
+
+	for (i = 0; i < batch->nr; i++)
+		bio_add_page(bio, batch->pages[i], PAGE_SIZE, 0);
+
+	ctl->inflight++;
+	atomic64_inc(&zram->stats.bd_wb_bios);
+	submit_bio(bio);
+}
+
+static void zram_wb_finish_batch(struct zram *zram,
+				struct zram_wb_batch *batch)
+{
+	unsigned int i;
+
+	for (i = 0; i < batch->nr; i++) {
+		u32 index = batch->index[i];
+		unsigned long blk_idx = batch->blk_idx + i;
+
+		if (batch->status) {
+			zram_wb_abort_slot(zram, index);
+			free_block_bdev(zram, blk_idx);
+			continue;
+		}
+
+		atomic64_inc(&zram->stats.bd_writes);
+		/*
+		 * We released zram_slot_lock so need to check if the slot was
+		 * changed. If there is freeing for the slot, we can catch it
+		 * easily by zram_allocated.
+		 * A subtle case is the slot is freed/reallocated/marked as
+		 * ZRAM_IDLE again. To close the race, idle_store doesn't
+		 * mark ZRAM_IDLE once it found the slot was ZRAM_UNDER_WB.
+		 * Thus, we could close the race by checking ZRAM_IDLE bit.
+		 */
+		zram_slot_lock(zram, index);
+		if (!zram_allocated(zram, index) ||
+			  !zram_test_flag(zram, index, ZRAM_IDLE)) {
+			zram_clear_flag(zram, index, ZRAM_UNDER_WB);
+			zram_clear_flag(zram, index, ZRAM_IDLE);
+			zram_slot_unlock(zram, index);
+			free_block_bdev(zram, blk_idx);
+			zram_wb_limit_put(zram);
+			continue;
+		}
+
+		zram_free_page(zram, index);
+		zram_clear_flag(zram, index, ZRAM_UNDER_WB);
+		zram_set_flag(zram, index, ZRAM_WB);
+		zram_set_element(zram, index, blk_idx);
+		atomic64_inc(&zram->stats.pages_stored);
+		zram_slot_unlock(zram, index);
+	}
+}
+
+static void zram_wb_reap(struct zram *zram, struct zram_wb_ctl *ctl)
+{
+	struct zram_wb_batch *batch, *tmp;
+	struct llist_node *done;
+
+	done = llist_del_all(&ctl->done);
+	llist_for_each_entry_safe(batch, tmp, done, node) {
+		zram_wb_finish_batch(zram, batch);
+		batch->nr = 0;
+		list_add(&batch->list, &ctl->free);
+		ctl->inflight--;
+	}
+}
+
+/* Get an empty batch, waiting for an in-flight one to complete if needed */
+static struct zram_wb_batch *zram_wb_get_batch(struct zram *zram,
+				struct zram_wb_ctl *ctl, struct blk_plug *plug)
+{
+	struct zram_wb_batch *batch;
+
+	zram_wb_reap(zram, ctl);
+	if (list_empty(&ctl->free)) {
+		/* kick the plugged bios before we go to sleep on them */
+		blk_finish_plug(plug);
+		wait_event(zram->wb_wait, !llist_empty(&ctl->done));
+		blk_start_plug(plug);
+		zram_wb_reap(zram, ctl);
+	}
+
+	batch = list_first_entry(&ctl->free, struct zram_wb_batch, list);
+	list_del(&batch->list);
+	return batch;
+}
+
+/*
+ * Try to extend the batch with the next contiguous block, otherwise
+ * submit it and start a new batch on a freshly allocated block.
+ * Returns the block index or 0 if the backing device is full.
+ */
+static unsigned long zram_wb_get_block(struct zram *zram,
+				struct zram_wb_ctl *ctl,
+				struct zram_wb_batch **batchp,
+				struct blk_plug *plug)
+{
+	struct zram_wb_batch *batch = *batchp;
+	unsigned long blk_idx;
+
+	if (batch->nr) {
+		blk_idx = batch->blk_idx + batch->nr;
+		if (blk_idx < zram->nr_pages &&
+				!test_and_set_bit(blk_idx, zram->bitmap)) {
+			atomic64_inc(&zram->stats.bd_count);
+			return blk_idx;
+		}
+
+		zram_wb_submit_batch(zram, ctl, batch);
+		batch = *batchp = zram_wb_get_batch(zram, ctl, plug);
+	}
+
+	blk_idx = alloc_block_bdev(zram);
+	batch->blk_idx = blk_idx;
+	return blk_idx;
+}
+
+/* Must be called with the slot lock held */
+static bool zram_wb_slot_eligible(struct zram *zram, u32 index, int mode)
+{
+	if (!zram_allocated(zram, index))
+		return false;
+
+	if (zram_test_flag(zram, index, ZRAM_WB) ||
+			zram_test_flag(zram, index, ZRAM_SAME) ||
+			zram_test_flag(zram, index, ZRAM_UNDER_WB))
+		return false;
+
+	if (mode == IDLE_WRITEBACK &&
+		  !zram_test_flag(zram, index, ZRAM_IDLE))
+		return false;
+	if (mode == HUGE_WRITEBACK &&
+		  !zram_test_flag(zram, index, ZRAM_HUGE))
+		return false;
+
+	return true;
+}
+
 static ssize_t writeback_store(struct device *dev,
 		struct device_attribute *attr, const char *buf, size_t len)
 {
 	struct zram *zram = dev_to_zram(dev);
 	unsigned long nr_pages = zram->disksize >> PAGE_SHIFT;
+	struct zram_wb_ctl ctl;
+	struct zram_wb_batch *batch, *tmp;
+	struct blk_plug plug;
 	unsigned long index;
-	struct bio bio;
-	struct bio_vec bio_vec;
-	struct page *page;
-	ssize_t ret;
-	int mode;
-	unsigned long blk_idx = 0;
+	ktime_t start;
+	ssize_t ret = len;
+	int i, mode;
 
 	if (sysfs_streq(buf, "idle"))
 		mode = IDLE_WRITEBACK;
@@ -647,50 +954,46 @@ static ssize_t writeback_store(struct device *dev,
 		goto release_init_lock;
 	}
 
-	page = alloc_page(GFP_KERNEL);
-	if (!page) {
+	INIT_LIST_HEAD(&ctl.free);
+	init_llist_head(&ctl.done);
+	ctl.inflight = 0;
+	for (i = 0; i < ZRAM_WB_MAX_INFLIGHT; i++) {
+		batch = zram_wb_batch_alloc(zram, &ctl);
+		if (!batch)
+			break;
+		list_add(&batch->list, &ctl.free);
+	}
+
+	/* We can make progress with a single batch, just slower */
+	if (list_empty(&ctl.free)) {
 		ret = -ENOMEM;
 		goto release_init_lock;
 	}
 
+	start = ktime_get();
+	blk_start_plug(&plug);
+	batch = zram_wb_get_batch(zram, &ctl, &plug);
 	for (index = 0; index < nr_pages; index++) {
 		struct bio_vec bvec;
+		unsigned long blk_idx;
 
-		bvec.bv_page = page;
-		bvec.bv_len = PAGE_SIZE;
-		bvec.bv_offset = 0;
+		zram_slot_lock(zram, index);
+		if (!zram_wb_slot_eligible(zram, index, mode))
+			goto next;
+		zram_slot_unlock(zram, index);
 
-		spin_lock(&zram->wb_limit_lock);
-		if (zram->wb_limit_enable && !zram->bd_wb_limit) {
-			spin_unlock(&zram->wb_limit_lock);
+		if (!zram_wb_limit_get(zram)) {
 			ret = -EIO;
 			break;
 		}
-		spin_unlock(&zram->wb_limit_lock);
-
-		if (!blk_idx) {
-			blk_idx = alloc_block_bdev(zram);
-			if (!blk_idx) {
-				ret = -ENOSPC;
-				break;
-			}
-		}
 
 		zram_slot_lock(zram, index);
-		if (!zram_allocated(zram, index))
-			goto next;
-
-		if (zram_test_flag(zram, index, ZRAM_WB) ||
-				zram_test_flag(zram, index, ZRAM_SAME) ||
-				zram_test_flag(zram, index, ZRAM_UNDER_WB))
-			goto next;
-
-		if (mode == IDLE_WRITEBACK &&
-			  !zram_test_flag(zram, index, ZRAM_IDLE))
-			goto next;
-		if (mode == HUGE_WRITEBACK &&
-			  !zram_test_flag(zram, index, ZRAM_HUGE))
-			goto next;
+		/* The slot may have been freed or rewritten meanwhile */
+		if (!zram_wb_slot_eligible(zram, index, mode)) {
+			zram_slot_unlock(zram, index);
+			zram_wb_limit_put(zram);
+			continue;
+		}
 		/*
 		 * Clearing ZRAM_UNDER_WB is duty of caller.
 		 * IOW, zram_free_page never clear it.
@@ -699,70 +1002,48 @@ static ssize_t writeback_store(struct device *dev,
 		/* Need for hugepage writeback racing */
 		zram_set_flag(zram, index, ZRAM_IDLE);
 		zram_slot_unlock(zram, index);
-		if (zram_bvec_read(zram, &bvec, index, 0, NULL)) {
-			zram_slot_lock(zram, index);
-			zram_clear_flag(zram, index, ZRAM_UNDER_WB);
-			zram_clear_flag(zram, index, ZRAM_IDLE);
-			zram_slot_unlock(zram, index);
-			continue;
-		}
 
-		bio_init(&bio, &bio_vec, 1);
-		bio_set_dev(&bio, zram->bdev);
-		bio.bi_iter.bi_sector = blk_idx * (PAGE_SIZE >> 9);
-		bio.bi_opf = REQ_OP_WRITE | REQ_SYNC;
+		blk_idx = zram_wb_get_block(zram, &ctl, &batch, &plug);
+		if (!blk_idx) {
+			zram_wb_abort_slot(zram, index);
+			ret = -ENOSPC;
+			break;
+		}
 
-		bio_add_page(&bio, bvec.bv_page, bvec.bv_len,
-				bvec.bv_offset);
-		/*
-		 * XXX: A single page IO would be inefficient for write
-		 * but it would be not bad as starter.
-		 */
-		ret = submit_bio_wait(&bio);
-		if (ret) {
-			zram_slot_lock(zram, index);
-			zram_clear_flag(zram, index, ZRAM_UNDER_WB);
-			zram_clear_flag(zram, index, ZRAM_IDLE);
-			zram_slot_unlock(zram, index);
+		bvec.bv_page = batch->pages[batch->nr];
+		bvec.bv_len = PAGE_SIZE;
+		bvec.bv_offset = 0;
+		if (zram_bvec_read(zram, &bvec, index, 0, NULL)) {
+			zram_wb_abort_slot(zram, index);
+			free_block_bdev(zram, blk_idx);
 			continue;
 		}
 
-		atomic64_inc(&zram->stats.bd_writes);
-		/*
-		 * We released zram_slot_lock so need to check if the slot was
-		 * changed. If there is freeing for the slot, we can catch it
-		 * easily by zram_allocated.
-		 * A subtle case is the slot is freed/reallocated/marked as
-		 * ZRAM_IDLE again. To close the race, idle_store doesn't
-		 * mark ZRAM_IDLE once it found the slot was ZRAM_UNDER_WB.
-		 * Thus, we could close the race by checking ZRAM_IDLE bit.
-		 */
-		zram_slot_lock(zram, index);
-		if (!zram_allocated(zram, index) ||
-			  !zram_test_flag(zram, index, ZRAM_IDLE)) {
-			zram_clear_flag(zram, index, ZRAM_UNDER_WB);
-			zram_clear_flag(zram, index, ZRAM_IDLE);
-			goto next;
+		batch->index[batch->nr++] = index;
+		if (batch->nr == ZRAM_WB_BATCH_PAGES) {
+			zram_wb_submit_batch(zram, &ctl, batch);
+			batch = zram_wb_get_batch(zram, &ctl, &plug);
 		}
-
-		zram_free_page(zram, index);
-		zram_clear_flag(zram, index, ZRAM_UNDER_WB);
-		zram_set_flag(zram, index, ZRAM_WB);
-		zram_set_element(zram, index, blk_idx);
-		blk_idx = 0;
-		atomic64_inc(&zram->stats.pages_stored);
-		spin_lock(&zram->wb_limit_lock);
-		if (zram->wb_limit_enable && zram->bd_wb_limit > 0)
-			zram->bd_wb_limit -=  1UL << (PAGE_SHIFT - 12);
-		spin_unlock(&zram->wb_limit_lock);
+		continue;
 next:
 		zram_slot_unlock(zram, index);
 	}
 
-	if (blk_idx)
-		free_block_bdev(zram, blk_idx);
-	ret = len;
-	__free_page(page);
+	if (batch->nr)
+		zram_wb_submit_batch(zram, &ctl, batch);
+	else
+		list_add(&batch->list, &ctl.free);
+	blk_finish_plug(&plug);
+
+	while (ctl.inflight) {
+		wait_event(zram->wb_wait, !llist_empty(&ctl.done));
+		zram_wb_reap(zram, &ctl);
+	}
+	atomic64_add(ktime_us_delta(ktime_get(), start),
+			&zram->stats.bd_wb_time);
+
+	list_for_each_entry_safe(batch, tmp, &ctl.free, list)
+		zram_wb_batch_free(batch);
 release_init_lock:
 	up_read(&zram->init_lock);
 
@@ -859,6 +1140,11 @@ static void zram_accessed(struct zram *zram, u32 index)
 	zram->table[index].ac_time = ktime_get_boottime();
 }
 
+static inline bool zram_need_access_update(struct zram *zram, u32 index)
+{
+	return true;
+}
+
 static ssize_t read_block_state(struct file *file, char __user *buf,
 				size_t count, loff_t *ppos)
 {
@@ -888,13 +1174,14 @@ static ssize_t read_block_state(struct file *file, char __user *buf,
 
 		ts = ktime_to_timespec64(zram->table[index].ac_time);
 		copied = snprintf(kbuf + written, count,
-			"%12zd %12lld.%06lu %c%c%c%c\n",
+			"%12zd %12lld.%06lu %c%c%c%c%c\n",
 			index, (s64)ts.tv_sec,
 			ts.tv_nsec / NSEC_PER_USEC,
 			zram_test_flag(zram, index, ZRAM_SAME) ? 's' : '.',
 			zram_test_flag(zram, index, ZRAM_WB) ? 'w' : '.',
 			zram_test_flag(zram, index, ZRAM_HUGE) ? 'h' : '.',
-			zram_test_flag(zram, index, ZRAM_IDLE) ? 'i' : '.');
+			zram_test_flag(zram, index, ZRAM_IDLE) ? 'i' : '.',
+			zram_test_flag(zram, index, ZRAM_RECOMP) ? 'r' : '.');
 
 		if (count < copied) {
 			zram_slot_unlock(zram, index);
@@ -943,6 +1230,15 @@ static void zram_accessed(struct zram *zram, u32 index)
 {
 	zram_clear_flag(zram, index, ZRAM_IDLE);
 };
+
+/*
+ * Only ZRAM_IDLE needs clearing, so don't dirty the slot (and bounce its
+ * cache line) when it's not set. Racing with idle_store() is harmless.
+ */
+static inline bool zram_need_access_update(struct zram *zram, u32 index)
+{
+	return READ_ONCE(zram->table[index].flags) & BIT(ZRAM_IDLE);
+}
 static void zram_debugfs_register(struct zram *zram) {};
 static void zram_debugfs_unregister(struct zram *zram) {};
 #endif
@@ -1009,6 +1305,49 @@ static ssize_t comp_algorithm_store(struct device *dev,
 	return len;
 }
 
+#ifdef CONFIG_ZRAM_MULTI_COMP
+static ssize_t recomp_algorithm_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	size_t sz;
+	struct zram *zram = dev_to_zram(dev);
+
+	down_read(&zram->init_lock);
+	sz = zcomp_available_show(zram->recomp_algorithm, buf);
+	up_read(&zram->init_lock);
+
+	return sz;
+}
+
+static ssize_t recomp_algorithm_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct zram *zram = dev_to_zram(dev);
+	char compressor[ARRAY_SIZE(zram->recomp_algorithm)];
+	size_t sz;
+
+	strlcpy(compressor, buf, sizeof(compressor));
+	/* ignore trailing newline */
+	sz = strlen(compressor);
+	if (sz > 0 && compressor[sz - 1] == '\n')
+		compressor[sz - 1] = 0x00;
+
+	if (!zcomp_available_algorithm(compressor))
+		return -EINVAL;
+
+	down_write(&zram->init_lock);
+	if (init_done(zram)) {
+		up_write(&zram->init_lock);
+		pr_info("Can't change algorithm for initialized device\n");
+		return -EBUSY;
+	}
+
+	strcpy(zram->recomp_algorithm, compressor);
+	up_write(&zram->init_lock);
+	return len;
+}
+#endif
+
 static ssize_t compact_store(struct device *dev,
 		struct device_attribute *attr, const char *buf, size_t len)
 {
@@ -1085,14 +1424,23 @@ static ssize_t bd_stat_show(struct device *dev,
 		struct device_attribute *attr, char *buf)
 {
 	struct zram *zram = dev_to_zram(dev);
+	u64 wb_time, wb_kbps = 0;
 	ssize_t ret;
 
 	down_read(&zram->init_lock);
+	/* average writeback throughput in KiB/s */
+	wb_time = atomic64_read(&zram->stats.bd_wb_time);
+	if (wb_time)
+		wb_kbps = div64_u64(FOUR_K((u64)atomic64_read(
+				&zram->stats.bd_writes)) * 4 * USEC_PER_SEC,
+				wb_time);
 	ret = scnprintf(buf, PAGE_SIZE,
-		"%8llu %8llu %8llu\n",
+		"%8llu %8llu %8llu %8llu %8llu\n",
 			FOUR_K((u64)atomic64_read(&zram->stats.bd_count)),
 			FOUR_K((u64)atomic64_read(&zram->stats.bd_reads)),
-			FOUR_K((u64)atomic64_read(&zram->stats.bd_writes)));
+			FOUR_K((u64)atomic64_read(&zram->stats.bd_writes)),
+			(u64)atomic64_read(&zram->stats.bd_wb_bios),
+			wb_kbps);
 	up_read(&zram->init_lock);
 
 	return ret;
@@ -1112,6 +1460,12 @@ static ssize_t debug_stat_show(struct device *dev,
 			version,
 			(u64)atomic64_read(&zram->stats.writestall),
 			(u64)atomic64_read(&zram->stats.miss_free));
+#ifdef CONFIG_ZRAM_MULTI_COMP
+	ret += scnprintf(buf + ret, PAGE_SIZE - ret,
+			"%8llu %8llu\n",
+			(u64)atomic64_read(&zram->stats.num_recompressed),
+			(u64)atomic64_read(&zram->stats.recomp_saved));
+#endif
 	up_read(&zram->init_lock);
 
 	return ret;
@@ -1135,6 +1489,9 @@ static void zram_meta_free(struct zram *zram, u64 disksize)
 
 	zs_destroy_pool(zram->mem_pool);
 	vfree(zram->table);
+#ifdef CONFIG_ZRAM_LOCKLESS_READ
+	free_percpu(zram->hazard);
+#endif
 }
 
 static bool zram_meta_alloc(struct zram *zram, u64 disksize)
@@ -1152,11 +1509,122 @@ static bool zram_meta_alloc(struct zram *zram, u64 disksize)
 		return false;
 	}
 
+#ifdef CONFIG_ZRAM_LOCKLESS_READ
+	zram->hazard = alloc_percpu(unsigned long);
+	if (!zram->hazard) {
+		zs_destroy_pool(zram->mem_pool);
+		vfree(zram->table);
+		return false;
+	}
+#endif
+
 	if (!huge_class_size)
 		huge_class_size = zs_huge_class_size(zram->mem_pool);
 	return true;
 }
 
+#ifdef CONFIG_ZRAM_LOCKLESS_READ
+/*
+ * Lockless readers publish the handle they are about to map in a per-cpu
+ * hazard pointer and then re-validate the slot sequence. A writer bumps
+ * the sequence before it frees the object, so either the reader sees the
+ * new sequence and backs off, or the writer sees the hazard pointer here
+ * and waits for the reader to unmap the object.
+ */
+static void zram_wait_lockless_readers(struct zram *zram, unsigned long handle)
+{
+	int cpu;
+
+	smp_mb();
+	for_each_possible_cpu(cpu) {
+		while (READ_ONCE(*per_cpu_ptr(zram->hazard, cpu)) == handle)
+			cpu_relax();
+	}
+}
+
+/*
+ * Read the slot without taking the slot lock, so that concurrent readers
+ * of an unchanged slot don't write to the shared table entry. Returns
+ * -EAGAIN if the slot is being modified or its content can't be read
+ * locklessly, in which case the caller has to take the slot lock.
+ */
+static int zram_read_lockless(struct zram *zram, struct page *page, u32 index)
+{
+	struct zram_table_entry *entry = &zram->table[index];
+	unsigned long flags, handle, *hazard;
+	struct zcomp_strm *zstrm;
+	struct zcomp *comp;
+	unsigned int seq, size;
+	void *src, *dst;
+	int ret = 0;
+
+	seq = READ_ONCE(entry->seq);
+	if (seq & 1)
+		return -EAGAIN;
+	smp_rmb();
+
+	flags = READ_ONCE(entry->flags);
+	handle = READ_ONCE(entry->handle);
+	if (flags & (BIT(ZRAM_LOCK) | BIT(ZRAM_WB)))
+		return -EAGAIN;
+
+	if (!handle || (flags & BIT(ZRAM_SAME))) {
+		unsigned long value = handle;
+
+		smp_rmb();
+		if (READ_ONCE(entry->seq) != seq)
+			return -EAGAIN;
+
+		dst = kmap_atomic(page);
+		zram_fill_page(dst, PAGE_SIZE, value);
+		kunmap_atomic(dst);
+		return 0;
+	}
+
+	size = flags & (BIT(ZRAM_FLAG_SHIFT) - 1);
+	comp = zram->comp;
+#ifdef CONFIG_ZRAM_MULTI_COMP
+	if (flags & BIT(ZRAM_RECOMP))
+		comp = zram->recomp;
+#endif
+
+	hazard = get_cpu_ptr(zram->hazard);
+	WRITE_ONCE(*hazard, handle);
+	smp_mb();
+	if (READ_ONCE(entry->seq) != seq) {
+		WRITE_ONCE(*hazard, 0);
+		put_cpu_ptr(zram->hazard);
+		return -EAGAIN;
+	}
+
+	src = zs_map_object(zram->mem_pool, handle, ZS_MM_RO);
+	dst = kmap_atomic(page);
+	if (size == PAGE_SIZE) {
+		memcpy(dst, src, PAGE_SIZE);
+	} else {
+		zstrm = zcomp_stream_get(comp);
+		ret = zcomp_decompress(zstrm, src, size, dst);
+		zcomp_stream_put(comp);
+	}
+	kunmap_atomic(dst);
+	zs_unmap_object(zram->mem_pool, handle);
+
+	smp_store_release(hazard, 0);
+	put_cpu_ptr(zram->hazard);
+
+	return ret;
+}
+#else
+static inline void zram_wait_lockless_readers(struct zram *zram,
+				unsigned long handle) {}
+
+static inline int zram_read_lockless(struct zram *zram, struct page *page,
+				u32 index)
+{
+	return -EAGAIN;
+}
+#endif
+
 /*
  * To protect concurrent access to the same index entry,
  * caller should hold this table index entry's bit_spinlock to
@@ -1172,6 +1640,9 @@ static void zram_free_page(struct zram *zram, size_t index)
 	if (zram_test_flag(zram, index, ZRAM_IDLE))
 		zram_clear_flag(zram, index, ZRAM_IDLE);
 
+	zram_clear_flag(zram, index, ZRAM_RECOMP);
+	zram_clear_flag(zram, index, ZRAM_INCOMPRESSIBLE);
+
 	if (zram_test_flag(zram, index, ZRAM_HUGE)) {
 		zram_clear_flag(zram, index, ZRAM_HUGE);
 		atomic64_dec(&zram->stats.huge_pages);
@@ -1197,6 +1668,7 @@ static void zram_free_page(struct zram *zram, size_t index)
 	if (!handle)
 		return;
 
+	zram_wait_lockless_readers(zram, handle);
 	zs_free(zram->mem_pool, handle);
 
 	atomic64_sub(zram_get_obj_size(zram, index),
@@ -1209,28 +1681,18 @@ static void zram_free_page(struct zram *zram, size_t index)
 		~(1UL << ZRAM_LOCK | 1UL << ZRAM_UNDER_WB));
 }
 
-static int __zram_bvec_read(struct zram *zram, struct page *page, u32 index,
-				struct bio *bio, bool partial_io)
+/*
+ * Decompress (or fill) the in-memory object of the slot into @page.
+ * The caller must hold the slot lock and the slot must not be ZRAM_WB.
+ */
+static int zram_read_from_zspool(struct zram *zram, struct page *page,
+				u32 index)
 {
 	int ret;
 	unsigned long handle;
 	unsigned int size;
 	void *src, *dst;
 
-	zram_slot_lock(zram, index);
-	if (zram_test_flag(zram, index, ZRAM_WB)) {
-		struct bio_vec bvec;
-
-		zram_slot_unlock(zram, index);
-
-		bvec.bv_page = page;
-		bvec.bv_len = PAGE_SIZE;
-		bvec.bv_offset = 0;
-		return read_from_bdev(zram, &bvec,
-				zram_get_element(zram, index),
-				bio, partial_io);
-	}
-
 	handle = zram_get_handle(zram, index);
 	if (!handle || zram_test_flag(zram, index, ZRAM_SAME)) {
 		unsigned long value;
@@ -1240,7 +1702,6 @@ static int __zram_bvec_read(struct zram *zram, struct page *page, u32 index,
 		mem = kmap_atomic(page);
 		zram_fill_page(mem, PAGE_SIZE, value);
 		kunmap_atomic(mem);
-		zram_slot_unlock(zram, index);
 		return 0;
 	}
 
@@ -1253,16 +1714,45 @@ static int __zram_bvec_read(struct zram *zram, struct page *page, u32 index,
 		kunmap_atomic(dst);
 		ret = 0;
 	} else {
-		struct zcomp_strm *zstrm = zcomp_stream_get(zram->comp);
+		struct zcomp *comp = zram_slot_comp(zram, index);
+		struct zcomp_strm *zstrm = zcomp_stream_get(comp);
 
 		dst = kmap_atomic(page);
 		ret = zcomp_decompress(zstrm, src, size, dst);
 		kunmap_atomic(dst);
-		zcomp_stream_put(zram->comp);
+		zcomp_stream_put(comp);
 	}
 	zs_unmap_object(zram->mem_pool, handle);
-	zram_slot_unlock(zram, index);
 
+	return ret;
+}
+
+static int __zram_bvec_read(struct zram *zram, struct page *page, u32 index,
+				struct bio *bio, bool partial_io)
+{
+	int ret;
+
+	ret = zram_read_lockless(zram, page, index);
+	if (ret != -EAGAIN)
+		goto out;
+
+	zram_slot_lock(zram, index);
+	if (zram_test_flag(zram, index, ZRAM_WB)) {
+		struct bio_vec bvec;
+
+		zram_slot_unlock(zram, index);
+
+		bvec.bv_page = page;
+		bvec.bv_len = PAGE_SIZE;
+		bvec.bv_offset = 0;
+		return read_from_bdev(zram, &bvec,
+				zram_get_element(zram, index),
+				bio, partial_io);
+	}
+
+	ret = zram_read_from_zspool(zram, page, index);
+	zram_slot_unlock(zram, index);
+out:
 	/* Should NEVER happen. Return bio error if it does. */
 	if (unlikely(ret))
 		pr_err("Decompression failed! err=%d, page=%u\n", ret, index);
@@ -1327,13 +1817,11 @@ static int __zram_bvec_write(struct zram *zram, struct bio_vec *bvec,
 	kunmap_atomic(mem);
 
 compress_again:
-	zstrm = zcomp_stream_get(zram->comp);
-	src = kmap_atomic(page);
-	ret = zcomp_compress(zstrm, src, &comp_len);
-	kunmap_atomic(src);
+	zstrm = zcomp_compress_stream_get(zram->comp);
+	ret = zcomp_compress_page(zstrm, page, &comp_len);
 
 	if (unlikely(ret)) {
-		zcomp_stream_put(zram->comp);
+		zcomp_compress_stream_put(zram->comp, zstrm);
 		pr_err("Compression failed! err=%d\n", ret);
 		zs_free(zram->mem_pool, handle);
 		return ret;
@@ -1361,7 +1849,7 @@ static int __zram_bvec_write(struct zram *zram, struct bio_vec *bvec,
 				__GFP_HIGHMEM |
 				__GFP_MOVABLE);
 	if (!handle) {
-		zcomp_stream_put(zram->comp);
+		zcomp_compress_stream_put(zram->comp, zstrm);
 		atomic64_inc(&zram->stats.writestall);
 		handle = zs_malloc(zram->mem_pool, comp_len,
 				GFP_NOIO | __GFP_HIGHMEM |
@@ -1375,7 +1863,7 @@ static int __zram_bvec_write(struct zram *zram, struct bio_vec *bvec,
 	update_used_max(zram, alloced_pages);
 
 	if (zram->limit_pages && alloced_pages > zram->limit_pages) {
-		zcomp_stream_put(zram->comp);
+		zcomp_compress_stream_put(zram->comp, zstrm);
 		zs_free(zram->mem_pool, handle);
 		return -ENOMEM;
 	}
@@ -1389,7 +1877,7 @@ static int __zram_bvec_write(struct zram *zram, struct bio_vec *bvec,
 	if (comp_len == PAGE_SIZE)
 		kunmap_atomic(src);
 
-	zcomp_stream_put(zram->comp);
+	zcomp_compress_stream_put(zram->comp, zstrm);
 	zs_unmap_object(zram->mem_pool, handle);
 	atomic64_add(comp_len, &zram->stats.compr_data_size);
 out:
@@ -1460,6 +1948,173 @@ static int zram_bvec_write(struct zram *zram, struct bio_vec *bvec,
 	return ret;
 }
 
+#ifdef CONFIG_ZRAM_MULTI_COMP
+/*
+ * Re-compress the object of the slot with the secondary algorithm and
+ * replace the old object if the new one is smaller. The caller must
+ * hold the slot lock; @page is a scratch page.
+ */
+static int zram_recompress_slot(struct zram *zram, u32 index,
+				struct page *page)
+{
+	unsigned int comp_len_old, comp_len_new;
+	unsigned long handle, alloced_pages;
+	struct zcomp_strm *zstrm;
+	bool idle;
+	void *src, *dst;
+	int ret;
+
+	comp_len_old = zram_get_obj_size(zram, index);
+	ret = zram_read_from_zspool(zram, page, index);
+	if (ret)
+		return ret;
+
+	zstrm = zcomp_stream_get(zram->recomp);
+	src = kmap_atomic(page);
+	ret = zcomp_compress(zstrm, src, &comp_len_new);
+	kunmap_atomic(src);
+
+	if (unlikely(ret)) {
+		zcomp_stream_put(zram->recomp);
+		return ret;
+	}
+
+	/*
+	 * Neither algorithm could make the page fit in a non-huge class,
+	 * remember that so that we don't waste CPU cycles on it again.
+	 */
+	if (comp_len_new >= huge_class_size) {
+		zcomp_stream_put(zram->recomp);
+		zram_set_flag(zram, index, ZRAM_INCOMPRESSIBLE);
+		return 0;
+	}
+
+	/* No gain, keep the object compressed by the primary algorithm */
+	if (comp_len_new >= comp_len_old) {
+		zcomp_stream_put(zram->recomp);
+		return 0;
+	}
+
+	/*
+	 * We are holding the slot lock and the per-cpu stream, so the
+	 * allocation must not enter direct reclaim. If it fails, leave the
+	 * slot alone; the user can retry the recompression later.
+	 */
+	handle = zs_malloc(zram->mem_pool, comp_len_new,
+			__GFP_KSWAPD_RECLAIM |
+			__GFP_NOWARN |
+			__GFP_HIGHMEM |
+			__GFP_MOVABLE);
+	if (!handle) {
+		zcomp_stream_put(zram->recomp);
+		return -ENOMEM;
+	}
+
+	dst = zs_map_object(zram->mem_pool, handle, ZS_MM_WO);
+	memcpy(dst, zstrm->buffer, comp_len_new);
+	zcomp_stream_put(zram->recomp);
+	zs_unmap_object(zram->mem_pool, handle);
+
+	alloced_pages = zs_get_total_pages(zram->mem_pool);
+	update_used_max(zram, alloced_pages);
+
+	/* The content did not change, the slot keeps its idle state */
+	idle = zram_test_flag(zram, index, ZRAM_IDLE);
+	zram_free_page(zram, index);
+	zram_set_handle(zram, index, handle);
+	zram_set_obj_size(zram, index, comp_len_new);
+	zram_set_flag(zram, index, ZRAM_RECOMP);
+	if (idle)
+		zram_set_flag(zram, index, ZRAM_IDLE);
+
+	atomic64_add(comp_len_new, &zram->stats.compr_data_size);
+	atomic64_inc(&zram->stats.pages_stored);
+	atomic64_inc(&zram->stats.num_recompressed);
+	atomic64_add(comp_len_old - comp_len_new, &zram->stats.recomp_saved);
+
+	return 0;
+}
+
+#define HUGE_RECOMP 1
+#define IDLE_RECOMP 2
+#define HUGE_IDLE_RECOMP (HUGE_RECOMP | IDLE_RECOMP)
+
+static ssize_t recompress_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct zram *zram = dev_to_zram(dev);
+	unsigned long nr_pages = zram->disksize >> PAGE_SHIFT;
+	unsigned long index;
+	struct page *page;
+	ssize_t ret = len;
+	int mode;
+
+	if (sysfs_streq(buf, "idle"))
+		mode = IDLE_RECOMP;
+	else if (sysfs_streq(buf, "huge"))
+		mode = HUGE_RECOMP;
+	else if (sysfs_streq(buf, "huge_idle"))
+		mode = HUGE_IDLE_RECOMP;
+	else
+		return -EINVAL;
+
+	down_read(&zram->init_lock);
+	if (!init_done(zram)) {
+		ret = -EINVAL;
+		goto release_init_lock;
+	}
+
+	if (!zram->recomp) {
+		ret = -ENODEV;
+		goto release_init_lock;
+	}
+
+	page = alloc_page(GFP_KERNEL);
+	if (!page) {
+		ret = -ENOMEM;
+		goto release_init_lock;
+	}
+
+	for (index = 0; index < nr_pages; index++) {
+		int err = 0;
+
+		zram_slot_lock(zram, index);
+		if (!zram_allocated(zram, index))
+			goto next;
+
+		if (zram_test_flag(zram, index, ZRAM_WB) ||
+				zram_test_flag(zram, index, ZRAM_SAME) ||
+				zram_test_flag(zram, index, ZRAM_UNDER_WB) ||
+				zram_test_flag(zram, index, ZRAM_RECOMP) ||
+				zram_test_flag(zram, index, ZRAM_INCOMPRESSIBLE))
+			goto next;
+
+		if ((mode & IDLE_RECOMP) &&
+				!zram_test_flag(zram, index, ZRAM_IDLE))
+			goto next;
+		if ((mode & HUGE_RECOMP) &&
+				!zram_test_flag(zram, index, ZRAM_HUGE))
+			goto next;
+
+		err = zram_recompress_slot(zram, index, page);
+next:
+		zram_slot_unlock(zram, index);
+
+		if (err) {
+			ret = err;
+			break;
+		}
+		cond_resched();
+	}
+
+	__free_page(page);
+release_init_lock:
+	up_read(&zram->init_lock);
+
+	return ret;
+}
+#endif
+
 /*
  * zram_bio_discard - handler on discard request
  * @index: physical block index in PAGE_SIZE units
@@ -1524,9 +2179,11 @@ static int zram_bvec_rw(struct zram *zram, struct bio_vec *bvec, u32 index,
 
 	generic_end_io_acct(q, op, &zram->disk->part0, start_time);
 
-	zram_slot_lock(zram, index);
-	zram_accessed(zram, index);
-	zram_slot_unlock(zram, index);
+	if (zram_need_access_update(zram, index)) {
+		zram_slot_lock(zram, index);
+		zram_accessed(zram, index);
+		zram_slot_unlock(zram, index);
+	}
 
 	if (unlikely(ret < 0)) {
 		if (!op_is_write(op))
@@ -1676,6 +2333,9 @@ static int zram_rw_page(struct block_device *bdev, sector_t sector,
 static void zram_reset_device(struct zram *zram)
 {
 	struct zcomp *comp;
+#ifdef CONFIG_ZRAM_MULTI_COMP
+	struct zcomp *recomp;
+#endif
 	u64 disksize;
 
 	down_write(&zram->init_lock);
@@ -1690,6 +2350,10 @@ static void zram_reset_device(struct zram *zram)
 	comp = zram->comp;
 	disksize = zram->disksize;
 	zram->disksize = 0;
+#ifdef CONFIG_ZRAM_MULTI_COMP
+	recomp = zram->recomp;
+	zram->recomp = NULL;
+#endif
 
 	set_capacity(zram->disk, 0);
 	part_stat_set_all(&zram->disk->part0, 0);
@@ -1699,6 +2363,10 @@ static void zram_reset_device(struct zram *zram)
 	zram_meta_free(zram, disksize);
 	memset(&zram->stats, 0, sizeof(zram->stats));
 	zcomp_destroy(comp);
+#ifdef CONFIG_ZRAM_MULTI_COMP
+	if (recomp)
+		zcomp_destroy(recomp);
+#endif
 	reset_bdev(zram);
 }
 
@@ -1735,6 +2403,22 @@ static ssize_t disksize_store(struct device *dev,
 		goto out_free_meta;
 	}
 
+#ifdef CONFIG_ZRAM_MULTI_COMP
+	if (zram->recomp_algorithm[0]) {
+		struct zcomp *recomp;
+
+		recomp = zcomp_create(zram->recomp_algorithm);
+		if (IS_ERR(recomp)) {
+			pr_err("Cannot initialise %s recompressing backend\n",
+					zram->recomp_algorithm);
+			err = PTR_ERR(recomp);
+			zcomp_destroy(comp);
+			goto out_free_meta;
+		}
+		zram->recomp = recomp;
+	}
+#endif
+
 	zram->comp = comp;
 	zram->disksize = disksize;
 	set_capacity(zram->disk, zram->disksize >> SECTOR_SHIFT);
@@ -1827,6 +2511,10 @@ static DEVICE_ATTR_WO(mem_used_max);
 static DEVICE_ATTR_WO(idle);
 static DEVICE_ATTR_RW(max_comp_streams);
 static DEVICE_ATTR_RW(comp_algorithm);
+#ifdef CONFIG_ZRAM_MULTI_COMP
+static DEVICE_ATTR_RW(recomp_algorithm);
+static DEVICE_ATTR_WO(recompress);
+#endif
 #ifdef CONFIG_ZRAM_WRITEBACK
 static DEVICE_ATTR_RW(backing_dev);
 static DEVICE_ATTR_WO(writeback);
@@ -1844,6 +2532,10 @@ static struct attribute *zram_disk_attrs[] = {
 	&dev_attr_idle.attr,
 	&dev_attr_max_comp_streams.attr,
 	&dev_attr_comp_algorithm.attr,
+#ifdef CONFIG_ZRAM_MULTI_COMP
+	&dev_attr_recomp_algorithm.attr,
+	&dev_attr_recompress.attr,
+#endif
 #ifdef CONFIG_ZRAM_WRITEBACK
 	&dev_attr_backing_dev.attr,
 	&dev_attr_writeback.attr,
@@ -1890,6 +2582,7 @@ static int zram_add(void)
 	init_rwsem(&zram->init_lock);
 #ifdef CONFIG_ZRAM_WRITEBACK
 	spin_lock_init(&zram->wb_limit_lock);
+	init_waitqueue_head(&zram->wb_wait);
 #endif
 	queue = blk_alloc_queue(GFP_KERNEL);
 	if (!queue) {
@@ -50,6 +50,8 @@ enum zram_pageflags {
 	ZRAM_UNDER_WB,	/* page is under writeback */
 	ZRAM_HUGE,	/* Incompressible page */
 	ZRAM_IDLE,	/* not accessed page since last idle marking */
+	ZRAM_RECOMP,	/* page was compressed by the secondary algorithm */
+	ZRAM_INCOMPRESSIBLE, /* none of the algorithms could compress it */
 
 	__NR_ZRAM_PAGEFLAGS,
 };
@@ -66,6 +68,9 @@ struct zram_table_entry {
 #ifdef CONFIG_ZRAM_MEMORY_TRACKING
 	ktime_t ac_time;
 #endif
+#ifdef CONFIG_ZRAM_LOCKLESS_READ
+	unsigned int seq;	/* odd while the slot is being modified */
+#endif
 };
 
 struct zram_stats {
@@ -82,10 +87,16 @@ struct zram_stats {
 	atomic_long_t max_used_pages;	/* no. of maximum pages stored */
 	atomic64_t writestall;		/* no. of write slow paths */
 	atomic64_t miss_free;		/* no. of missed free */
+#ifdef CONFIG_ZRAM_MULTI_COMP
+	atomic64_t num_recompressed;	/* no. of recompressed pages */
+	atomic64_t recomp_saved;	/* bytes saved by recompression */
+#endif
 #ifdef	CONFIG_ZRAM_WRITEBACK
 	atomic64_t bd_count;		/* no. of pages in backing device */
 	atomic64_t bd_reads;		/* no. of reads from backing device */
 	atomic64_t bd_writes;		/* no. of writes from backing device */
+	atomic64_t bd_wb_bios;		/* no. of bios issued by writeback */
+	atomic64_t bd_wb_time;		/* usecs spent in writeback */
 #endif
 };
 
@@ -94,6 +105,10 @@ struct zram {
 	struct zs_pool *mem_pool;
 	struct zcomp *comp;
 	struct gendisk *disk;
+#ifdef CONFIG_ZRAM_LOCKLESS_READ
+	/* per-cpu handle being read by the lockless read path */
+	unsigned long __percpu *hazard;
+#endif
 	/* Prevent concurrent execution of device init */
 	struct rw_semaphore init_lock;
 	/*
@@ -108,6 +123,11 @@ struct zram {
 	 */
 	u64 disksize;	/* bytes */
 	char compressor[CRYPTO_MAX_ALG_NAME];
+#ifdef CONFIG_ZRAM_MULTI_COMP
+	/* secondary compression backend, used for recompression only */
+	struct zcomp *recomp;
+	char recomp_algorithm[CRYPTO_MAX_ALG_NAME];
+#endif
 	/*
 	 * zram is claimed so open request will be failed
 	 */
@@ -121,6 +141,7 @@ struct zram {
 	unsigned int old_block_size;
 	unsigned long *bitmap;
 	unsigned long nr_pages;
+	wait_queue_head_t wb_wait;	/* writeback bio completions */
 #endif
 #ifdef CONFIG_ZRAM_MEMORY_TRACKING
 	struct dentry *debugfs_dir;
@@ -0,0 +1,342 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Raise the CPU frequency floor for a short while after input events.
+ *
+ * Sampling governors only react to a burst of work one or two sampling
+ * periods after it has started. Input is a good hint that such a burst is
+ * about to happen: a touch, key press or wheel movement is usually followed
+ * by a redraw. So on every input event each policy gets a minimum frequency
+ * for input_boost/duration_ms, extended by further events.
+ *
+ * The floor is a DEV_PM_QOS_MIN_FREQUENCY request on the CPU devices, so it
+ * is combined with scaling_min_freq and any other constraint by the PM QoS
+ * core. Tunables and statistics are in /sys/devices/system/cpu/cpufreq/
+ * input_boost/:
+ *
+ *   freq         floor in kHz, 0 (default) for cpuinfo_max_freq
+ *   duration_ms  how long the floor is held after the last event
+ *   count        number of boost periods started
+ *   time_ms      total time spent boosted
+ */
+
+#define pr_fmt(fmt) KBUILD_MODNAME ": " fmt
+
+#include <linux/cpu.h>
+#include <linux/cpufreq.h>
+#include <linux/input.h>
+#include <linux/jiffies.h>
+#include <linux/module.h>
+#include <linux/mutex.h>
+#include <linux/pm_qos.h>
+#include <linux/slab.h>
+#include <linux/workqueue.h>
+
+static unsigned int input_boost_freq;
+static unsigned int input_boost_ms = 100;
+
+static DEFINE_PER_CPU(struct dev_pm_qos_request, input_boost_req);
+
+/* Protects the boost state and statistics below. */
+static DEFINE_MUTEX(input_boost_lock);
+static bool input_boost_active;
+static unsigned long input_boost_start;
+static unsigned long input_boost_count;
+static u64 input_boost_time;		/* in jiffies */
+
+static void input_boost_set_floor(bool on)
+{
+	unsigned int cpu;
+
+	for_each_possible_cpu(cpu) {
+		struct dev_pm_qos_request *req = &per_cpu(input_boost_req, cpu);
+		unsigned int floor = 0;
+
+		if (!dev_pm_qos_request_active(req))
+			continue;
+
+		if (on) {
+			struct cpufreq_policy *policy = cpufreq_cpu_get(cpu);
+
+			if (!policy)
+				continue;
+
+			floor = policy->cpuinfo.max_freq;
+			if (input_boost_freq)
+				floor = min(floor, input_boost_freq);
+			cpufreq_cpu_put(policy);
+		}
+
+		dev_pm_qos_update_request(req, floor);
+	}
+}
+
+static void input_boost_off(struct work_struct *work)
+{
+	mutex_lock(&input_boost_lock);
+	if (input_boost_active) {
+		input_boost_set_floor(false);
+		input_boost_active = false;
+		input_boost_time += jiffies - input_boost_start;
+	}
+	mutex_unlock(&input_boost_lock);
+}
+
+static DECLARE_DELAYED_WORK(input_boost_off_work, input_boost_off);
+
+static void input_boost_on(struct work_struct *work)
+{
+	mutex_lock(&input_boost_lock);
+	if (!input_boost_active) {
+		input_boost_set_floor(true);
+		input_boost_active = true;
+		input_boost_start = jiffies;
+		input_boost_count++;
+	}
+	mod_delayed_work(system_wq, &input_boost_off_work,
+			 msecs_to_jiffies(input_boost_ms));
+	mutex_unlock(&input_boost_lock);
+}
+
+static DECLARE_WORK(input_boost_on_work, input_boost_on);
+
+/*
+ * Called with the input device event lock held and interrupts off, so the
+ * QoS update has to be done from process context. Queueing an already
+ * pending work item is a single test_and_set_bit(), which keeps the cost
+ * of a stream of motion events down.
+ */
+static void input_boost_event(struct input_handle *handle, unsigned int type,
+			      unsigned int code, int value)
+{
+	if (type == EV_SYN)
+		return;
+
+	queue_work(system_highpri_wq, &input_boost_on_work);
+}
+
+static int input_boost_connect(struct input_handler *handler,
+			       struct input_dev *dev,
+			       const struct input_device_id *id)
+{
+	struct input_handle *handle;
+	int error;
+
+	handle = kzalloc(sizeof(*handle), GFP_KERNEL);
+	if (!handle)
+		return -ENOMEM;
+
+	handle->dev = dev;
+	handle->handler = handler;
+	handle->name = "cpufreq_input_boost";
+
+	error = input_register_handle(handle);
+	if (error)
+		goto err_free;
+
+	error = input_open_device(handle);
+	if (error)
+		goto err_unregister;
+
+	return 0;
+
+err_unregister:
+	input_unregister_handle(handle);
+err_free:
+	kfree(handle);
+	return error;
+}
+
+static void input_boost_disconnect(struct input_handle *handle)
+{
+	input_close_device(handle);
+	input_unregister_handle(handle);
+	kfree(handle);
+}
+
+static const struct input_device_id input_boost_ids[] = {
+	/* multi-touch touchscreens */
+	{
+		.flags = INPUT_DEVICE_ID_MATCH_EVBIT |
+			 INPUT_DEVICE_ID_MATCH_ABSBIT,
+		.evbit = { BIT_MASK(EV_ABS) },
+		.absbit = { [BIT_WORD(ABS_MT_POSITION_X)] =
+			    BIT_MASK(ABS_MT_POSITION_X) },
+	},
+	/* single-touch touchscreens and touchpads */
+	{
+		.flags = INPUT_DEVICE_ID_MATCH_KEYBIT |
+			 INPUT_DEVICE_ID_MATCH_ABSBIT,
+		.keybit = { [BIT_WORD(BTN_TOUCH)] = BIT_MASK(BTN_TOUCH) },
+		.absbit = { [BIT_WORD(ABS_X)] = BIT_MASK(ABS_X) },
+	},
+	/* mice and scroll wheels */
+	{
+		.flags = INPUT_DEVICE_ID_MATCH_EVBIT,
+		.evbit = { BIT_MASK(EV_REL) },
+	},
+	/* keyboards and buttons */
+	{
+		.flags = INPUT_DEVICE_ID_MATCH_EVBIT,
+		.evbit = { BIT_MASK(EV_KEY) },
+	},
+	{ },
+};
+
+static struct input_handler input_boost_handler = {
+	.event		= input_boost_event,
+	.connect	= input_boost_connect,
+	.disconnect	= input_boost_disconnect,
+	.name		= "cpufreq_input_boost",
+	.id_table	= input_boost_ids,
+};
+
+static ssize_t show_freq(struct kobject *kobj, struct kobj_attribute *attr,
+			 char *buf)
+{
+	return sprintf(buf, "%u\n", input_boost_freq);
+}
+
+static ssize_t store_freq(struct kobject *kobj, struct kobj_attribute *attr,
+			  const char *buf, size_t count)
+{
+	unsigned int val;
+	int ret;
+
+	ret = kstrtouint(buf, 0, &val);
+	if (ret)
+		return ret;
+
+	/* Takes effect from the next boost period on. */
+	WRITE_ONCE(input_boost_freq, val);
+	return count;
+}
+
+static ssize_t show_duration_ms(struct kobject *kobj,
+				struct kobj_attribute *attr, char *buf)
+{
+	return sprintf(buf, "%u\n", input_boost_ms);
+}
+
+static ssize_t store_duration_ms(struct kobject *kobj,
+				 struct kobj_attribute *attr,
+				 const char *buf, size_t count)
+{
+	unsigned int val;
+	int ret;
+
+	ret = kstrtouint(buf, 0, &val);
+	if (ret)
+		return ret;
+
+	if (!val || val > MSEC_PER_SEC * 10)
+		return -EINVAL;
+
+	WRITE_ONCE(input_boost_ms, val);
+	return count;
+}
+
+static ssize_t show_count(struct kobject *kobj, struct kobj_attribute *attr,
+			  char *buf)
+{
+	return sprintf(buf, "%lu\n", READ_ONCE(input_boost_count));
+}
+
+static ssize_t show_time_ms(struct kobject *kobj, struct kobj_attribute *attr,
+			    char *buf)
+{
+	u64 time;
+
+	mutex_lock(&input_boost_lock);
+	time = input_boost_time;
+	if (input_boost_active)
+		time += jiffies - input_boost_start;
+	mutex_unlock(&input_boost_lock);
+
+	return sprintf(buf, "%llu\n", jiffies64_to_msecs(time));
+}
+
+define_one_global_rw(freq);
+define_one_global_rw(duration_ms);
+define_one_global_ro(count);
+define_one_global_ro(time_ms);
+
+static struct attribute *input_boost_attrs[] = {
+	&freq.attr,
+	&duration_ms.attr,
+	&count.attr,
+	&time_ms.attr,
+	NULL
+};
+
+static const struct attribute_group input_boost_attr_group = {
+	.name = "input_boost",
+	.attrs = input_boost_attrs,
+};
+
+static void input_boost_remove_requests(void)
+{
+	unsigned int cpu;
+
+	for_each_possible_cpu(cpu) {
+		struct dev_pm_qos_request *req = &per_cpu(input_boost_req, cpu);
+
+		if (dev_pm_qos_request_active(req))
+			dev_pm_qos_remove_request(req);
+	}
+}
+
+static int __init input_boost_init(void)
+{
+	unsigned int cpu;
+	int ret;
+
+	/*
+	 * The policy reads its limits from the device of whichever CPU
+	 * currently manages it, so put a request on every CPU device.
+	 */
+	for_each_possible_cpu(cpu) {
+		struct device *dev = get_cpu_device(cpu);
+
+		if (!dev)
+			continue;
+
+		ret = dev_pm_qos_add_request(dev, &per_cpu(input_boost_req, cpu),
+					     DEV_PM_QOS_MIN_FREQUENCY, 0);
+		if (ret < 0)
+			goto err_requests;
+	}
+
+	ret = sysfs_create_group(cpufreq_global_kobject,
+				 &input_boost_attr_group);
+	if (ret)
+		goto err_requests;
+
+	ret = input_register_handler(&input_boost_handler);
+	if (ret)
+		goto err_sysfs;
+
+	return 0;
+
+err_sysfs:
+	sysfs_remove_group(cpufreq_global_kobject, &input_boost_attr_group);
+err_requests:
+	input_boost_remove_requests();
+	pr_err("initialization failed: %d\n", ret);
+	return ret;
+}
+
+static void __exit input_boost_exit(void)
+{
+	input_unregister_handler(&input_boost_handler);
+	sysfs_remove_group(cpufreq_global_kobject, &input_boost_attr_group);
+
+	cancel_work_sync(&input_boost_on_work);
+	cancel_delayed_work_sync(&input_boost_off_work);
+	input_boost_remove_requests();
+}
+
+module_init(input_boost_init);
+module_exit(input_boost_exit);
+
+MODULE_DESCRIPTION("Raise the CPU frequency floor on input events");
+MODULE_LICENSE("GPL v2");
@@ -43,9 +43,15 @@
  *   target residency of the idle state selected so far, use those values to
  *   compute the new expected idle duration and find an idle state matching it
  *   (which has to be shallower than the one selected so far).
+ *
+ * With CONFIG_CPU_IDLE_GOV_TEO_IRQ_TIMINGS, interrupts recurring with a stable
+ * period are taken into account too: if the IRQ timings code predicts one of
+ * them before the closest timer, the time till that interrupt is used in place
+ * of the sleep length when looking for an idle state.
  */
 
 #include <linux/cpuidle.h>
+#include <linux/interrupt.h>
 #include <linux/jiffies.h>
 #include <linux/kernel.h>
 #include <linux/sched/clock.h>
@@ -230,6 +236,34 @@ static int teo_find_shallower_state(struct cpuidle_driver *drv,
 	return state_idx;
 }
 
+#ifdef CONFIG_CPU_IDLE_GOV_TEO_IRQ_TIMINGS
+/**
+ * teo_irq_duration_us - Bound the expected idle duration by the next IRQ.
+ * @duration_us: Time till the closest timer event.
+ *
+ * Must be called with interrupts disabled, as required by
+ * irq_timings_next_event().
+ */
+static unsigned int teo_irq_duration_us(unsigned int duration_us)
+{
+	u64 now = local_clock();
+	u64 next_irq = irq_timings_next_event(now);
+	u64 irq_us;
+
+	if (next_irq == U64_MAX)
+		return duration_us;
+
+	irq_us = div_u64(next_irq - now, NSEC_PER_USEC);
+
+	return min_t(u64, duration_us, irq_us);
+}
+#else
+static inline unsigned int teo_irq_duration_us(unsigned int duration_us)
+{
+	return duration_us;
+}
+#endif
+
 /**
  * teo_select - Selects the next idle state to enter.
  * @drv: cpuidle driver containing state data.
@@ -253,7 +287,7 @@ static int teo_select(struct cpuidle_driver *drv, struct cpuidle_device *dev,
 	cpu_data->time_span_ns = local_clock();
 
 	cpu_data->sleep_length_ns = tick_nohz_get_sleep_length(&delta_tick);
-	duration_us = ktime_to_us(cpu_data->sleep_length_ns);
+	duration_us = teo_irq_duration_us(ktime_to_us(cpu_data->sleep_length_ns));
 
 	count = 0;
 	max_early_idx = -1;
@@ -438,6 +472,9 @@ static struct cpuidle_governor teo_governor = {
 
 static int __init teo_governor_init(void)
 {
+#ifdef CONFIG_CPU_IDLE_GOV_TEO_IRQ_TIMINGS
+	irq_timings_enable();
+#endif
 	return cpuidle_register_governor(&teo_governor);
 }
 
@@ -17,6 +17,7 @@
 #include <linux/slab.h>
 #include <linux/stat.h>
 #include <linux/pm_opp.h>
+#include <linux/pm_qos.h>
 #include <linux/devfreq.h>
 #include <linux/workqueue.h>
 #include <linux/platform_device.h>
@@ -335,6 +336,7 @@ static int devfreq_set_target(struct devfreq *devfreq, unsigned long new_freq,
 int update_devfreq(struct devfreq *devfreq)
 {
 	unsigned long freq, min_freq, max_freq;
+	u64 qos_min_freq;
 	int err = 0;
 	u32 flags = 0;
 
@@ -361,6 +363,19 @@ int update_devfreq(struct devfreq *devfreq)
 	max_freq = min(devfreq->scaling_max_freq, devfreq->max_freq);
 	min_freq = max(devfreq->scaling_min_freq, devfreq->min_freq);
 
+	/*
+	 * Other drivers that know they are about to load this device (e.g. a
+	 * GPU or codec sitting on a bus) can request a floor through
+	 * DEV_PM_QOS_MIN_FREQUENCY on the parent device. The QoS value is in
+	 * kHz, devfreq works in Hz; on 32-bit the conversion can exceed an
+	 * unsigned long, so do it in 64 bits and saturate.
+	 */
+	qos_min_freq = dev_pm_qos_read_value(devfreq->dev.parent,
+					     DEV_PM_QOS_MIN_FREQUENCY);
+	qos_min_freq *= 1000;
+	min_freq = max_t(unsigned long, min_freq,
+			 min_t(u64, qos_min_freq, ULONG_MAX));
+
 	if (freq < min_freq) {
 		freq = min_freq;
 		flags &= ~DEVFREQ_FLAG_LEAST_UPPER_BOUND; /* Use GLB */
@@ -572,6 +587,29 @@ static int devfreq_notifier_call(struct notifier_block *nb, unsigned long type,
 	return ret;
 }
 
+/**
+ * devfreq_qos_min_notifier_call() - Re-evaluate the frequency after a change
+ *				     of the device PM QoS minimum frequency.
+ * @nb:		the notifier_block (supposed to be devfreq->nb_min)
+ * @val:	the new aggregated minimum frequency in kHz, not used
+ * @ptr:	not used
+ */
+static int devfreq_qos_min_notifier_call(struct notifier_block *nb,
+					 unsigned long val, void *ptr)
+{
+	struct devfreq *devfreq = container_of(nb, struct devfreq, nb_min);
+	int err;
+
+	mutex_lock(&devfreq->lock);
+	err = update_devfreq(devfreq);
+	mutex_unlock(&devfreq->lock);
+	if (err)
+		dev_err(devfreq->dev.parent,
+			"failed to update frequency from PM QoS (%d)\n", err);
+
+	return NOTIFY_OK;
+}
+
 /**
  * devfreq_dev_release() - Callback for struct device to release the device.
  * @dev:	the devfreq device
@@ -712,6 +750,16 @@ struct devfreq *devfreq_add_device(struct device *dev,
 
 	mutex_unlock(&devfreq->lock);
 
+	/*
+	 * The QoS notifier is called with the dev_pm_qos lock held and takes
+	 * devfreq->lock, so it must not be added with devfreq->lock held.
+	 */
+	devfreq->nb_min.notifier_call = devfreq_qos_min_notifier_call;
+	err = dev_pm_qos_add_notifier(devfreq->dev.parent, &devfreq->nb_min,
+				      DEV_PM_QOS_MIN_FREQUENCY);
+	if (err)
+		goto err_devfreq;
+
 	mutex_lock(&devfreq_list_lock);
 
 	governor = try_then_request_governor(devfreq->governor_name);
@@ -760,6 +808,9 @@ int devfreq_remove_device(struct devfreq *devfreq)
 	if (!devfreq)
 		return -EINVAL;
 
+	dev_pm_qos_remove_notifier(devfreq->dev.parent, &devfreq->nb_min,
+				   DEV_PM_QOS_MIN_FREQUENCY);
+
 	if (devfreq->governor)
 		devfreq->governor->event_handler(devfreq,
 						 DEVFREQ_GOV_STOP, NULL);
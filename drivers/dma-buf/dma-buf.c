@@ -560,6 +560,10 @@ struct dma_buf *dma_buf_export(const struct dma_buf_export_info *exp_info)
 
 	mutex_init(&dmabuf->lock);
 	INIT_LIST_HEAD(&dmabuf->attachments);
+	spin_lock_init(&dmabuf->sync.lock);
+	/* nothing is known about the CPU caches yet */
+	dmabuf->sync.dev_gen = 1;
+	dmabuf->sync.cpu_dirty = true;
 
 	mutex_lock(&db_list.lock);
 	list_add(&dmabuf->list_node, &db_list.head);
@@ -698,6 +702,67 @@ struct dma_buf_attachment *dma_buf_attach(struct dma_buf *dmabuf,
 }
 EXPORT_SYMBOL_GPL(dma_buf_attach);
 
+/*
+ * A device may access the buffer for as long as it is mapped. Any change
+ * in the device mappings invalidates what we know about the CPU caches.
+ */
+static void dma_buf_sync_track_map(struct dma_buf *dmabuf, int delta)
+{
+	spin_lock(&dmabuf->sync.lock);
+	dmabuf->sync.dev_mappings += delta;
+	dmabuf->sync.dev_gen++;
+	spin_unlock(&dmabuf->sync.lock);
+}
+
+/*
+ * Returns false if the begin_cpu_access cache maintenance can be left out:
+ * the CPU view was made coherent after the last device mapping went away
+ * and no device has mapped the buffer since. *@gen returns the generation
+ * the CPU view will be coherent with once the sync is done.
+ */
+static bool dma_buf_sync_begin_needed(struct dma_buf *dmabuf,
+				      enum dma_data_direction direction,
+				      unsigned long *gen)
+{
+	struct dma_buf_sync_state *sync = &dmabuf->sync;
+	bool needed;
+
+	spin_lock(&sync->lock);
+	needed = sync->dev_mappings || sync->cpu_gen != sync->dev_gen;
+	*gen = sync->dev_gen;
+	if (direction != DMA_FROM_DEVICE)
+		sync->cpu_dirty = true;
+	if (needed)
+		sync->done++;
+	else
+		sync->skipped++;
+	spin_unlock(&sync->lock);
+
+	return needed;
+}
+
+/*
+ * Returns false if the end_cpu_access cache maintenance can be left out
+ * because the CPU hasn't written to the buffer since the last one.
+ */
+static bool dma_buf_sync_end_needed(struct dma_buf *dmabuf,
+				    enum dma_data_direction direction)
+{
+	struct dma_buf_sync_state *sync = &dmabuf->sync;
+	bool needed;
+
+	spin_lock(&sync->lock);
+	needed = sync->cpu_dirty || direction != DMA_FROM_DEVICE;
+	sync->cpu_dirty = false;
+	if (needed)
+		sync->done++;
+	else
+		sync->skipped++;
+	spin_unlock(&sync->lock);
+
+	return needed;
+}
+
 /**
  * dma_buf_detach - Remove the given attachment from dmabuf's attachments list;
  * optionally calls detach() of dma_buf_ops for device-specific detach
@@ -711,8 +776,10 @@ void dma_buf_detach(struct dma_buf *dmabuf, struct dma_buf_attachment *attach)
 	if (WARN_ON(!dmabuf || !attach))
 		return;
 
-	if (attach->sgt)
+	if (attach->sgt) {
 		dmabuf->ops->unmap_dma_buf(attach, attach->sgt, attach->dir);
+		dma_buf_sync_track_map(dmabuf, -1);
+	}
 
 	mutex_lock(&dmabuf->lock);
 	list_del(&attach->node);
@@ -765,6 +832,9 @@ struct sg_table *dma_buf_map_attachment(struct dma_buf_attachment *attach,
 	if (!sg_table)
 		sg_table = ERR_PTR(-ENOMEM);
 
+	if (!IS_ERR(sg_table))
+		dma_buf_sync_track_map(attach->dmabuf, 1);
+
 	if (!IS_ERR(sg_table) && attach->dmabuf->ops->cache_sgt_mapping) {
 		attach->sgt = sg_table;
 		attach->dir = direction;
@@ -797,6 +867,7 @@ void dma_buf_unmap_attachment(struct dma_buf_attachment *attach,
 		return;
 
 	attach->dmabuf->ops->unmap_dma_buf(attach, sg_table, direction);
+	dma_buf_sync_track_map(attach->dmabuf, -1);
 }
 EXPORT_SYMBOL_GPL(dma_buf_unmap_attachment);
 
@@ -938,14 +1009,25 @@ static int __dma_buf_begin_cpu_access(struct dma_buf *dmabuf,
 int dma_buf_begin_cpu_access(struct dma_buf *dmabuf,
 			     enum dma_data_direction direction)
 {
+	unsigned long gen = 0;
+	bool sync = true;
 	int ret = 0;
 
 	if (WARN_ON(!dmabuf))
 		return -EINVAL;
 
-	if (dmabuf->ops->begin_cpu_access)
+	if (dmabuf->ops->skip_redundant_cpu_sync)
+		sync = dma_buf_sync_begin_needed(dmabuf, direction, &gen);
+
+	if (dmabuf->ops->begin_cpu_access && sync)
 		ret = dmabuf->ops->begin_cpu_access(dmabuf, direction);
 
+	if (ret == 0 && sync && dmabuf->ops->skip_redundant_cpu_sync) {
+		spin_lock(&dmabuf->sync.lock);
+		dmabuf->sync.cpu_gen = gen;
+		spin_unlock(&dmabuf->sync.lock);
+	}
+
 	/* Ensure that all fences are waited upon - but we first allow
 	 * the native handler the chance to do so more efficiently if it
 	 * chooses. A double invocation here will be reasonably cheap no-op.
@@ -976,6 +1058,10 @@ int dma_buf_end_cpu_access(struct dma_buf *dmabuf,
 
 	WARN_ON(!dmabuf);
 
+	if (dmabuf->ops->skip_redundant_cpu_sync &&
+	    !dma_buf_sync_end_needed(dmabuf, direction))
+		return 0;
+
 	if (dmabuf->ops->end_cpu_access)
 		ret = dmabuf->ops->end_cpu_access(dmabuf, direction);
 
@@ -1159,6 +1245,7 @@ static int dma_buf_debug_show(struct seq_file *s, void *unused)
 	struct dma_fence *fence;
 	unsigned seq;
 	int count = 0, attach_count, shared_count, i;
+	unsigned long syncs_done = 0, syncs_skipped = 0;
 	size_t size = 0;
 
 	ret = mutex_lock_interruptible(&db_list.lock);
@@ -1224,15 +1311,27 @@ static int dma_buf_debug_show(struct seq_file *s, void *unused)
 			attach_count++;
 		}
 
-		seq_printf(s, "Total %d devices attached\n\n",
+		seq_printf(s, "Total %d devices attached\n",
 				attach_count);
 
+		if (buf_obj->ops->skip_redundant_cpu_sync) {
+			spin_lock(&buf_obj->sync.lock);
+			seq_printf(s, "CPU access syncs: %lu done, %lu skipped\n",
+				   buf_obj->sync.done, buf_obj->sync.skipped);
+			syncs_done += buf_obj->sync.done;
+			syncs_skipped += buf_obj->sync.skipped;
+			spin_unlock(&buf_obj->sync.lock);
+		}
+		seq_puts(s, "\n");
+
 		count++;
 		size += buf_obj->size;
 		mutex_unlock(&buf_obj->lock);
 	}
 
 	seq_printf(s, "\nTotal %d objects, %zu bytes\n", count, size);
+	seq_printf(s, "Total CPU access syncs: %lu done, %lu skipped\n",
+		   syncs_done, syncs_skipped);
 
 	mutex_unlock(&db_list.lock);
 	return 0;
@@ -357,6 +357,12 @@ struct _pl330_req {
 	u32 mc_bus;
 	void *mc_cpu;
 	struct dma_pl330_desc *desc;
+	/* Shape of the program last built in mc_cpu, see _reuse_req() */
+	bool mc_valid;
+	u32 mc_ccr;
+	u32 mc_bytes;
+	unsigned mc_peri;
+	enum dma_transfer_direction mc_rqtype;
 };
 
 /* ToBeDone for tasklet */
@@ -1420,6 +1426,43 @@ static int _setup_req(struct pl330_dmac *pl330, unsigned dry_run,
 	return off;
 }
 
+/*
+ * The program built by _setup_req() depends on the addresses only through
+ * the DMAMOV SAR/DAR that follow DMAMOV CCR. Back-to-back reqs of the same
+ * shape, i.e. the periods of a cyclic transfer or the entries of an SG list
+ * of equal sized chunks, can therefore keep the loops already in the buffer
+ * and just patch in their addresses.
+ */
+static bool _reuse_req(struct pl330_thread *thrd, unsigned index,
+		       const struct _xfer_spec *pxs)
+{
+	struct _pl330_req *req = &thrd->req[index];
+	struct dma_pl330_desc *desc = pxs->desc;
+	u8 *buf = req->mc_cpu;
+
+	if (!req->mc_valid || req->mc_ccr != pxs->ccr ||
+	    req->mc_bytes != desc->px.bytes ||
+	    req->mc_rqtype != desc->rqtype || req->mc_peri != desc->peri)
+		return false;
+
+	_emit_MOV(0, &buf[SZ_DMAMOV], SAR, desc->px.src_addr);
+	_emit_MOV(0, &buf[2 * SZ_DMAMOV], DAR, desc->px.dst_addr);
+
+	return true;
+}
+
+static void _cache_req(struct pl330_thread *thrd, unsigned index,
+		       const struct _xfer_spec *pxs)
+{
+	struct _pl330_req *req = &thrd->req[index];
+
+	req->mc_ccr = pxs->ccr;
+	req->mc_bytes = pxs->desc->px.bytes;
+	req->mc_rqtype = pxs->desc->rqtype;
+	req->mc_peri = pxs->desc->peri;
+	req->mc_valid = true;
+}
+
 static inline u32 _prepare_ccr(const struct pl330_reqcfg *rqc)
 {
 	u32 ccr = 0;
@@ -1517,6 +1560,12 @@ static int pl330_submit_req(struct pl330_thread *thrd,
 	xs.ccr = ccr;
 	xs.desc = desc;
 
+	if (_reuse_req(thrd, idx, &xs)) {
+		thrd->lstenq = idx;
+		thrd->req[idx].desc = desc;
+		goto xfer_exit;
+	}
+
 	/* First dry run to check if req is acceptable */
 	ret = _setup_req(pl330, 1, thrd, idx, &xs);
 	if (ret < 0)
@@ -1533,6 +1582,7 @@ static int pl330_submit_req(struct pl330_thread *thrd,
 	thrd->lstenq = idx;
 	thrd->req[idx].desc = desc;
 	_setup_req(pl330, 0, thrd, idx, &xs);
+	_cache_req(thrd, idx, &xs);
 
 	ret = 0;
 
@@ -1769,6 +1819,9 @@ static struct pl330_thread *pl330_request_channel(struct pl330_dmac *pl330)
 				thrd->lstenq = 1;
 				thrd->req[0].desc = NULL;
 				thrd->req[1].desc = NULL;
+				/* The programs embed the old event number */
+				thrd->req[0].mc_valid = false;
+				thrd->req[1].mc_valid = false;
 				thrd->req_running = -1;
 				break;
 			}
@@ -1858,12 +1911,14 @@ static inline void _reset_thread(struct pl330_thread *thrd)
 	thrd->req[0].mc_bus = pl330->mcode_bus
 				+ (thrd->id * pl330->mcbufsz);
 	thrd->req[0].desc = NULL;
+	thrd->req[0].mc_valid = false;
 
 	thrd->req[1].mc_cpu = thrd->req[0].mc_cpu
 				+ pl330->mcbufsz / 2;
 	thrd->req[1].mc_bus = thrd->req[0].mc_bus
 				+ pl330->mcbufsz / 2;
 	thrd->req[1].desc = NULL;
+	thrd->req[1].mc_valid = false;
 
 	thrd->req_running = -1;
 }
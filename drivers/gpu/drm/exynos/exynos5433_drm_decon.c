@@ -673,7 +673,7 @@ static void decon_handle_vblank(struct decon_context *ctx)
 	if (frm != ctx->frame_id) {
 		/* handle only if incremented, take care of wrap-around */
 		if ((s32)(frm - ctx->frame_id) > 0)
-			drm_crtc_handle_vblank(&ctx->crtc->base);
+			exynos_drm_crtc_handle_vblank(ctx->crtc);
 		ctx->frame_id = frm;
 	}
 
@@ -39,6 +39,9 @@ static void exynos_drm_crtc_atomic_disable(struct drm_crtc *crtc,
 	if (exynos_crtc->ops->disable)
 		exynos_crtc->ops->disable(exynos_crtc);
 
+	/* nothing is scanned out anymore, see exynos_drm_crtc_queue_fb_put() */
+	drm_flip_work_commit(&exynos_crtc->fb_unref_work, system_unbound_wq);
+
 	if (crtc->state->event && !crtc->state->active) {
 		spin_lock_irq(&crtc->dev->event_lock);
 		drm_crtc_send_vblank_event(crtc, crtc->state->event);
@@ -132,10 +135,48 @@ void exynos_crtc_handle_event(struct exynos_drm_crtc *exynos_crtc)
 	spin_unlock_irqrestore(&crtc->dev->event_lock, flags);
 }
 
+bool exynos_drm_crtc_handle_vblank(struct exynos_drm_crtc *exynos_crtc)
+{
+	bool ret = drm_crtc_handle_vblank(&exynos_crtc->base);
+
+	drm_flip_work_commit(&exynos_crtc->fb_unref_work, system_unbound_wq);
+
+	return ret;
+}
+
+static void exynos_drm_crtc_fb_unref_worker(struct drm_flip_work *work,
+					    void *val)
+{
+	struct exynos_drm_crtc *exynos_crtc =
+		container_of(work, struct exynos_drm_crtc, fb_unref_work);
+
+	drm_crtc_vblank_put(&exynos_crtc->base);
+	drm_framebuffer_put(val);
+}
+
+/*
+ * The framebuffer replaced by an async plane update is still scanned out
+ * until the hardware latches the new one at the next vblank, so its
+ * reference is only dropped from there. The vblank reference keeps the
+ * interrupt enabled until then.
+ */
+void exynos_drm_crtc_queue_fb_put(struct exynos_drm_crtc *exynos_crtc,
+				  struct drm_framebuffer *fb)
+{
+	if (WARN_ON(drm_crtc_vblank_get(&exynos_crtc->base))) {
+		drm_framebuffer_put(fb);
+		return;
+	}
+
+	drm_flip_work_queue(&exynos_crtc->fb_unref_work, fb);
+}
+
 static void exynos_drm_crtc_destroy(struct drm_crtc *crtc)
 {
 	struct exynos_drm_crtc *exynos_crtc = to_exynos_crtc(crtc);
 
+	flush_work(&exynos_crtc->fb_unref_work.worker);
+	drm_flip_work_cleanup(&exynos_crtc->fb_unref_work);
 	drm_crtc_cleanup(crtc);
 	kfree(exynos_crtc);
 }
@@ -158,9 +199,74 @@ static void exynos_drm_crtc_disable_vblank(struct drm_crtc *crtc)
 		exynos_crtc->ops->disable_vblank(exynos_crtc);
 }
 
+/*
+ * Async flips only swap the framebuffer of the primary plane. Marking the
+ * state as a legacy cursor update lets drm_atomic_helper_check() pick the
+ * plane async_update path, and when that is not possible the commit still
+ * does not wait for vblank. The event can't go through the commit since an
+ * async commit does not deliver it, so once the new framebuffer has been
+ * programmed it is armed for the vblank at which the hardware latches it.
+ */
+static int exynos_drm_crtc_async_page_flip(struct drm_crtc *crtc,
+				struct drm_framebuffer *fb,
+				struct drm_pending_vblank_event *event,
+				struct drm_modeset_acquire_ctx *ctx)
+{
+	struct drm_plane *plane = crtc->primary;
+	struct drm_atomic_state *state;
+	struct drm_plane_state *plane_state;
+	int ret;
+
+	state = drm_atomic_state_alloc(plane->dev);
+	if (!state)
+		return -ENOMEM;
+
+	state->acquire_ctx = ctx;
+	state->legacy_cursor_update = true;
+
+	plane_state = drm_atomic_get_plane_state(state, plane);
+	if (IS_ERR(plane_state)) {
+		ret = PTR_ERR(plane_state);
+		goto out;
+	}
+
+	ret = drm_atomic_set_crtc_for_plane(plane_state, crtc);
+	if (ret)
+		goto out;
+	drm_atomic_set_fb_for_plane(plane_state, fb);
+
+	ret = drm_atomic_commit(state);
+	if (ret == 0 && event) {
+		bool armed = drm_crtc_vblank_get(crtc) == 0;
+
+		spin_lock_irq(&crtc->dev->event_lock);
+		if (armed)
+			drm_crtc_arm_vblank_event(crtc, event);
+		else
+			drm_crtc_send_vblank_event(crtc, event);
+		spin_unlock_irq(&crtc->dev->event_lock);
+	}
+
+out:
+	drm_atomic_state_put(state);
+	return ret;
+}
+
+static int exynos_drm_crtc_page_flip(struct drm_crtc *crtc,
+				     struct drm_framebuffer *fb,
+				     struct drm_pending_vblank_event *event,
+				     uint32_t flags,
+				     struct drm_modeset_acquire_ctx *ctx)
+{
+	if (flags & DRM_MODE_PAGE_FLIP_ASYNC)
+		return exynos_drm_crtc_async_page_flip(crtc, fb, event, ctx);
+
+	return drm_atomic_helper_page_flip(crtc, fb, event, flags, ctx);
+}
+
 static const struct drm_crtc_funcs exynos_crtc_funcs = {
 	.set_config	= drm_atomic_helper_set_config,
-	.page_flip	= drm_atomic_helper_page_flip,
+	.page_flip	= exynos_drm_crtc_page_flip,
 	.destroy	= exynos_drm_crtc_destroy,
 	.reset = drm_atomic_helper_crtc_reset,
 	.atomic_duplicate_state = drm_atomic_helper_crtc_duplicate_state,
@@ -186,6 +292,8 @@ struct exynos_drm_crtc *exynos_drm_crtc_create(struct drm_device *drm_dev,
 	exynos_crtc->type = type;
 	exynos_crtc->ops = ops;
 	exynos_crtc->ctx = ctx;
+	drm_flip_work_init(&exynos_crtc->fb_unref_work, "fb_unref",
+			   exynos_drm_crtc_fb_unref_worker);
 
 	crtc = &exynos_crtc->base;
 
@@ -200,6 +308,7 @@ struct exynos_drm_crtc *exynos_drm_crtc_create(struct drm_device *drm_dev,
 
 err_crtc:
 	plane->funcs->destroy(plane);
+	drm_flip_work_cleanup(&exynos_crtc->fb_unref_work);
 	kfree(exynos_crtc);
 	return ERR_PTR(ret);
 }
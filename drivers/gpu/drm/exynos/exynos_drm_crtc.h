@@ -39,4 +39,13 @@ void exynos_drm_crtc_te_handler(struct drm_crtc *crtc);
 
 void exynos_crtc_handle_event(struct exynos_drm_crtc *exynos_crtc);
 
+/*
+ * Called by the crtc drivers from their vblank interrupt instead of
+ * drm_crtc_handle_vblank(), it also releases the framebuffers queued
+ * with exynos_drm_crtc_queue_fb_put().
+ */
+bool exynos_drm_crtc_handle_vblank(struct exynos_drm_crtc *exynos_crtc);
+void exynos_drm_crtc_queue_fb_put(struct exynos_drm_crtc *exynos_crtc,
+				  struct drm_framebuffer *fb);
+
 #endif
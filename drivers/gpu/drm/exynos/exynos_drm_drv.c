@@ -34,9 +34,10 @@
  *
  * 1.0 - Original version
  * 1.1 - Upgrade IPP driver to version 2.0
+ * 1.2 - Add IPP chain commit ioctl
  */
 #define DRIVER_MAJOR	1
-#define DRIVER_MINOR	1
+#define DRIVER_MINOR	2
 
 static int exynos_drm_open(struct drm_device *dev, struct drm_file *file)
 {
@@ -98,6 +99,9 @@ static const struct drm_ioctl_desc exynos_ioctls[] = {
 			DRM_AUTH | DRM_RENDER_ALLOW),
 	DRM_IOCTL_DEF_DRV(EXYNOS_IPP_COMMIT, exynos_drm_ipp_commit_ioctl,
 			DRM_AUTH | DRM_RENDER_ALLOW),
+	DRM_IOCTL_DEF_DRV(EXYNOS_IPP_CHAIN_COMMIT,
+			exynos_drm_ipp_chain_commit_ioctl,
+			DRM_AUTH | DRM_RENDER_ALLOW),
 };
 
 static const struct file_operations exynos_drm_driver_fops = {
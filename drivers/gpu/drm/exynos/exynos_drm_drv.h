@@ -11,10 +11,13 @@
 #ifndef _EXYNOS_DRM_DRV_H_
 #define _EXYNOS_DRM_DRV_H_
 
+#include <linux/mmu_notifier.h>
 #include <linux/module.h>
+#include <linux/rbtree.h>
 
 #include <drm/drm_crtc.h>
 #include <drm/drm_device.h>
+#include <drm/drm_flip_work.h>
 #include <drm/drm_plane.h>
 
 #define MAX_CRTC	3
@@ -172,6 +175,7 @@ struct exynos_drm_crtc {
 	const struct exynos_drm_crtc_ops	*ops;
 	void				*ctx;
 	struct exynos_drm_clk		*pipe_clk;
+	struct drm_flip_work		fb_unref_work;
 	bool				i80_mode : 1;
 };
 
@@ -186,7 +190,15 @@ struct drm_exynos_file_private {
 	/* for g2d api */
 	struct list_head	inuse_cmdlist;
 	struct list_head	event_list;
+
+	/* pinned userptr buffers, see g2d_userptr_get_dma_addr() */
 	struct list_head	userptr_list;
+	struct list_head	userptr_stale;
+	struct rb_root_cached	userptr_tree;
+	spinlock_t		userptr_lock;
+	unsigned long		userptr_seq;
+	struct mmu_notifier	userptr_mn;
+	struct mm_struct	*userptr_mm;
 };
 
 /*
@@ -179,5 +179,8 @@ void exynos_drm_mode_config_init(struct drm_device *dev)
 
 	dev->mode_config.allow_fb_modifiers = true;
 
+	/* see exynos_drm_crtc_async_page_flip() */
+	dev->mode_config.async_page_flip = true;
+
 	dev->mode_config.normalize_zpos = true;
 }
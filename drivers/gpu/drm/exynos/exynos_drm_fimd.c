@@ -997,7 +997,7 @@ static void fimd_te_handler(struct exynos_drm_crtc *crtc)
 	}
 
 	if (test_bit(0, &ctx->irq_flags))
-		drm_crtc_handle_vblank(&ctx->crtc->base);
+		exynos_drm_crtc_handle_vblank(ctx->crtc);
 }
 
 static void fimd_dp_clock_enable(struct exynos_drm_clk *clk, bool enable)
@@ -1037,7 +1037,7 @@ static irqreturn_t fimd_irq_handler(int irq, void *dev_id)
 		goto out;
 
 	if (!ctx->i80_if)
-		drm_crtc_handle_vblank(&ctx->crtc->base);
+		exynos_drm_crtc_handle_vblank(ctx->crtc);
 
 	if (ctx->i80_if) {
 		/* Exits triggering mode */
@@ -4,14 +4,17 @@
  * Authors: Joonyoung Shim <jy0922.shim@samsung.com>
  */
 
+#include <linux/capability.h>
 #include <linux/clk.h>
 #include <linux/component.h>
 #include <linux/delay.h>
 #include <linux/dma-mapping.h>
 #include <linux/err.h>
 #include <linux/interrupt.h>
+#include <linux/interval_tree.h>
 #include <linux/io.h>
 #include <linux/kernel.h>
+#include <linux/mmu_notifier.h>
 #include <linux/of.h>
 #include <linux/platform_device.h>
 #include <linux/pm_runtime.h>
@@ -19,6 +22,7 @@
 #include <linux/uaccess.h>
 #include <linux/workqueue.h>
 
+#include <drm/drm_auth.h>
 #include <drm/drm_file.h>
 #include <drm/exynos_drm.h>
 
@@ -122,6 +126,9 @@
 /* maximum buffer pool size of userptr is 64MB as default */
 #define MAX_POOL		(64 * 1024 * 1024)
 
+/* maximum number of runqueue nodes chained into one dma run */
+#define G2D_RUNQUEUE_MERGE_MAX	8
+
 enum {
 	BUF_TYPE_GEM = 1,
 	BUF_TYPE_USERPTR,
@@ -200,16 +207,27 @@ struct drm_exynos_pending_g2d_event {
 	struct drm_exynos_g2d_event	event;
 };
 
+/*
+ * A pinned userptr buffer. While cached it sits in the file's interval tree
+ * and userptr_list and stays pinned with a zero refcount, so the next
+ * cmdlist using the same buffer skips get_vaddr_frames() and dma_map_sg().
+ * The mmu notifier takes it out of the tree when its range is unmapped or
+ * remapped; it is then released by the last user, or from the stale list
+ * if it was idle.
+ */
 struct g2d_cmdlist_userptr {
 	struct list_head	list;
+	struct interval_tree_node	itree;
+	struct drm_exynos_file_private	*file_priv;
 	dma_addr_t		dma_addr;
 	unsigned long		userptr;
 	unsigned long		size;
 	struct frame_vector	*vec;
 	struct sg_table		*sgt;
-	atomic_t		refcount;
+	/* refcount and in_tree are protected by file_priv->userptr_lock */
+	unsigned int		refcount;
 	bool			in_pool;
-	bool			out_of_list;
+	bool			in_tree;
 };
 struct g2d_cmdlist_node {
 	struct list_head	list;
@@ -224,6 +242,8 @@ struct g2d_runqueue_node {
 	struct list_head	list;
 	struct list_head	run_cmdlist;
 	struct list_head	event_list;
+	/* nodes whose cmdlists were chained behind ours, see g2d_merge */
+	struct list_head	merged;
 	struct drm_file		*filp;
 	pid_t			pid;
 	struct completion	complete;
@@ -250,11 +270,11 @@ struct g2d_data {
 
 	/* runqueue*/
 	struct g2d_runqueue_node	*runqueue_node;
-	struct list_head		runqueue;
+	struct list_head		runqueue[G2D_PRIORITY_NUM];
 	struct mutex			runqueue_mutex;
 	struct kmem_cache		*runqueue_slab;
 
-	unsigned long			current_pool;
+	atomic_long_t			current_pool;
 	unsigned long			max_pool;
 };
 
@@ -372,28 +392,12 @@ static void g2d_add_cmdlist_to_inuse(struct drm_exynos_file_private *file_priv,
 		list_add_tail(&node->event->base.link, &file_priv->event_list);
 }
 
-static void g2d_userptr_put_dma_addr(struct g2d_data *g2d,
-					void *obj,
-					bool force)
+static void g2d_userptr_free(struct g2d_data *g2d,
+			     struct g2d_cmdlist_userptr *g2d_userptr)
 {
-	struct g2d_cmdlist_userptr *g2d_userptr = obj;
+	unsigned int npages = frame_vector_count(g2d_userptr->vec);
 	struct page **pages;
 
-	if (!obj)
-		return;
-
-	if (force)
-		goto out;
-
-	atomic_dec(&g2d_userptr->refcount);
-
-	if (atomic_read(&g2d_userptr->refcount) > 0)
-		return;
-
-	if (g2d_userptr->in_pool)
-		return;
-
-out:
 	dma_unmap_sg(to_dma_dev(g2d->drm_dev), g2d_userptr->sgt->sgl,
 			g2d_userptr->sgt->nents, DMA_BIDIRECTIONAL);
 
@@ -401,20 +405,157 @@ static void g2d_userptr_put_dma_addr(struct g2d_data *g2d,
 	if (!IS_ERR(pages)) {
 		int i;
 
-		for (i = 0; i < frame_vector_count(g2d_userptr->vec); i++)
+		for (i = 0; i < npages; i++)
 			set_page_dirty_lock(pages[i]);
 	}
 	put_vaddr_frames(g2d_userptr->vec);
 	frame_vector_destroy(g2d_userptr->vec);
 
-	if (!g2d_userptr->out_of_list)
-		list_del_init(&g2d_userptr->list);
+	if (g2d_userptr->in_pool)
+		atomic_long_sub(npages << PAGE_SHIFT, &g2d->current_pool);
 
 	sg_free_table(g2d_userptr->sgt);
 	kfree(g2d_userptr->sgt);
 	kfree(g2d_userptr);
 }
 
+static void g2d_userptr_put_dma_addr(struct g2d_data *g2d,
+					void *obj,
+					bool force)
+{
+	struct g2d_cmdlist_userptr *g2d_userptr = obj;
+	struct drm_exynos_file_private *file_priv;
+
+	if (!obj)
+		return;
+
+	file_priv = g2d_userptr->file_priv;
+
+	spin_lock(&file_priv->userptr_lock);
+
+	if (!force) {
+		g2d_userptr->refcount--;
+
+		/* cached buffers stay pinned for the next cmdlist */
+		if (g2d_userptr->refcount > 0 || g2d_userptr->in_tree) {
+			spin_unlock(&file_priv->userptr_lock);
+			return;
+		}
+	}
+
+	if (g2d_userptr->in_tree) {
+		interval_tree_remove(&g2d_userptr->itree,
+				     &file_priv->userptr_tree);
+		g2d_userptr->in_tree = false;
+	}
+	list_del_init(&g2d_userptr->list);
+
+	spin_unlock(&file_priv->userptr_lock);
+
+	g2d_userptr_free(g2d, g2d_userptr);
+}
+
+static void g2d_userptr_invalidate(struct drm_exynos_file_private *file_priv,
+				   unsigned long start, unsigned long last)
+{
+	struct interval_tree_node *it, *next;
+
+	spin_lock(&file_priv->userptr_lock);
+
+	/* makes a get_dma_addr() racing with us skip caching its pages */
+	file_priv->userptr_seq++;
+
+	it = interval_tree_iter_first(&file_priv->userptr_tree, start, last);
+	while (it) {
+		struct g2d_cmdlist_userptr *g2d_userptr =
+			container_of(it, struct g2d_cmdlist_userptr, itree);
+
+		next = interval_tree_iter_next(it, start, last);
+
+		interval_tree_remove(it, &file_priv->userptr_tree);
+		g2d_userptr->in_tree = false;
+
+		/*
+		 * Busy buffers keep their pages pinned until the engine is done
+		 * and are released by the last put, idle ones can't be released
+		 * here since that sleeps.
+		 */
+		if (g2d_userptr->refcount)
+			list_del_init(&g2d_userptr->list);
+		else
+			list_move_tail(&g2d_userptr->list,
+				       &file_priv->userptr_stale);
+
+		it = next;
+	}
+
+	spin_unlock(&file_priv->userptr_lock);
+}
+
+static int g2d_userptr_invalidate_range_start(struct mmu_notifier *mn,
+				const struct mmu_notifier_range *range)
+{
+	struct drm_exynos_file_private *file_priv =
+		container_of(mn, struct drm_exynos_file_private, userptr_mn);
+
+	g2d_userptr_invalidate(file_priv, range->start, range->end - 1);
+
+	return 0;
+}
+
+static void g2d_userptr_release(struct mmu_notifier *mn, struct mm_struct *mm)
+{
+	struct drm_exynos_file_private *file_priv =
+		container_of(mn, struct drm_exynos_file_private, userptr_mn);
+
+	g2d_userptr_invalidate(file_priv, 0, ULONG_MAX);
+}
+
+static const struct mmu_notifier_ops g2d_userptr_mn_ops = {
+	.release		= g2d_userptr_release,
+	.invalidate_range_start	= g2d_userptr_invalidate_range_start,
+};
+
+static void g2d_userptr_free_stale(struct g2d_data *g2d,
+				   struct drm_exynos_file_private *file_priv)
+{
+	struct g2d_cmdlist_userptr *g2d_userptr, *n;
+	LIST_HEAD(stale);
+
+	spin_lock(&file_priv->userptr_lock);
+	list_splice_init(&file_priv->userptr_stale, &stale);
+	spin_unlock(&file_priv->userptr_lock);
+
+	list_for_each_entry_safe(g2d_userptr, n, &stale, list)
+		g2d_userptr_free(g2d, g2d_userptr);
+}
+
+/*
+ * Only buffers of the mm the notifier watches can be cached, the notifier
+ * is registered by the first userptr cmdlist of the file.
+ */
+static bool g2d_userptr_can_cache(struct g2d_data *g2d,
+				  struct drm_exynos_file_private *file_priv)
+{
+	bool ret;
+
+	if (!current->mm)
+		return false;
+
+	mutex_lock(&g2d->cmdlist_mutex);
+
+	if (!file_priv->userptr_mm) {
+		file_priv->userptr_mn.ops = &g2d_userptr_mn_ops;
+		if (!mmu_notifier_register(&file_priv->userptr_mn, current->mm))
+			file_priv->userptr_mm = current->mm;
+	}
+	ret = file_priv->userptr_mm == current->mm;
+
+	mutex_unlock(&g2d->cmdlist_mutex);
+
+	return ret;
+}
+
 static dma_addr_t *g2d_userptr_get_dma_addr(struct g2d_data *g2d,
 					unsigned long userptr,
 					unsigned long size,
@@ -423,9 +564,11 @@ static dma_addr_t *g2d_userptr_get_dma_addr(struct g2d_data *g2d,
 {
 	struct drm_exynos_file_private *file_priv = filp->driver_priv;
 	struct g2d_cmdlist_userptr *g2d_userptr;
+	struct interval_tree_node *it;
 	struct sg_table	*sgt;
-	unsigned long start, end;
+	unsigned long start, end, seq;
 	unsigned int npages, offset;
+	bool cache;
 	int ret;
 
 	if (!size) {
@@ -433,46 +576,51 @@ static dma_addr_t *g2d_userptr_get_dma_addr(struct g2d_data *g2d,
 		return ERR_PTR(-EINVAL);
 	}
 
-	/* check if userptr already exists in userptr_list. */
-	list_for_each_entry(g2d_userptr, &file_priv->userptr_list, list) {
-		if (g2d_userptr->userptr == userptr) {
-			/*
-			 * also check size because there could be same address
-			 * and different size.
-			 */
-			if (g2d_userptr->size == size) {
-				atomic_inc(&g2d_userptr->refcount);
-				*obj = g2d_userptr;
-
-				return &g2d_userptr->dma_addr;
-			}
+	g2d_userptr_free_stale(g2d, file_priv);
 
-			/*
-			 * at this moment, maybe g2d dma is accessing this
-			 * g2d_userptr memory region so just remove this
-			 * g2d_userptr object from userptr_list not to be
-			 * referred again and also except it the userptr
-			 * pool to be released after the dma access completion.
-			 */
-			g2d_userptr->out_of_list = true;
-			g2d_userptr->in_pool = false;
-			list_del_init(&g2d_userptr->list);
+	start = userptr & PAGE_MASK;
+	offset = userptr & ~PAGE_MASK;
+	end = PAGE_ALIGN(userptr + size);
+	npages = (end - start) >> PAGE_SHIFT;
 
-			break;
+	cache = g2d_userptr_can_cache(g2d, file_priv);
+
+	spin_lock(&file_priv->userptr_lock);
+
+	/* check if userptr is already pinned and still mapped. */
+	it = cache ? interval_tree_iter_first(&file_priv->userptr_tree,
+					      start, end - 1) : NULL;
+	for (; it; it = interval_tree_iter_next(it, start, end - 1)) {
+		g2d_userptr = container_of(it, struct g2d_cmdlist_userptr,
+					   itree);
+
+		/*
+		 * also check size because there could be same address
+		 * and different size.
+		 */
+		if (g2d_userptr->userptr == userptr &&
+		    g2d_userptr->size == size) {
+			g2d_userptr->refcount++;
+			spin_unlock(&file_priv->userptr_lock);
+
+			*obj = g2d_userptr;
+			return &g2d_userptr->dma_addr;
 		}
 	}
 
+	seq = file_priv->userptr_seq;
+
+	spin_unlock(&file_priv->userptr_lock);
+
 	g2d_userptr = kzalloc(sizeof(*g2d_userptr), GFP_KERNEL);
 	if (!g2d_userptr)
 		return ERR_PTR(-ENOMEM);
 
-	atomic_set(&g2d_userptr->refcount, 1);
+	INIT_LIST_HEAD(&g2d_userptr->list);
+	g2d_userptr->file_priv = file_priv;
+	g2d_userptr->refcount = 1;
 	g2d_userptr->size = size;
 
-	start = userptr & PAGE_MASK;
-	offset = userptr & ~PAGE_MASK;
-	end = PAGE_ALIGN(userptr + size);
-	npages = (end - start) >> PAGE_SHIFT;
 	g2d_userptr->vec = frame_vector_create(npages);
 	if (!g2d_userptr->vec) {
 		ret = -ENOMEM;
@@ -519,12 +667,25 @@ static dma_addr_t *g2d_userptr_get_dma_addr(struct g2d_data *g2d,
 
 	g2d_userptr->dma_addr = sgt->sgl[0].dma_address;
 	g2d_userptr->userptr = userptr;
+	g2d_userptr->itree.start = start;
+	g2d_userptr->itree.last = end - 1;
 
-	list_add_tail(&g2d_userptr->list, &file_priv->userptr_list);
-
-	if (g2d->current_pool + (npages << PAGE_SHIFT) < g2d->max_pool) {
-		g2d->current_pool += npages << PAGE_SHIFT;
+	if (cache && atomic_long_add_return(npages << PAGE_SHIFT,
+					    &g2d->current_pool) <= g2d->max_pool) {
 		g2d_userptr->in_pool = true;
+
+		spin_lock(&file_priv->userptr_lock);
+		/* don't cache pages the notifier already invalidated */
+		if (seq == file_priv->userptr_seq) {
+			interval_tree_insert(&g2d_userptr->itree,
+					     &file_priv->userptr_tree);
+			list_add_tail(&g2d_userptr->list,
+				      &file_priv->userptr_list);
+			g2d_userptr->in_tree = true;
+		}
+		spin_unlock(&file_priv->userptr_lock);
+	} else if (cache) {
+		atomic_long_sub(npages << PAGE_SHIFT, &g2d->current_pool);
 	}
 
 	*obj = g2d_userptr;
@@ -554,11 +715,16 @@ static void g2d_userptr_free_all(struct g2d_data *g2d, struct drm_file *filp)
 	struct drm_exynos_file_private *file_priv = filp->driver_priv;
 	struct g2d_cmdlist_userptr *g2d_userptr, *n;
 
+	if (file_priv->userptr_mm) {
+		mmu_notifier_unregister(&file_priv->userptr_mn,
+					file_priv->userptr_mm);
+		file_priv->userptr_mm = NULL;
+	}
+
 	list_for_each_entry_safe(g2d_userptr, n, &file_priv->userptr_list, list)
-		if (g2d_userptr->in_pool)
-			g2d_userptr_put_dma_addr(g2d, g2d_userptr, true);
+		g2d_userptr_put_dma_addr(g2d, g2d_userptr, true);
 
-	g2d->current_pool = 0;
+	g2d_userptr_free_stale(g2d, file_priv);
 }
 
 static enum g2d_reg_type g2d_get_reg_type(struct g2d_data *g2d, int reg_offset)
@@ -812,17 +978,66 @@ static void g2d_dma_start(struct g2d_data *g2d,
 	writel_relaxed(G2D_DMA_START, g2d->regs + G2D_DMA_COMMAND);
 }
 
+/*
+ * Chain the cmdlists of the following nodes of the same file and priority
+ * behind the ones of @runqueue_node, so the engine runs them in one go
+ * instead of taking an interrupt and a worker round trip for each exec.
+ */
+static void g2d_merge_runqueue_nodes(struct list_head *runqueue,
+				     struct g2d_runqueue_node *runqueue_node)
+{
+	struct g2d_runqueue_node *next;
+	struct g2d_cmdlist_node *lnode, *fnode;
+	unsigned int nr = 1;
+
+	while (nr++ < G2D_RUNQUEUE_MERGE_MAX && !list_empty(runqueue)) {
+		next = list_first_entry(runqueue, struct g2d_runqueue_node,
+					list);
+		if (next->filp != runqueue_node->filp)
+			break;
+
+		/* this links to base address of the next cmdlist */
+		lnode = list_last_entry(&runqueue_node->run_cmdlist,
+					struct g2d_cmdlist_node, list);
+		fnode = list_first_entry(&next->run_cmdlist,
+					 struct g2d_cmdlist_node, list);
+		lnode->cmdlist->data[lnode->cmdlist->last] = fnode->dma_addr;
+
+		list_splice_tail_init(&next->run_cmdlist,
+				      &runqueue_node->run_cmdlist);
+		list_splice_tail_init(&next->event_list,
+				      &runqueue_node->event_list);
+		list_move_tail(&next->list, &runqueue_node->merged);
+	}
+}
+
+/* the order in which the runqueues of each priority class are served */
+static const int g2d_priority_order[G2D_PRIORITY_NUM] = {
+	G2D_PRIORITY_HIGH,
+	G2D_PRIORITY_NORMAL,
+	G2D_PRIORITY_LOW,
+};
+
 static struct g2d_runqueue_node *g2d_get_runqueue_node(struct g2d_data *g2d)
 {
 	struct g2d_runqueue_node *runqueue_node;
+	int i;
 
-	if (list_empty(&g2d->runqueue))
-		return NULL;
+	for (i = 0; i < G2D_PRIORITY_NUM; i++) {
+		struct list_head *runqueue =
+			&g2d->runqueue[g2d_priority_order[i]];
 
-	runqueue_node = list_first_entry(&g2d->runqueue,
-					 struct g2d_runqueue_node, list);
-	list_del_init(&runqueue_node->list);
-	return runqueue_node;
+		if (list_empty(runqueue))
+			continue;
+
+		runqueue_node = list_first_entry(runqueue,
+						 struct g2d_runqueue_node, list);
+		list_del_init(&runqueue_node->list);
+		g2d_merge_runqueue_nodes(runqueue, runqueue_node);
+		return runqueue_node;
+	}
+
+	return NULL;
 }
 
 static void g2d_free_runqueue_node(struct g2d_data *g2d,
@@ -853,17 +1068,42 @@ static void g2d_free_runqueue_node(struct g2d_data *g2d,
 static void g2d_remove_runqueue_nodes(struct g2d_data *g2d, struct drm_file *file)
 {
 	struct g2d_runqueue_node *node, *n;
+	int prio;
 
-	if (list_empty(&g2d->runqueue))
-		return;
+	for (prio = 0; prio < G2D_PRIORITY_NUM; prio++) {
+		list_for_each_entry_safe(node, n, &g2d->runqueue[prio], list) {
+			if (file && node->filp != file)
+				continue;
 
-	list_for_each_entry_safe(node, n, &g2d->runqueue, list) {
-		if (file && node->filp != file)
-			continue;
+			list_del_init(&node->list);
+			g2d_free_runqueue_node(g2d, node);
+		}
+	}
+}
 
+/*
+ * Signal the waiters of a finished runqueue node and of all nodes merged
+ * into it. The cmdlists of merged nodes were moved to @runqueue_node and
+ * are unmapped when it is freed.
+ *
+ * Has to be called under runqueue lock.
+ */
+static void g2d_complete_runqueue_node(struct g2d_data *g2d,
+				       struct g2d_runqueue_node *runqueue_node)
+{
+	struct g2d_runqueue_node *node, *n;
+
+	list_for_each_entry_safe(node, n, &runqueue_node->merged, list) {
 		list_del_init(&node->list);
-		g2d_free_runqueue_node(g2d, node);
+
+		complete(&node->complete);
+		if (node->async)
+			g2d_free_runqueue_node(g2d, node);
 	}
+
+	complete(&runqueue_node->complete);
+	if (runqueue_node->async)
+		g2d_free_runqueue_node(g2d, runqueue_node);
 }
 
 static void g2d_runqueue_worker(struct work_struct *work)
@@ -888,9 +1128,7 @@ static void g2d_runqueue_worker(struct work_struct *work)
 		pm_runtime_mark_last_busy(g2d->dev);
 		pm_runtime_put_autosuspend(g2d->dev);
 
-		complete(&runqueue_node->complete);
-		if (runqueue_node->async)
-			g2d_free_runqueue_node(g2d, runqueue_node);
+		g2d_complete_runqueue_node(g2d, runqueue_node);
 	}
 
 	if (!test_bit(G2D_BIT_SUSPEND_RUNQUEUE, &g2d->flags)) {
@@ -1008,9 +1246,7 @@ static void g2d_wait_finish(struct g2d_data *g2d, struct drm_file *file)
 	pm_runtime_mark_last_busy(dev);
 	pm_runtime_put_autosuspend(dev);
 
-	complete(&runqueue_node->complete);
-	if (runqueue_node->async)
-		g2d_free_runqueue_node(g2d, runqueue_node);
+	g2d_complete_runqueue_node(g2d, runqueue_node);
 
 out:
 	mutex_unlock(&g2d->runqueue_mutex);
@@ -1302,6 +1538,14 @@ int exynos_g2d_exec_ioctl(struct drm_device *drm_dev, void *data,
 	struct list_head *run_cmdlist;
 	struct list_head *event_list;
 
+	if (req->priority >= G2D_PRIORITY_NUM || req->reserved)
+		return -EINVAL;
+
+	/* jumping ahead of everybody else is not for unprivileged clients */
+	if (req->priority == G2D_PRIORITY_HIGH &&
+	    !capable(CAP_SYS_NICE) && !drm_is_current_master(file))
+		return -EACCES;
+
 	runqueue_node = kmem_cache_alloc(g2d->runqueue_slab, GFP_KERNEL);
 	if (!runqueue_node)
 		return -ENOMEM;
@@ -1310,6 +1554,7 @@ int exynos_g2d_exec_ioctl(struct drm_device *drm_dev, void *data,
 	event_list = &runqueue_node->event_list;
 	INIT_LIST_HEAD(run_cmdlist);
 	INIT_LIST_HEAD(event_list);
+	INIT_LIST_HEAD(&runqueue_node->merged);
 	init_completion(&runqueue_node->complete);
 	runqueue_node->async = req->async;
 
@@ -1325,7 +1570,7 @@ int exynos_g2d_exec_ioctl(struct drm_device *drm_dev, void *data,
 	mutex_lock(&g2d->runqueue_mutex);
 	runqueue_node->pid = current->pid;
 	runqueue_node->filp = file;
-	list_add_tail(&runqueue_node->list, &g2d->runqueue);
+	list_add_tail(&runqueue_node->list, &g2d->runqueue[req->priority]);
 	mutex_unlock(&g2d->runqueue_mutex);
 
 	/* Let the runqueue know that there is work to do. */
@@ -1348,6 +1593,9 @@ int g2d_open(struct drm_device *drm_dev, struct drm_file *file)
 	INIT_LIST_HEAD(&file_priv->inuse_cmdlist);
 	INIT_LIST_HEAD(&file_priv->event_list);
 	INIT_LIST_HEAD(&file_priv->userptr_list);
+	INIT_LIST_HEAD(&file_priv->userptr_stale);
+	file_priv->userptr_tree = RB_ROOT_CACHED;
+	spin_lock_init(&file_priv->userptr_lock);
 
 	return 0;
 }
@@ -1447,7 +1695,7 @@ static int g2d_probe(struct platform_device *pdev)
 	struct device *dev = &pdev->dev;
 	struct resource *res;
 	struct g2d_data *g2d;
-	int ret;
+	int ret, i;
 
 	g2d = devm_kzalloc(dev, sizeof(*g2d), GFP_KERNEL);
 	if (!g2d)
@@ -1469,7 +1717,8 @@ static int g2d_probe(struct platform_device *pdev)
 
 	INIT_WORK(&g2d->runqueue_work, g2d_runqueue_worker);
 	INIT_LIST_HEAD(&g2d->free_cmdlist);
-	INIT_LIST_HEAD(&g2d->runqueue);
+	for (i = 0; i < G2D_PRIORITY_NUM; i++)
+		INIT_LIST_HEAD(&g2d->runqueue[i]);
 
 	mutex_init(&g2d->cmdlist_mutex);
 	mutex_init(&g2d->runqueue_mutex);
@@ -27,6 +27,38 @@
 static int num_ipp;
 static LIST_HEAD(ipp_list);
 
+#define IPP_CHAIN_POOL_MAX	4
+
+/*
+ * Intermediate buffers of chained tasks are never exposed to userspace, so
+ * instead of freeing them they are kept for the next chain.
+ */
+static DEFINE_MUTEX(ipp_chain_pool_lock);
+static struct exynos_drm_gem *ipp_chain_pool[IPP_CHAIN_POOL_MAX];
+static unsigned int ipp_chain_pool_count;
+
+/**
+ * struct exynos_drm_ipp_chain - a sequence of ipp tasks, each one using
+ * the destination buffer of the previous one as its source
+ */
+struct exynos_drm_ipp_chain {
+	struct drm_device *drm_dev;
+	spinlock_t lock;
+	wait_queue_head_t done_wq;
+	struct work_struct cleanup_work;
+	struct work_struct next_work;
+
+	struct exynos_drm_ipp_task *tasks[DRM_EXYNOS_IPP_CHAIN_MAX];
+	struct exynos_drm_gem *bufs[DRM_EXYNOS_IPP_CHAIN_MAX - 1];
+	unsigned int num_tasks;
+	unsigned int cur;
+
+	unsigned int flags;
+	int ret;
+};
+
+static void exynos_drm_ipp_chain_pool_drain(void);
+
 /**
  * exynos_drm_ipp_register - Register a new picture processor hardware module
  * @dev: DRM device
@@ -82,6 +114,9 @@ void exynos_drm_ipp_unregister(struct device *dev,
 	WARN_ON(ipp->task);
 	WARN_ON(!list_empty(&ipp->todo_list));
 	list_del(&ipp->head);
+
+	if (list_empty(&ipp_list))
+		exynos_drm_ipp_chain_pool_drain();
 }
 
 /**
@@ -573,7 +608,9 @@ static int exynos_drm_ipp_check_format(struct exynos_drm_ipp_task *task,
 			buf->buf.pitch[i] = width * buf->format->cpp[i];
 		if (buf->buf.pitch[i] < width * buf->format->cpp[i])
 			return -EINVAL;
-		if (!buf->buf.gem_id[i])
+		if (buf->internal && buf->buf.gem_id[i])
+			return -EINVAL;
+		if (!buf->internal && !buf->buf.gem_id[i])
 			return -ENOENT;
 	}
 
@@ -749,6 +786,8 @@ static void exynos_drm_ipp_cleanup_work(struct work_struct *work)
 }
 
 static void exynos_drm_ipp_next_task(struct exynos_drm_ipp *ipp);
+static void exynos_drm_ipp_chain_stage_done(struct exynos_drm_ipp_chain *chain,
+					    int ret);
 
 /**
  * exynos_drm_ipp_task_done - finish given task and set return code
@@ -758,7 +797,9 @@ static void exynos_drm_ipp_next_task(struct exynos_drm_ipp *ipp);
 void exynos_drm_ipp_task_done(struct exynos_drm_ipp_task *task, int ret)
 {
 	struct exynos_drm_ipp *ipp = task->ipp;
+	struct exynos_drm_ipp_chain *chain = task->chain;
 	unsigned long flags;
+	bool async;
 
 	DRM_DEV_DEBUG_DRIVER(task->dev, "ipp: %d, task %pK done: %d\n",
 			     ipp->id, task, ret);
@@ -768,12 +809,17 @@ void exynos_drm_ipp_task_done(struct exynos_drm_ipp_task *task, int ret)
 		ipp->task = NULL;
 	task->flags |= DRM_EXYNOS_IPP_TASK_DONE;
 	task->ret = ret;
+	async = task->flags & DRM_EXYNOS_IPP_TASK_ASYNC;
 	spin_unlock_irqrestore(&ipp->lock, flags);
 
+	/* a chained task may be freed together with its chain from here on */
+	if (chain)
+		exynos_drm_ipp_chain_stage_done(chain, ret);
+
 	exynos_drm_ipp_next_task(ipp);
 	wake_up(&ipp->done_wq);
 
-	if (task->flags & DRM_EXYNOS_IPP_TASK_ASYNC) {
+	if (async) {
 		INIT_WORK(&task->cleanup_work, exynos_drm_ipp_cleanup_work);
 		schedule_work(&task->cleanup_work);
 	}
@@ -936,3 +982,377 @@ int exynos_drm_ipp_commit_ioctl(struct drm_device *dev, void *data,
 
 	return ret;
 }
+
+static struct exynos_drm_gem *exynos_drm_ipp_chain_buf_get(
+				struct drm_device *drm_dev, unsigned long size)
+{
+	struct exynos_drm_gem *gem = NULL;
+	unsigned int i, best = 0;
+
+	mutex_lock(&ipp_chain_pool_lock);
+	for (i = 0; i < ipp_chain_pool_count; i++) {
+		if (ipp_chain_pool[i]->size < size)
+			continue;
+		if (!gem || ipp_chain_pool[i]->size < gem->size) {
+			gem = ipp_chain_pool[i];
+			best = i;
+		}
+	}
+	if (gem)
+		ipp_chain_pool[best] = ipp_chain_pool[--ipp_chain_pool_count];
+	mutex_unlock(&ipp_chain_pool_lock);
+
+	if (gem)
+		return gem;
+
+	return exynos_drm_gem_create(drm_dev, is_drm_iommu_supported(drm_dev) ?
+				     EXYNOS_BO_NONCONTIG : EXYNOS_BO_CONTIG,
+				     size);
+}
+
+static void exynos_drm_ipp_chain_buf_put(struct exynos_drm_gem *gem)
+{
+	mutex_lock(&ipp_chain_pool_lock);
+	if (ipp_chain_pool_count < IPP_CHAIN_POOL_MAX) {
+		ipp_chain_pool[ipp_chain_pool_count++] = gem;
+		gem = NULL;
+	}
+	mutex_unlock(&ipp_chain_pool_lock);
+
+	if (gem)
+		exynos_drm_gem_destroy(gem);
+}
+
+static void exynos_drm_ipp_chain_pool_drain(void)
+{
+	mutex_lock(&ipp_chain_pool_lock);
+	while (ipp_chain_pool_count)
+		exynos_drm_gem_destroy(ipp_chain_pool[--ipp_chain_pool_count]);
+	mutex_unlock(&ipp_chain_pool_lock);
+}
+
+static int exynos_drm_ipp_chain_setup_buf(struct exynos_drm_ipp_chain *chain,
+					  struct exynos_drm_ipp_buffer *buf,
+					  unsigned int n)
+{
+	struct exynos_drm_gem *gem;
+	unsigned long size = 0;
+	int i;
+
+	for (i = 0; i < buf->format->num_planes; i++) {
+		unsigned int height = (i == 0) ? buf->buf.height :
+			     DIV_ROUND_UP(buf->buf.height, buf->format->vsub);
+
+		buf->buf.offset[i] = size;
+		size += height * buf->buf.pitch[i];
+	}
+
+	gem = exynos_drm_ipp_chain_buf_get(chain->drm_dev, size);
+	if (IS_ERR(gem))
+		return PTR_ERR(gem);
+	chain->bufs[n] = gem;
+
+	for (i = 0; i < buf->format->num_planes; i++)
+		buf->dma_addr[i] = gem->dma_addr + buf->buf.offset[i];
+
+	return 0;
+}
+
+static void exynos_drm_ipp_chain_free(struct exynos_drm_ipp_chain *chain)
+{
+	struct exynos_drm_ipp_task *task;
+	int i;
+
+	for (i = 0; i < chain->num_tasks; i++) {
+		task = chain->tasks[i];
+		exynos_drm_ipp_task_free(task->ipp, task);
+	}
+	for (i = 0; i < ARRAY_SIZE(chain->bufs); i++)
+		if (chain->bufs[i])
+			exynos_drm_ipp_chain_buf_put(chain->bufs[i]);
+	kfree(chain);
+}
+
+static int exynos_drm_ipp_chain_cleanup(struct exynos_drm_ipp_chain *chain)
+{
+	struct exynos_drm_ipp_task *last = chain->tasks[chain->num_tasks - 1];
+	int ret = chain->ret;
+
+	if (ret == 0 && last->event) {
+		exynos_drm_ipp_event_send(last);
+		/* ensure event won't be canceled on task free */
+		last->event = NULL;
+	}
+
+	exynos_drm_ipp_chain_free(chain);
+	return ret;
+}
+
+static void exynos_drm_ipp_chain_cleanup_work(struct work_struct *work)
+{
+	struct exynos_drm_ipp_chain *chain = container_of(work,
+				      struct exynos_drm_ipp_chain, cleanup_work);
+
+	exynos_drm_ipp_chain_cleanup(chain);
+}
+
+/*
+ * The next stage is started from process context: the commit callbacks of
+ * the modules take a runtime PM reference, which may sleep.
+ */
+static void exynos_drm_ipp_chain_next_work(struct work_struct *work)
+{
+	struct exynos_drm_ipp_chain *chain = container_of(work,
+				      struct exynos_drm_ipp_chain, next_work);
+	struct exynos_drm_ipp_task *next;
+	unsigned long flags;
+	bool aborted;
+
+	spin_lock_irqsave(&chain->lock, flags);
+	next = chain->tasks[chain->cur];
+	aborted = chain->flags & DRM_EXYNOS_IPP_TASK_ABORT;
+	spin_unlock_irqrestore(&chain->lock, flags);
+
+	if (aborted) {
+		exynos_drm_ipp_chain_stage_done(chain, -ECANCELED);
+		return;
+	}
+
+	DRM_DEV_DEBUG_DRIVER(next->dev, "ipp: %d, chain %pK next stage\n",
+			     next->ipp->id, chain);
+	exynos_drm_ipp_schedule_task(next->ipp, next);
+}
+
+/*
+ * Called from exynos_drm_ipp_task_done(), usually in the interrupt handler
+ * of the module that finished the stage.
+ */
+static void exynos_drm_ipp_chain_stage_done(struct exynos_drm_ipp_chain *chain,
+					    int ret)
+{
+	unsigned long flags;
+	bool next = false, async = false;
+
+	spin_lock_irqsave(&chain->lock, flags);
+	if (chain->cur + 1 < chain->num_tasks && ret == 0 &&
+	    !(chain->flags & DRM_EXYNOS_IPP_TASK_ABORT)) {
+		chain->cur++;
+		next = true;
+	} else {
+		if (ret == 0 && chain->cur + 1 < chain->num_tasks)
+			ret = -ECANCELED;
+		chain->ret = ret;
+		chain->flags |= DRM_EXYNOS_IPP_TASK_DONE;
+		async = chain->flags & DRM_EXYNOS_IPP_TASK_ASYNC;
+		/*
+		 * the blocking waiter frees the chain once it observes DONE
+		 * under chain->lock, so the wakeup has to happen before the
+		 * lock is dropped
+		 */
+		wake_up(&chain->done_wq);
+	}
+	spin_unlock_irqrestore(&chain->lock, flags);
+
+	if (next) {
+		schedule_work(&chain->next_work);
+		return;
+	}
+
+	if (async)
+		schedule_work(&chain->cleanup_work);
+}
+
+static bool exynos_drm_ipp_chain_is_done(struct exynos_drm_ipp_chain *chain)
+{
+	unsigned long flags;
+	bool done;
+
+	spin_lock_irqsave(&chain->lock, flags);
+	done = chain->flags & DRM_EXYNOS_IPP_TASK_DONE;
+	spin_unlock_irqrestore(&chain->lock, flags);
+
+	return done;
+}
+
+static void exynos_drm_ipp_chain_abort(struct exynos_drm_ipp_chain *chain)
+{
+	struct exynos_drm_ipp_task *task;
+	struct exynos_drm_ipp *ipp;
+	unsigned long flags;
+	bool running;
+
+	spin_lock_irqsave(&chain->lock, flags);
+	if (chain->flags & DRM_EXYNOS_IPP_TASK_DONE) {
+		/* already completed chain */
+		spin_unlock_irqrestore(&chain->lock, flags);
+		exynos_drm_ipp_chain_cleanup(chain);
+		return;
+	}
+
+	/*
+	 * don't start any further stage, cleanup will be performed with
+	 * async worker once the current one finishes
+	 */
+	chain->flags |= DRM_EXYNOS_IPP_TASK_ASYNC | DRM_EXYNOS_IPP_TASK_ABORT;
+	task = chain->tasks[chain->cur];
+	ipp = task->ipp;
+
+	spin_lock(&ipp->lock);
+	running = ipp->task == task;
+	spin_unlock(&ipp->lock);
+	spin_unlock_irqrestore(&chain->lock, flags);
+
+	if (running && ipp->funcs->abort)
+		ipp->funcs->abort(ipp, task);
+}
+
+static int exynos_drm_ipp_chain_add_stage(struct exynos_drm_ipp_chain *chain,
+			const struct drm_exynos_ipp_chain_stage __user *ustage,
+			struct drm_file *filp, bool last)
+{
+	struct drm_exynos_ioctl_ipp_commit arg = { };
+	struct drm_exynos_ipp_chain_stage stage;
+	struct exynos_drm_ipp_task *task;
+	struct exynos_drm_ipp *ipp;
+	unsigned int n = chain->num_tasks;
+	int ret;
+
+	if (copy_from_user(&stage, ustage, sizeof(stage)))
+		return -EFAULT;
+
+	ipp = __ipp_get(stage.ipp_id);
+	if (!ipp)
+		return -ENOENT;
+
+	task = exynos_drm_ipp_task_alloc(ipp);
+	if (!task)
+		return -ENOMEM;
+	task->chain = chain;
+	chain->tasks[chain->num_tasks++] = task;
+
+	arg.params_size = stage.params_size;
+	arg.params_ptr = stage.params_ptr;
+	ret = exynos_drm_ipp_task_set(task, &arg);
+	if (ret)
+		return ret;
+
+	if (n) {
+		struct exynos_drm_ipp_buffer *prev = &chain->tasks[n - 1]->dst;
+
+		task->src.buf = prev->buf;
+		memcpy(task->src.dma_addr, prev->dma_addr,
+		       sizeof(task->src.dma_addr));
+		task->src.internal = true;
+	}
+	task->dst.internal = !last;
+
+	ret = exynos_drm_ipp_task_check(task);
+	if (ret)
+		return ret;
+
+	if (!n) {
+		ret = exynos_drm_ipp_task_setup_buffer(&task->src, filp);
+		if (ret)
+			return ret;
+	}
+
+	if (last)
+		return exynos_drm_ipp_task_setup_buffer(&task->dst, filp);
+
+	return exynos_drm_ipp_chain_setup_buf(chain, &task->dst, n);
+}
+
+/**
+ * exynos_drm_ipp_chain_commit_ioctl - perform chained image processing
+ * @dev: DRM device
+ * @data: ioctl data
+ * @file_priv: DRM file info
+ *
+ * Construct a chain of ipp tasks linked with buffers owned by the kernel
+ * and schedule its first stage. Each following stage is started when the
+ * previous one is done.
+ *
+ * Called by the user via ioctl.
+ *
+ * Returns:
+ * Zero on success, negative errno on failure.
+ */
+int exynos_drm_ipp_chain_commit_ioctl(struct drm_device *dev, void *data,
+				      struct drm_file *file_priv)
+{
+	struct drm_exynos_ioctl_ipp_chain_commit *arg = data;
+	const struct drm_exynos_ipp_chain_stage __user *stages =
+				u64_to_user_ptr(arg->stages_ptr);
+	struct exynos_drm_ipp_chain *chain;
+	struct exynos_drm_ipp_task *first;
+	int ret = 0;
+	int i;
+
+	if (arg->flags & ~DRM_EXYNOS_IPP_FLAGS)
+		return -EINVAL;
+
+	/* can't test and expect an event at the same time */
+	if ((arg->flags & DRM_EXYNOS_IPP_FLAG_TEST_ONLY) &&
+			(arg->flags & DRM_EXYNOS_IPP_FLAG_EVENT))
+		return -EINVAL;
+
+	if (arg->num_stages < 2 || arg->num_stages > DRM_EXYNOS_IPP_CHAIN_MAX)
+		return -EINVAL;
+
+	chain = kzalloc(sizeof(*chain), GFP_KERNEL);
+	if (!chain)
+		return -ENOMEM;
+
+	chain->drm_dev = dev;
+	spin_lock_init(&chain->lock);
+	init_waitqueue_head(&chain->done_wq);
+	INIT_WORK(&chain->cleanup_work, exynos_drm_ipp_chain_cleanup_work);
+	INIT_WORK(&chain->next_work, exynos_drm_ipp_chain_next_work);
+
+	for (i = 0; i < arg->num_stages; i++) {
+		ret = exynos_drm_ipp_chain_add_stage(chain, &stages[i],
+					file_priv, i == arg->num_stages - 1);
+		if (ret)
+			goto free;
+	}
+
+	if (arg->flags & DRM_EXYNOS_IPP_FLAG_TEST_ONLY)
+		goto free;
+
+	if (arg->flags & DRM_EXYNOS_IPP_FLAG_EVENT) {
+		ret = exynos_drm_ipp_event_create(chain->tasks[i - 1],
+						  file_priv, arg->user_data);
+		if (ret)
+			goto free;
+	}
+
+	/*
+	 * Queue the first stage for processing on the hardware. chain object
+	 * will be then freed after the last exynos_drm_ipp_task_done()
+	 */
+	first = chain->tasks[0];
+	if (arg->flags & DRM_EXYNOS_IPP_FLAG_NONBLOCK) {
+		DRM_DEV_DEBUG_DRIVER(first->dev,
+				     "nonblocking processing chain %pK\n",
+				     chain);
+
+		chain->flags |= DRM_EXYNOS_IPP_TASK_ASYNC;
+		exynos_drm_ipp_schedule_task(first->ipp, first);
+		ret = 0;
+	} else {
+		DRM_DEV_DEBUG_DRIVER(first->dev, "processing chain %pK\n",
+				     chain);
+		exynos_drm_ipp_schedule_task(first->ipp, first);
+		ret = wait_event_interruptible(chain->done_wq,
+				exynos_drm_ipp_chain_is_done(chain));
+		if (ret)
+			exynos_drm_ipp_chain_abort(chain);
+		else
+			ret = exynos_drm_ipp_chain_cleanup(chain);
+	}
+	return ret;
+free:
+	exynos_drm_ipp_chain_free(chain);
+
+	return ret;
+}
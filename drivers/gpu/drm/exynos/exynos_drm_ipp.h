@@ -10,6 +10,7 @@
 
 struct exynos_drm_ipp;
 struct exynos_drm_ipp_task;
+struct exynos_drm_ipp_chain;
 
 /**
  * struct exynos_drm_ipp_funcs - exynos_drm_ipp control functions
@@ -75,6 +76,7 @@ struct exynos_drm_ipp_buffer {
 	struct exynos_drm_gem *exynos_gem[MAX_FB_BUFFER];
 	const struct drm_format_info *format;
 	dma_addr_t dma_addr[MAX_FB_BUFFER];
+	bool internal;
 };
 
 /**
@@ -97,10 +99,12 @@ struct exynos_drm_ipp_task {
 	int ret;
 
 	struct drm_pending_exynos_ipp_event *event;
+	struct exynos_drm_ipp_chain *chain;
 };
 
 #define DRM_EXYNOS_IPP_TASK_DONE	(1 << 0)
 #define DRM_EXYNOS_IPP_TASK_ASYNC	(1 << 1)
+#define DRM_EXYNOS_IPP_TASK_ABORT	(1 << 2)
 
 struct exynos_drm_ipp_formats {
 	uint32_t fourcc;
@@ -144,6 +148,8 @@ int exynos_drm_ipp_get_limits_ioctl(struct drm_device *dev, void *data,
 				    struct drm_file *file_priv);
 int exynos_drm_ipp_commit_ioctl(struct drm_device *dev,
 				void *data, struct drm_file *file_priv);
+int exynos_drm_ipp_chain_commit_ioctl(struct drm_device *dev,
+				      void *data, struct drm_file *file_priv);
 #else
 static inline int exynos_drm_ipp_get_res_ioctl(struct drm_device *dev,
 	 void *data, struct drm_file *file_priv)
@@ -168,5 +174,10 @@ static inline int exynos_drm_ipp_commit_ioctl(struct drm_device *dev,
 {
 	return -ENODEV;
 }
+static inline int exynos_drm_ipp_chain_commit_ioctl(struct drm_device *dev,
+	 void *data, struct drm_file *file_priv)
+{
+	return -ENODEV;
+}
 #endif
 #endif
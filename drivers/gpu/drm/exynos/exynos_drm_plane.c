@@ -276,10 +276,74 @@ static void exynos_plane_atomic_disable(struct drm_plane *plane,
 		exynos_crtc->ops->disable_plane(exynos_crtc, exynos_plane);
 }
 
+/*
+ * A plane that keeps its position, size and format but gets a new
+ * framebuffer can be updated in place, without a full atomic commit and
+ * without waiting for the previous update to reach the screen. This is
+ * used by legacy cursor updates and async page flips.
+ */
+static int exynos_plane_atomic_async_check(struct drm_plane *plane,
+					   struct drm_plane_state *state)
+{
+	struct exynos_drm_plane_state *old_exynos_state =
+					to_exynos_plane_state(plane->state);
+	struct exynos_drm_plane_state *exynos_state =
+					to_exynos_plane_state(state);
+	struct drm_plane_state *old_state = plane->state;
+	struct exynos_drm_crtc *exynos_crtc;
+
+	if (!state->crtc || state->crtc != old_state->crtc ||
+	    !state->fb || !old_state->fb || !state->crtc->state->active)
+		return -EINVAL;
+
+	if (state->fb->format != old_state->fb->format ||
+	    state->fb->modifier != old_state->fb->modifier)
+		return -EINVAL;
+
+	if (memcmp(&exynos_state->src, &old_exynos_state->src,
+		   sizeof(exynos_state->src)) ||
+	    memcmp(&exynos_state->crtc, &old_exynos_state->crtc,
+		   sizeof(exynos_state->crtc)) ||
+	    state->alpha != old_state->alpha ||
+	    state->pixel_blend_mode != old_state->pixel_blend_mode ||
+	    state->normalized_zpos != old_state->normalized_zpos)
+		return -EINVAL;
+
+	exynos_crtc = to_exynos_crtc(state->crtc);
+	if (!exynos_crtc->ops->update_plane)
+		return -EINVAL;
+
+	return 0;
+}
+
+static void exynos_plane_atomic_async_update(struct drm_plane *plane,
+					     struct drm_plane_state *new_state)
+{
+	struct exynos_drm_crtc *exynos_crtc = to_exynos_crtc(new_state->crtc);
+	struct exynos_drm_plane *exynos_plane = to_exynos_plane(plane);
+	struct drm_framebuffer *old_fb = plane->state->fb;
+
+	/* keep the old fb alive until the new one has been latched */
+	drm_framebuffer_get(old_fb);
+	swap(plane->state->fb, new_state->fb);
+
+	if (exynos_crtc->ops->atomic_begin)
+		exynos_crtc->ops->atomic_begin(exynos_crtc);
+
+	exynos_crtc->ops->update_plane(exynos_crtc, exynos_plane);
+
+	if (exynos_crtc->ops->atomic_flush)
+		exynos_crtc->ops->atomic_flush(exynos_crtc);
+
+	exynos_drm_crtc_queue_fb_put(exynos_crtc, old_fb);
+}
+
 static const struct drm_plane_helper_funcs plane_helper_funcs = {
 	.atomic_check = exynos_plane_atomic_check,
 	.atomic_update = exynos_plane_atomic_update,
 	.atomic_disable = exynos_plane_atomic_disable,
+	.atomic_async_check = exynos_plane_atomic_async_check,
+	.atomic_async_update = exynos_plane_atomic_async_update,
 };
 
 static void exynos_plane_attach_zpos_property(struct drm_plane *plane,
@@ -159,7 +159,7 @@ static void vidi_fake_vblank_timer(struct timer_list *t)
 {
 	struct vidi_context *ctx = from_timer(ctx, t, timer);
 
-	if (drm_crtc_handle_vblank(&ctx->crtc->base))
+	if (exynos_drm_crtc_handle_vblank(ctx->crtc))
 		mod_timer(&ctx->timer,
 			jiffies + msecs_to_jiffies(VIDI_REFRESH_TIME) - 1);
 }
@@ -758,7 +758,7 @@ static irqreturn_t mixer_irq_handler(int irq, void *arg)
 		    && !mixer_is_synced(ctx))
 			goto out;
 
-		drm_crtc_handle_vblank(&ctx->crtc->base);
+		exynos_drm_crtc_handle_vblank(ctx->crtc);
 	}
 
 out:
@@ -0,0 +1,210 @@
+// SPDX-License-Identifier: GPL-2.0 OR MIT
+/* Copyright 2017-2019 Qiang Yu <yuq825@gmail.com> */
+
+#include <linux/clk.h>
+#include <linux/devfreq.h>
+#include <linux/pm_opp.h>
+#include <linux/regulator/consumer.h>
+
+#include "lima_device.h"
+#include "lima_devfreq.h"
+
+static void lima_devfreq_update_utilization(struct lima_devfreq *devfreq)
+{
+	ktime_t now = ktime_get();
+	ktime_t last = devfreq->time_last_update;
+
+	if (devfreq->busy_pipes)
+		devfreq->busy_time += ktime_sub(now, last);
+	else
+		devfreq->idle_time += ktime_sub(now, last);
+
+	devfreq->time_last_update = now;
+}
+
+static int lima_devfreq_target(struct device *dev, unsigned long *freq,
+			       u32 flags)
+{
+	struct lima_device *ldev = dev_get_drvdata(dev);
+	struct dev_pm_opp *opp;
+	unsigned long old_rate = ldev->devfreq.cur_freq;
+	unsigned long target_volt, target_rate;
+	int err;
+
+	opp = devfreq_recommended_opp(dev, freq, flags);
+	if (IS_ERR(opp))
+		return PTR_ERR(opp);
+
+	target_rate = dev_pm_opp_get_freq(opp);
+	target_volt = dev_pm_opp_get_voltage(opp);
+	dev_pm_opp_put(opp);
+
+	if (old_rate == target_rate)
+		return 0;
+
+	/* raise voltage before frequency, lower it after */
+	if (ldev->regulator && target_volt && old_rate < target_rate) {
+		err = regulator_set_voltage(ldev->regulator, target_volt,
+					    target_volt);
+		if (err) {
+			dev_err(dev, "set voltage %lu uV fail %d\n",
+				target_volt, err);
+			return err;
+		}
+	}
+
+	err = clk_set_rate(ldev->clk_gpu, target_rate);
+	if (err) {
+		dev_err(dev, "set frequency %lu fail %d\n", target_rate, err);
+		if (ldev->regulator && ldev->devfreq.cur_volt)
+			regulator_set_voltage(ldev->regulator,
+					      ldev->devfreq.cur_volt,
+					      ldev->devfreq.cur_volt);
+		return err;
+	}
+
+	if (ldev->regulator && target_volt && old_rate > target_rate) {
+		err = regulator_set_voltage(ldev->regulator, target_volt,
+					    target_volt);
+		if (err)
+			dev_err(dev, "set voltage %lu uV fail %d\n",
+				target_volt, err);
+	}
+
+	ldev->devfreq.cur_freq = target_rate;
+	ldev->devfreq.cur_volt = target_volt;
+
+	return 0;
+}
+
+static int lima_devfreq_get_dev_status(struct device *dev,
+				       struct devfreq_dev_status *status)
+{
+	struct lima_device *ldev = dev_get_drvdata(dev);
+	struct lima_devfreq *devfreq = &ldev->devfreq;
+	unsigned long flags;
+
+	spin_lock_irqsave(&devfreq->lock, flags);
+
+	lima_devfreq_update_utilization(devfreq);
+
+	status->current_frequency = devfreq->cur_freq;
+	status->total_time = ktime_to_ns(ktime_add(devfreq->busy_time,
+						   devfreq->idle_time));
+	status->busy_time = ktime_to_ns(devfreq->busy_time);
+
+	devfreq->busy_time = 0;
+	devfreq->idle_time = 0;
+
+	spin_unlock_irqrestore(&devfreq->lock, flags);
+
+	dev_dbg(ldev->dev, "busy %lu total %lu freq %lu MHz\n",
+		status->busy_time, status->total_time,
+		status->current_frequency / 1000 / 1000);
+
+	return 0;
+}
+
+static int lima_devfreq_get_cur_freq(struct device *dev, unsigned long *freq)
+{
+	struct lima_device *ldev = dev_get_drvdata(dev);
+
+	*freq = ldev->devfreq.cur_freq;
+	return 0;
+}
+
+static struct devfreq_dev_profile lima_devfreq_profile = {
+	.polling_ms = 50, /* ~3 frames */
+	.target = lima_devfreq_target,
+	.get_dev_status = lima_devfreq_get_dev_status,
+	.get_cur_freq = lima_devfreq_get_cur_freq,
+};
+
+int lima_devfreq_init(struct lima_device *ldev)
+{
+	struct lima_devfreq *devfreq = &ldev->devfreq;
+	struct device *dev = ldev->dev;
+	struct dev_pm_opp *opp;
+	int err;
+
+	spin_lock_init(&devfreq->lock);
+	devfreq->time_last_update = ktime_get();
+
+	err = dev_pm_opp_of_add_table(dev);
+	/* no OPP table in DT, keep running at the boot clock */
+	if (err == -ENODEV)
+		return 0;
+	else if (err)
+		return err;
+
+	devfreq->cur_freq = clk_get_rate(ldev->clk_gpu);
+	if (ldev->regulator)
+		devfreq->cur_volt = regulator_get_voltage(ldev->regulator);
+
+	opp = devfreq_recommended_opp(dev, &devfreq->cur_freq, 0);
+	if (IS_ERR(opp)) {
+		err = PTR_ERR(opp);
+		goto err_out0;
+	}
+	dev_pm_opp_put(opp);
+
+	lima_devfreq_profile.initial_freq = devfreq->cur_freq;
+
+	devfreq->devfreq = devm_devfreq_add_device(dev, &lima_devfreq_profile,
+						   DEVFREQ_GOV_SIMPLE_ONDEMAND,
+						   NULL);
+	if (IS_ERR(devfreq->devfreq)) {
+		dev_err(dev, "fail to init devfreq\n");
+		err = PTR_ERR(devfreq->devfreq);
+		devfreq->devfreq = NULL;
+		goto err_out0;
+	}
+
+	return 0;
+
+err_out0:
+	dev_pm_opp_of_remove_table(dev);
+	return err;
+}
+
+void lima_devfreq_fini(struct lima_device *ldev)
+{
+	struct lima_devfreq *devfreq = &ldev->devfreq;
+
+	if (!devfreq->devfreq)
+		return;
+
+	devm_devfreq_remove_device(ldev->dev, devfreq->devfreq);
+	devfreq->devfreq = NULL;
+
+	dev_pm_opp_of_remove_table(ldev->dev);
+}
+
+/* called when a task is started on the hardware of @pipe */
+void lima_devfreq_record_busy(struct lima_devfreq *devfreq, unsigned int pipe)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&devfreq->lock, flags);
+
+	lima_devfreq_update_utilization(devfreq);
+	__set_bit(pipe, &devfreq->busy_pipes);
+
+	spin_unlock_irqrestore(&devfreq->lock, flags);
+}
+
+/*
+ * called when the task left the hardware of @pipe, either done or reset
+ * away; harmless if the pipe wasn't busy
+ */
+void lima_devfreq_record_idle(struct lima_devfreq *devfreq, unsigned int pipe)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&devfreq->lock, flags);
+
+	lima_devfreq_update_utilization(devfreq);
+	__clear_bit(pipe, &devfreq->busy_pipes);
+
+	spin_unlock_irqrestore(&devfreq->lock, flags);
+}
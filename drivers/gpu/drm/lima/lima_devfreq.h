@@ -0,0 +1,33 @@
+/* SPDX-License-Identifier: GPL-2.0 OR MIT */
+/* Copyright 2017-2019 Qiang Yu <yuq825@gmail.com> */
+
+#ifndef __LIMA_DEVFREQ_H__
+#define __LIMA_DEVFREQ_H__
+
+#include <linux/spinlock.h>
+#include <linux/ktime.h>
+
+struct devfreq;
+struct lima_device;
+
+struct lima_devfreq {
+	struct devfreq *devfreq;
+	unsigned long cur_freq;
+	unsigned long cur_volt;
+
+	/* protects the fields below, updated from irq context */
+	spinlock_t lock;
+	ktime_t busy_time;
+	ktime_t idle_time;
+	ktime_t time_last_update;
+	/* bitmap of the pipes that have a task on the hardware */
+	unsigned long busy_pipes;
+};
+
+int lima_devfreq_init(struct lima_device *ldev);
+void lima_devfreq_fini(struct lima_device *ldev);
+
+void lima_devfreq_record_busy(struct lima_devfreq *devfreq, unsigned int pipe);
+void lima_devfreq_record_idle(struct lima_devfreq *devfreq, unsigned int pipe);
+
+#endif
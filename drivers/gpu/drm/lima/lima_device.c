@@ -302,6 +302,9 @@ int lima_device_init(struct lima_device *ldev)
 		goto err_out0;
 	}
 
+	mutex_init(&ldev->bt_cache_lock);
+	lima_perfcnt_init(ldev);
+
 	ldev->empty_vm = lima_vm_create(ldev);
 	if (!ldev->empty_vm) {
 		err = -ENOMEM;
@@ -356,6 +359,7 @@ int lima_device_init(struct lima_device *ldev)
 			    ldev->dlbu_cpu, ldev->dlbu_dma);
 err_out2:
 	lima_vm_put(ldev->empty_vm);
+	lima_vm_bt_cache_fini(ldev);
 err_out1:
 	lima_regulator_fini(ldev);
 err_out0:
@@ -378,6 +382,7 @@ void lima_device_fini(struct lima_device *ldev)
 			    ldev->dlbu_cpu, ldev->dlbu_dma);
 
 	lima_vm_put(ldev->empty_vm);
+	lima_vm_bt_cache_fini(ldev);
 
 	lima_regulator_fini(ldev);
 
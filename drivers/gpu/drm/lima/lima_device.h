@@ -8,6 +8,9 @@
 #include <linux/delay.h>
 
 #include "lima_sched.h"
+#include "lima_vm.h"
+#include "lima_devfreq.h"
+#include "lima_perfcnt.h"
 
 enum lima_gpu_id {
 	lima_gpu_mali400 = 0,
@@ -94,6 +97,14 @@ struct lima_device {
 
 	u32 *dlbu_cpu;
 	dma_addr_t dlbu_dma;
+
+	/* zeroed BT pages of released VMs */
+	struct mutex bt_cache_lock;
+	struct lima_vm_page bt_cache[LIMA_VM_BT_CACHE_MAX];
+	int bt_cache_count;
+
+	struct lima_devfreq devfreq;
+	struct lima_perfcnt perfcnt;
 };
 
 static inline struct lima_device *
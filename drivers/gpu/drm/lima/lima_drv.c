@@ -20,6 +20,11 @@ int lima_sched_timeout_ms;
 MODULE_PARM_DESC(sched_timeout_ms, "task run timeout in ms");
 module_param_named(sched_timeout_ms, lima_sched_timeout_ms, int, 0444);
 
+bool lima_unstable_ioctls;
+
+MODULE_PARM_DESC(unstable_ioctls, "enable ioctls whose uapi is not stable yet (perfcnt)");
+module_param_named_unsafe(unstable_ioctls, lima_unstable_ioctls, bool, 0600);
+
 static int lima_ioctl_get_param(struct drm_device *dev, void *data, struct drm_file *file)
 {
 	struct drm_lima_get_param *args = data;
@@ -85,9 +90,11 @@ static int lima_ioctl_gem_info(struct drm_device *dev, void *data, struct drm_fi
 	return lima_gem_get_info(file, args->handle, &args->va, &args->offset);
 }
 
-static int lima_ioctl_gem_submit(struct drm_device *dev, void *data, struct drm_file *file)
+static int lima_submit_one(struct drm_device *dev, struct drm_file *file,
+			   struct drm_lima_gem_submit *args,
+			   struct dma_fence *in_fence,
+			   struct dma_fence **out_fence)
 {
-	struct drm_lima_gem_submit *args = data;
 	struct lima_device *ldev = to_lima_dev(dev);
 	struct lima_drm_priv *priv = file->driver_priv;
 	struct drm_lima_gem_submit_bo *bos;
@@ -150,6 +157,8 @@ static int lima_ioctl_gem_submit(struct drm_device *dev, void *data, struct drm_
 	submit.in_sync[0] = args->in_sync[0];
 	submit.in_sync[1] = args->in_sync[1];
 	submit.out_sync = args->out_sync;
+	submit.in_fence = in_fence;
+	submit.out_fence = out_fence;
 
 	err = lima_gem_submit(file, &submit);
 
@@ -162,6 +171,55 @@ static int lima_ioctl_gem_submit(struct drm_device *dev, void *data, struct drm_
 	return err;
 }
 
+static int lima_ioctl_gem_submit(struct drm_device *dev, void *data, struct drm_file *file)
+{
+	return lima_submit_one(dev, file, data, NULL, NULL);
+}
+
+static int lima_ioctl_gem_submit_batch(struct drm_device *dev, void *data,
+				       struct drm_file *file)
+{
+	struct drm_lima_gem_submit_batch *args = data;
+	struct drm_lima_gem_submit __user *submits =
+		u64_to_user_ptr(args->submits);
+	struct dma_fence *gp_fence = NULL;
+	u32 i, nr_submits = args->nr_submits;
+	int err = 0;
+
+	if (args->flags || !nr_submits ||
+	    nr_submits > LIMA_SUBMIT_BATCH_MAX)
+		return -EINVAL;
+
+	args->nr_submits = 0;
+	for (i = 0; i < nr_submits; i++) {
+		struct drm_lima_gem_submit submit;
+		struct dma_fence *fence = NULL;
+
+		if (copy_from_user(&submit, submits + i, sizeof(submit))) {
+			err = -EFAULT;
+			break;
+		}
+
+		/* PP tasks consume the output of the last GP task before them */
+		err = lima_submit_one(dev, file, &submit,
+				      submit.pipe == LIMA_PIPE_PP ?
+				      gp_fence : NULL, &fence);
+		if (err)
+			break;
+
+		if (submit.pipe == LIMA_PIPE_GP) {
+			dma_fence_put(gp_fence);
+			gp_fence = fence;
+		} else {
+			dma_fence_put(fence);
+		}
+		args->nr_submits++;
+	}
+
+	dma_fence_put(gp_fence);
+	return err;
+}
+
 static int lima_ioctl_gem_wait(struct drm_device *dev, void *data, struct drm_file *file)
 {
 	struct drm_lima_gem_wait *args = data;
@@ -225,6 +283,7 @@ static void lima_drm_driver_postclose(struct drm_device *dev, struct drm_file *f
 {
 	struct lima_drm_priv *priv = file->driver_priv;
 
+	lima_perfcnt_close(file);
 	lima_ctx_mgr_fini(&priv->ctx_mgr);
 	lima_vm_put(priv->vm);
 	kfree(priv);
@@ -238,6 +297,8 @@ static const struct drm_ioctl_desc lima_drm_driver_ioctls[] = {
 	DRM_IOCTL_DEF_DRV(LIMA_GEM_WAIT, lima_ioctl_gem_wait, DRM_AUTH|DRM_RENDER_ALLOW),
 	DRM_IOCTL_DEF_DRV(LIMA_CTX_CREATE, lima_ioctl_ctx_create, DRM_AUTH|DRM_RENDER_ALLOW),
 	DRM_IOCTL_DEF_DRV(LIMA_CTX_FREE, lima_ioctl_ctx_free, DRM_AUTH|DRM_RENDER_ALLOW),
+	DRM_IOCTL_DEF_DRV(LIMA_GEM_SUBMIT_BATCH, lima_ioctl_gem_submit_batch, DRM_AUTH|DRM_RENDER_ALLOW),
+	DRM_IOCTL_DEF_DRV(LIMA_PERFCNT_ENABLE, lima_perfcnt_ioctl_enable, DRM_AUTH|DRM_RENDER_ALLOW),
 };
 
 static const struct file_operations lima_drm_driver_fops = {
@@ -266,7 +327,7 @@ static struct drm_driver lima_drm_driver = {
 	.desc               = "lima DRM",
 	.date               = "20190217",
 	.major              = 1,
-	.minor              = 0,
+	.minor              = 2,
 	.patchlevel         = 0,
 
 	.prime_fd_to_handle = drm_gem_prime_fd_to_handle,
@@ -312,16 +373,24 @@ static int lima_pdev_probe(struct platform_device *pdev)
 		goto err_out1;
 	}
 
+	err = lima_devfreq_init(ldev);
+	if (err) {
+		dev_err(&pdev->dev, "Fatal error during devfreq init\n");
+		goto err_out2;
+	}
+
 	/*
 	 * Register the DRM device with the core and the connectors with
 	 * sysfs.
 	 */
 	err = drm_dev_register(ddev, 0);
 	if (err < 0)
-		goto err_out2;
+		goto err_out3;
 
 	return 0;
 
+err_out3:
+	lima_devfreq_fini(ldev);
 err_out2:
 	lima_device_fini(ldev);
 err_out1:
@@ -337,6 +406,7 @@ static int lima_pdev_remove(struct platform_device *pdev)
 	struct drm_device *ddev = ldev->ddev;
 
 	drm_dev_unregister(ddev);
+	lima_devfreq_fini(ldev);
 	lima_device_fini(ldev);
 	drm_dev_put(ddev);
 	lima_sched_slab_fini();
@@ -9,6 +9,7 @@
 #include "lima_ctx.h"
 
 extern int lima_sched_timeout_ms;
+extern bool lima_unstable_ioctls;
 
 struct lima_vm;
 struct lima_bo;
@@ -33,6 +34,10 @@ struct lima_submit {
 	u32 in_sync[2];
 	u32 out_sync;
 
+	/* extra in-kernel dependency, and where to return the task fence */
+	struct dma_fence *in_fence;
+	struct dma_fence **out_fence;
+
 	struct lima_sched_task *task;
 };
 
@@ -225,6 +225,16 @@ static int lima_gem_add_deps(struct drm_file *file, struct lima_submit *submit)
 		}
 	}
 
+	if (submit->in_fence) {
+		struct dma_fence *fence = dma_fence_get(submit->in_fence);
+
+		err = drm_gem_fence_array_add(&submit->task->deps, fence);
+		if (err) {
+			dma_fence_put(fence);
+			return err;
+		}
+	}
+
 	return 0;
 }
 
@@ -311,7 +321,10 @@ int lima_gem_submit(struct drm_file *file, struct lima_submit *submit)
 		drm_syncobj_put(out_sync);
 	}
 
-	dma_fence_put(fence);
+	if (submit->out_fence)
+		*submit->out_fence = fence;
+	else
+		dma_fence_put(fence);
 
 	return 0;
 
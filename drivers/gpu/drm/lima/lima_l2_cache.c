@@ -29,12 +29,14 @@ static int lima_l2_cache_wait_idle(struct lima_ip *ip)
 
 int lima_l2_cache_flush(struct lima_ip *ip)
 {
+	unsigned long flags;
 	int ret;
 
-	spin_lock(&ip->data.lock);
+	/* GP and PP share the L2 cache and start tasks from irq context */
+	spin_lock_irqsave(&ip->data.lock, flags);
 	l2_cache_write(LIMA_L2_CACHE_COMMAND, LIMA_L2_CACHE_COMMAND_CLEAR_ALL);
 	ret = lima_l2_cache_wait_idle(ip);
-	spin_unlock(&ip->data.lock);
+	spin_unlock_irqrestore(&ip->data.lock, flags);
 	return ret;
 }
 
@@ -4,11 +4,14 @@
 #include <drm/drm_prime.h>
 #include <linux/pagemap.h>
 #include <linux/dma-mapping.h>
+#include <linux/vmalloc.h>
 
 #include "lima_object.h"
 
 void lima_bo_destroy(struct lima_bo *bo)
 {
+	lima_bo_vunmap(bo);
+
 	if (bo->sgt) {
 		kfree(bo->pages);
 		drm_prime_gem_destroy(&bo->gem, bo->sgt);
@@ -120,3 +123,22 @@ struct lima_bo *lima_bo_create(struct lima_device *dev, u32 size,
 	lima_bo_destroy(bo);
 	return ret;
 }
+
+void *lima_bo_vmap(struct lima_bo *bo)
+{
+	mutex_lock(&bo->lock);
+	if (!bo->vaddr)
+		bo->vaddr = vmap(bo->pages, bo->gem.size >> PAGE_SHIFT, VM_MAP,
+				 pgprot_writecombine(PAGE_KERNEL));
+	mutex_unlock(&bo->lock);
+
+	return bo->vaddr;
+}
+
+void lima_bo_vunmap(struct lima_bo *bo)
+{
+	if (bo->vaddr) {
+		vunmap(bo->vaddr);
+		bo->vaddr = NULL;
+	}
+}
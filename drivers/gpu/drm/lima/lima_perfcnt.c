@@ -0,0 +1,241 @@
+// SPDX-License-Identifier: GPL-2.0 OR MIT
+/* Copyright 2017-2019 Qiang Yu <yuq825@gmail.com> */
+
+#include <linux/slab.h>
+#include <drm/drm_file.h>
+#include <drm/lima_drm.h>
+
+#include "lima_drv.h"
+#include "lima_device.h"
+#include "lima_object.h"
+#include "lima_perfcnt.h"
+#include "lima_regs.h"
+
+/*
+ * Each Mali-4xx GP, PP and L2 cache unit has two 32bit counters with a
+ * selectable event source. They are programmed right before a task is
+ * started and read back from the irq handler when it is done, so every
+ * sample in the ring belongs to one task. The L2 caches are shared by
+ * GP and PP, so their counts include the other pipe's traffic while
+ * both pipes were running.
+ */
+
+#define perfcnt_write(ip, reg, data) writel(data, (ip)->iomem + (reg))
+#define perfcnt_read(ip, reg) readl((ip)->iomem + (reg))
+
+static void lima_perfcnt_l2_start(struct lima_perfcnt *perfcnt,
+				  struct lima_ip *ip)
+{
+	/* writing the source also clears the counter */
+	perfcnt_write(ip, LIMA_L2_CACHE_PERFCNT_SRC0, perfcnt->l2_src[0]);
+	perfcnt_write(ip, LIMA_L2_CACHE_PERFCNT_SRC1, perfcnt->l2_src[1]);
+}
+
+static void lima_perfcnt_gp_start(struct lima_perfcnt *perfcnt,
+				  struct lima_ip *ip)
+{
+	perfcnt_write(ip, LIMA_GP_PERF_CNT_0_SRC, perfcnt->gp_src[0]);
+	perfcnt_write(ip, LIMA_GP_PERF_CNT_1_SRC, perfcnt->gp_src[1]);
+	perfcnt_write(ip, LIMA_GP_PERF_CNT_0_ENABLE, 1);
+	perfcnt_write(ip, LIMA_GP_PERF_CNT_1_ENABLE, 1);
+}
+
+static void lima_perfcnt_pp_start(struct lima_perfcnt *perfcnt,
+				  struct lima_ip *ip)
+{
+	perfcnt_write(ip, LIMA_PP_PERF_CNT_0_SRC, perfcnt->pp_src[0]);
+	perfcnt_write(ip, LIMA_PP_PERF_CNT_1_SRC, perfcnt->pp_src[1]);
+	perfcnt_write(ip, LIMA_PP_PERF_CNT_0_ENABLE, 1);
+	perfcnt_write(ip, LIMA_PP_PERF_CNT_1_ENABLE, 1);
+}
+
+void lima_perfcnt_task_start(struct lima_sched_pipe *pipe,
+			     struct lima_sched_task *task)
+{
+	struct lima_perfcnt *perfcnt = &pipe->processor[0]->dev->perfcnt;
+	unsigned long flags;
+	int i;
+
+	task->perfcnt = false;
+
+	spin_lock_irqsave(&perfcnt->lock, flags);
+
+	if (!perfcnt->ring)
+		goto out;
+
+	for (i = 0; i < pipe->num_l2_cache; i++)
+		lima_perfcnt_l2_start(perfcnt, pipe->l2_cache[i]);
+
+	for (i = 0; i < pipe->num_processor; i++) {
+		struct lima_ip *ip = pipe->processor[i];
+
+		if (ip->id == lima_ip_gp)
+			lima_perfcnt_gp_start(perfcnt, ip);
+		else
+			lima_perfcnt_pp_start(perfcnt, ip);
+	}
+
+	task->perfcnt = true;
+
+out:
+	spin_unlock_irqrestore(&perfcnt->lock, flags);
+}
+
+void lima_perfcnt_task_done(struct lima_sched_pipe *pipe,
+			    struct lima_sched_task *task)
+{
+	struct lima_perfcnt *perfcnt = &pipe->processor[0]->dev->perfcnt;
+	struct drm_lima_perfcnt_sample *sample;
+	unsigned long flags;
+	int i;
+
+	if (!task->perfcnt)
+		return;
+
+	spin_lock_irqsave(&perfcnt->lock, flags);
+
+	/* disabled while the task was running */
+	if (!perfcnt->ring)
+		goto out;
+
+	sample = perfcnt->ring->samples +
+		perfcnt->head % LIMA_PERFCNT_RING_SAMPLES;
+	memset(sample, 0, sizeof(*sample));
+
+	sample->seqno = task->fence->seqno;
+	sample->pipe = pipe->processor[0]->id == lima_ip_gp ?
+		LIMA_PIPE_GP : LIMA_PIPE_PP;
+
+	for (i = 0; i < pipe->num_l2_cache; i++) {
+		struct lima_ip *ip = pipe->l2_cache[i];
+		u32 *l2 = sample->l2[ip->id - lima_ip_l2_cache0];
+
+		l2[0] = perfcnt_read(ip, LIMA_L2_CACHE_PERFCNT_VAL0);
+		l2[1] = perfcnt_read(ip, LIMA_L2_CACHE_PERFCNT_VAL1);
+	}
+
+	for (i = 0; i < pipe->num_processor; i++) {
+		struct lima_ip *ip = pipe->processor[i];
+
+		if (ip->id == lima_ip_gp) {
+			sample->gp[0] = perfcnt_read(ip, LIMA_GP_PERF_CNT_0_VALUE);
+			sample->gp[1] = perfcnt_read(ip, LIMA_GP_PERF_CNT_1_VALUE);
+		} else {
+			u32 *pp = sample->pp[ip->id - lima_ip_pp0];
+
+			pp[0] = perfcnt_read(ip, LIMA_PP_PERF_CNT_0_VALUE);
+			pp[1] = perfcnt_read(ip, LIMA_PP_PERF_CNT_1_VALUE);
+		}
+	}
+
+	/* publish the sample before moving head, user polls head */
+	smp_wmb();
+	WRITE_ONCE(perfcnt->ring->head, ++perfcnt->head);
+
+out:
+	spin_unlock_irqrestore(&perfcnt->lock, flags);
+}
+
+static int lima_perfcnt_enable_locked(struct lima_device *ldev,
+				      struct drm_file *file,
+				      struct drm_lima_perfcnt_enable *args)
+{
+	struct lima_perfcnt *perfcnt = &ldev->perfcnt;
+	struct drm_lima_perfcnt_ring *ring;
+	struct lima_bo *bo;
+	int err;
+
+	if (perfcnt->user)
+		return -EBUSY;
+
+	bo = lima_bo_create(ldev, sizeof(*ring), 0, NULL, NULL);
+	if (IS_ERR(bo))
+		return PTR_ERR(bo);
+
+	ring = lima_bo_vmap(bo);
+	if (!ring) {
+		err = -ENOMEM;
+		goto err_out;
+	}
+	memset(ring, 0, sizeof(*ring));
+
+	/* the handle takes its own reference, ours is dropped on disable */
+	err = drm_gem_handle_create(file, &bo->gem, &args->handle);
+	if (err)
+		goto err_out;
+
+	perfcnt->user = file;
+	perfcnt->bo = bo;
+
+	spin_lock_irq(&perfcnt->lock);
+	memcpy(perfcnt->l2_src, args->l2_src, sizeof(perfcnt->l2_src));
+	memcpy(perfcnt->gp_src, args->gp_src, sizeof(perfcnt->gp_src));
+	memcpy(perfcnt->pp_src, args->pp_src, sizeof(perfcnt->pp_src));
+	perfcnt->head = 0;
+	perfcnt->ring = ring;
+	spin_unlock_irq(&perfcnt->lock);
+
+	return 0;
+
+err_out:
+	drm_gem_object_put_unlocked(&bo->gem);
+	return err;
+}
+
+static void lima_perfcnt_disable_locked(struct lima_device *ldev)
+{
+	struct lima_perfcnt *perfcnt = &ldev->perfcnt;
+
+	spin_lock_irq(&perfcnt->lock);
+	perfcnt->ring = NULL;
+	spin_unlock_irq(&perfcnt->lock);
+
+	drm_gem_object_put_unlocked(&perfcnt->bo->gem);
+	perfcnt->bo = NULL;
+	perfcnt->user = NULL;
+}
+
+int lima_perfcnt_ioctl_enable(struct drm_device *dev, void *data,
+			      struct drm_file *file)
+{
+	struct drm_lima_perfcnt_enable *args = data;
+	struct lima_device *ldev = to_lima_dev(dev);
+	struct lima_perfcnt *perfcnt = &ldev->perfcnt;
+	int err = 0;
+
+	if (!lima_unstable_ioctls)
+		return -ENOSYS;
+
+	if (args->enable > 1)
+		return -EINVAL;
+
+	mutex_lock(&perfcnt->mutex);
+
+	if (args->enable)
+		err = lima_perfcnt_enable_locked(ldev, file, args);
+	else if (perfcnt->user == file)
+		lima_perfcnt_disable_locked(ldev);
+	else
+		err = -EINVAL;
+
+	mutex_unlock(&perfcnt->mutex);
+
+	return err;
+}
+
+void lima_perfcnt_close(struct drm_file *file)
+{
+	struct lima_device *ldev = to_lima_dev(file->minor->dev);
+	struct lima_perfcnt *perfcnt = &ldev->perfcnt;
+
+	mutex_lock(&perfcnt->mutex);
+	if (perfcnt->user == file)
+		lima_perfcnt_disable_locked(ldev);
+	mutex_unlock(&perfcnt->mutex);
+}
+
+void lima_perfcnt_init(struct lima_device *ldev)
+{
+	mutex_init(&ldev->perfcnt.mutex);
+	spin_lock_init(&ldev->perfcnt.lock);
+}
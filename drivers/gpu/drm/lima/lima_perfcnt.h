@@ -0,0 +1,44 @@
+/* SPDX-License-Identifier: GPL-2.0 OR MIT */
+/* Copyright 2017-2019 Qiang Yu <yuq825@gmail.com> */
+
+#ifndef __LIMA_PERFCNT_H__
+#define __LIMA_PERFCNT_H__
+
+#include <linux/mutex.h>
+#include <linux/spinlock.h>
+
+struct drm_device;
+struct drm_file;
+struct drm_lima_perfcnt_ring;
+struct lima_bo;
+struct lima_device;
+struct lima_sched_pipe;
+struct lima_sched_task;
+
+struct lima_perfcnt {
+	/* serialize enable/disable */
+	struct mutex mutex;
+	struct drm_file *user;
+	struct lima_bo *bo;
+
+	/* protects the fields below, used from irq context */
+	spinlock_t lock;
+	struct drm_lima_perfcnt_ring *ring;
+	u32 head;
+	u32 l2_src[2];
+	u32 gp_src[2];
+	u32 pp_src[2];
+};
+
+void lima_perfcnt_init(struct lima_device *ldev);
+
+void lima_perfcnt_task_start(struct lima_sched_pipe *pipe,
+			     struct lima_sched_task *task);
+void lima_perfcnt_task_done(struct lima_sched_pipe *pipe,
+			    struct lima_sched_task *task);
+
+int lima_perfcnt_ioctl_enable(struct drm_device *dev, void *data,
+			      struct drm_file *file);
+void lima_perfcnt_close(struct drm_file *file);
+
+#endif
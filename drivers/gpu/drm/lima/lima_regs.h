@@ -48,7 +48,7 @@
 #define LIMA_L2_CACHE_PERFCNT_SRC0           0x0020
 #define LIMA_L2_CACHE_PERFCNT_VAL0           0x0024
 #define LIMA_L2_CACHE_PERFCNT_SRC1           0x0028
-#define LIMA_L2_CACHE_ERFCNT_VAL1            0x002C
+#define LIMA_L2_CACHE_PERFCNT_VAL1           0x002C
 
 /* GP regs */
 #define LIMA_GP_VSCL_START_ADDR                0x00
@@ -17,6 +17,26 @@ struct lima_fence {
 	struct lima_sched_pipe *pipe;
 };
 
+static inline struct lima_device *
+to_lima_pipe_dev(struct lima_sched_pipe *pipe)
+{
+	return pipe->processor[0]->dev;
+}
+
+static void lima_sched_pipe_record_busy(struct lima_sched_pipe *pipe)
+{
+	struct lima_device *ldev = to_lima_pipe_dev(pipe);
+
+	lima_devfreq_record_busy(&ldev->devfreq, pipe - ldev->pipe);
+}
+
+static void lima_sched_pipe_record_idle(struct lima_sched_pipe *pipe)
+{
+	struct lima_device *ldev = to_lima_pipe_dev(pipe);
+
+	lima_devfreq_record_idle(&ldev->devfreq, pipe - ldev->pipe);
+}
+
 static struct kmem_cache *lima_fence_slab;
 static int lima_fence_slab_refcnt;
 
@@ -190,31 +210,18 @@ static struct dma_fence *lima_sched_dependency(struct drm_sched_job *job,
 	return NULL;
 }
 
-static struct dma_fence *lima_sched_run_job(struct drm_sched_job *job)
+/*
+ * Start @task on the hardware. Called from the scheduler thread, or from
+ * the irq handler of the previous task when no VM switch is needed, so
+ * nothing here may sleep except the VM reference drop.
+ */
+static void lima_sched_pipe_start_task(struct lima_sched_pipe *pipe,
+				       struct lima_sched_task *task)
 {
-	struct lima_sched_task *task = to_lima_task(job);
-	struct lima_sched_pipe *pipe = to_lima_pipe(job->sched);
-	struct lima_fence *fence;
-	struct dma_fence *ret;
 	struct lima_vm *vm = NULL, *last_vm = NULL;
+	u32 pt_gen;
 	int i;
 
-	/* after GPU reset */
-	if (job->s_fence->finished.error < 0)
-		return NULL;
-
-	fence = lima_fence_create(pipe);
-	if (!fence)
-		return NULL;
-	task->fence = &fence->base;
-
-	/* for caller usage of the fence, otherwise irq handler
-	 * may consume the fence before caller use it
-	 */
-	ret = dma_fence_get(task->fence);
-
-	pipe->current_task = task;
-
 	/* this is needed for MMU to work correctly, otherwise GP/PP
 	 * will hang or page fault for unknown reason after running for
 	 * a while.
@@ -239,20 +246,66 @@ static struct dma_fence *lima_sched_run_job(struct drm_sched_job *job)
 		pipe->current_vm = task->vm;
 	}
 
-	if (pipe->bcast_mmu)
-		lima_mmu_switch_vm(pipe->bcast_mmu, vm);
-	else {
-		for (i = 0; i < pipe->num_mmu; i++)
-			lima_mmu_switch_vm(pipe->mmu[i], vm);
+	/* BO add/del only touch the page table, the TLB zap is done here
+	 * once per task and skipped when nothing changed since the last one
+	 */
+	pt_gen = READ_ONCE(task->vm->pt_gen);
+	if (vm || pt_gen != pipe->current_pt_gen) {
+		pipe->current_pt_gen = pt_gen;
+
+		if (pipe->bcast_mmu)
+			lima_mmu_switch_vm(pipe->bcast_mmu, vm);
+		else {
+			for (i = 0; i < pipe->num_mmu; i++)
+				lima_mmu_switch_vm(pipe->mmu[i], vm);
+		}
 	}
 
 	if (last_vm)
 		lima_vm_put(last_vm);
 
+	lima_sched_pipe_record_busy(pipe);
+	lima_perfcnt_task_start(pipe, task);
+
 	pipe->error = false;
 	pipe->task_run(pipe, task);
+}
+
+static struct dma_fence *lima_sched_run_job(struct drm_sched_job *job)
+{
+	struct lima_sched_task *task = to_lima_task(job);
+	struct lima_sched_pipe *pipe = to_lima_pipe(job->sched);
+	struct lima_fence *fence;
+	struct dma_fence *ret;
+	unsigned long flags;
+
+	/* after GPU reset */
+	if (job->s_fence->finished.error < 0)
+		return NULL;
+
+	fence = lima_fence_create(pipe);
+	if (!fence)
+		return NULL;
+	task->fence = &fence->base;
+
+	/* for caller usage of the fence, otherwise irq handler
+	 * may consume the fence before caller use it
+	 */
+	ret = dma_fence_get(task->fence);
 
-	return task->fence;
+	/* hardware busy, let the irq handler chain it */
+	spin_lock_irqsave(&pipe->task_lock, flags);
+	if (pipe->current_task) {
+		pipe->queued_task = task;
+		spin_unlock_irqrestore(&pipe->task_lock, flags);
+		return ret;
+	}
+	pipe->current_task = task;
+	spin_unlock_irqrestore(&pipe->task_lock, flags);
+
+	lima_sched_pipe_start_task(pipe, task);
+
+	return ret;
 }
 
 static void lima_sched_handle_error_task(struct lima_sched_pipe *pipe,
@@ -263,6 +316,12 @@ static void lima_sched_handle_error_task(struct lima_sched_pipe *pipe,
 	if (task)
 		drm_sched_increase_karma(&task->base);
 
+	/*
+	 * a deferred start must neither hit the hardware while it is being
+	 * reset nor race the resubmit below
+	 */
+	cancel_work_sync(&pipe->start_work);
+
 	pipe->task_error(pipe);
 
 	if (pipe->bcast_mmu)
@@ -278,7 +337,17 @@ static void lima_sched_handle_error_task(struct lima_sched_pipe *pipe,
 		lima_vm_put(pipe->current_vm);
 
 	pipe->current_vm = NULL;
+	/*
+	 * the current task may not have reached the hardware if its
+	 * deferred start was cancelled above, record the pipe idle anyway
+	 */
+	lima_sched_pipe_record_idle(pipe);
+
+	spin_lock_irq(&pipe->task_lock);
 	pipe->current_task = NULL;
+	/* resubmit runs the queued task again */
+	pipe->queued_task = NULL;
+	spin_unlock_irq(&pipe->task_lock);
 
 	drm_sched_resubmit_jobs(&pipe->base);
 	drm_sched_start(&pipe->base, true);
@@ -327,6 +396,21 @@ static void lima_sched_error_work(struct work_struct *work)
 	lima_sched_handle_error_task(pipe, task);
 }
 
+static void lima_sched_start_work(struct work_struct *work)
+{
+	struct lima_sched_pipe *pipe =
+		container_of(work, struct lima_sched_pipe, start_work);
+	struct lima_sched_task *task;
+
+	spin_lock_irq(&pipe->task_lock);
+	task = pipe->current_task;
+	spin_unlock_irq(&pipe->task_lock);
+
+	/* dropped by error recovery before we got here */
+	if (task)
+		lima_sched_pipe_start_task(pipe, task);
+}
+
 int lima_sched_pipe_init(struct lima_sched_pipe *pipe, const char *name)
 {
 	unsigned int timeout = lima_sched_timeout_ms > 0 ?
@@ -334,15 +418,23 @@ int lima_sched_pipe_init(struct lima_sched_pipe *pipe, const char *name)
 
 	pipe->fence_context = dma_fence_context_alloc(1);
 	spin_lock_init(&pipe->fence_lock);
+	spin_lock_init(&pipe->task_lock);
 
 	INIT_WORK(&pipe->error_work, lima_sched_error_work);
+	INIT_WORK(&pipe->start_work, lima_sched_start_work);
 
-	return drm_sched_init(&pipe->base, &lima_sched_ops, 1, 0,
+	/*
+	 * One task on the hardware and one queued behind it, so the next
+	 * task is started from the irq handler instead of waiting for the
+	 * scheduler thread to be woken up.
+	 */
+	return drm_sched_init(&pipe->base, &lima_sched_ops, 2, 0,
 			      msecs_to_jiffies(timeout), name);
 }
 
 void lima_sched_pipe_fini(struct lima_sched_pipe *pipe)
 {
+	cancel_work_sync(&pipe->start_work);
 	drm_sched_fini(&pipe->base);
 }
 
@@ -352,8 +444,24 @@ void lima_sched_pipe_task_done(struct lima_sched_pipe *pipe)
 		schedule_work(&pipe->error_work);
 	else {
 		struct lima_sched_task *task = pipe->current_task;
+		struct lima_sched_task *next;
 
+		lima_perfcnt_task_done(pipe, task);
 		pipe->task_fini(pipe);
+		lima_sched_pipe_record_idle(pipe);
+
+		spin_lock(&pipe->task_lock);
+		next = pipe->queued_task;
+		pipe->queued_task = NULL;
+		pipe->current_task = next;
+		spin_unlock(&pipe->task_lock);
+
+		/* a VM switch may drop the last VM reference, which sleeps */
+		if (next && next->vm == pipe->current_vm)
+			lima_sched_pipe_start_task(pipe, next);
+		else if (next)
+			schedule_work(&pipe->start_work);
+
 		dma_fence_signal(task->fence);
 	}
 }
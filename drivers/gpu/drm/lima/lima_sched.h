@@ -22,6 +22,9 @@ struct lima_sched_task {
 
 	/* pipe fence */
 	struct dma_fence *fence;
+
+	/* counters were programmed when the task started */
+	bool perfcnt;
 };
 
 struct lima_sched_context {
@@ -41,8 +44,13 @@ struct lima_sched_pipe {
 	u32 fence_seqno;
 	spinlock_t fence_lock;
 
+	/* protects current_task and queued_task */
+	spinlock_t task_lock;
 	struct lima_sched_task *current_task;
+	/* next task, started from the irq handler when current_task is done */
+	struct lima_sched_task *queued_task;
 	struct lima_vm *current_vm;
+	u32 current_pt_gen;
 
 	struct lima_ip *mmu[LIMA_SCHED_PIPE_MAX_MMU];
 	int num_mmu;
@@ -70,6 +78,7 @@ struct lima_sched_pipe {
 	void (*task_mmu_error)(struct lima_sched_pipe *pipe);
 
 	struct work_struct error_work;
+	struct work_struct start_work;
 };
 
 int lima_sched_task_init(struct lima_sched_task *task,
@@ -31,6 +31,50 @@ struct lima_bo_va {
 #define LIMA_PBE(va) (va >> LIMA_VM_PB_SHIFT)
 #define LIMA_BTE(va) ((va & LIMA_VM_BT_MASK) >> LIMA_VM_BT_SHIFT)
 
+#define LIMA_VM_BT_SIZE (LIMA_PAGE_SIZE << LIMA_VM_NUM_PT_PER_BT_SHIFT)
+
+static int lima_vm_bt_alloc(struct lima_vm *vm, struct lima_vm_page *bt)
+{
+	struct lima_device *dev = vm->dev;
+
+	mutex_lock(&dev->bt_cache_lock);
+	if (dev->bt_cache_count) {
+		*bt = dev->bt_cache[--dev->bt_cache_count];
+		mutex_unlock(&dev->bt_cache_lock);
+		return 0;
+	}
+	mutex_unlock(&dev->bt_cache_lock);
+
+	bt->cpu = dma_alloc_wc(dev->dev, LIMA_VM_BT_SIZE, &bt->dma,
+			       GFP_KERNEL | __GFP_ZERO);
+	return bt->cpu ? 0 : -ENOMEM;
+}
+
+static void lima_vm_bt_free(struct lima_vm *vm, struct lima_vm_page *bt)
+{
+	struct lima_device *dev = vm->dev;
+
+	mutex_lock(&dev->bt_cache_lock);
+	if (dev->bt_cache_count < LIMA_VM_BT_CACHE_MAX) {
+		memset(bt->cpu, 0, LIMA_VM_BT_SIZE);
+		dev->bt_cache[dev->bt_cache_count++] = *bt;
+		mutex_unlock(&dev->bt_cache_lock);
+		return;
+	}
+	mutex_unlock(&dev->bt_cache_lock);
+
+	dma_free_wc(dev->dev, LIMA_VM_BT_SIZE, bt->cpu, bt->dma);
+}
+
+void lima_vm_bt_cache_fini(struct lima_device *dev)
+{
+	while (dev->bt_cache_count) {
+		struct lima_vm_page *bt = dev->bt_cache + --dev->bt_cache_count;
+
+		dma_free_wc(dev->dev, LIMA_VM_BT_SIZE, bt->cpu, bt->dma);
+	}
+}
+
 
 static void lima_vm_unmap_page_table(struct lima_vm *vm, u32 start, u32 end)
 {
@@ -42,6 +86,8 @@ static void lima_vm_unmap_page_table(struct lima_vm *vm, u32 start, u32 end)
 
 		vm->bts[pbe].cpu[bte] = 0;
 	}
+
+	WRITE_ONCE(vm->pt_gen, vm->pt_gen + 1);
 }
 
 static int lima_vm_map_page_table(struct lima_vm *vm, dma_addr_t *dma,
@@ -59,10 +105,7 @@ static int lima_vm_map_page_table(struct lima_vm *vm, dma_addr_t *dma,
 			u32 *pd;
 			int j;
 
-			vm->bts[pbe].cpu = dma_alloc_wc(
-				vm->dev->dev, LIMA_PAGE_SIZE << LIMA_VM_NUM_PT_PER_BT_SHIFT,
-				&vm->bts[pbe].dma, GFP_KERNEL | __GFP_ZERO);
-			if (!vm->bts[pbe].cpu) {
+			if (lima_vm_bt_alloc(vm, vm->bts + pbe)) {
 				if (addr != start)
 					lima_vm_unmap_page_table(vm, start, addr - 1);
 				return -ENOMEM;
@@ -79,9 +122,67 @@ static int lima_vm_map_page_table(struct lima_vm *vm, dma_addr_t *dma,
 		vm->bts[pbe].cpu[bte] = dma[i++] | LIMA_VM_FLAGS_CACHE;
 	}
 
+	WRITE_ONCE(vm->pt_gen, vm->pt_gen + 1);
 	return 0;
 }
 
+/*
+ * Short lived BOs would otherwise pay a drm_mm search for every open and
+ * close, so freed VA ranges stay reserved in the VM for a while and get
+ * handed out again to the next BO of the same size. The page table entries
+ * of a cached range are always cleared, the BO pages may be gone already.
+ */
+static struct lima_bo_va *
+lima_vm_va_cache_get(struct lima_vm *vm, u64 size)
+{
+	struct lima_bo_va *bo_va;
+
+	list_for_each_entry(bo_va, &vm->va_cache, list) {
+		if (bo_va->node.size == size) {
+			list_del(&bo_va->list);
+			vm->va_cache_count--;
+			return bo_va;
+		}
+	}
+
+	return NULL;
+}
+
+static void lima_vm_va_cache_evict(struct lima_vm *vm)
+{
+	struct lima_bo_va *bo_va;
+
+	bo_va = list_last_entry(&vm->va_cache, struct lima_bo_va, list);
+	list_del(&bo_va->list);
+	vm->va_cache_count--;
+
+	drm_mm_remove_node(&bo_va->node);
+	kfree(bo_va);
+}
+
+static void lima_vm_va_cache_put(struct lima_vm *vm, struct lima_bo_va *bo_va)
+{
+	list_add(&bo_va->list, &vm->va_cache);
+	if (++vm->va_cache_count > LIMA_VM_VA_CACHE_MAX)
+		lima_vm_va_cache_evict(vm);
+}
+
+static int lima_vm_va_alloc(struct lima_vm *vm, struct lima_bo_va *bo_va,
+			    u64 size)
+{
+	int err;
+
+	for (;;) {
+		err = drm_mm_insert_node(&vm->mm, &bo_va->node, size);
+		if (err != -ENOSPC || !vm->va_cache_count)
+			return err;
+
+		/* VA space is fragmented by cached ranges, give them back */
+		while (vm->va_cache_count)
+			lima_vm_va_cache_evict(vm);
+	}
+}
+
 static struct lima_bo_va *
 lima_vm_bo_find(struct lima_vm *vm, struct lima_bo *bo)
 {
@@ -117,21 +218,24 @@ int lima_vm_bo_add(struct lima_vm *vm, struct lima_bo *bo, bool create)
 		return -ENOENT;
 	}
 
-	bo_va = kzalloc(sizeof(*bo_va), GFP_KERNEL);
+	mutex_lock(&vm->lock);
+
+	bo_va = lima_vm_va_cache_get(vm, bo->gem.size);
 	if (!bo_va) {
-		err = -ENOMEM;
-		goto err_out0;
+		bo_va = kzalloc(sizeof(*bo_va), GFP_KERNEL);
+		if (!bo_va) {
+			err = -ENOMEM;
+			goto err_out0;
+		}
+
+		err = lima_vm_va_alloc(vm, bo_va, bo->gem.size);
+		if (err)
+			goto err_out1;
 	}
 
 	bo_va->vm = vm;
 	bo_va->ref_count = 1;
 
-	mutex_lock(&vm->lock);
-
-	err = drm_mm_insert_node(&vm->mm, &bo_va->node, bo->gem.size);
-	if (err)
-		goto err_out1;
-
 	err = lima_vm_map_page_table(vm, bo->pages_dma_addr, bo_va->node.start,
 				     bo_va->node.start + bo_va->node.size - 1);
 	if (err)
@@ -147,9 +251,9 @@ int lima_vm_bo_add(struct lima_vm *vm, struct lima_bo *bo, bool create)
 err_out2:
 	drm_mm_remove_node(&bo_va->node);
 err_out1:
-	mutex_unlock(&vm->lock);
 	kfree(bo_va);
 err_out0:
+	mutex_unlock(&vm->lock);
 	mutex_unlock(&bo->lock);
 	return err;
 }
@@ -166,20 +270,18 @@ void lima_vm_bo_del(struct lima_vm *vm, struct lima_bo *bo)
 		return;
 	}
 
+	list_del(&bo_va->list);
+
 	mutex_lock(&vm->lock);
 
 	lima_vm_unmap_page_table(vm, bo_va->node.start,
 				 bo_va->node.start + bo_va->node.size - 1);
 
-	drm_mm_remove_node(&bo_va->node);
+	lima_vm_va_cache_put(vm, bo_va);
 
 	mutex_unlock(&vm->lock);
 
-	list_del(&bo_va->list);
-
 	mutex_unlock(&bo->lock);
-
-	kfree(bo_va);
 }
 
 u32 lima_vm_get_va(struct lima_vm *vm, struct lima_bo *bo)
@@ -208,6 +310,7 @@ struct lima_vm *lima_vm_create(struct lima_device *dev)
 	vm->dev = dev;
 	mutex_init(&vm->lock);
 	kref_init(&vm->refcount);
+	INIT_LIST_HEAD(&vm->va_cache);
 
 	vm->pd.cpu = dma_alloc_wc(dev->dev, LIMA_PAGE_SIZE, &vm->pd.dma,
 				  GFP_KERNEL | __GFP_ZERO);
@@ -238,12 +341,14 @@ void lima_vm_release(struct kref *kref)
 	struct lima_vm *vm = container_of(kref, struct lima_vm, refcount);
 	int i;
 
+	while (vm->va_cache_count)
+		lima_vm_va_cache_evict(vm);
+
 	drm_mm_takedown(&vm->mm);
 
 	for (i = 0; i < LIMA_VM_NUM_BT; i++) {
 		if (vm->bts[i].cpu)
-			dma_free_wc(vm->dev->dev, LIMA_PAGE_SIZE << LIMA_VM_NUM_PT_PER_BT_SHIFT,
-				    vm->bts[i].cpu, vm->bts[i].dma);
+			lima_vm_bt_free(vm, vm->bts + i);
 	}
 
 	if (vm->pd.cpu)
@@ -19,6 +19,10 @@
 #define LIMA_VA_RESERVE_DLBU   LIMA_VA_RESERVE_START
 #define LIMA_VA_RESERVE_END    0x100000000
 
+/* freed VA ranges kept per VM, and free BT pages kept per device */
+#define LIMA_VM_VA_CACHE_MAX   64
+#define LIMA_VM_BT_CACHE_MAX   8
+
 struct lima_device;
 
 struct lima_vm_page {
@@ -36,6 +40,13 @@ struct lima_vm {
 
 	struct lima_vm_page pd;
 	struct lima_vm_page bts[LIMA_VM_NUM_BT];
+
+	/* recently freed VA ranges, still reserved in mm, newest first */
+	struct list_head va_cache;
+	unsigned int va_cache_count;
+
+	/* bumped on every page table change, tells pipes to zap the TLB */
+	u32 pt_gen;
 };
 
 int lima_vm_bo_add(struct lima_vm *vm, struct lima_bo *bo, bool create);
@@ -59,4 +70,6 @@ static inline void lima_vm_put(struct lima_vm *vm)
 
 void lima_vm_print(struct lima_vm *vm);
 
+void lima_vm_bt_cache_fini(struct lima_device *dev);
+
 #endif
@@ -26,6 +26,29 @@ static void panfrost_gem_free_object(struct drm_gem_object *obj)
 	drm_mm_remove_node(&bo->node);
 	spin_unlock(&pfdev->mm_lock);
 
+	if (bo->sgts) {
+		int n_sgt = obj->size / SZ_2M;
+		int i;
+
+		for (i = 0; i < n_sgt; i++) {
+			if (!bo->sgts[i].sgl)
+				continue;
+			dma_unmap_sg(pfdev->dev, bo->sgts[i].sgl,
+				     bo->sgts[i].nents, DMA_BIDIRECTIONAL);
+			sg_free_table(&bo->sgts[i]);
+		}
+		kvfree(bo->sgts);
+	}
+
+	if (bo->heap_pages) {
+		size_t i;
+
+		for (i = 0; i < obj->size >> PAGE_SHIFT; i++)
+			if (bo->heap_pages[i])
+				put_page(bo->heap_pages[i]);
+		kvfree(bo->heap_pages);
+	}
+
 	drm_gem_shmem_free_object(obj);
 }
 
@@ -78,6 +101,36 @@ struct drm_gem_object *panfrost_gem_create_object(struct drm_device *dev, size_t
 	return ERR_PTR(ret);
 }
 
+struct panfrost_gem_object *
+panfrost_gem_create_with_handle(struct drm_file *file_priv,
+				struct drm_device *dev, size_t size,
+				u32 flags, uint32_t *handle)
+{
+	int ret;
+	struct drm_gem_shmem_object *shmem;
+	struct panfrost_gem_object *bo;
+
+	/* Round up heap allocations to 2MB to keep fault handling simple */
+	if (flags & PANFROST_BO_HEAP)
+		size = roundup(size, SZ_2M);
+
+	shmem = drm_gem_shmem_create(dev, size);
+	if (IS_ERR(shmem))
+		return ERR_CAST(shmem);
+
+	bo = to_panfrost_bo(&shmem->base);
+	bo->noexec = !!(flags & PANFROST_BO_NOEXEC);
+	bo->is_heap = !!(flags & PANFROST_BO_HEAP);
+
+	ret = drm_gem_handle_create(file_priv, &shmem->base, handle);
+	/* drop reference from allocate - handle holds it now. */
+	drm_gem_object_put_unlocked(&shmem->base);
+	if (ret)
+		return ERR_PTR(ret);
+
+	return bo;
+}
+
 struct drm_gem_object *
 panfrost_gem_prime_import_sg_table(struct drm_device *dev,
 				   struct dma_buf_attachment *attach,
@@ -10,8 +10,17 @@
 struct panfrost_gem_object {
 	struct drm_gem_shmem_object base;
 
+	/*
+	 * Heap BOs are populated by the GPU fault handler, one 2MB chunk at
+	 * a time, and don't use the shmem helper's page array.
+	 */
+	struct page **heap_pages;
+	struct sg_table *sgts;
+
 	struct drm_mm_node node;
 	bool is_mapped;
+	bool noexec;
+	bool is_heap;
 };
 
 static inline
@@ -27,4 +36,9 @@ panfrost_gem_prime_import_sg_table(struct drm_device *dev,
 				   struct dma_buf_attachment *attach,
 				   struct sg_table *sgt);
 
+struct panfrost_gem_object *
+panfrost_gem_create_with_handle(struct drm_file *file_priv,
+				struct drm_device *dev, size_t size,
+				u32 flags, uint32_t *handle);
+
 #endif /* __PANFROST_GEM_H__ */
@@ -9,6 +9,7 @@
 #include <linux/iommu.h>
 #include <linux/platform_device.h>
 #include <linux/pm_runtime.h>
+#include <linux/shmem_fs.h>
 #include <linux/sizes.h>
 
 #include "panfrost_device.h"
@@ -145,27 +146,13 @@ static size_t get_pgsize(u64 addr, size_t size)
 	return SZ_2M;
 }
 
-int panfrost_mmu_map(struct panfrost_gem_object *bo)
+static void mmu_map_sg(struct panfrost_device *pfdev, u64 iova,
+		       int prot, struct sg_table *sgt)
 {
-	struct drm_gem_object *obj = &bo->base.base;
-	struct panfrost_device *pfdev = to_panfrost_device(obj->dev);
 	struct io_pgtable_ops *ops = pfdev->mmu->pgtbl_ops;
-	u64 iova = bo->node.start << PAGE_SHIFT;
+	u64 start_iova = iova;
 	unsigned int count;
 	struct scatterlist *sgl;
-	struct sg_table *sgt;
-	int ret;
-
-	if (WARN_ON(bo->is_mapped))
-		return 0;
-
-	sgt = drm_gem_shmem_get_pages_sgt(obj);
-	if (WARN_ON(IS_ERR(sgt)))
-		return PTR_ERR(sgt);
-
-	ret = pm_runtime_get_sync(pfdev->dev);
-	if (ret < 0)
-		return ret;
 
 	mutex_lock(&pfdev->mmu->lock);
 
@@ -178,17 +165,42 @@ int panfrost_mmu_map(struct panfrost_gem_object *bo)
 		while (len) {
 			size_t pgsize = get_pgsize(iova | paddr, len);
 
-			ops->map(ops, iova, paddr, pgsize, IOMMU_WRITE | IOMMU_READ);
+			ops->map(ops, iova, paddr, pgsize, prot);
 			iova += pgsize;
 			paddr += pgsize;
 			len -= pgsize;
 		}
 	}
 
-	mmu_hw_do_operation(pfdev, 0, bo->node.start << PAGE_SHIFT,
-			    bo->node.size << PAGE_SHIFT, AS_COMMAND_FLUSH_PT);
+	mmu_hw_do_operation(pfdev, 0, start_iova, iova - start_iova,
+			    AS_COMMAND_FLUSH_PT);
 
 	mutex_unlock(&pfdev->mmu->lock);
+}
+
+int panfrost_mmu_map(struct panfrost_gem_object *bo)
+{
+	struct drm_gem_object *obj = &bo->base.base;
+	struct panfrost_device *pfdev = to_panfrost_device(obj->dev);
+	struct sg_table *sgt;
+	int prot = IOMMU_READ | IOMMU_WRITE;
+	int ret;
+
+	if (WARN_ON(bo->is_mapped))
+		return 0;
+
+	if (bo->noexec)
+		prot |= IOMMU_NOEXEC;
+
+	sgt = drm_gem_shmem_get_pages_sgt(obj);
+	if (WARN_ON(IS_ERR(sgt)))
+		return PTR_ERR(sgt);
+
+	ret = pm_runtime_get_sync(pfdev->dev);
+	if (ret < 0)
+		return ret;
+
+	mmu_map_sg(pfdev, bo->node.start << PAGE_SHIFT, prot, sgt);
 
 	pm_runtime_mark_last_busy(pfdev->dev);
 	pm_runtime_put_autosuspend(pfdev->dev);
@@ -222,12 +234,14 @@ void panfrost_mmu_unmap(struct panfrost_gem_object *bo)
 		size_t unmapped_page;
 		size_t pgsize = get_pgsize(iova, len - unmapped_len);
 
-		unmapped_page = ops->unmap(ops, iova, pgsize);
-		if (!unmapped_page)
-			break;
+		/* Heap BOs may have chunks that were never faulted in */
+		if (ops->iova_to_phys(ops, iova)) {
+			unmapped_page = ops->unmap(ops, iova, pgsize);
+			WARN_ON(unmapped_page != pgsize);
+		}
 
-		iova += unmapped_page;
-		unmapped_len += unmapped_page;
+		iova += pgsize;
+		unmapped_len += pgsize;
 	}
 
 	mmu_hw_do_operation(pfdev, 0, bo->node.start << PAGE_SHIFT,
@@ -284,16 +298,155 @@ static const char *access_type_name(struct panfrost_device *pfdev,
 	}
 }
 
+#define NUM_FAULT_PAGES (SZ_2M / PAGE_SIZE)
+
+/*
+ * Find the heap BO backing a faulting GPU address and take a reference,
+ * unless it is already on its way out.
+ */
+static struct panfrost_gem_object *
+addr_to_heap_bo(struct panfrost_device *pfdev, u64 addr)
+{
+	struct panfrost_gem_object *bo = NULL;
+	struct drm_mm_node *node;
+	u64 offset = addr >> PAGE_SHIFT;
+
+	spin_lock(&pfdev->mm_lock);
+	drm_mm_for_each_node(node, &pfdev->mm) {
+		if (offset < node->start || offset >= node->start + node->size)
+			continue;
+
+		bo = container_of(node, struct panfrost_gem_object, node);
+		if (!bo->is_heap ||
+		    !kref_get_unless_zero(&bo->base.base.refcount))
+			bo = NULL;
+		break;
+	}
+	spin_unlock(&pfdev->mm_lock);
+
+	return bo;
+}
+
+static int panfrost_mmu_map_fault_addr(struct panfrost_device *pfdev, int as,
+				       u64 addr)
+{
+	struct panfrost_gem_object *bo;
+	struct address_space *mapping;
+	struct sg_table *sgt;
+	struct page **pages;
+	pgoff_t page_offset;
+	int ret = 0;
+	int i;
+
+	bo = addr_to_heap_bo(pfdev, addr);
+	if (!bo)
+		return -ENOENT;
+
+	/* Heap BOs are 2MB aligned and a multiple of 2MB in size */
+	addr &= ~((u64)SZ_2M - 1);
+	page_offset = (addr >> PAGE_SHIFT) - bo->node.start;
+
+	mutex_lock(&bo->base.pages_lock);
+
+	if (!bo->heap_pages) {
+		bo->sgts = kvmalloc_array(bo->base.base.size / SZ_2M,
+					  sizeof(struct sg_table),
+					  GFP_KERNEL | __GFP_ZERO);
+		if (!bo->sgts) {
+			ret = -ENOMEM;
+			goto out_unlock;
+		}
+
+		bo->heap_pages = kvmalloc_array(bo->base.base.size / PAGE_SIZE,
+						sizeof(struct page *),
+						GFP_KERNEL | __GFP_ZERO);
+		if (!bo->heap_pages) {
+			kvfree(bo->sgts);
+			bo->sgts = NULL;
+			ret = -ENOMEM;
+			goto out_unlock;
+		}
+	}
+
+	pages = bo->heap_pages;
+	sgt = &bo->sgts[page_offset / NUM_FAULT_PAGES];
+
+	/*
+	 * Another unit may have faulted on the same chunk before it got
+	 * mapped; the flush below is all that is needed to let it go on.
+	 */
+	if (sgt->sgl) {
+		mmu_hw_do_operation(pfdev, as, addr, SZ_2M,
+				    AS_COMMAND_FLUSH_PT);
+		goto out_unlock;
+	}
+
+	mapping = bo->base.base.filp->f_mapping;
+	mapping_set_unevictable(mapping);
+
+	for (i = page_offset; i < page_offset + NUM_FAULT_PAGES; i++) {
+		pages[i] = shmem_read_mapping_page(mapping, i);
+		if (IS_ERR(pages[i])) {
+			ret = PTR_ERR(pages[i]);
+			pages[i] = NULL;
+			goto err_pages;
+		}
+	}
+
+	ret = sg_alloc_table_from_pages(sgt, pages + page_offset,
+					NUM_FAULT_PAGES, 0, SZ_2M, GFP_KERNEL);
+	if (ret)
+		goto err_pages;
+
+	if (!dma_map_sg(pfdev->dev, sgt->sgl, sgt->nents, DMA_BIDIRECTIONAL)) {
+		ret = -EINVAL;
+		goto err_map;
+	}
+
+	mmu_map_sg(pfdev, addr, IOMMU_WRITE | IOMMU_READ | IOMMU_NOEXEC, sgt);
+
+	bo->is_mapped = true;
+
+	dev_dbg(pfdev->dev, "mapped page fault @ AS%d %llx", as, addr);
+
+	mutex_unlock(&bo->base.pages_lock);
+	drm_gem_object_put_unlocked(&bo->base.base);
+
+	return 0;
+
+err_map:
+	sg_free_table(sgt);
+err_pages:
+	for (i = page_offset; i < page_offset + NUM_FAULT_PAGES; i++) {
+		if (!pages[i])
+			break;
+		put_page(pages[i]);
+		pages[i] = NULL;
+	}
+out_unlock:
+	mutex_unlock(&bo->base.pages_lock);
+	drm_gem_object_put_unlocked(&bo->base.base);
+
+	return ret;
+}
+
 static irqreturn_t panfrost_mmu_irq_handler(int irq, void *data)
 {
 	struct panfrost_device *pfdev = data;
-	u32 status = mmu_read(pfdev, MMU_INT_STAT);
-	int i;
 
-	if (!status)
+	if (!mmu_read(pfdev, MMU_INT_STAT))
 		return IRQ_NONE;
 
-	dev_err(pfdev->dev, "mmu irq status=%x\n", status);
+	/* Faults are handled in the thread, which may need to sleep. */
+	mmu_write(pfdev, MMU_INT_MASK, 0);
+	return IRQ_WAKE_THREAD;
+}
+
+static irqreturn_t panfrost_mmu_irq_handler_thread(int irq, void *data)
+{
+	struct panfrost_device *pfdev = data;
+	u32 status = mmu_read(pfdev, MMU_INT_RAWSTAT);
+	int i, ret;
 
 	for (i = 0; status; i++) {
 		u32 mask = BIT(i) | BIT(i + 16);
@@ -315,6 +468,18 @@ static irqreturn_t panfrost_mmu_irq_handler(int irq, void *data)
 		access_type = (fault_status >> 8) & 0x3;
 		source_id = (fault_status >> 16);
 
+		mmu_write(pfdev, MMU_INT_CLEAR, mask);
+
+		/* A plain translation fault may be a heap that needs to grow */
+		if ((status & mask) == BIT(i) &&
+		    (exception_type & 0xF8) == 0xC0) {
+			ret = panfrost_mmu_map_fault_addr(pfdev, i, addr);
+			if (!ret) {
+				status &= ~mask;
+				continue;
+			}
+		}
+
 		/* terminal fault, print info about the fault */
 		dev_err(pfdev->dev,
 			"Unhandled Page fault in AS%d at VA 0x%016llX\n"
@@ -332,11 +497,10 @@ static irqreturn_t panfrost_mmu_irq_handler(int irq, void *data)
 			access_type, access_type_name(pfdev, fault_status),
 			source_id);
 
-		mmu_write(pfdev, MMU_INT_CLEAR, mask);
-
 		status &= ~mask;
 	}
 
+	mmu_write(pfdev, MMU_INT_MASK, ~0);
 	return IRQ_HANDLED;
 };
 
@@ -355,8 +519,10 @@ int panfrost_mmu_init(struct panfrost_device *pfdev)
 	if (irq <= 0)
 		return -ENODEV;
 
-	err = devm_request_irq(pfdev->dev, irq, panfrost_mmu_irq_handler,
-			       IRQF_SHARED, "mmu", pfdev);
+	err = devm_request_threaded_irq(pfdev->dev, irq,
+					panfrost_mmu_irq_handler,
+					panfrost_mmu_irq_handler_thread,
+					IRQF_SHARED, "mmu", pfdev);
 
 	if (err) {
 		dev_err(pfdev->dev, "failed to request mmu irq");
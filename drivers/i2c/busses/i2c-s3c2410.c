@@ -23,6 +23,7 @@
 #include <linux/cpufreq.h>
 #include <linux/slab.h>
 #include <linux/io.h>
+#include <linux/iopoll.h>
 #include <linux/of.h>
 #include <linux/gpio/consumer.h>
 #include <linux/pinctrl/consumer.h>
@@ -80,6 +81,15 @@
 /* Max time to wait for bus to become idle after a xfer (in us) */
 #define S3C2410_IDLE_TIMEOUT	5000
 
+/*
+ * Transfers that take at most this long on the wire (in us) are polled, as
+ * taking an interrupt per byte and sleeping costs more than spinning.
+ */
+#define S3C2410_POLL_MAX_XFER	100
+
+/* Time to spin for a byte of a polled transfer (in us) */
+#define S3C2410_POLL_SPIN	100
+
 /* Exynos5 Sysreg offset */
 #define EXYNOS5_SYS_I2C_CFG	0x0234
 
@@ -103,6 +113,8 @@ struct s3c24xx_i2c {
 
 	unsigned int		tx_setup;
 	unsigned int		irq;
+	unsigned int		frequency;	/* bus clock in kHz */
+	bool			polling;	/* current xfer is polled */
 
 	enum s3c24xx_i2c_state	state;
 	unsigned long		clkrate;
@@ -138,6 +150,11 @@ MODULE_DEVICE_TABLE(platform, s3c24xx_driver_ids);
 
 static int i2c_s3c_irq_nextbyte(struct s3c24xx_i2c *i2c, unsigned long iicstat);
 
+static inline bool s3c24xx_i2c_polled(struct s3c24xx_i2c *i2c)
+{
+	return (i2c->quirks & QUIRK_POLL) || i2c->polling;
+}
+
 #ifdef CONFIG_OF
 static const struct of_device_id s3c24xx_i2c_match[] = {
 	{ .compatible = "samsung,s3c2410-i2c", .data = (void *)0 },
@@ -181,7 +198,7 @@ static inline void s3c24xx_i2c_master_complete(struct s3c24xx_i2c *i2c, int ret)
 	if (ret)
 		i2c->msg_idx = ret;
 
-	if (!(i2c->quirks & QUIRK_POLL))
+	if (!s3c24xx_i2c_polled(i2c))
 		wake_up(&i2c->wait);
 }
 
@@ -235,6 +252,39 @@ static bool is_ack(struct s3c24xx_i2c *i2c)
 	return false;
 }
 
+/*
+ * Run a short transfer by spinning on IRQPEND and doing the work of the
+ * interrupt handler for each byte, so a NACK ends the transfer exactly as
+ * it does there. Should a byte take longer than expected, e.g. when the
+ * slave stretches the clock, leave the rest of it to the interrupt.
+ */
+static void s3c24xx_i2c_poll_xfer(struct s3c24xx_i2c *i2c)
+{
+	unsigned long iiccon, iicstat;
+
+	/*
+	 * i2c_s3c_irq_nextbyte() may restart the bus for the next message
+	 * and land in here again; stop as soon as a nested call handed the
+	 * transfer over to the interrupt handler.
+	 */
+	while (i2c->polling && i2c->msg_num != 0) {
+		if (readl_poll_timeout_atomic(i2c->regs + S3C2410_IICCON,
+					      iiccon,
+					      iiccon & S3C2410_IICCON_IRQPEND,
+					      1, S3C2410_POLL_SPIN)) {
+			i2c->polling = false;
+			enable_irq(i2c->irq);
+			return;
+		}
+
+		iicstat = readl(i2c->regs + S3C2410_IICSTAT);
+		if (iicstat & S3C2410_IICSTAT_ARBITR)
+			dev_err(i2c->dev, "deal with arbitration loss\n");
+
+		i2c_s3c_irq_nextbyte(i2c, iicstat);
+	}
+}
+
 /*
  * put the start of a message onto the bus
  */
@@ -286,6 +336,8 @@ static void s3c24xx_i2c_message_start(struct s3c24xx_i2c *i2c,
 			if (stat & S3C2410_IICSTAT_ARBITR)
 				dev_err(i2c->dev, "deal with arbitration loss\n");
 		}
+	} else if (i2c->polling) {
+		s3c24xx_i2c_poll_xfer(i2c);
 	}
 }
 
@@ -685,6 +737,25 @@ static void s3c24xx_i2c_wait_idle(struct s3c24xx_i2c *i2c)
 		dev_warn(i2c->dev, "timeout waiting for bus idle\n");
 }
 
+/*
+ * decide whether a transfer is short enough to be polled
+ */
+static bool s3c24xx_i2c_short_xfer(struct s3c24xx_i2c *i2c,
+				   struct i2c_msg *msgs, int num)
+{
+	unsigned int bytes = 0;
+	int i;
+
+	if (!i2c->frequency)
+		return false;
+
+	/* one address byte per message, nine clocks per byte with the ack */
+	for (i = 0; i < num; i++)
+		bytes += msgs[i].len + 1;
+
+	return bytes * 9 * 1000 / i2c->frequency <= S3C2410_POLL_MAX_XFER;
+}
+
 /*
  * this starts an i2c transfer
  */
@@ -707,6 +778,15 @@ static int s3c24xx_i2c_doxfer(struct s3c24xx_i2c *i2c,
 	i2c->msg_idx = 0;
 	i2c->state   = STATE_START;
 
+	/*
+	 * For a polled transfer the controller still raises IRQPEND after
+	 * every byte, keep the handler off it while we do its work.
+	 */
+	i2c->polling = !(i2c->quirks & QUIRK_POLL) &&
+		       s3c24xx_i2c_short_xfer(i2c, msgs, num);
+	if (i2c->polling)
+		disable_irq(i2c->irq);
+
 	s3c24xx_i2c_enable_irq(i2c);
 	s3c24xx_i2c_message_start(i2c, msgs);
 
@@ -719,7 +799,16 @@ static int s3c24xx_i2c_doxfer(struct s3c24xx_i2c *i2c,
 		goto out;
 	}
 
-	timeout = wait_event_timeout(i2c->wait, i2c->msg_num == 0, HZ * 5);
+	if (i2c->polling) {
+		/* s3c24xx_i2c_message_start() has run the whole transfer */
+		timeout = 1;
+		enable_irq(i2c->irq);
+		i2c->polling = false;
+	} else {
+		/* interrupt driven, or handed over by s3c24xx_i2c_poll_xfer() */
+		timeout = wait_event_timeout(i2c->wait, i2c->msg_num == 0,
+					     HZ * 5);
+	}
 
 	ret = i2c->msg_idx;
 
@@ -853,6 +942,7 @@ static int s3c24xx_i2c_clockrate(struct s3c24xx_i2c *i2c, unsigned int *got)
 	}
 
 	*got = freq;
+	i2c->frequency = freq;
 
 	iiccon = readl(i2c->regs + S3C2410_IICCON);
 	iiccon &= ~(S3C2410_IICCON_SCALEMASK | S3C2410_IICCON_TXDIV_512);
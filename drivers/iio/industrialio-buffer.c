@@ -130,6 +130,8 @@ ssize_t iio_buffer_read_first_n_outer(struct file *filp, char __user *buf,
 		to_wait = min_t(size_t, n / datum_size, rb->watermark);
 
 	add_wait_queue(&rb->pollq, &wait);
+	/* Pairs with wq_has_sleeper() in iio_push_to_buffer() */
+	smp_mb();
 	do {
 		if (!indio_dev->info) {
 			ret = -ENODEV;
@@ -175,6 +177,8 @@ __poll_t iio_buffer_poll(struct file *filp,
 		return 0;
 
 	poll_wait(filp, &rb->pollq, wait);
+	/* Pairs with wq_has_sleeper() in iio_push_to_buffer() */
+	smp_mb();
 	if (iio_buffer_ready(indio_dev, rb, rb->watermark, 0))
 		return EPOLLIN | EPOLLRDNORM;
 	return 0;
@@ -1387,9 +1391,13 @@ static int iio_push_to_buffer(struct iio_buffer *buffer, const void *data)
 
 	/*
 	 * We can't just test for watermark to decide if we wake the poll queue
-	 * because read may request less samples than the watermark.
+	 * because read may request less samples than the watermark. This runs
+	 * for every scan though, mostly with nobody waiting, so don't take the
+	 * wait queue lock unless there is a sleeper.
 	 */
-	wake_up_interruptible_poll(&buffer->pollq, EPOLLIN | EPOLLRDNORM);
+	if (wq_has_sleeper(&buffer->pollq))
+		wake_up_interruptible_poll(&buffer->pollq,
+					   EPOLLIN | EPOLLRDNORM);
 	return 0;
 }
 
@@ -11,6 +11,7 @@
 #define EVDEV_MINORS		32
 #define EVDEV_MIN_BUFFER_SIZE	64U
 #define EVDEV_BUF_PACKETS	8
+#define EVDEV_READ_BATCH	16
 
 #include <linux/poll.h>
 #include <linux/sched.h>
@@ -568,22 +569,49 @@ static ssize_t evdev_write(struct file *file, const char __user *buffer,
 	return retval;
 }
 
-static int evdev_fetch_next_event(struct evdev_client *client,
-				  struct input_event *event)
+/*
+ * Take up to @max complete events off the client buffer. A multitouch
+ * frame easily has a few dozen events, so grab them under one lock
+ * round trip rather than one per event. The tail left behind is stored
+ * in @tail for evdev_unfetch_events().
+ */
+static unsigned int evdev_fetch_events(struct evdev_client *client,
+				       struct input_event *events,
+				       unsigned int max, unsigned int *tail)
 {
-	int have_event;
+	unsigned int n = 0;
 
 	spin_lock_irq(&client->buffer_lock);
 
-	have_event = client->packet_head != client->tail;
-	if (have_event) {
-		*event = client->buffer[client->tail++];
+	while (n < max && client->packet_head != client->tail) {
+		events[n++] = client->buffer[client->tail++];
 		client->tail &= client->bufsize - 1;
 	}
+	*tail = client->tail;
 
 	spin_unlock_irq(&client->buffer_lock);
 
-	return have_event;
+	return n;
+}
+
+/*
+ * Give the last @n fetched events back to the client buffer. They are
+ * still in place right behind the tail unless the buffer overflowed in
+ * the meantime, which moves the tail away from @tail, or new events have
+ * wrapped around onto them.
+ */
+static void evdev_unfetch_events(struct evdev_client *client,
+				 unsigned int tail, unsigned int n)
+{
+	unsigned int mask = client->bufsize - 1;
+
+	spin_lock_irq(&client->buffer_lock);
+
+	if (client->tail == tail &&
+	    ((client->head - client->tail) & mask) + n < client->bufsize)
+		client->tail = (client->tail - n) & mask;
+
+	spin_unlock_irq(&client->buffer_lock);
 }
 
 static ssize_t evdev_read(struct file *file, char __user *buffer,
@@ -591,7 +619,8 @@ static ssize_t evdev_read(struct file *file, char __user *buffer,
 {
 	struct evdev_client *client = file->private_data;
 	struct evdev *evdev = client->evdev;
-	struct input_event event;
+	struct input_event events[EVDEV_READ_BATCH];
+	unsigned int i, n, tail;
 	size_t read = 0;
 	int error;
 
@@ -613,13 +642,23 @@ static ssize_t evdev_read(struct file *file, char __user *buffer,
 		if (count == 0)
 			break;
 
-		while (read + input_event_size() <= count &&
-		       evdev_fetch_next_event(client, &event)) {
-
-			if (input_event_to_user(buffer + read, &event))
-				return -EFAULT;
-
-			read += input_event_size();
+		while (read + input_event_size() <= count) {
+			n = min_t(size_t, EVDEV_READ_BATCH,
+				  (count - read) / input_event_size());
+			n = evdev_fetch_events(client, events, n, &tail);
+			if (!n)
+				break;
+
+			for (i = 0; i < n; i++) {
+				if (input_event_to_user(buffer + read,
+							&events[i])) {
+					evdev_unfetch_events(client, tail,
+							     n - i);
+					return read ? read : -EFAULT;
+				}
+
+				read += input_event_size();
+			}
 		}
 
 		if (read)
@@ -249,6 +249,8 @@ struct exynos_iommu_domain {
 	short *lv2entcnt;	/* free lv2 entry counter for each section */
 	spinlock_t lock;	/* lock for modyfying list of clients */
 	spinlock_t pgtablelock;	/* lock for modifying page table @ pgtable */
+	sysmmu_iova_t flush_start; /* first and last byte of unmapped range */
+	sysmmu_iova_t flush_last;  /* not yet flushed, empty if start > last */
 	struct iommu_domain domain; /* generic domain data structure */
 };
 
@@ -531,32 +533,36 @@ static void sysmmu_tlb_invalidate_flpdcache(struct sysmmu_drvdata *data,
 	spin_unlock_irqrestore(&data->lock, flags);
 }
 
-static void sysmmu_tlb_invalidate_entry(struct sysmmu_drvdata *data,
-					sysmmu_iova_t iova, size_t size)
+/*
+ * Above this many pages it is cheaper to drop the whole TLB than to walk
+ * the range entry by entry on SYSMMUs without a range flush.
+ */
+#define SYSMMU_MAX_FLUSH_ENTRIES	64
+
+static void sysmmu_tlb_invalidate_range(struct sysmmu_drvdata *data,
+					sysmmu_iova_t start, sysmmu_iova_t last)
 {
 	unsigned long flags;
 
 	spin_lock_irqsave(&data->lock, flags);
 	if (data->active) {
-		unsigned int num_inv = 1;
+		unsigned int num_inv = ((last - start) >> SPAGE_ORDER) + 1;
 
 		clk_enable(data->clk_master);
 
 		/*
-		 * L2TLB invalidation required
-		 * 4KB page: 1 invalidation
-		 * 64KB page: 16 invalidations
-		 * 1MB page: 64 invalidations
-		 * because it is set-associative TLB
-		 * with 8-way and 64 sets.
-		 * 1MB page can be cached in one of all sets.
-		 * 64KB page can be one of 16 consecutive sets.
+		 * Every 4KB page of the range is invalidated, which also
+		 * covers the v2 L2TLB: it is 8-way set-associative with 64
+		 * sets, so a 64KB page can be cached in one of 16
+		 * consecutive sets and a 1MB page in any of them.
 		 */
-		if (MMU_MAJ_VER(data->version) == 2)
-			num_inv = min_t(unsigned int, size / PAGE_SIZE, 64);
-
 		if (sysmmu_block(data)) {
-			__sysmmu_tlb_invalidate_entry(data, iova, num_inv);
+			if (MMU_MAJ_VER(data->version) < 5 &&
+			    num_inv > SYSMMU_MAX_FLUSH_ENTRIES)
+				__sysmmu_tlb_invalidate(data);
+			else
+				__sysmmu_tlb_invalidate_entry(data, start,
+							      num_inv);
 			sysmmu_unblock(data);
 		}
 		clk_disable(data->clk_master);
@@ -774,6 +780,7 @@ static struct iommu_domain *exynos_iommu_domain_alloc(unsigned type)
 	spin_lock_init(&domain->lock);
 	spin_lock_init(&domain->pgtablelock);
 	INIT_LIST_HEAD(&domain->clients);
+	domain->flush_start = ~0;
 
 	domain->domain.geometry.aperture_start = 0;
 	domain->domain.geometry.aperture_end   = ~0UL;
@@ -1115,16 +1122,64 @@ static int exynos_iommu_map(struct iommu_domain *iommu_domain,
 	return ret;
 }
 
-static void exynos_iommu_tlb_invalidate_entry(struct exynos_iommu_domain *domain,
-					      sysmmu_iova_t iova, size_t size)
+/*
+ * Unmapping only records the range that has to be dropped from the TLBs;
+ * the flush itself is issued once for all of it from ->iotlb_sync(), which
+ * both iommu_unmap() and the iommu_unmap_fast() users call when done.
+ */
+static void exynos_iommu_tlb_range_add(struct exynos_iommu_domain *domain,
+				       sysmmu_iova_t iova, size_t size)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&domain->lock, flags);
+	domain->flush_start = min(domain->flush_start, iova);
+	domain->flush_last = max_t(sysmmu_iova_t, domain->flush_last,
+				   iova + size - 1);
+	spin_unlock_irqrestore(&domain->lock, flags);
+}
+
+static void exynos_iommu_iotlb_sync(struct iommu_domain *iommu_domain)
 {
+	struct exynos_iommu_domain *domain = to_exynos_domain(iommu_domain);
 	struct sysmmu_drvdata *data;
 	unsigned long flags;
 
 	spin_lock_irqsave(&domain->lock, flags);
 
-	list_for_each_entry(data, &domain->clients, domain_node)
-		sysmmu_tlb_invalidate_entry(data, iova, size);
+	if (domain->flush_start <= domain->flush_last) {
+		list_for_each_entry(data, &domain->clients, domain_node)
+			sysmmu_tlb_invalidate_range(data, domain->flush_start,
+						    domain->flush_last);
+	}
+	domain->flush_start = ~0;
+	domain->flush_last = 0;
+
+	spin_unlock_irqrestore(&domain->lock, flags);
+}
+
+static void exynos_iommu_flush_iotlb_all(struct iommu_domain *iommu_domain)
+{
+	struct exynos_iommu_domain *domain = to_exynos_domain(iommu_domain);
+	struct sysmmu_drvdata *data;
+	unsigned long flags;
+
+	spin_lock_irqsave(&domain->lock, flags);
+
+	list_for_each_entry(data, &domain->clients, domain_node) {
+		spin_lock(&data->lock);
+		if (data->active) {
+			clk_enable(data->clk_master);
+			if (sysmmu_block(data)) {
+				__sysmmu_tlb_invalidate(data);
+				sysmmu_unblock(data);
+			}
+			clk_disable(data->clk_master);
+		}
+		spin_unlock(&data->lock);
+	}
+	domain->flush_start = ~0;
+	domain->flush_last = 0;
 
 	spin_unlock_irqrestore(&domain->lock, flags);
 }
@@ -1196,7 +1251,7 @@ static size_t exynos_iommu_unmap(struct iommu_domain *iommu_domain,
 done:
 	spin_unlock_irqrestore(&domain->pgtablelock, flags);
 
-	exynos_iommu_tlb_invalidate_entry(domain, iova, size);
+	exynos_iommu_tlb_range_add(domain, iova, size);
 
 	return size;
 err:
@@ -1330,6 +1385,8 @@ static const struct iommu_ops exynos_iommu_ops = {
 	.detach_dev = exynos_iommu_detach_device,
 	.map = exynos_iommu_map,
 	.unmap = exynos_iommu_unmap,
+	.flush_iotlb_all = exynos_iommu_flush_iotlb_all,
+	.iotlb_sync = exynos_iommu_iotlb_sync,
 	.iova_to_phys = exynos_iommu_iova_to_phys,
 	.device_group = generic_device_group,
 	.add_device = exynos_iommu_add_device,
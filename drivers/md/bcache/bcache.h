@@ -333,7 +333,8 @@ struct cached_dev {
 	struct delayed_work	writeback_rate_update;
 
 	/* Limit number of writeback bios in flight */
-	struct semaphore	in_flight;
+	atomic_t		writeback_in_flight;
+	wait_queue_head_t	writeback_in_flight_wait;
 	struct task_struct	*writeback_thread;
 	struct workqueue_struct	*writeback_write_wq;
 
@@ -382,6 +383,7 @@ struct cached_dev {
 	unsigned int		writeback_rate_i_term_inverse;
 	unsigned int		writeback_rate_p_term_inverse;
 	unsigned int		writeback_rate_minimum;
+	unsigned int		writeback_max_in_flight;
 
 	enum stop_on_failure	stop_when_cache_set_failed;
 #define DEFAULT_CACHED_DEV_ERROR_LIMIT	64
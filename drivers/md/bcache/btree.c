@@ -1604,6 +1604,17 @@ static size_t btree_gc_min_nodes(struct cache_set *c)
 	return min_nodes;
 }
 
+/*
+ * Incremental GC backs off when front side I/O comes in, but the buckets the
+ * allocators free up are only handed out again once GC has finished. If some
+ * of that I/O is already blocked in bch_bucket_alloc(), backing off only
+ * makes it wait longer - run GC to completion instead.
+ */
+static bool btree_gc_should_yield(struct cache_set *c)
+{
+	return atomic_read(&c->search_inflight) &&
+	       !waitqueue_active(&c->bucket_wait);
+}
 
 static int btree_gc_recurse(struct btree *b, struct btree_op *op,
 			    struct closure *writes, struct gc_stat *gc)
@@ -1670,7 +1681,7 @@ static int btree_gc_recurse(struct btree *b, struct btree_op *op,
 		memmove(r + 1, r, sizeof(r[0]) * (GC_MERGE_NODES - 1));
 		r->b = NULL;
 
-		if (atomic_read(&b->c->search_inflight) &&
+		if (btree_gc_should_yield(b->c) &&
 		    gc->nodes >= gc->nodes_pre + btree_gc_min_nodes(b->c)) {
 			gc->nodes_pre =  gc->nodes;
 			ret = -EAGAIN;
@@ -1845,10 +1856,11 @@ static void bch_btree_gc(struct cache_set *c)
 		closure_sync(&writes);
 		cond_resched();
 
-		if (ret == -EAGAIN)
-			schedule_timeout_interruptible(msecs_to_jiffies
-						       (GC_SLEEP_MS));
-		else if (ret)
+		if (ret == -EAGAIN) {
+			if (btree_gc_should_yield(c))
+				schedule_timeout_interruptible(msecs_to_jiffies
+							       (GC_SLEEP_MS));
+		} else if (ret)
 			pr_warn("gc failed!");
 	} while (ret && !test_bit(CACHE_SET_IO_DISABLE, &c->flags));
 
@@ -111,6 +111,7 @@ rw_attribute(writeback_rate_update_seconds);
 rw_attribute(writeback_rate_i_term_inverse);
 rw_attribute(writeback_rate_p_term_inverse);
 rw_attribute(writeback_rate_minimum);
+rw_attribute(writeback_max_in_flight);
 read_attribute(writeback_rate_debug);
 
 read_attribute(stripe_size);
@@ -189,6 +190,7 @@ SHOW(__bch_cached_dev)
 	var_print(writeback_rate_i_term_inverse);
 	var_print(writeback_rate_p_term_inverse);
 	var_print(writeback_rate_minimum);
+	var_print(writeback_max_in_flight);
 
 	if (attr == &sysfs_writeback_rate_debug) {
 		char rate[20];
@@ -317,6 +319,9 @@ STORE(__cached_dev)
 	sysfs_strtoul_clamp(writeback_rate_minimum,
 			    dc->writeback_rate_minimum,
 			    1, UINT_MAX);
+	sysfs_strtoul_clamp(writeback_max_in_flight,
+			    dc->writeback_max_in_flight,
+			    1, WRITEBACK_MAX_IN_FLIGHT_MAX);
 
 	sysfs_strtoul_clamp(io_error_limit, dc->error_limit, 0, INT_MAX);
 
@@ -476,6 +481,7 @@ static struct attribute *bch_cached_dev_files[] = {
 	&sysfs_writeback_rate_i_term_inverse,
 	&sysfs_writeback_rate_p_term_inverse,
 	&sysfs_writeback_rate_minimum,
+	&sysfs_writeback_max_in_flight,
 	&sysfs_writeback_rate_debug,
 	&sysfs_io_errors,
 	&sysfs_io_error_limit,
@@ -301,7 +301,8 @@ static void write_dirty_finish(struct closure *cl)
 	}
 
 	bch_keybuf_del(&dc->writeback_keys, w);
-	up(&dc->in_flight);
+	atomic_dec(&dc->writeback_in_flight);
+	wake_up(&dc->writeback_in_flight_wait);
 
 	closure_return_with_destructor(cl, dirty_io_destructor);
 }
@@ -390,16 +391,33 @@ static void read_dirty_submit(struct closure *cl)
 	continue_at(cl, write_dirty, io->dc->writeback_write_wq);
 }
 
+static bool dirty_same_stripe(struct cached_dev *dc, struct bkey *l,
+			      struct bkey *r)
+{
+	return offset_to_stripe(&dc->disk, KEY_START(l)) ==
+	       offset_to_stripe(&dc->disk, KEY_START(r));
+}
+
 static void read_dirty(struct cached_dev *dc)
 {
 	unsigned int delay = 0;
-	struct keybuf_key *next, *keys[MAX_WRITEBACKS_IN_PASS], *w;
-	size_t size;
-	int nk, i;
+	struct keybuf_key *next, *keys[MAX_WRITEBACKS_IN_STRIPE_PASS], *w;
+	size_t size, max_size = MAX_WRITESIZE_IN_PASS;
+	int nk, i, max_keys = MAX_WRITEBACKS_IN_PASS;
 	struct dirty_io *io;
 	struct closure cl;
 	uint16_t sequence = 0;
 
+	/*
+	 * If partial stripe writes are expensive, a pass covers (at most) one
+	 * stripe, so that the writes to it are issued back to back and not
+	 * split up by the rate limiting delay.
+	 */
+	if (dc->partial_stripes_expensive) {
+		max_keys = MAX_WRITEBACKS_IN_STRIPE_PASS;
+		max_size = max_t(size_t, max_size, dc->disk.stripe_size);
+	}
+
 	BUG_ON(!llist_empty(&dc->writeback_ordering_wait.list));
 	atomic_set(&dc->writeback_sequence_next, sequence);
 	closure_init_stack(&cl);
@@ -424,34 +442,39 @@ static void read_dirty(struct cached_dev *dc)
 			 * Don't combine too many operations, even if they
 			 * are all small.
 			 */
-			if (nk >= MAX_WRITEBACKS_IN_PASS)
+			if (nk >= max_keys)
 				break;
 
 			/*
 			 * If the current operation is very large, don't
 			 * further combine operations.
 			 */
-			if (size >= MAX_WRITESIZE_IN_PASS)
+			if (size >= max_size)
 				break;
 
 			/*
 			 * Operations are only eligible to be combined
-			 * if they are contiguous.
-			 *
-			 * TODO: add a heuristic willing to fire a
-			 * certain amount of non-contiguous IO per pass,
-			 * so that we can benefit from backing device
-			 * command queueing.
+			 * if they are contiguous - or, if partial stripes
+			 * are expensive, if they are in the same stripe:
+			 * the keybuf is sorted, so they are still issued
+			 * in LBA order, and the backing device can queue
+			 * them up to complete the stripe.
 			 */
-			if ((nk != 0) && bkey_cmp(&keys[nk-1]->key,
-						&START_KEY(&next->key)))
+			if (dc->partial_stripes_expensive) {
+				if (nk != 0 &&
+				    !dirty_same_stripe(dc, &keys[0]->key,
+						       &next->key))
+					break;
+			} else if ((nk != 0) && bkey_cmp(&keys[nk-1]->key,
+						&START_KEY(&next->key))) {
 				break;
+			}
 
 			size += KEY_SIZE(&next->key);
 			keys[nk++] = next;
 		} while ((next = bch_keybuf_next(&dc->writeback_keys)));
 
-		/* Now we have gathered a set of 1..5 keys to write back. */
+		/* Now we have gathered a set of keys to write back. */
 		for (i = 0; i < nk; i++) {
 			w = keys[i];
 
@@ -479,10 +502,13 @@ static void read_dirty(struct cached_dev *dc)
 
 			trace_bcache_writeback(&w->key);
 
-			down(&dc->in_flight);
+			wait_event(dc->writeback_in_flight_wait,
+				   atomic_read(&dc->writeback_in_flight) <
+				   READ_ONCE(dc->writeback_max_in_flight));
+			atomic_inc(&dc->writeback_in_flight);
 
 			/*
-			 * We've acquired a semaphore for the maximum
+			 * We've acquired a slot for the maximum
 			 * simultaneous number of writebacks; from here
 			 * everything happens asynchronously.
 			 */
@@ -806,7 +832,8 @@ void bch_sectors_dirty_init(struct bcache_device *d)
 
 void bch_cached_dev_writeback_init(struct cached_dev *dc)
 {
-	sema_init(&dc->in_flight, 64);
+	atomic_set(&dc->writeback_in_flight, 0);
+	init_waitqueue_head(&dc->writeback_in_flight_wait);
 	init_rwsem(&dc->writeback_lock);
 	bch_keybuf_init(&dc->writeback_keys);
 
@@ -816,6 +843,7 @@ void bch_cached_dev_writeback_init(struct cached_dev *dc)
 	dc->writeback_delay		= 30;
 	atomic_long_set(&dc->writeback_rate.rate, 1024);
 	dc->writeback_rate_minimum	= 8;
+	dc->writeback_max_in_flight	= WRITEBACK_MAX_IN_FLIGHT_DEFAULT;
 
 	dc->writeback_rate_update_seconds = WRITEBACK_RATE_UPDATE_SECS_DEFAULT;
 	dc->writeback_rate_p_term_inverse = 40;
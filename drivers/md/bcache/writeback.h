@@ -10,6 +10,10 @@
 
 #define MAX_WRITEBACKS_IN_PASS  5
 #define MAX_WRITESIZE_IN_PASS   5000	/* *512b */
+#define MAX_WRITEBACKS_IN_STRIPE_PASS	32
+
+#define WRITEBACK_MAX_IN_FLIGHT_DEFAULT	64
+#define WRITEBACK_MAX_IN_FLIGHT_MAX	1024
 
 #define WRITEBACK_RATE_UPDATE_SECS_MAX		60
 #define WRITEBACK_RATE_UPDATE_SECS_DEFAULT	5
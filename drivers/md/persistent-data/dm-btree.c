@@ -446,6 +446,14 @@ static int dm_btree_lookup_next_single(struct dm_btree_info *info, dm_block_t ro
 			goto out;
 		}
 
+		/*
+		 * The next sibling is where we end up if this child has
+		 * nothing >= @key, and where a caller walking a range will
+		 * look next.
+		 */
+		if (i < (nr_entries - 1))
+			dm_bm_prefetch(dm_tm_get_bm(info->tm), value64(n, i + 1));
+
 		r = dm_btree_lookup_next_single(info, value64(n, i), key, rkey, value_le);
 		if (r == -ENODATA && i < (nr_entries - 1)) {
 			i++;
@@ -759,81 +767,111 @@ static bool need_insert(struct btree_node *node, uint64_t *keys,
 		(le64_to_cpu(node->keys[index]) != keys[level]));
 }
 
-static int insert(struct dm_btree_info *info, dm_block_t root,
-		  uint64_t *keys, void *value, dm_block_t *new_root,
-		  int *inserted)
-		  __dm_written_to_disk(value)
+/*
+ * Shadows the path down to the leaf @leaf_key belongs in, creating the
+ * lower level trees @keys leads through if they don't exist yet.  @keys
+ * holds the keys for all but the bottom level.  On return the leaf is at
+ * the bottom of the spine and @index is where @leaf_key goes in it.
+ */
+static int insert_path(struct dm_btree_info *info, struct shadow_spine *s,
+		       dm_block_t root, uint64_t *keys, uint64_t leaf_key,
+		       unsigned *index)
 {
 	int r;
-	unsigned level, index = -1, last_level = info->levels - 1;
+	unsigned level;
 	dm_block_t block = root;
-	struct shadow_spine spine;
 	struct btree_node *n;
 	struct dm_btree_value_type le64_type;
 
 	init_le64_type(info->tm, &le64_type);
-	init_shadow_spine(&spine, info);
 
 	for (level = 0; level < (info->levels - 1); level++) {
-		r = btree_insert_raw(&spine, block, &le64_type, keys[level], &index);
+		r = btree_insert_raw(s, block, &le64_type, keys[level], index);
 		if (r < 0)
-			goto bad;
+			return r;
 
-		n = dm_block_data(shadow_current(&spine));
+		n = dm_block_data(shadow_current(s));
 
-		if (need_insert(n, keys, level, index)) {
+		if (need_insert(n, keys, level, *index)) {
 			dm_block_t new_tree;
 			__le64 new_le;
 
 			r = dm_btree_empty(info, &new_tree);
 			if (r < 0)
-				goto bad;
+				return r;
 
 			new_le = cpu_to_le64(new_tree);
 			__dm_bless_for_disk(&new_le);
 
-			r = insert_at(sizeof(uint64_t), n, index,
+			r = insert_at(sizeof(uint64_t), n, *index,
 				      keys[level], &new_le);
 			if (r)
-				goto bad;
+				return r;
 		}
 
-		if (level < last_level)
-			block = value64(n, index);
+		block = value64(n, *index);
 	}
 
-	r = btree_insert_raw(&spine, block, &info->value_type,
-			     keys[level], &index);
-	if (r < 0)
-		goto bad;
-
-	n = dm_block_data(shadow_current(&spine));
+	return btree_insert_raw(s, block, &info->value_type, leaf_key, index);
+}
 
-	if (need_insert(n, keys, level, index)) {
+/*
+ * Inserts @value at @index of leaf @n, or overwrites the value already
+ * there for @key.
+ */
+static int insert_value(struct dm_btree_info *info, struct btree_node *n,
+			unsigned index, uint64_t key, void *value,
+			int *inserted)
+			__dm_written_to_disk(value)
+{
+	if ((index >= le32_to_cpu(n->header.nr_entries)) ||
+	    (le64_to_cpu(n->keys[index]) != key)) {
 		if (inserted)
 			*inserted = 1;
 
-		r = insert_at(info->value_type.size, n, index,
-			      keys[level], value);
-		if (r)
-			goto bad_unblessed;
-	} else {
-		if (inserted)
-			*inserted = 0;
-
-		if (info->value_type.dec &&
-		    (!info->value_type.equal ||
-		     !info->value_type.equal(
-			     info->value_type.context,
-			     value_ptr(n, index),
-			     value))) {
-			info->value_type.dec(info->value_type.context,
-					     value_ptr(n, index));
-		}
-		memcpy_disk(value_ptr(n, index),
-			    value, info->value_type.size);
+		return insert_at(info->value_type.size, n, index, key, value);
 	}
 
+	if (inserted)
+		*inserted = 0;
+
+	if (info->value_type.dec &&
+	    (!info->value_type.equal ||
+	     !info->value_type.equal(
+		     info->value_type.context,
+		     value_ptr(n, index),
+		     value))) {
+		info->value_type.dec(info->value_type.context,
+				     value_ptr(n, index));
+	}
+	memcpy_disk(value_ptr(n, index),
+		    value, info->value_type.size);
+
+	return 0;
+}
+
+static int insert(struct dm_btree_info *info, dm_block_t root,
+		  uint64_t *keys, void *value, dm_block_t *new_root,
+		  int *inserted)
+		  __dm_written_to_disk(value)
+{
+	int r;
+	unsigned index = -1, last_level = info->levels - 1;
+	struct shadow_spine spine;
+	struct btree_node *n;
+
+	init_shadow_spine(&spine, info);
+
+	r = insert_path(info, &spine, root, keys, keys[last_level], &index);
+	if (r < 0)
+		goto bad;
+
+	n = dm_block_data(shadow_current(&spine));
+
+	r = insert_value(info, n, index, keys[last_level], value, inserted);
+	if (r)
+		goto bad_unblessed;
+
 	*new_root = shadow_root(&spine);
 	exit_shadow_spine(&spine);
 
@@ -846,6 +884,84 @@ static int insert(struct dm_btree_info *info, dm_block_t root,
 	return r;
 }
 
+/*
+ * Can @key go straight into the leaf at the bottom of the spine, which
+ * @prev_key was just inserted into?  Only if there's room, and @key is
+ * below the next key in the parent.  If the parent isn't an internal node
+ * the leaf is the root of the bottom level tree and covers all keys.
+ */
+static bool leaf_takes_key(struct shadow_spine *s, uint64_t prev_key,
+			   uint64_t key)
+{
+	struct btree_node *n = dm_block_data(shadow_current(s));
+	struct btree_node *parent;
+	int i;
+
+	if (n->header.nr_entries == n->header.max_entries)
+		return false;
+
+	if (!shadow_has_parent(s))
+		return true;
+
+	parent = dm_block_data(shadow_parent(s));
+	if (le32_to_cpu(parent->header.flags) & LEAF_NODE)
+		return true;
+
+	i = lower_bound(parent, prev_key);
+	return (i + 1 < le32_to_cpu(parent->header.nr_entries)) &&
+		(key < le64_to_cpu(parent->keys[i + 1]));
+}
+
+int dm_btree_insert_many(struct dm_btree_info *info, dm_block_t root,
+			 uint64_t *keys, uint64_t *leaf_keys, unsigned nr,
+			 void *values, dm_block_t *new_root)
+			 __dm_written_to_disk(values)
+{
+	int r = 0, i;
+	unsigned k, index = -1;
+	size_t size = info->value_type.size;
+	struct shadow_spine spine;
+	struct btree_node *n;
+
+	*new_root = root;
+	init_shadow_spine(&spine, info);
+
+	for (k = 0; k < nr; k++) {
+		if (k && leaf_takes_key(&spine, leaf_keys[k - 1], leaf_keys[k])) {
+			n = dm_block_data(shadow_current(&spine));
+			i = lower_bound(n, leaf_keys[k]);
+			if (i < 0 || le64_to_cpu(n->keys[i]) != leaf_keys[k])
+				i++;
+			index = i;
+		} else {
+			if (k) {
+				root = shadow_root(&spine);
+				exit_shadow_spine(&spine);
+				init_shadow_spine(&spine, info);
+				index = -1;
+			}
+
+			r = insert_path(info, &spine, root, keys,
+					leaf_keys[k], &index);
+			if (r < 0)
+				goto out;
+		}
+
+		n = dm_block_data(shadow_current(&spine));
+		r = insert_value(info, n, index, leaf_keys[k],
+				 values + k * size, NULL);
+		if (r)
+			goto out;
+
+		*new_root = shadow_root(&spine);
+	}
+
+out:
+	exit_shadow_spine(&spine);
+	return r;
+}
+EXPORT_SYMBOL_GPL(dm_btree_insert_many);
+
 int dm_btree_insert(struct dm_btree_info *info, dm_block_t root,
 		    uint64_t *keys, void *value, dm_block_t *new_root)
 		    __dm_written_to_disk(value)
@@ -963,6 +1079,13 @@ static int walk_node(struct dm_btree_info *info, dm_block_t block,
 	n = dm_block_data(node);
 
 	nr = le32_to_cpu(n->header.nr_entries);
+	if (le32_to_cpu(n->header.flags) & INTERNAL_NODE) {
+		struct dm_block_manager *bm = dm_tm_get_bm(info->tm);
+
+		for (i = 0; i < nr; i++)
+			dm_bm_prefetch(bm, value64(n, i));
+	}
+
 	for (i = 0; i < nr; i++) {
 		if (le32_to_cpu(n->header.flags) & INTERNAL_NODE) {
 			r = walk_node(info, value64(n, i), fn, context);
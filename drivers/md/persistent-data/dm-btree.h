@@ -133,6 +133,20 @@ int dm_btree_insert_notify(struct dm_btree_info *info, dm_block_t root,
 			   int *inserted)
 			   __dm_written_to_disk(value);
 
+/*
+ * Inserts a batch of values into the bottom level tree reached through
+ * @keys, which holds the keys for all but the bottom level (and can be
+ * NULL for a single level tree).  @leaf_keys must be sorted in ascending
+ * order, @values holds @nr values of the tree's value type.  Consecutive
+ * keys that land in the same leaf share its shadowed path, so bulk updates
+ * walk the tree once per leaf rather than once per key.  On error
+ * @new_root holds the root after the keys inserted so far.
+ */
+int dm_btree_insert_many(struct dm_btree_info *info, dm_block_t root,
+			 uint64_t *keys, uint64_t *leaf_keys, unsigned nr,
+			 void *values, dm_block_t *new_root)
+			 __dm_written_to_disk(values);
+
 /*
  * Remove a key if present.  This doesn't remove empty sub trees.  Normally
  * subtrees represent a separate entity, like a snapshot map, so this is
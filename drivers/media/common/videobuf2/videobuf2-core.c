@@ -1118,6 +1118,76 @@ static int __prepare_userptr(struct vb2_buffer *vb)
 	return ret;
 }
 
+/*
+ * __vb2_steal_dmabuf() - take over another buffer's attachment of a dma-buf
+ *
+ * Applications cycling a set of dma-bufs through a queue don't necessarily
+ * queue each of them at the same index every time. Instead of attaching and
+ * mapping the dma-buf again, move the attachment over from a dequeued buffer
+ * that still holds it. That buffer is emptied and acquires its memory from
+ * scratch on its next prepare.
+ */
+static bool __vb2_steal_dmabuf(struct vb2_buffer *vb, unsigned int plane,
+			       struct dma_buf *dbuf, unsigned int length)
+{
+	struct vb2_queue *q = vb->vb2_queue;
+	struct vb2_buffer *donor;
+	struct vb2_plane *dp;
+	unsigned int i, p;
+
+	for (i = 0; i < q->num_buffers; i++) {
+		donor = q->bufs[i];
+		if (donor == vb || donor->state != VB2_BUF_STATE_DEQUEUED ||
+		    plane >= donor->num_planes)
+			continue;
+
+		/*
+		 * A buffer prepared through VIDIOC_PREPARE_BUF is still
+		 * DEQUEUED but is about to be queued with its memory in
+		 * place; leave it alone.
+		 */
+		if (donor->prepared || donor->synced)
+			continue;
+
+		dp = &donor->planes[plane];
+		if (dp->dbuf != dbuf || dp->length != length)
+			continue;
+
+		dprintk(3, "plane %d taken over from buffer %d\n", plane, i);
+
+		donor->copied_timestamp = 0;
+		call_void_vb_qop(donor, buf_cleanup, donor);
+
+		/* The reference on dbuf moves along with the attachment */
+		vb->planes[plane].dbuf = dp->dbuf;
+		vb->planes[plane].mem_priv = dp->mem_priv;
+		vb->planes[plane].dbuf_mapped = dp->dbuf_mapped;
+#ifdef CONFIG_VIDEO_ADV_DEBUG
+		donor->cnt_mem_attach_dmabuf--;
+		vb->cnt_mem_attach_dmabuf++;
+		if (dp->dbuf_mapped) {
+			donor->cnt_mem_map_dmabuf--;
+			vb->cnt_mem_map_dmabuf++;
+		}
+#endif
+		dp->dbuf = NULL;
+		dp->mem_priv = NULL;
+		dp->dbuf_mapped = 0;
+
+		for (p = 0; p < donor->num_planes; p++) {
+			__vb2_plane_dmabuf_put(donor, &donor->planes[p]);
+			donor->planes[p].bytesused = 0;
+			donor->planes[p].length = 0;
+			donor->planes[p].m.fd = 0;
+			donor->planes[p].data_offset = 0;
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
 /*
  * __prepare_dmabuf() - prepare a DMABUF buffer
  */
@@ -1182,6 +1252,11 @@ static int __prepare_dmabuf(struct vb2_buffer *vb)
 		vb->planes[plane].m.fd = 0;
 		vb->planes[plane].data_offset = 0;
 
+		if (__vb2_steal_dmabuf(vb, plane, dbuf, planes[plane].length)) {
+			dma_buf_put(dbuf);
+			continue;
+		}
+
 		/* Acquire each plane's memory */
 		mem_priv = call_ptr_memop(vb, attach_dmabuf,
 				q->alloc_devs[plane] ? : q->dev,
@@ -187,17 +187,28 @@ void fimc_capture_irq_handler(struct fimc_dev *fimc, int deq_buf)
 		goto done;
 	}
 
-	if (!list_empty(&cap->active_buf_q) &&
-	    test_bit(ST_CAPT_RUN, &fimc->state) && deq_buf) {
-		v_buf = fimc_active_queue_pop(cap);
+	if (test_bit(ST_CAPT_RUN, &fimc->state) && deq_buf) {
+		if (!list_empty(&cap->active_buf_q)) {
+			v_buf = fimc_active_queue_pop(cap);
 
-		v_buf->vb.vb2_buf.timestamp = ktime_get_ns();
-		v_buf->vb.sequence = cap->frame_count++;
+			v_buf->vb.vb2_buf.timestamp = ktime_get_ns();
+			v_buf->vb.sequence = cap->frame_count++;
 
-		vb2_buffer_done(&v_buf->vb.vb2_buf, VB2_BUF_STATE_DONE);
+			vb2_buffer_done(&v_buf->vb.vb2_buf,
+					VB2_BUF_STATE_DONE);
+		} else {
+			/* No buffer for this frame, leave a sequence gap. */
+			cap->frame_count++;
+		}
 	}
 
-	if (!list_empty(&cap->pending_buf_q)) {
+	/*
+	 * Fill all free output address slots, not just the one that has
+	 * been released, so that buffers queued while userspace was late
+	 * are all handed to the hardware at once.
+	 */
+	while (!list_empty(&cap->pending_buf_q) &&
+	       cap->active_buf_cnt < FIMC_MAX_OUT_BUFS) {
 
 		v_buf = fimc_pending_queue_pop(cap);
 		fimc_hw_set_output_addr(fimc, &v_buf->paddr, cap->buf_index);
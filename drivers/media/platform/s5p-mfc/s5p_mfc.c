@@ -7,6 +7,7 @@
  */
 
 #include <linux/clk.h>
+#include <linux/debugfs.h>
 #include <linux/delay.h>
 #include <linux/interrupt.h>
 #include <linux/io.h>
@@ -87,24 +88,53 @@ void set_work_bit_irqsave(struct s5p_mfc_ctx *ctx)
 	spin_unlock_irqrestore(&dev->condlock, flags);
 }
 
+/* Pick the ready context with the lowest virtual hw time */
 int s5p_mfc_get_new_ctx(struct s5p_mfc_dev *dev)
 {
+	struct s5p_mfc_ctx *ctx, *best = NULL;
 	unsigned long flags;
-	int ctx;
+	int i, num;
 
 	spin_lock_irqsave(&dev->condlock, flags);
-	ctx = dev->curr_ctx;
-	do {
-		ctx = (ctx + 1) % MFC_NUM_CONTEXTS;
-		if (ctx == dev->curr_ctx) {
-			if (!test_bit(ctx, &dev->ctx_work_bits))
-				ctx = -EAGAIN;
-			break;
-		}
-	} while (!test_bit(ctx, &dev->ctx_work_bits));
+	/* start after the current context, so equal contexts take turns */
+	for (i = 1; i <= MFC_NUM_CONTEXTS; i++) {
+		num = (dev->curr_ctx + i) % MFC_NUM_CONTEXTS;
+		ctx = dev->ctx[num];
+		if (!ctx || !test_bit(num, &dev->ctx_work_bits))
+			continue;
+		if (ctx->sched_vtime + MFC_SCHED_MAX_LAG < dev->sched_vtime)
+			ctx->sched_vtime = dev->sched_vtime - MFC_SCHED_MAX_LAG;
+		if (!best || ctx->sched_vtime < best->sched_vtime)
+			best = ctx;
+	}
+	if (best) {
+		dev->sched_vtime = max(dev->sched_vtime, best->sched_vtime);
+		dev->sched_run_start = ktime_get();
+		num = best->num;
+	} else {
+		num = -EAGAIN;
+	}
 	spin_unlock_irqrestore(&dev->condlock, flags);
 
-	return ctx;
+	return num;
+}
+
+/* Charge the hw time since the last scheduling decision to the context */
+static void s5p_mfc_sched_account(struct s5p_mfc_dev *dev,
+				  struct s5p_mfc_ctx *ctx)
+{
+	u64 delta;
+
+	spin_lock(&dev->condlock);
+	if (ctx && dev->sched_run_start) {
+		delta = ktime_to_ns(ktime_sub(ktime_get(),
+					      dev->sched_run_start));
+		ctx->sched_hw_time += delta;
+		ctx->sched_vtime += delta <<
+				    (MFC_SCHED_PRIO_MAX - ctx->priority);
+	}
+	dev->sched_run_start = 0;
+	spin_unlock(&dev->condlock);
 }
 
 /* Wake up context wait_queue */
@@ -639,6 +669,7 @@ static irqreturn_t s5p_mfc_irq(int irq, void *priv)
 	atomic_set(&dev->watchdog_cnt, 0);
 	spin_lock(&dev->irqlock);
 	ctx = dev->ctx[dev->curr_ctx];
+	s5p_mfc_sched_account(dev, ctx);
 	/* Get the reason of interrupt and the error code */
 	reason = s5p_mfc_hw_call(dev->mfc_ops, get_int_reason, dev);
 	err = s5p_mfc_hw_call(dev->mfc_ops, get_int_err, dev);
@@ -787,6 +818,10 @@ static int s5p_mfc_open(struct file *file)
 	}
 	/* Mark context as idle */
 	clear_work_bit_irqsave(ctx);
+	/* start at the current virtual time, not ahead of everybody else */
+	ctx->priority = MFC_SCHED_PRIO_DEFAULT;
+	ctx->sched_vtime = dev->sched_vtime;
+	ctx->sched_open = ktime_get();
 	dev->ctx[ctx->num] = ctx;
 	if (vdev == dev->vfd_dec) {
 		ctx->type = MFCINST_DECODER;
@@ -1262,6 +1297,38 @@ static void s5p_mfc_unconfigure_dma_memory(struct s5p_mfc_dev *mfc_dev)
 		s5p_mfc_unconfigure_2port_memory(mfc_dev);
 }
 
+static int s5p_mfc_sched_show(struct seq_file *s, void *data)
+{
+	struct s5p_mfc_dev *dev = s->private;
+	struct s5p_mfc_ctx *ctx;
+	u64 now, alive;
+	u32 permille;
+	int i;
+
+	seq_puts(s, "ctx type prio hw_time_us util\n");
+
+	mutex_lock(&dev->mfc_mutex);
+	now = ktime_to_ns(ktime_get());
+	for (i = 0; i < MFC_NUM_CONTEXTS; i++) {
+		ctx = dev->ctx[i];
+		if (!ctx)
+			continue;
+
+		alive = now - ktime_to_ns(ctx->sched_open);
+		permille = alive ? div64_u64(ctx->sched_hw_time * 1000, alive)
+				 : 0;
+		seq_printf(s, "%3d %s %4d %10llu %3u.%u%%\n", i,
+			   ctx->type == MFCINST_DECODER ? "dec " : "enc ",
+			   ctx->priority, div_u64(ctx->sched_hw_time,
+						  NSEC_PER_USEC),
+			   permille / 10, permille % 10);
+	}
+	mutex_unlock(&dev->mfc_mutex);
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(s5p_mfc_sched);
+
 /* MFC probe function */
 static int s5p_mfc_probe(struct platform_device *pdev)
 {
@@ -1392,6 +1459,10 @@ static int s5p_mfc_probe(struct platform_device *pdev)
 	v4l2_info(&dev->v4l2_dev,
 		  "encoder registered as /dev/video%d\n", dev->vfd_enc->num);
 
+	dev->debugfs_root = debugfs_create_dir(dev_name(&pdev->dev), NULL);
+	debugfs_create_file("sched", 0444, dev->debugfs_root, dev,
+			    &s5p_mfc_sched_fops);
+
 	pr_debug("%s--\n", __func__);
 	return 0;
 
@@ -1438,6 +1509,8 @@ static int s5p_mfc_remove(struct platform_device *pdev)
 	}
 	mutex_unlock(&dev->mfc_mutex);
 
+	debugfs_remove_recursive(dev->debugfs_root);
+
 	del_timer_sync(&dev->watchdog_timer);
 	flush_work(&dev->watchdog_work);
 
@@ -293,6 +293,9 @@ struct s5p_mfc_priv_buf {
  * @fw_get_done		flag set when request_firmware() is complete and
  *			copied into fw_buf
  * risc_on:		flag indicates RISC is on or off
+ * @sched_vtime:	virtual hw time of the most recently scheduled context
+ * @sched_run_start:	time at which the running context was given the hw
+ * @debugfs_root:	debugfs directory of the device
  *
  */
 struct s5p_mfc_dev {
@@ -340,6 +343,10 @@ struct s5p_mfc_dev {
 	enum s5p_mfc_fw_ver fw_ver;
 	bool fw_get_done;
 	bool risc_on; /* indicates if RISC is on or off */
+
+	u64 sched_vtime;
+	ktime_t sched_run_start;
+	struct dentry *debugfs_root;
 };
 
 /**
@@ -588,6 +595,8 @@ struct s5p_mfc_codec_ops {
  * @loop_filter_mpeg4:	loop filter for MPEG4 flag
  * @display_delay:	value of the display delay for H264
  * @display_delay_enable:	display delay for H264 enable flag
+ * @low_delay:		return frames in decode order as soon as they are
+ *			decoded (MFC v6+), overrides the display delay
  * @after_packed_pb:	flag used to track buffer when stream is in
  *			Packed PB format
  * @sei_fp_parse:	enable/disable parsing of frame packing SEI information
@@ -611,6 +620,10 @@ struct s5p_mfc_codec_ops {
  * @ctrls:		array of controls, used when adding controls to the
  *			v4l2 control framework
  * @ctrl_handler:	handler for v4l2 framework
+ * @priority:		scheduling priority, 0 (lowest) to MFC_SCHED_PRIO_MAX
+ * @sched_vtime:	hw time used by the context, scaled by its priority
+ * @sched_hw_time:	total hw time used by the context in ns
+ * @sched_open:		time at which the context was opened
  */
 struct s5p_mfc_ctx {
 	struct s5p_mfc_dev *dev;
@@ -675,6 +688,7 @@ struct s5p_mfc_ctx {
 	int loop_filter_mpeg4;
 	int display_delay;
 	int display_delay_enable;
+	int low_delay;
 	int after_packed_pb;
 	int sei_fp_parse;
 
@@ -711,6 +725,11 @@ struct s5p_mfc_ctx {
 	struct v4l2_ctrl_handler ctrl_handler;
 	unsigned int frame_tag;
 	size_t scratch_buf_size;
+
+	int priority;
+	u64 sched_vtime;
+	u64 sched_hw_time;
+	ktime_t sched_open;
 };
 
 /*
@@ -744,6 +763,17 @@ struct mfc_control {
 	__u8			is_volatile;
 };
 
+/*
+ * Contexts get the hardware in order of their virtual hw time, which grows
+ * by the hw time they use, doubled for each priority level below the
+ * highest one. A context that was idle for a while can not claim more than
+ * MFC_SCHED_MAX_LAG of virtual time ahead of the others.
+ */
+#define MFC_SCHED_PRIO_MAX	7
+#define MFC_SCHED_PRIO_DEFAULT	4
+#define MFC_SCHED_MAX_LAG	((u64)(100 * NSEC_PER_MSEC) << \
+				 (MFC_SCHED_PRIO_MAX - MFC_SCHED_PRIO_DEFAULT))
+
 /* Macro for making hardware specific calls */
 #define s5p_mfc_hw_call(f, op, args...) \
 	((f && f->op) ? f->op(args) : (typeof(f->op(args)))(-ENODEV))
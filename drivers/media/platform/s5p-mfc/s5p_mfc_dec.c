@@ -190,6 +190,15 @@ static struct mfc_control controls[] = {
 		.step = 1,
 		.default_value = 0,
 	},
+	{
+		.id = V4L2_CID_MPEG_MFC51_VIDEO_DECODER_LOW_DELAY,
+		.type = V4L2_CTRL_TYPE_BOOLEAN,
+		.name = "Decoder Low Delay Mode",
+		.minimum = 0,
+		.maximum = 1,
+		.step = 1,
+		.default_value = 0,
+	},
 	{
 		.id = V4L2_CID_MPEG_VIDEO_DECODER_MPEG4_DEBLOCK_FILTER,
 		.type = V4L2_CTRL_TYPE_BOOLEAN,
@@ -208,6 +217,15 @@ static struct mfc_control controls[] = {
 		.step = 1,
 		.default_value = 0,
 	},
+	{
+		.id = V4L2_CID_MPEG_MFC51_VIDEO_PRIORITY,
+		.type = V4L2_CTRL_TYPE_INTEGER,
+		.name = "Hardware Scheduling Priority",
+		.minimum = 0,
+		.maximum = MFC_SCHED_PRIO_MAX,
+		.step = 1,
+		.default_value = MFC_SCHED_PRIO_DEFAULT,
+	},
 	{
 		.id = V4L2_CID_MIN_BUFFERS_FOR_CAPTURE,
 		.type = V4L2_CTRL_TYPE_INTEGER,
@@ -712,6 +730,12 @@ static int s5p_mfc_dec_s_ctrl(struct v4l2_ctrl *ctrl)
 	case V4L2_CID_MPEG_MFC51_VIDEO_DECODER_H264_DISPLAY_DELAY_ENABLE:
 		ctx->display_delay_enable = ctrl->val;
 		break;
+	case V4L2_CID_MPEG_MFC51_VIDEO_DECODER_LOW_DELAY:
+		ctx->low_delay = ctrl->val;
+		break;
+	case V4L2_CID_MPEG_MFC51_VIDEO_PRIORITY:
+		ctx->priority = ctrl->val;
+		break;
 	case V4L2_CID_MPEG_VIDEO_DECODER_MPEG4_DEBLOCK_FILTER:
 		ctx->loop_filter_mpeg4 = ctrl->val;
 		break;
@@ -1141,6 +1165,11 @@ int s5p_mfc_dec_ctrls_setup(struct s5p_mfc_ctx *ctx)
 	}
 
 	for (i = 0; i < NUM_CTRLS; i++) {
+		/* low delay mode is only supported by MFC v6+ firmware */
+		if (controls[i].id == V4L2_CID_MPEG_MFC51_VIDEO_DECODER_LOW_DELAY &&
+		    !IS_MFCV6_PLUS(ctx->dev))
+			continue;
+
 		if (IS_MFC51_PRIV(controls[i].id)) {
 			memset(&cfg, 0, sizeof(struct v4l2_ctrl_config));
 			cfg.ops = &s5p_mfc_dec_ctrl_ops;
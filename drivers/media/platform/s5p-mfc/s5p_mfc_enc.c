@@ -201,6 +201,15 @@ static struct mfc_control controls[] = {
 		.step = 1,
 		.default_value = 1,
 	},
+	{
+		.id = V4L2_CID_MPEG_MFC51_VIDEO_PRIORITY,
+		.type = V4L2_CTRL_TYPE_INTEGER,
+		.name = "Hardware Scheduling Priority",
+		.minimum = 0,
+		.maximum = MFC_SCHED_PRIO_MAX,
+		.step = 1,
+		.default_value = MFC_SCHED_PRIO_DEFAULT,
+	},
 	{
 		.id = V4L2_CID_MPEG_MFC51_VIDEO_FORCE_FRAME_TYPE,
 		.type = V4L2_CTRL_TYPE_MENU,
@@ -1841,6 +1850,9 @@ static int s5p_mfc_enc_s_ctrl(struct v4l2_ctrl *ctrl)
 	case V4L2_CID_MPEG_MFC51_VIDEO_FORCE_FRAME_TYPE:
 		ctx->force_frame_type = ctrl->val;
 		break;
+	case V4L2_CID_MPEG_MFC51_VIDEO_PRIORITY:
+		ctx->priority = ctrl->val;
+		break;
 	case V4L2_CID_MPEG_VIDEO_FORCE_KEY_FRAME:
 		ctx->force_frame_type =
 			V4L2_MPEG_MFC51_VIDEO_FORCE_FRAME_TYPE_I_FRAME;
@@ -57,6 +57,9 @@
 #include "quirks.h"
 #include "sd_ops.h"
 
+#define CREATE_TRACE_POINTS
+#include "block_trace.h"
+
 MODULE_ALIAS("mmc:block");
 #ifdef MODULE_PARAM_PREFIX
 #undef MODULE_PARAM_PREFIX
@@ -1446,6 +1449,79 @@ static void mmc_blk_data_prep(struct mmc_queue *mq, struct mmc_queue_req *mqrq,
 		*do_data_tag_p = do_data_tag;
 }
 
+static int mmc_blk_lat_class(struct request *req)
+{
+	switch (req_op(req)) {
+	case REQ_OP_READ:
+		return MMC_LAT_READ;
+	case REQ_OP_WRITE:
+		return MMC_LAT_WRITE;
+	case REQ_OP_DISCARD:
+	case REQ_OP_SECURE_ERASE:
+		return MMC_LAT_DISCARD;
+	case REQ_OP_FLUSH:
+		return MMC_LAT_FLUSH;
+	case REQ_OP_DRV_IN:
+	case REQ_OP_DRV_OUT:
+		if (req_to_mmc_queue_req(req)->drv_op == MMC_DRV_OP_IOCTL_RPMB)
+			return MMC_LAT_RPMB;
+		return -1;
+	default:
+		return -1;
+	}
+}
+
+static void mmc_blk_lat_add(struct mmc_lat_hist *hist, s64 us)
+{
+	unsigned int bucket;
+
+	if (us < 0)
+		us = 0;
+
+	bucket = min_t(unsigned int, fls64(us), MMC_LAT_BUCKETS - 1);
+	hist->buckets[bucket]++;
+	hist->count++;
+	hist->total_us += us;
+	if (us > hist->max_us)
+		hist->max_us = us;
+}
+
+/*
+ * Account a request that was dispatched to us at @issue, handed to the host
+ * at @start and finished by the card at @done, and is being completed now.
+ */
+static void mmc_blk_lat_account(struct mmc_queue *mq, int class,
+				ktime_t issue, ktime_t start, ktime_t done)
+{
+	struct mmc_lat_stats *stats = &mq->card->lat_stats;
+	s64 issue_us, busy_us, complete_us;
+	unsigned long flags;
+
+	if (class < 0)
+		return;
+
+	issue_us = ktime_us_delta(start, issue);
+	busy_us = ktime_us_delta(done, start);
+	complete_us = ktime_us_delta(ktime_get(), done);
+
+	spin_lock_irqsave(&stats->lock, flags);
+	mmc_blk_lat_add(&stats->hist[class][MMC_LAT_ISSUE], issue_us);
+	mmc_blk_lat_add(&stats->hist[class][MMC_LAT_BUSY], busy_us);
+	mmc_blk_lat_add(&stats->hist[class][MMC_LAT_COMPLETE], complete_us);
+	spin_unlock_irqrestore(&stats->lock, flags);
+
+	trace_mmc_blk_latency(mq->blkdata->disk->disk_name, class, issue_us,
+			      busy_us, complete_us);
+}
+
+static void mmc_blk_lat_account_rq(struct mmc_queue *mq, struct request *req)
+{
+	struct mmc_queue_req *mqrq = req_to_mmc_queue_req(req);
+
+	mmc_blk_lat_account(mq, mmc_blk_lat_class(req), mqrq->lat_issue,
+			    mqrq->lat_start, mqrq->lat_done);
+}
+
 #define MMC_CQE_RETRIES 2
 
 static void mmc_blk_cqe_complete_rq(struct mmc_queue *mq, struct request *req)
@@ -1460,6 +1536,8 @@ static void mmc_blk_cqe_complete_rq(struct mmc_queue *mq, struct request *req)
 
 	mmc_cqe_post_req(host, mrq);
 
+	mmc_blk_lat_account_rq(mq, req);
+
 	if (mrq->cmd && mrq->cmd->error)
 		err = mrq->cmd->error;
 	else if (mrq->data && mrq->data->error)
@@ -1523,6 +1601,8 @@ static void mmc_blk_cqe_req_done(struct mmc_request *mrq)
 	struct request_queue *q = req->q;
 	struct mmc_queue *mq = q->queuedata;
 
+	mqrq->lat_done = ktime_get();
+
 	/*
 	 * Block layer timeouts race with completions which means the normal
 	 * completion path cannot be used during recovery.
@@ -1535,6 +1615,11 @@ static void mmc_blk_cqe_req_done(struct mmc_request *mrq)
 
 static int mmc_blk_cqe_start_req(struct mmc_host *host, struct mmc_request *mrq)
 {
+	struct mmc_queue_req *mqrq = container_of(mrq, struct mmc_queue_req,
+						  brq.mrq);
+
+	mqrq->lat_start = ktime_get();
+
 	mrq->done		= mmc_blk_cqe_req_done;
 	mrq->recovery_notifier	= mmc_cqe_recovery_notifier;
 
@@ -1644,6 +1729,87 @@ static void mmc_blk_rw_rq_prep(struct mmc_queue_req *mqrq,
 	}
 }
 
+#define PACKED_CMD_VER	0x01
+#define PACKED_CMD_WR	0x02
+
+static inline bool mmc_blk_is_packed(struct mmc_queue_req *mqrq)
+{
+	return mqrq->packed && mqrq->packed->nr_reqs;
+}
+
+/*
+ * A packed write sends several writes with a single CMD23/CMD25 pair. The
+ * data starts with a header block holding the CMD23 and CMD25 arguments of
+ * each write, followed by the data of all of them in the same order.
+ */
+static void mmc_blk_packed_hdr_wrq_prep(struct mmc_queue_req *mqrq,
+					struct mmc_card *card,
+					struct mmc_queue *mq)
+{
+	struct mmc_blk_request *brq = &mqrq->brq;
+	struct request *req = mmc_queue_req_to_req(mqrq);
+	struct mmc_packed *packed = mqrq->packed;
+	__le32 *hdr = packed->cmd_hdr;
+	unsigned int hdr_blocks = mmc_large_sector(card) ? 8 : 1;
+	unsigned int sg_len;
+	int i;
+
+	memset(hdr, 0, hdr_blocks << 9);
+	hdr[0] = cpu_to_le32((packed->nr_reqs << 16) |
+			     (PACKED_CMD_WR << 8) | PACKED_CMD_VER);
+
+	sg_set_buf(mqrq->sg, hdr, hdr_blocks << 9);
+	sg_unmark_end(mqrq->sg);
+	sg_len = 1;
+
+	for (i = 0; i < packed->nr_reqs; i++) {
+		struct request *prq = packed->reqs[i];
+		u32 addr = blk_rq_pos(prq);
+
+		if (!mmc_card_blockaddr(card))
+			addr <<= 9;
+
+		/* Entries start after the first 8 bytes of the header */
+		hdr[(i + 1) * 2] = cpu_to_le32(blk_rq_sectors(prq));
+		hdr[(i + 1) * 2 + 1] = cpu_to_le32(addr);
+
+		sg_len += blk_rq_map_sg(mq->queue, prq, mqrq->sg + sg_len);
+		sg_unmark_end(mqrq->sg + sg_len - 1);
+	}
+	sg_mark_end(mqrq->sg + sg_len - 1);
+
+	memset(brq, 0, sizeof(struct mmc_blk_request));
+
+	brq->mrq.cmd = &brq->cmd;
+	brq->mrq.data = &brq->data;
+	brq->mrq.sbc = &brq->sbc;
+	brq->mrq.stop = &brq->stop;
+	brq->mrq.tag = req->tag;
+
+	brq->sbc.opcode = MMC_SET_BLOCK_COUNT;
+	brq->sbc.arg = MMC_CMD23_ARG_PACKED | (packed->blocks + hdr_blocks);
+	brq->sbc.flags = MMC_RSP_R1 | MMC_CMD_AC;
+
+	/* CMD25 carries the address of the first write */
+	brq->cmd.opcode = MMC_WRITE_MULTIPLE_BLOCK;
+	brq->cmd.arg = blk_rq_pos(req);
+	if (!mmc_card_blockaddr(card))
+		brq->cmd.arg <<= 9;
+	brq->cmd.flags = MMC_RSP_SPI_R1 | MMC_RSP_R1 | MMC_CMD_ADTC;
+
+	brq->stop.opcode = MMC_STOP_TRANSMISSION;
+	brq->stop.flags = MMC_RSP_SPI_R1B | MMC_RSP_R1B | MMC_CMD_AC;
+
+	brq->data.blksz = 512;
+	brq->data.blocks = packed->blocks + hdr_blocks;
+	brq->data.blk_addr = blk_rq_pos(req);
+	brq->data.flags = MMC_DATA_WRITE;
+	brq->data.sg = mqrq->sg;
+	brq->data.sg_len = sg_len;
+
+	mmc_set_data_timeout(&brq->data, card);
+}
+
 #define MMC_MAX_RETRIES		5
 #define MMC_DATA_RETRIES	2
 #define MMC_NO_RETRIES		(MMC_MAX_RETRIES + 1)
@@ -1926,6 +2092,8 @@ static void mmc_blk_mq_complete_rq(struct mmc_queue *mq, struct request *req)
 	struct mmc_queue_req *mqrq = req_to_mmc_queue_req(req);
 	unsigned int nr_bytes = mqrq->brq.data.bytes_xfered;
 
+	mmc_blk_lat_account_rq(mq, req);
+
 	if (nr_bytes) {
 		if (blk_update_request(req, BLK_STS_OK, nr_bytes))
 			blk_mq_requeue_request(req, true);
@@ -1981,6 +2149,10 @@ static void mmc_blk_mq_poll_completion(struct mmc_queue *mq,
 		mmc_retune_release(host);
 	}
 
+	/* Writes are not done until the card stops signalling busy */
+	if (rq_data_dir(req) == WRITE)
+		mqrq->lat_done = ktime_get();
+
 	mmc_blk_urgent_bkops(mq, mqrq);
 }
 
@@ -2001,6 +2173,43 @@ static void mmc_blk_mq_dec_in_flight(struct mmc_queue *mq, struct request *req)
 		mmc_put_card(mq->card, &mq->ctx);
 }
 
+/*
+ * The card does not tell which writes of a failed packed command made it,
+ * so none of them is accepted and each one is retried on its own.
+ */
+static void mmc_blk_packed_post_req(struct mmc_queue *mq, struct request *req)
+{
+	struct mmc_queue_req *mqrq = req_to_mmc_queue_req(req);
+	struct mmc_blk_request *brq = &mqrq->brq;
+	struct mmc_packed *packed = mqrq->packed;
+	int i = packed->nr_reqs;
+	bool ok;
+
+	ok = !mmc_blk_rq_error(brq) &&
+	     brq->data.bytes_xfered == brq->data.blocks * brq->data.blksz;
+	if (!ok)
+		mq->card->packed_stats.failed++;
+
+	packed->nr_reqs = 0;
+
+	/* The first request owns the pack, so complete it last */
+	while (i--) {
+		struct request *prq = packed->reqs[i];
+		struct mmc_queue_req *pmqrq = req_to_mmc_queue_req(prq);
+
+		pmqrq->brq.data.bytes_xfered = ok ? blk_rq_bytes(prq) : 0;
+		pmqrq->lat_start = mqrq->lat_start;
+		pmqrq->lat_done = mqrq->lat_done;
+
+		if (mq->in_recovery)
+			mmc_blk_mq_complete_rq(mq, prq);
+		else
+			blk_mq_complete_request(prq);
+
+		mmc_blk_mq_dec_in_flight(mq, prq);
+	}
+}
+
 static void mmc_blk_mq_post_req(struct mmc_queue *mq, struct request *req)
 {
 	struct mmc_queue_req *mqrq = req_to_mmc_queue_req(req);
@@ -2009,6 +2218,11 @@ static void mmc_blk_mq_post_req(struct mmc_queue *mq, struct request *req)
 
 	mmc_post_req(host, mrq, 0);
 
+	if (mmc_blk_is_packed(mqrq)) {
+		mmc_blk_packed_post_req(mq, req);
+		return;
+	}
+
 	/*
 	 * Block layer timeouts race with completions which means the normal
 	 * completion path cannot be used during recovery.
@@ -2082,6 +2296,8 @@ static void mmc_blk_mq_req_done(struct mmc_request *mrq)
 	struct mmc_host *host = mq->card->host;
 	unsigned long flags;
 
+	mqrq->lat_done = ktime_get();
+
 	if (!mmc_host_done_complete(host)) {
 		bool waiting;
 
@@ -2173,7 +2389,10 @@ static int mmc_blk_mq_issue_rw_rq(struct mmc_queue *mq,
 	struct request *prev_req = NULL;
 	int err = 0;
 
-	mmc_blk_rw_rq_prep(mqrq, mq->card, 0, mq);
+	if (mmc_blk_is_packed(mqrq))
+		mmc_blk_packed_hdr_wrq_prep(mqrq, mq->card, mq);
+	else
+		mmc_blk_rw_rq_prep(mqrq, mq->card, 0, mq);
 
 	mqrq->brq.mrq.done = mmc_blk_mq_req_done;
 
@@ -2185,6 +2404,7 @@ static int mmc_blk_mq_issue_rw_rq(struct mmc_queue *mq,
 
 	mq->rw_wait = true;
 
+	mqrq->lat_start = ktime_get();
 	err = mmc_start_request(host, &mqrq->brq.mrq);
 
 	if (prev_req)
@@ -2217,7 +2437,8 @@ enum mmc_issued mmc_blk_mq_issue_rq(struct mmc_queue *mq, struct request *req)
 	struct mmc_blk_data *md = mq->blkdata;
 	struct mmc_card *card = md->queue.card;
 	struct mmc_host *host = card->host;
-	int ret;
+	ktime_t issue, start;
+	int ret, lat_class;
 
 	ret = mmc_blk_part_switch(card, md->part_type);
 	if (ret)
@@ -2228,6 +2449,10 @@ enum mmc_issued mmc_blk_mq_issue_rq(struct mmc_queue *mq, struct request *req)
 		ret = mmc_blk_wait_for_idle(mq, host);
 		if (ret)
 			return MMC_REQ_BUSY;
+		/* The request is gone once it has been issued */
+		lat_class = mmc_blk_lat_class(req);
+		issue = req_to_mmc_queue_req(req)->lat_issue;
+		start = ktime_get();
 		switch (req_op(req)) {
 		case REQ_OP_DRV_IN:
 		case REQ_OP_DRV_OUT:
@@ -2246,6 +2471,7 @@ enum mmc_issued mmc_blk_mq_issue_rq(struct mmc_queue *mq, struct request *req)
 			WARN_ON_ONCE(1);
 			return MMC_REQ_FAILED_TO_START;
 		}
+		mmc_blk_lat_account(mq, lat_class, issue, start, ktime_get());
 		return MMC_REQ_FINISHED;
 	case MMC_ISSUE_DCMD:
 	case MMC_ISSUE_ASYNC:
@@ -2273,6 +2499,150 @@ enum mmc_issued mmc_blk_mq_issue_rq(struct mmc_queue *mq, struct request *req)
 	}
 }
 
+static bool mmc_blk_packable(struct mmc_queue *mq, struct request *req)
+{
+	struct mmc_card *card = mq->card;
+
+	if (req_op(req) != REQ_OP_WRITE || (req->cmd_flags & REQ_FUA))
+		return false;
+
+	/* Writes that failed in a packed command are retried unpacked */
+	if (req_to_mmc_queue_req(req)->retries)
+		return false;
+
+	return card->packed_max_reqs > 1 &&
+	       blk_rq_sectors(req) <= card->packed_max_sectors;
+}
+
+static bool mmc_blk_packed_fits(struct mmc_queue *mq,
+				struct mmc_packed *packed,
+				struct request *req)
+{
+	struct mmc_card *card = mq->card;
+	unsigned int max_reqs, hdr_blocks = mmc_large_sector(card) ? 8 : 1;
+
+	max_reqs = min_t(unsigned int, card->packed_max_reqs,
+			 card->ext_csd.max_packed_writes);
+	max_reqs = min_t(unsigned int, max_reqs, MMC_PACKED_MAX_ENTRIES);
+
+	return packed->nr_reqs < max_reqs &&
+	       packed->blocks + hdr_blocks + blk_rq_sectors(req) <=
+			queue_max_hw_sectors(mq->queue) &&
+	       packed->segs + blk_rq_nr_phys_segments(req) <=
+			queue_max_segments(mq->queue);
+}
+
+/*
+ * Issue the pack being gathered. If it cannot be started, all requests in it
+ * but @cur, which the caller owns, are requeued or failed here.
+ */
+static enum mmc_issued mmc_blk_packed_flush(struct mmc_queue *mq,
+					    struct request *cur)
+{
+	struct mmc_packed_stats *stats = &mq->card->packed_stats;
+	struct request *req = mq->packed_req;
+	struct mmc_packed *packed = req_to_mmc_queue_req(req)->packed;
+	unsigned int nr_reqs = packed->nr_reqs;
+	enum mmc_issued issued;
+	int i;
+
+	mq->packed_req = NULL;
+
+	/* A single write is not worth a header block */
+	if (nr_reqs == 1) {
+		packed->nr_reqs = 0;
+		stats->single++;
+	}
+
+	issued = mmc_blk_mq_issue_rq(mq, req);
+	if (issued == MMC_REQ_STARTED) {
+		if (nr_reqs > 1) {
+			stats->cmds++;
+			stats->reqs += nr_reqs;
+			stats->blocks += packed->blocks;
+		}
+		return issued;
+	}
+
+	for (i = 0; i < nr_reqs; i++) {
+		struct request *prq = packed->reqs[i];
+
+		if (prq == cur)
+			continue;
+
+		if (issued == MMC_REQ_BUSY)
+			blk_mq_requeue_request(prq, true);
+		else
+			blk_mq_end_request(prq, BLK_STS_IOERR);
+
+		mmc_blk_mq_dec_in_flight(mq, prq);
+	}
+	packed->nr_reqs = 0;
+
+	return issued;
+}
+
+/*
+ * Small writes dispatched back to back are held until the block layer has no
+ * more requests for us, the pack is full or a request that cannot be packed
+ * comes in, and are then sent as a single packed write.
+ *
+ * Flushing the previous pack on behalf of @req only decides @req's fate when
+ * the host is busy, in which case @req is requeued along with it. A pack that
+ * failed to start has already been failed on its own, @req is still tried.
+ */
+enum mmc_issued mmc_blk_packed_issue_rq(struct mmc_queue *mq,
+					struct request *req, bool last)
+{
+	struct request *leader = mq->packed_req;
+	struct mmc_packed *packed;
+	enum mmc_issued issued;
+
+	if (!mmc_blk_packable(mq, req)) {
+		if (leader) {
+			issued = mmc_blk_packed_flush(mq, NULL);
+			if (issued == MMC_REQ_BUSY)
+				return issued;
+		}
+		return mmc_blk_mq_issue_rq(mq, req);
+	}
+
+	if (leader &&
+	    !mmc_blk_packed_fits(mq, req_to_mmc_queue_req(leader)->packed,
+				 req)) {
+		issued = mmc_blk_packed_flush(mq, NULL);
+		if (issued == MMC_REQ_BUSY)
+			return issued;
+		leader = NULL;
+	}
+
+	if (!leader) {
+		leader = req;
+		packed = req_to_mmc_queue_req(leader)->packed;
+		packed->nr_reqs = 0;
+		packed->blocks = 0;
+		packed->segs = 1;
+		mq->packed_req = leader;
+	} else {
+		packed = req_to_mmc_queue_req(leader)->packed;
+	}
+
+	packed->reqs[packed->nr_reqs++] = req;
+	packed->blocks += blk_rq_sectors(req);
+	packed->segs += blk_rq_nr_phys_segments(req);
+
+	if (!last)
+		return MMC_REQ_STARTED;
+
+	return mmc_blk_packed_flush(mq, req);
+}
+
+/* The block layer stopped dispatching before the last request */
+void mmc_blk_packed_commit(struct mmc_queue *mq)
+{
+	mmc_blk_packed_flush(mq, NULL);
+}
+
 static inline int mmc_blk_readonly(struct mmc_card *card)
 {
 	return mmc_card_readonly(card) ||
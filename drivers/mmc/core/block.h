@@ -10,6 +10,9 @@ void mmc_blk_cqe_recovery(struct mmc_queue *mq);
 enum mmc_issued;
 
 enum mmc_issued mmc_blk_mq_issue_rq(struct mmc_queue *mq, struct request *req);
+enum mmc_issued mmc_blk_packed_issue_rq(struct mmc_queue *mq,
+					struct request *req, bool last);
+void mmc_blk_packed_commit(struct mmc_queue *mq);
 void mmc_blk_mq_complete(struct request *req);
 void mmc_blk_mq_recovery(struct mmc_queue *mq);
 
@@ -0,0 +1,53 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM mmc_blk
+
+#if !defined(_MMC_BLOCK_TRACE_H) || defined(TRACE_HEADER_MULTI_READ)
+#define _MMC_BLOCK_TRACE_H
+
+#include <linux/tracepoint.h>
+#include <linux/mmc/card.h>
+
+TRACE_EVENT(mmc_blk_latency,
+
+	TP_PROTO(const char *disk_name, int class, s64 issue_us, s64 busy_us,
+		 s64 complete_us),
+
+	TP_ARGS(disk_name, class, issue_us, busy_us, complete_us),
+
+	TP_STRUCT__entry(
+		__string(name,		disk_name)
+		__field(int,		class)
+		__field(s64,		issue_us)
+		__field(s64,		busy_us)
+		__field(s64,		complete_us)
+	),
+
+	TP_fast_assign(
+		__assign_str(name, disk_name);
+		__entry->class = class;
+		__entry->issue_us = issue_us;
+		__entry->busy_us = busy_us;
+		__entry->complete_us = complete_us;
+	),
+
+	TP_printk("%s: %s issue=%lld us busy=%lld us complete=%lld us",
+		  __get_str(name),
+		  __print_symbolic(__entry->class,
+				   { MMC_LAT_READ,	"read" },
+				   { MMC_LAT_WRITE,	"write" },
+				   { MMC_LAT_DISCARD,	"discard" },
+				   { MMC_LAT_FLUSH,	"flush" },
+				   { MMC_LAT_RPMB,	"rpmb" }),
+		  __entry->issue_us, __entry->busy_us, __entry->complete_us)
+);
+
+#endif /* _MMC_BLOCK_TRACE_H */
+
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+#undef TRACE_INCLUDE_FILE
+#define TRACE_INCLUDE_FILE block_trace
+
+/* This part must be outside protection */
+#include <trace/define_trace.h>
@@ -12,6 +12,7 @@
 #include <linux/slab.h>
 #include <linux/stat.h>
 #include <linux/fault-inject.h>
+#include <linux/math64.h>
 
 #include <linux/mmc/card.h>
 #include <linux/mmc/host.h>
@@ -249,6 +250,90 @@ void mmc_remove_host_debugfs(struct mmc_host *host)
 	debugfs_remove_recursive(host->debugfs_root);
 }
 
+static int mmc_packed_show(struct seq_file *s, void *data)
+{
+	struct mmc_card *card = s->private;
+	struct mmc_packed_stats *stats = &card->packed_stats;
+
+	seq_printf(s, "packed commands:\t%lu\n", stats->cmds);
+	seq_printf(s, "packed requests:\t%lu\n", stats->reqs);
+	seq_printf(s, "packed blocks:\t\t%lu\n", stats->blocks);
+	seq_printf(s, "single requests:\t%lu\n", stats->single);
+	seq_printf(s, "failed commands:\t%lu\n", stats->failed);
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(mmc_packed);
+
+static int mmc_latency_show(struct seq_file *s, void *data)
+{
+	static const char *class_str[MMC_LAT_CLASS_MAX] = {
+		[MMC_LAT_READ]		= "read",
+		[MMC_LAT_WRITE]		= "write",
+		[MMC_LAT_DISCARD]	= "discard",
+		[MMC_LAT_FLUSH]		= "flush",
+		[MMC_LAT_RPMB]		= "rpmb",
+	};
+	static const char *stage_str[MMC_LAT_STAGE_MAX] = {
+		[MMC_LAT_ISSUE]		= "issue",
+		[MMC_LAT_BUSY]		= "busy",
+		[MMC_LAT_COMPLETE]	= "complete",
+	};
+	struct mmc_card *card = s->private;
+	struct mmc_lat_stats *stats = &card->lat_stats;
+	struct mmc_lat_hist *hist;
+	int class, stage, i;
+
+	seq_puts(s, "# class stage count avg_us max_us, then requests below 2^n us\n");
+
+	spin_lock_irq(&stats->lock);
+	for (class = 0; class < MMC_LAT_CLASS_MAX; class++) {
+		for (stage = 0; stage < MMC_LAT_STAGE_MAX; stage++) {
+			hist = &stats->hist[class][stage];
+			if (!hist->count)
+				continue;
+
+			seq_printf(s, "%s %s %lu %llu %llu:", class_str[class],
+				   stage_str[stage], hist->count,
+				   div_u64(hist->total_us, hist->count),
+				   hist->max_us);
+			for (i = 0; i < MMC_LAT_BUCKETS; i++)
+				seq_printf(s, " %lu", hist->buckets[i]);
+			seq_putc(s, '\n');
+		}
+	}
+	spin_unlock_irq(&stats->lock);
+
+	return 0;
+}
+
+static int mmc_latency_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, mmc_latency_show, inode->i_private);
+}
+
+/* Any write clears the histograms */
+static ssize_t mmc_latency_write(struct file *file, const char __user *ubuf,
+				 size_t count, loff_t *ppos)
+{
+	struct mmc_card *card = ((struct seq_file *)file->private_data)->private;
+	struct mmc_lat_stats *stats = &card->lat_stats;
+
+	spin_lock_irq(&stats->lock);
+	memset(stats->hist, 0, sizeof(stats->hist));
+	spin_unlock_irq(&stats->lock);
+
+	return count;
+}
+
+static const struct file_operations mmc_latency_fops = {
+	.open		= mmc_latency_open,
+	.read		= seq_read,
+	.write		= mmc_latency_write,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
 void mmc_add_card_debugfs(struct mmc_card *card)
 {
 	struct mmc_host	*host = card->host;
@@ -261,6 +346,19 @@ void mmc_add_card_debugfs(struct mmc_card *card)
 	card->debugfs_root = root;
 
 	debugfs_create_x32("state", S_IRUSR, root, &card->state);
+
+	if (mmc_card_mmc(card) || mmc_card_sd(card))
+		debugfs_create_file("latency", S_IRUSR | S_IWUSR, root, card,
+				    &mmc_latency_fops);
+
+	if (mmc_card_mmc(card) && card->ext_csd.max_packed_writes) {
+		debugfs_create_file("packed", S_IRUSR, root, card,
+				    &mmc_packed_fops);
+		debugfs_create_u32("packed_max_reqs", S_IRUSR | S_IWUSR, root,
+				   &card->packed_max_reqs);
+		debugfs_create_u32("packed_max_sectors", S_IRUSR | S_IWUSR,
+				   root, &card->packed_max_sectors);
+	}
 }
 
 void mmc_remove_card_debugfs(struct mmc_card *card)
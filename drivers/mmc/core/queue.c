@@ -174,6 +174,20 @@ static struct scatterlist *mmc_alloc_sg(int sg_len, gfp_t gfp)
 	return sg;
 }
 
+/*
+ * Packed commands are an eMMC 4.5 feature and cannot be used together with
+ * the command queue.
+ */
+static bool mmc_queue_can_pack(struct mmc_queue *mq)
+{
+	struct mmc_card *card = mq->card;
+	struct mmc_host *host = card->host;
+
+	return !mq->use_cqe && mmc_card_mmc(card) &&
+	       (host->caps2 & MMC_CAP2_PACKED_WR) && mmc_host_cmd23(host) &&
+	       card->ext_csd.rev >= 6 && card->ext_csd.max_packed_writes > 1;
+}
+
 static void mmc_queue_setup_discard(struct request_queue *q,
 				    struct mmc_card *card)
 {
@@ -210,6 +224,17 @@ static int __mmc_init_request(struct mmc_queue *mq, struct request *req,
 	if (!mq_rq->sg)
 		return -ENOMEM;
 
+	if (mq->use_packed) {
+		mq_rq->packed = kzalloc(sizeof(*mq_rq->packed) +
+					(mmc_large_sector(card) ? 4096 : 512),
+					gfp);
+		if (!mq_rq->packed) {
+			kfree(mq_rq->sg);
+			mq_rq->sg = NULL;
+			return -ENOMEM;
+		}
+	}
+
 	return 0;
 }
 
@@ -219,6 +244,8 @@ static void mmc_exit_request(struct request_queue *q, struct request *req)
 
 	kfree(mq_rq->sg);
 	mq_rq->sg = NULL;
+	kfree(mq_rq->packed);
+	mq_rq->packed = NULL;
 }
 
 static int mmc_mq_init_request(struct blk_mq_tag_set *set, struct request *req,
@@ -298,6 +325,8 @@ static blk_status_t mmc_mq_queue_rq(struct blk_mq_hw_ctx *hctx,
 		req->rq_flags |= RQF_DONTPREP;
 	}
 
+	req_to_mmc_queue_req(req)->lat_issue = ktime_get();
+
 	if (get_card)
 		mmc_get_card(card, &mq->ctx);
 
@@ -308,7 +337,10 @@ static blk_status_t mmc_mq_queue_rq(struct blk_mq_hw_ctx *hctx,
 
 	blk_mq_start_request(req);
 
-	issued = mmc_blk_mq_issue_rq(mq, req);
+	if (mq->use_packed)
+		issued = mmc_blk_packed_issue_rq(mq, req, bd->last);
+	else
+		issued = mmc_blk_mq_issue_rq(mq, req);
 
 	switch (issued) {
 	case MMC_REQ_BUSY:
@@ -340,8 +372,29 @@ static blk_status_t mmc_mq_queue_rq(struct blk_mq_hw_ctx *hctx,
 	return ret;
 }
 
+static void mmc_mq_commit_rqs(struct blk_mq_hw_ctx *hctx)
+{
+	struct mmc_queue *mq = hctx->queue->queuedata;
+
+	spin_lock_irq(&mq->lock);
+
+	/* A dispatch in progress will issue the pack itself */
+	if (!mq->packed_req || mq->busy) {
+		spin_unlock_irq(&mq->lock);
+		return;
+	}
+	mq->busy = true;
+
+	spin_unlock_irq(&mq->lock);
+
+	mmc_blk_packed_commit(mq);
+
+	WRITE_ONCE(mq->busy, false);
+}
+
 static const struct blk_mq_ops mmc_mq_ops = {
 	.queue_rq	= mmc_mq_queue_rq,
+	.commit_rqs	= mmc_mq_commit_rqs,
 	.init_request	= mmc_mq_init_request,
 	.exit_request	= mmc_mq_exit_request,
 	.complete	= mmc_blk_mq_complete,
@@ -398,6 +451,11 @@ int mmc_init_queue(struct mmc_queue *mq, struct mmc_card *card)
 
 	mq->card = card;
 	mq->use_cqe = host->cqe_enabled;
+	mq->use_packed = mmc_queue_can_pack(mq);
+	if (mq->use_packed) {
+		card->packed_max_reqs = MMC_PACKED_MAX_ENTRIES;
+		card->packed_max_sectors = MMC_PACKED_MAX_SECTORS;
+	}
 	
 	spin_lock_init(&mq->lock);
 
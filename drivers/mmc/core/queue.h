@@ -37,6 +37,26 @@ static inline struct request *mmc_queue_req_to_req(struct mmc_queue_req *mqr)
 struct mmc_blk_data;
 struct mmc_blk_ioc_data;
 
+/* A 512 byte packed command header has room for 63 entries */
+#define MMC_PACKED_MAX_ENTRIES	63
+#define MMC_PACKED_MAX_SECTORS	64
+
+/**
+ * struct mmc_packed - eMMC packed write command
+ * @reqs: Requests sent with the packed command, the first one carries it.
+ * @nr_reqs: Number of entries in @reqs, zero when not packed.
+ * @blocks: Data blocks of all requests, without the header.
+ * @segs: Segments needed for the header and the data of all requests.
+ * @cmd_hdr: Packed command header sent ahead of the data.
+ */
+struct mmc_packed {
+	struct request		*reqs[MMC_PACKED_MAX_ENTRIES];
+	unsigned int		nr_reqs;
+	unsigned int		blocks;
+	unsigned int		segs;
+	__le32			cmd_hdr[];
+};
+
 struct mmc_blk_request {
 	struct mmc_request	mrq;
 	struct mmc_command	sbc;
@@ -69,6 +89,10 @@ struct mmc_queue_req {
 	void			*drv_op_data;
 	unsigned int		ioc_count;
 	int			retries;
+	struct mmc_packed	*packed;
+	ktime_t			lat_issue;
+	ktime_t			lat_start;
+	ktime_t			lat_done;
 };
 
 struct mmc_queue {
@@ -84,6 +108,7 @@ struct mmc_queue {
 #define MMC_CQE_QUEUE_FULL	BIT(1)
 	bool			busy;
 	bool			use_cqe;
+	bool			use_packed;
 	bool			recovery_needed;
 	bool			in_recovery;
 	bool			rw_wait;
@@ -92,6 +117,7 @@ struct mmc_queue {
 	wait_queue_head_t	wait;
 	struct request		*recovery_req;
 	struct request		*complete_req;
+	struct request		*packed_req;	/* Pack being gathered */
 	struct mutex		complete_lock;
 	struct work_struct	complete_work;
 };
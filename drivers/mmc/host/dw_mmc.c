@@ -493,24 +493,22 @@ static void dw_mci_dmac_complete_dma(void *arg)
 	}
 }
 
-static int dw_mci_idmac_init(struct dw_mci *host)
+static void dw_mci_idmac_init_ring(struct dw_mci *host,
+				   struct dw_mci_desc_ring *ring)
 {
 	int i;
 
 	if (host->dma_64bit_address == 1) {
 		struct idmac_desc_64addr *p;
-		/* Number of descriptors in the ring buffer */
-		host->ring_size =
-			DESC_RING_BUF_SZ / sizeof(struct idmac_desc_64addr);
 
 		/* Forward link the descriptor list */
-		for (i = 0, p = host->sg_cpu; i < host->ring_size - 1;
+		for (i = 0, p = ring->cpu; i < host->ring_size - 1;
 								i++, p++) {
-			p->des6 = (host->sg_dma +
+			p->des6 = (ring->dma +
 					(sizeof(struct idmac_desc_64addr) *
 							(i + 1))) & 0xffffffff;
 
-			p->des7 = (u64)(host->sg_dma +
+			p->des7 = (u64)(ring->dma +
 					(sizeof(struct idmac_desc_64addr) *
 							(i + 1))) >> 32;
 			/* Initialize reserved and buffer size fields to "0" */
@@ -521,31 +519,55 @@ static int dw_mci_idmac_init(struct dw_mci *host)
 		}
 
 		/* Set the last descriptor as the end-of-ring descriptor */
-		p->des6 = host->sg_dma & 0xffffffff;
-		p->des7 = (u64)host->sg_dma >> 32;
+		p->des6 = ring->dma & 0xffffffff;
+		p->des7 = (u64)ring->dma >> 32;
 		p->des0 = IDMAC_DES0_ER;
 
 	} else {
 		struct idmac_desc *p;
-		/* Number of descriptors in the ring buffer */
-		host->ring_size =
-			DESC_RING_BUF_SZ / sizeof(struct idmac_desc);
 
 		/* Forward link the descriptor list */
-		for (i = 0, p = host->sg_cpu;
+		for (i = 0, p = ring->cpu;
 		     i < host->ring_size - 1;
 		     i++, p++) {
-			p->des3 = cpu_to_le32(host->sg_dma +
+			p->des3 = cpu_to_le32(ring->dma +
 					(sizeof(struct idmac_desc) * (i + 1)));
 			p->des0 = 0;
 			p->des1 = 0;
 		}
 
 		/* Set the last descriptor as the end-of-ring descriptor */
-		p->des3 = cpu_to_le32(host->sg_dma);
+		p->des3 = cpu_to_le32(ring->dma);
 		p->des0 = cpu_to_le32(IDMAC_DES0_ER);
 	}
 
+	ring->data = NULL;
+}
+
+static int dw_mci_idmac_init(struct dw_mci *host)
+{
+	struct dw_mci_desc_ring *ring;
+	unsigned long flags;
+	int i;
+
+	/* Number of descriptors in each ring buffer */
+	if (host->dma_64bit_address == 1)
+		host->ring_size =
+			DESC_RING_BUF_SZ / sizeof(struct idmac_desc_64addr);
+	else
+		host->ring_size =
+			DESC_RING_BUF_SZ / sizeof(struct idmac_desc);
+
+	spin_lock_irqsave(&host->desc_lock, flags);
+	for (i = 0; i < DW_MCI_DESC_RINGS; i++) {
+		ring = &host->desc_ring[i];
+		ring->cpu = host->sg_cpu + i * DESC_RING_BUF_SZ;
+		ring->dma = host->sg_dma + i * DESC_RING_BUF_SZ;
+		dw_mci_idmac_init_ring(host, ring);
+	}
+	host->desc_active = -1;
+	spin_unlock_irqrestore(&host->desc_lock, flags);
+
 	dw_mci_idmac_reset(host);
 
 	if (host->dma_64bit_address == 1) {
@@ -572,6 +594,7 @@ static int dw_mci_idmac_init(struct dw_mci *host)
 }
 
 static inline int dw_mci_prepare_desc64(struct dw_mci *host,
+					 struct dw_mci_desc_ring *ring,
 					 struct mmc_data *data,
 					 unsigned int sg_len)
 {
@@ -580,7 +603,7 @@ static inline int dw_mci_prepare_desc64(struct dw_mci *host,
 	u32 val;
 	int i;
 
-	desc_first = desc_last = desc = host->sg_cpu;
+	desc_first = desc_last = desc = ring->cpu;
 
 	for (i = 0; i < sg_len; i++) {
 		unsigned int length = sg_dma_len(&data->sg[i]);
@@ -637,13 +660,14 @@ static inline int dw_mci_prepare_desc64(struct dw_mci *host,
 err_own_bit:
 	/* restore the descriptor chain as it's polluted */
 	dev_dbg(host->dev, "descriptor is still owned by IDMAC.\n");
-	memset(host->sg_cpu, 0, DESC_RING_BUF_SZ);
-	dw_mci_idmac_init(host);
+	memset(ring->cpu, 0, DESC_RING_BUF_SZ);
+	dw_mci_idmac_init_ring(host, ring);
 	return -EINVAL;
 }
 
 
 static inline int dw_mci_prepare_desc32(struct dw_mci *host,
+					 struct dw_mci_desc_ring *ring,
 					 struct mmc_data *data,
 					 unsigned int sg_len)
 {
@@ -652,7 +676,7 @@ static inline int dw_mci_prepare_desc32(struct dw_mci *host,
 	u32 val;
 	int i;
 
-	desc_first = desc_last = desc = host->sg_cpu;
+	desc_first = desc_last = desc = ring->cpu;
 
 	for (i = 0; i < sg_len; i++) {
 		unsigned int length = sg_dma_len(&data->sg[i]);
@@ -711,20 +735,109 @@ static inline int dw_mci_prepare_desc32(struct dw_mci *host,
 err_own_bit:
 	/* restore the descriptor chain as it's polluted */
 	dev_dbg(host->dev, "descriptor is still owned by IDMAC.\n");
-	memset(host->sg_cpu, 0, DESC_RING_BUF_SZ);
-	dw_mci_idmac_init(host);
+	memset(ring->cpu, 0, DESC_RING_BUF_SZ);
+	dw_mci_idmac_init_ring(host, ring);
 	return -EINVAL;
 }
 
-static int dw_mci_idmac_start_dma(struct dw_mci *host, unsigned int sg_len)
+static int dw_mci_idmac_prepare_ring(struct dw_mci *host,
+				     struct dw_mci_desc_ring *ring,
+				     struct mmc_data *data,
+				     unsigned int sg_len)
 {
-	u32 temp;
 	int ret;
 
 	if (host->dma_64bit_address == 1)
-		ret = dw_mci_prepare_desc64(host, host->data, sg_len);
+		ret = dw_mci_prepare_desc64(host, ring, data, sg_len);
 	else
-		ret = dw_mci_prepare_desc32(host, host->data, sg_len);
+		ret = dw_mci_prepare_desc32(host, ring, data, sg_len);
+
+	if (!ret)
+		ring->data = data;
+
+	return ret;
+}
+
+/* Find the ring holding the chain of @data, or a free one if @data is NULL */
+static struct dw_mci_desc_ring *dw_mci_idmac_find_ring(struct dw_mci *host,
+						       struct mmc_data *data)
+{
+	int i;
+
+	for (i = 0; i < DW_MCI_DESC_RINGS; i++) {
+		if (i != host->desc_active && host->desc_ring[i].data == data)
+			return &host->desc_ring[i];
+	}
+
+	return NULL;
+}
+
+/*
+ * Build the descriptor chain of a mapped request ahead of time, while the
+ * IDMAC may still be running the previous one from the other ring.
+ */
+static void dw_mci_idmac_pre_req(struct dw_mci *host, struct mmc_data *data,
+				 unsigned int sg_len)
+{
+	struct dw_mci_desc_ring *ring;
+	unsigned long flags;
+
+	spin_lock_irqsave(&host->desc_lock, flags);
+	if (!dw_mci_idmac_find_ring(host, data)) {
+		ring = dw_mci_idmac_find_ring(host, NULL);
+		if (ring)
+			dw_mci_idmac_prepare_ring(host, ring, data, sg_len);
+	}
+	spin_unlock_irqrestore(&host->desc_lock, flags);
+}
+
+static void dw_mci_idmac_post_req(struct dw_mci *host, struct mmc_data *data)
+{
+	struct dw_mci_desc_ring *ring;
+	unsigned long flags;
+
+	spin_lock_irqsave(&host->desc_lock, flags);
+	ring = dw_mci_idmac_find_ring(host, data);
+	if (ring)
+		ring->data = NULL;
+	spin_unlock_irqrestore(&host->desc_lock, flags);
+}
+
+static void dw_mci_idmac_cleanup(struct dw_mci *host)
+{
+	unsigned long flags;
+
+	/* The chain has been consumed, the ring can be built again */
+	spin_lock_irqsave(&host->desc_lock, flags);
+	if (host->desc_active >= 0) {
+		host->desc_ring[host->desc_active].data = NULL;
+		host->desc_active = -1;
+	}
+	spin_unlock_irqrestore(&host->desc_lock, flags);
+
+	dw_mci_dma_cleanup(host);
+}
+
+static int dw_mci_idmac_start_dma(struct dw_mci *host, unsigned int sg_len)
+{
+	struct dw_mci_desc_ring *ring;
+	unsigned long flags;
+	u32 temp;
+	int ret = 0;
+
+	spin_lock_irqsave(&host->desc_lock, flags);
+	ring = dw_mci_idmac_find_ring(host, host->data);
+	if (!ring) {
+		/* Not built ahead of time, take over any idle ring */
+		ring = dw_mci_idmac_find_ring(host, NULL);
+		if (!ring)
+			ring = &host->desc_ring[0];
+		ret = dw_mci_idmac_prepare_ring(host, ring, host->data,
+						sg_len);
+	}
+	if (!ret)
+		host->desc_active = ring - host->desc_ring;
+	spin_unlock_irqrestore(&host->desc_lock, flags);
 
 	if (ret)
 		goto out;
@@ -736,6 +849,14 @@ static int dw_mci_idmac_start_dma(struct dw_mci *host, unsigned int sg_len)
 	dw_mci_ctrl_reset(host, SDMMC_CTRL_DMA_RESET);
 	dw_mci_idmac_reset(host);
 
+	/* Point the IDMAC at the ring holding this chain */
+	if (host->dma_64bit_address == 1) {
+		mci_writel(host, DBADDRL, ring->dma & 0xffffffff);
+		mci_writel(host, DBADDRU, (u64)ring->dma >> 32);
+	} else {
+		mci_writel(host, DBADDR, ring->dma);
+	}
+
 	/* Select IDMAC interface */
 	temp = mci_readl(host, CTRL);
 	temp |= SDMMC_CTRL_USE_IDMAC;
@@ -761,7 +882,7 @@ static const struct dw_mci_dma_ops dw_mci_idmac_ops = {
 	.start = dw_mci_idmac_start_dma,
 	.stop = dw_mci_idmac_stop_dma,
 	.complete = dw_mci_dmac_complete_dma,
-	.cleanup = dw_mci_dma_cleanup,
+	.cleanup = dw_mci_idmac_cleanup,
 };
 
 static void dw_mci_edmac_stop_dma(struct dw_mci *host)
@@ -908,6 +1029,7 @@ static void dw_mci_pre_req(struct mmc_host *mmc,
 {
 	struct dw_mci_slot *slot = mmc_priv(mmc);
 	struct mmc_data *data = mrq->data;
+	int sg_len;
 
 	if (!slot->host->use_dma || !data)
 		return;
@@ -915,9 +1037,15 @@ static void dw_mci_pre_req(struct mmc_host *mmc,
 	/* This data might be unmapped at this time */
 	data->host_cookie = COOKIE_UNMAPPED;
 
-	if (dw_mci_pre_dma_transfer(slot->host, mrq->data,
-				COOKIE_PRE_MAPPED) < 0)
+	sg_len = dw_mci_pre_dma_transfer(slot->host, mrq->data,
+					 COOKIE_PRE_MAPPED);
+	if (sg_len < 0) {
 		data->host_cookie = COOKIE_UNMAPPED;
+		return;
+	}
+
+	if (slot->host->use_dma == TRANS_MODE_IDMAC)
+		dw_mci_idmac_pre_req(slot->host, data, sg_len);
 }
 
 static void dw_mci_post_req(struct mmc_host *mmc,
@@ -930,6 +1058,9 @@ static void dw_mci_post_req(struct mmc_host *mmc,
 	if (!slot->host->use_dma || !data)
 		return;
 
+	if (slot->host->use_dma == TRANS_MODE_IDMAC)
+		dw_mci_idmac_post_req(slot->host, data);
+
 	if (data->host_cookie != COOKIE_UNMAPPED)
 		dma_unmap_sg(slot->host->dev,
 			     data->sg,
@@ -2740,6 +2871,433 @@ static irqreturn_t dw_mci_interrupt(int irq, void *dev_id)
 	return IRQ_HANDLED;
 }
 
+/*
+ * Software command queue engine
+ *
+ * The controller has no command queue engine, but eMMC 5.1 devices can
+ * hold up to 32 queued tasks on their own. Tasks are queued in the device
+ * with CMD44/CMD45 as soon as they are issued, the device queue status
+ * register is then polled with CMD13 and whichever task the device reports
+ * ready is executed with CMD46/CMD47. The device can prepare the next tasks
+ * while the current one is transferring data, instead of seeing a single
+ * request at a time.
+ */
+#define DW_MCI_CQE_DEPTH	32
+#define DW_MCI_CQE_POLL_MIN_US	16	/* first QSR poll backoff */
+#define DW_MCI_CQE_POLL_MAX_US	512	/* QSR poll backoff cap */
+#define DW_MCI_CQE_R1_ERRORS	(R1_OUT_OF_RANGE | R1_ADDRESS_ERROR | \
+				 R1_BLOCK_LEN_ERROR | R1_WP_VIOLATION | \
+				 R1_CC_ERROR | R1_ERROR | R1_ILLEGAL_COMMAND | \
+				 R1_COM_CRC_ERROR)
+
+struct dw_mci_cqe {
+	struct dw_mci_slot	*slot;
+	struct mmc_card		*card;
+	struct workqueue_struct	*wq;
+	struct work_struct	work;
+	wait_queue_head_t	wait;
+
+	spinlock_t		lock;
+	struct mmc_request	*mrq[DW_MCI_CQE_DEPTH];
+	unsigned long		issued;	/* tags not queued in the device yet */
+	unsigned long		queued;	/* tags queued in the device */
+	bool			running;
+	bool			halted;
+	bool			recovery_needed;
+};
+
+static void dw_mci_cqe_req_done(struct mmc_request *mrq)
+{
+	complete(&mrq->completion);
+}
+
+static int dw_mci_cqe_wait_cmd(struct dw_mci_cqe *cqe,
+			       struct mmc_command *cmd, struct mmc_data *data)
+{
+	struct mmc_host *mmc = cqe->slot->mmc;
+	struct mmc_request mrq = {};
+	struct mmc_request *data_mrq = NULL;
+
+	init_completion(&mrq.completion);
+	mrq.cmd = cmd;
+	mrq.data = data;
+	mrq.done = dw_mci_cqe_req_done;
+	mrq.host = mmc;
+
+	cmd->error = 0;
+	cmd->retries = 0;
+	cmd->mrq = &mrq;
+	cmd->data = data;
+	if (data) {
+		data_mrq = data->mrq;
+		data->error = 0;
+		data->bytes_xfered = 0;
+		data->stop = NULL;
+		data->mrq = &mrq;
+	}
+
+	dw_mci_request(mmc, &mrq);
+	wait_for_completion(&mrq.completion);
+
+	if (data)
+		data->mrq = data_mrq;
+
+	if (cmd->error)
+		return cmd->error;
+	if (data && data->error)
+		return data->error;
+	return 0;
+}
+
+static int dw_mci_cqe_queue_task(struct dw_mci_cqe *cqe,
+				 struct mmc_request *mrq)
+{
+	struct mmc_data *data = mrq->data;
+	struct mmc_command cmd = {};
+	int err;
+
+	cmd.opcode = MMC_QUE_TASK_PARAMS;
+	cmd.arg = (mrq->tag << 16) | data->blocks;
+	if (data->flags & MMC_DATA_REL_WR)
+		cmd.arg |= BIT(31);
+	if (data->flags & MMC_DATA_READ)
+		cmd.arg |= BIT(30);
+	if (data->flags & MMC_DATA_DAT_TAG)
+		cmd.arg |= BIT(29);
+	if (data->flags & MMC_DATA_FORCED_PRG)
+		cmd.arg |= BIT(24);
+	if (data->flags & MMC_DATA_PRIO)
+		cmd.arg |= BIT(23);
+	cmd.flags = MMC_RSP_R1 | MMC_CMD_AC;
+
+	err = dw_mci_cqe_wait_cmd(cqe, &cmd, NULL);
+	if (!err && (cmd.resp[0] & DW_MCI_CQE_R1_ERRORS))
+		err = -EIO;
+	if (err)
+		return err;
+
+	memset(&cmd, 0, sizeof(cmd));
+	cmd.opcode = MMC_QUE_TASK_ADDR;
+	cmd.arg = data->blk_addr;
+	cmd.flags = MMC_RSP_R1 | MMC_CMD_AC;
+
+	err = dw_mci_cqe_wait_cmd(cqe, &cmd, NULL);
+	if (!err && (cmd.resp[0] & DW_MCI_CQE_R1_ERRORS))
+		err = -EIO;
+	return err;
+}
+
+static int dw_mci_cqe_read_qsr(struct dw_mci_cqe *cqe, u32 *qsr)
+{
+	struct mmc_command cmd = {};
+	int err;
+
+	/* CMD13 with bit 15 set returns the queue status register */
+	cmd.opcode = MMC_SEND_STATUS;
+	cmd.arg = (cqe->card->rca << 16) | BIT(15);
+	cmd.flags = MMC_RSP_R1 | MMC_CMD_AC;
+
+	err = dw_mci_cqe_wait_cmd(cqe, &cmd, NULL);
+	if (!err)
+		*qsr = cmd.resp[0];
+	return err;
+}
+
+static int dw_mci_cqe_execute_task(struct dw_mci_cqe *cqe,
+				   struct mmc_request *mrq)
+{
+	struct mmc_data *data = mrq->data;
+	struct mmc_command cmd = {};
+
+	cmd.opcode = (data->flags & MMC_DATA_READ) ?
+		     MMC_EXECUTE_READ_TASK : MMC_EXECUTE_WRITE_TASK;
+	cmd.arg = mrq->tag << 16;
+	cmd.flags = MMC_RSP_R1 | MMC_CMD_ADTC;
+
+	return dw_mci_cqe_wait_cmd(cqe, &cmd, data);
+}
+
+static bool dw_mci_cqe_idle(struct dw_mci_cqe *cqe)
+{
+	unsigned long flags;
+	bool idle;
+
+	spin_lock_irqsave(&cqe->lock, flags);
+	idle = !cqe->running &&
+	       (cqe->halted || !(cqe->issued | cqe->queued));
+	spin_unlock_irqrestore(&cqe->lock, flags);
+
+	return idle;
+}
+
+static void dw_mci_cqe_work(struct work_struct *work)
+{
+	struct dw_mci_cqe *cqe = container_of(work, struct dw_mci_cqe, work);
+	struct mmc_host *mmc = cqe->slot->mmc;
+	struct mmc_request *mrq = NULL;
+	unsigned int poll_us = 0;
+	unsigned long flags;
+	u32 qsr;
+	int tag, err;
+
+	spin_lock_irqsave(&cqe->lock, flags);
+	while (!cqe->halted && (cqe->issued | cqe->queued)) {
+		cqe->running = true;
+
+		/* hand everything over to the device first */
+		if (cqe->issued) {
+			tag = __ffs(cqe->issued);
+			mrq = cqe->mrq[tag];
+			spin_unlock_irqrestore(&cqe->lock, flags);
+
+			err = dw_mci_cqe_queue_task(cqe, mrq);
+
+			spin_lock_irqsave(&cqe->lock, flags);
+			if (err) {
+				mrq->data->error = err;
+				goto error;
+			}
+			cqe->issued &= ~BIT(tag);
+			cqe->queued |= BIT(tag);
+			poll_us = 0;
+			continue;
+		}
+		mrq = cqe->mrq[__ffs(cqe->queued)];
+		spin_unlock_irqrestore(&cqe->lock, flags);
+
+		err = dw_mci_cqe_read_qsr(cqe, &qsr);
+
+		spin_lock_irqsave(&cqe->lock, flags);
+		if (err) {
+			mrq->data->error = err;
+			goto error;
+		}
+
+		/*
+		 * Back off exponentially while the device prepares its tasks.
+		 * A task that never gets ready is caught by the request
+		 * timeout, which halts the queue and ends this loop.
+		 */
+		qsr &= cqe->queued;
+		if (!qsr) {
+			spin_unlock_irqrestore(&cqe->lock, flags);
+			poll_us = clamp_t(unsigned int, poll_us * 2,
+					  DW_MCI_CQE_POLL_MIN_US,
+					  DW_MCI_CQE_POLL_MAX_US);
+			usleep_range(poll_us, poll_us * 2);
+			spin_lock_irqsave(&cqe->lock, flags);
+			continue;
+		}
+		poll_us = 0;
+
+		tag = __ffs(qsr);
+		mrq = cqe->mrq[tag];
+		spin_unlock_irqrestore(&cqe->lock, flags);
+
+		err = dw_mci_cqe_execute_task(cqe, mrq);
+
+		spin_lock_irqsave(&cqe->lock, flags);
+		if (err)
+			goto error;
+		cqe->queued &= ~BIT(tag);
+		cqe->mrq[tag] = NULL;
+		spin_unlock_irqrestore(&cqe->lock, flags);
+
+		mmc_cqe_request_done(mmc, mrq);
+
+		spin_lock_irqsave(&cqe->lock, flags);
+	}
+	cqe->running = false;
+	spin_unlock_irqrestore(&cqe->lock, flags);
+
+	wake_up(&cqe->wait);
+	return;
+
+error:
+	/* stop here, mmc_cqe_recovery() will clean up the queue */
+	dev_dbg(&mmc->class_dev, "CQE task %d failed: %d\n", mrq->tag, err);
+	cqe->halted = true;
+	cqe->recovery_needed = true;
+	cqe->running = false;
+	spin_unlock_irqrestore(&cqe->lock, flags);
+
+	wake_up(&cqe->wait);
+	if (mrq->recovery_notifier)
+		mrq->recovery_notifier(mrq);
+}
+
+static int dw_mci_cqe_enable(struct mmc_host *mmc, struct mmc_card *card)
+{
+	struct dw_mci_cqe *cqe = mmc->cqe_private;
+
+	cqe->card = card;
+	return 0;
+}
+
+static void dw_mci_cqe_disable(struct mmc_host *mmc)
+{
+	struct dw_mci_cqe *cqe = mmc->cqe_private;
+
+	wait_event(cqe->wait, dw_mci_cqe_idle(cqe));
+	cqe->card = NULL;
+}
+
+static int dw_mci_cqe_request(struct mmc_host *mmc, struct mmc_request *mrq)
+{
+	struct dw_mci_cqe *cqe = mmc->cqe_private;
+	unsigned long flags;
+
+	/* direct commands are not advertised */
+	if (!mrq->data || mrq->tag >= DW_MCI_CQE_DEPTH)
+		return -EINVAL;
+
+	spin_lock_irqsave(&cqe->lock, flags);
+	if (cqe->halted) {
+		spin_unlock_irqrestore(&cqe->lock, flags);
+		return -EBUSY;
+	}
+	cqe->mrq[mrq->tag] = mrq;
+	cqe->issued |= BIT(mrq->tag);
+	mmc->cqe_on = true;
+	spin_unlock_irqrestore(&cqe->lock, flags);
+
+	/* the transfer may start much later, map the buffers right away */
+	dw_mci_pre_req(mmc, mrq);
+
+	queue_work(cqe->wq, &cqe->work);
+	return 0;
+}
+
+static void dw_mci_cqe_post_req(struct mmc_host *mmc,
+				struct mmc_request *mrq)
+{
+	dw_mci_post_req(mmc, mrq, 0);
+}
+
+static void dw_mci_cqe_off(struct mmc_host *mmc)
+{
+	struct dw_mci_cqe *cqe = mmc->cqe_private;
+
+	/* the bus is free for other commands once the engine has stopped */
+	wait_event(cqe->wait, dw_mci_cqe_idle(cqe));
+	mmc->cqe_on = false;
+}
+
+static int dw_mci_cqe_wait_for_idle(struct mmc_host *mmc)
+{
+	struct dw_mci_cqe *cqe = mmc->cqe_private;
+
+	wait_event(cqe->wait, dw_mci_cqe_idle(cqe));
+	return cqe->recovery_needed ? -EBUSY : 0;
+}
+
+static bool dw_mci_cqe_timeout(struct mmc_host *mmc, struct mmc_request *mrq,
+			       bool *recovery_needed)
+{
+	struct dw_mci_cqe *cqe = mmc->cqe_private;
+	unsigned long flags;
+	bool timed_out;
+
+	spin_lock_irqsave(&cqe->lock, flags);
+	timed_out = cqe->mrq[mrq->tag] == mrq;
+	if (timed_out) {
+		cqe->halted = true;
+		cqe->recovery_needed = true;
+	}
+	spin_unlock_irqrestore(&cqe->lock, flags);
+
+	*recovery_needed = timed_out;
+	return timed_out;
+}
+
+static void dw_mci_cqe_recovery_start(struct mmc_host *mmc)
+{
+	struct dw_mci_cqe *cqe = mmc->cqe_private;
+	unsigned long flags;
+
+	spin_lock_irqsave(&cqe->lock, flags);
+	cqe->halted = true;
+	spin_unlock_irqrestore(&cqe->lock, flags);
+
+	wait_event(cqe->wait, dw_mci_cqe_idle(cqe));
+}
+
+static void dw_mci_cqe_recovery_finish(struct mmc_host *mmc)
+{
+	struct dw_mci_cqe *cqe = mmc->cqe_private;
+	struct mmc_request *mrq[DW_MCI_CQE_DEPTH];
+	unsigned long flags, pending;
+	int tag;
+
+	spin_lock_irqsave(&cqe->lock, flags);
+	pending = cqe->issued | cqe->queued;
+	for_each_set_bit(tag, &pending, DW_MCI_CQE_DEPTH) {
+		mrq[tag] = cqe->mrq[tag];
+		cqe->mrq[tag] = NULL;
+	}
+	cqe->issued = 0;
+	cqe->queued = 0;
+	cqe->halted = false;
+	cqe->recovery_needed = false;
+	spin_unlock_irqrestore(&cqe->lock, flags);
+
+	/* the device queue has been discarded, nothing was transferred */
+	for_each_set_bit(tag, &pending, DW_MCI_CQE_DEPTH) {
+		mrq[tag]->data->bytes_xfered = 0;
+		mmc_cqe_request_done(mmc, mrq[tag]);
+	}
+
+	mmc->cqe_on = false;
+	wake_up(&cqe->wait);
+}
+
+static const struct mmc_cqe_ops dw_mci_cqe_ops = {
+	.cqe_enable		= dw_mci_cqe_enable,
+	.cqe_disable		= dw_mci_cqe_disable,
+	.cqe_request		= dw_mci_cqe_request,
+	.cqe_post_req		= dw_mci_cqe_post_req,
+	.cqe_off		= dw_mci_cqe_off,
+	.cqe_wait_for_idle	= dw_mci_cqe_wait_for_idle,
+	.cqe_timeout		= dw_mci_cqe_timeout,
+	.cqe_recovery_start	= dw_mci_cqe_recovery_start,
+	.cqe_recovery_finish	= dw_mci_cqe_recovery_finish,
+};
+
+static int dw_mci_cqe_init(struct dw_mci_slot *slot)
+{
+	struct mmc_host *mmc = slot->mmc;
+	struct dw_mci_cqe *cqe;
+
+	cqe = devm_kzalloc(slot->host->dev, sizeof(*cqe), GFP_KERNEL);
+	if (!cqe)
+		return -ENOMEM;
+
+	cqe->wq = alloc_workqueue("%s-cqe", WQ_HIGHPRI | WQ_MEM_RECLAIM, 1,
+				  mmc_hostname(mmc));
+	if (!cqe->wq)
+		return -ENOMEM;
+
+	cqe->slot = slot;
+	spin_lock_init(&cqe->lock);
+	init_waitqueue_head(&cqe->wait);
+	INIT_WORK(&cqe->work, dw_mci_cqe_work);
+
+	mmc->cqe_private = cqe;
+	mmc->cqe_ops = &dw_mci_cqe_ops;
+	mmc->cqe_qdepth = DW_MCI_CQE_DEPTH;
+	mmc->caps2 |= MMC_CAP2_CQE;
+
+	return 0;
+}
+
+static void dw_mci_cqe_exit(struct dw_mci_slot *slot)
+{
+	struct dw_mci_cqe *cqe = slot->mmc->cqe_private;
+
+	if (cqe)
+		destroy_workqueue(cqe->wq);
+}
+
 static int dw_mci_init_slot_caps(struct dw_mci_slot *slot)
 {
 	struct dw_mci *host = slot->host;
@@ -2825,6 +3383,12 @@ static int dw_mci_init_slot(struct dw_mci *host)
 	if (ret)
 		goto err_host_allocated;
 
+	if (device_property_read_bool(host->dev, "supports-cqe")) {
+		ret = dw_mci_cqe_init(slot);
+		if (ret)
+			goto err_host_allocated;
+	}
+
 	/* Useful defaults if platform data is unset. */
 	if (host->use_dma == TRANS_MODE_IDMAC) {
 		mmc->max_segs = host->ring_size;
@@ -2853,7 +3417,7 @@ static int dw_mci_init_slot(struct dw_mci *host)
 
 	ret = mmc_add_host(mmc);
 	if (ret)
-		goto err_host_allocated;
+		goto err_cqe;
 
 #if defined(CONFIG_DEBUG_FS)
 	dw_mci_init_debugfs(slot);
@@ -2861,6 +3425,8 @@ static int dw_mci_init_slot(struct dw_mci *host)
 
 	return 0;
 
+err_cqe:
+	dw_mci_cqe_exit(slot);
 err_host_allocated:
 	mmc_free_host(mmc);
 	return ret;
@@ -2870,6 +3436,7 @@ static void dw_mci_cleanup_slot(struct dw_mci_slot *slot)
 {
 	/* Debugfs stuff is cleaned up by mmc core */
 	mmc_remove_host(slot->mmc);
+	dw_mci_cqe_exit(slot);
 	slot->host->slot = NULL;
 	mmc_free_host(slot->mmc);
 }
@@ -2923,9 +3490,10 @@ static void dw_mci_init_dma(struct dw_mci *host)
 				 "IDMAC supports 32-bit address mode.\n");
 		}
 
-		/* Alloc memory for sg translation */
+		/* Alloc memory for sg translation, one buffer per ring */
 		host->sg_cpu = dmam_alloc_coherent(host->dev,
-						   DESC_RING_BUF_SZ,
+						   DESC_RING_BUF_SZ *
+						   DW_MCI_DESC_RINGS,
 						   &host->sg_dma, GFP_KERNEL);
 		if (!host->sg_cpu) {
 			dev_err(host->dev,
@@ -3234,6 +3802,7 @@ int dw_mci_probe(struct dw_mci *host)
 
 	spin_lock_init(&host->lock);
 	spin_lock_init(&host->irq_lock);
+	spin_lock_init(&host->desc_lock);
 	INIT_LIST_HEAD(&host->queue);
 
 	/*
@@ -53,6 +53,21 @@ struct dw_mci_dma_slave {
 	enum dma_transfer_direction direction;
 };
 
+#define DW_MCI_DESC_RINGS	2
+
+/**
+ * struct dw_mci_desc_ring - IDMAC descriptor ring
+ * @cpu: Virtual address of the descriptors.
+ * @dma: Bus address of the descriptors.
+ * @data: The transfer whose descriptor chain is built in this ring,
+ *	or NULL if the ring is free.
+ */
+struct dw_mci_desc_ring {
+	void			*cpu;
+	dma_addr_t		dma;
+	struct mmc_data		*data;
+};
+
 /**
  * struct dw_mci - MMC controller state shared between all slots
  * @lock: Spinlock protecting the queue and associated data.
@@ -79,6 +94,10 @@ struct dw_mci_dma_slave {
  * @cmd_status: Snapshot of SR taken upon completion of the current
  * @ring_size: Buffer size for idma descriptors.
  *	command. Only valid when EVENT_CMD_COMPLETE is pending.
+ * @desc_ring: IDMAC descriptor rings, chains are built ahead of time in
+ *	whichever ring the hardware is not using.
+ * @desc_active: Index of the ring the IDMAC is running, or -1.
+ * @desc_lock: Spinlock protecting @desc_ring and @desc_active.
  * @dms: structure of slave-dma private data.
  * @phy_regs: physical address of controller's register map
  * @data_status: Snapshot of SR taken upon completion of the current
@@ -180,6 +199,9 @@ struct dw_mci {
 	const struct dw_mci_dma_ops	*dma_ops;
 	/* For idmac */
 	unsigned int		ring_size;
+	struct dw_mci_desc_ring	desc_ring[DW_MCI_DESC_RINGS];
+	int			desc_active;
+	spinlock_t		desc_lock;
 
 	/* For edmac */
 	struct dw_mci_dma_slave *dms;
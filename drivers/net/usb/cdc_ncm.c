@@ -1491,6 +1491,36 @@ int cdc_ncm_rx_verify_ndp16(struct sk_buff *skb_in, int ndpoffset)
 }
 EXPORT_SYMBOL_GPL(cdc_ncm_rx_verify_ndp16);
 
+/*
+ * Small datagrams get a fresh copy, so that e.g. a stream of TCP ACKs does
+ * not keep whole NTBs allocated.  Larger ones share the NTB buffer, and each
+ * clone is charged the part of the NTB truesize that its datagram takes up,
+ * so the socket accounting still sees the memory the NTB pins.
+ */
+static struct sk_buff *cdc_ncm_rx_datagram(struct usbnet *dev,
+					   struct sk_buff *skb_in,
+					   int offset, int len)
+{
+	struct sk_buff *skb;
+
+	if (len < CDC_NCM_RX_COPYBREAK) {
+		skb = netdev_alloc_skb_ip_align(dev->net, len);
+		if (skb)
+			skb_put_data(skb, skb_in->data + offset, len);
+		return skb;
+	}
+
+	skb = skb_clone(skb_in, GFP_ATOMIC);
+	if (skb) {
+		skb->data = skb_in->data + offset;
+		skb->len = len;
+		skb_set_tail_pointer(skb, len);
+		skb->truesize = sizeof(struct sk_buff) +
+				mult_frac(skb_in->truesize, len, skb_in->len);
+	}
+	return skb;
+}
+
 int cdc_ncm_rx_fixup(struct usbnet *dev, struct sk_buff *skb_in)
 {
 	struct sk_buff *skb;
@@ -1549,11 +1579,9 @@ int cdc_ncm_rx_fixup(struct usbnet *dev, struct sk_buff *skb_in)
 			break;
 
 		} else {
-			/* create a fresh copy to reduce truesize */
-			skb = netdev_alloc_skb_ip_align(dev->net,  len);
+			skb = cdc_ncm_rx_datagram(dev, skb_in, offset, len);
 			if (!skb)
 				goto error;
-			skb_put_data(skb, skb_in->data + offset, len);
 			usbnet_skb_return(dev, skb);
 			payload += len;	/* count payload bytes in this NTB */
 		}
@@ -281,6 +281,7 @@ brcmf_proto_bcdc_hdrpull(struct brcmf_pub *drvr, bool do_fws,
 {
 	struct brcmf_proto_bcdc_header *h;
 	struct brcmf_if *tmp_if;
+	uint hdrlen;
 
 	brcmf_dbg(BCDC, "Enter\n");
 
@@ -291,6 +292,17 @@ brcmf_proto_bcdc_hdrpull(struct brcmf_pub *drvr, bool do_fws,
 		return -EBADE;
 	}
 
+	/* headers of page fragment backed packets must be made linear,
+	 * the BCDC header first as it tells how much follows
+	 */
+	if (!pskb_may_pull(pktbuf, BCDC_HEADER_LEN))
+		return -ENOMEM;
+
+	h = (struct brcmf_proto_bcdc_header *)(pktbuf->data);
+	hdrlen = BCDC_HEADER_LEN + (h->data_offset << 2) + ETH_HLEN;
+	if (!pskb_may_pull(pktbuf, min_t(uint, hdrlen, pktbuf->len)))
+		return -ENOMEM;
+
 	trace_brcmf_bcdchdr(pktbuf->data);
 	h = (struct brcmf_proto_bcdc_header *)(pktbuf->data);
 
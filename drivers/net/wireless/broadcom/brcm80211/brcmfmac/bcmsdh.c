@@ -46,7 +46,7 @@
 /* Maximum milliseconds to wait for F2 to come up */
 #define SDIO_WAIT_F2RDY	3000
 
-#define BRCMF_DEFAULT_RXGLOM_SIZE	32  /* max rx frames in glom chain */
+#define BRCMF_DEFAULT_RXGLOM_SIZE	64  /* max rx frames in glom chain */
 
 struct brcmf_sdiod_freezer {
 	atomic_t freezing;
@@ -380,8 +380,8 @@ static int brcmf_sdiod_sglist_rw(struct brcmf_sdio_dev *sdiodev,
 				 struct sk_buff_head *pktlist)
 {
 	unsigned int req_sz, func_blk_sz, sg_cnt, sg_data_sz, pkt_offset;
-	unsigned int max_req_sz, src_offset, dst_offset;
-	unsigned char *pkt_data, *orig_data, *dst_data;
+	unsigned int max_req_sz, src_offset, dst_offset, seg_len;
+	unsigned char *pkt_data, *orig_data, *dst_data, *seg_data;
 	struct sk_buff_head local_list, *target_list;
 	struct sk_buff *pkt_next = NULL, *src;
 	unsigned short max_seg_cnt;
@@ -389,7 +389,9 @@ static int brcmf_sdiod_sglist_rw(struct brcmf_sdio_dev *sdiodev,
 	struct mmc_command mmc_cmd;
 	struct mmc_data mmc_dat;
 	struct scatterlist *sgl;
+	skb_frag_t *frag;
 	int ret = 0;
+	int i;
 
 	if (!pktlist->qlen)
 		return -EINVAL;
@@ -422,8 +424,12 @@ static int brcmf_sdiod_sglist_rw(struct brcmf_sdio_dev *sdiodev,
 
 	func_blk_sz = func->cur_blksize;
 	max_req_sz = sdiodev->max_request_size;
+	/* zero-copy rx subframes carry their tail in a page fragment */
+	sg_cnt = 0;
+	skb_queue_walk(target_list, pkt_next)
+		sg_cnt += 1 + skb_shinfo(pkt_next)->nr_frags;
 	max_seg_cnt = min_t(unsigned short, sdiodev->max_segment_count,
-			    target_list->qlen);
+			    sg_cnt);
 
 	memset(&mmc_req, 0, sizeof(struct mmc_request));
 	memset(&mmc_cmd, 0, sizeof(struct mmc_command));
@@ -446,30 +452,44 @@ static int brcmf_sdiod_sglist_rw(struct brcmf_sdio_dev *sdiodev,
 	sg_cnt = 0;
 	sgl = sdiodev->sgtable.sgl;
 	skb_queue_walk(target_list, pkt_next) {
-		pkt_offset = 0;
-		while (pkt_offset < pkt_next->len) {
-			pkt_data = pkt_next->data + pkt_offset;
-			sg_data_sz = pkt_next->len - pkt_offset;
-			if (sg_data_sz > sdiodev->max_segment_size)
-				sg_data_sz = sdiodev->max_segment_size;
-			if (sg_data_sz > max_req_sz - req_sz)
-				sg_data_sz = max_req_sz - req_sz;
-
-			sg_set_buf(sgl, pkt_data, sg_data_sz);
-			sg_cnt++;
-
-			sgl = sg_next(sgl);
-			req_sz += sg_data_sz;
-			pkt_offset += sg_data_sz;
-			if (req_sz >= max_req_sz || sg_cnt >= max_seg_cnt) {
-				ret = mmc_submit_one(&mmc_dat, &mmc_req, &mmc_cmd,
-						     sg_cnt, req_sz, func_blk_sz,
-						     &addr, sdiodev, func, write);
-				if (ret)
-					goto exit_queue_walk;
-				req_sz = 0;
-				sg_cnt = 0;
-				sgl = sdiodev->sgtable.sgl;
+		for (i = -1; i < skb_shinfo(pkt_next)->nr_frags; i++) {
+			if (i < 0) {
+				seg_data = pkt_next->data;
+				seg_len = skb_headlen(pkt_next);
+			} else {
+				frag = &skb_shinfo(pkt_next)->frags[i];
+				seg_data = skb_frag_address(frag);
+				seg_len = skb_frag_size(frag);
+			}
+			pkt_offset = 0;
+			while (pkt_offset < seg_len) {
+				pkt_data = seg_data + pkt_offset;
+				sg_data_sz = seg_len - pkt_offset;
+				if (sg_data_sz > sdiodev->max_segment_size)
+					sg_data_sz = sdiodev->max_segment_size;
+				if (sg_data_sz > max_req_sz - req_sz)
+					sg_data_sz = max_req_sz - req_sz;
+
+				sg_set_buf(sgl, pkt_data, sg_data_sz);
+				sg_cnt++;
+
+				sgl = sg_next(sgl);
+				req_sz += sg_data_sz;
+				pkt_offset += sg_data_sz;
+				if (req_sz >= max_req_sz ||
+				    sg_cnt >= max_seg_cnt) {
+					ret = mmc_submit_one(&mmc_dat, &mmc_req,
+							     &mmc_cmd, sg_cnt,
+							     req_sz,
+							     func_blk_sz,
+							     &addr, sdiodev,
+							     func, write);
+					if (ret)
+						goto exit_queue_walk;
+					req_sz = 0;
+					sg_cnt = 0;
+					sgl = sdiodev->sgtable.sgl;
+				}
 			}
 		}
 	}
@@ -574,7 +594,7 @@ int brcmf_sdiod_recv_chain(struct brcmf_sdio_dev *sdiodev,
 	addr &= SBSDIO_SB_OFT_ADDR_MASK;
 	addr |= SBSDIO_SB_ACCESS_2_4B_FLAG;
 
-	if (pktq->qlen == 1)
+	if (pktq->qlen == 1 && !skb_is_nonlinear(__skb_peek(pktq)))
 		err = brcmf_sdiod_skbuff_read(sdiodev, sdiodev->func2, addr,
 					      __skb_peek(pktq));
 	else if (!sdiodev->sg_support) {
@@ -764,13 +784,25 @@ void brcmf_sdiod_sgtable_alloc(struct brcmf_sdio_dev *sdiodev)
 	sdiodev->max_segment_count = min_t(uint, host->max_segs,
 					   SG_MAX_SINGLE_ALLOC);
 	sdiodev->max_segment_size = host->max_seg_size;
+	sdiodev->rxglomsz = BRCMF_DEFAULT_RXGLOM_SIZE;
 
 	if (!sdiodev->sg_support)
 		return;
 
-	nents = max_t(uint, BRCMF_DEFAULT_RXGLOM_SIZE,
+	/* Reading rx subframes straight into page fragments costs a second
+	 * sg entry per subframe. Only do it when the host takes arbitrary
+	 * sg entries and has enough of them, otherwise stay with linear skbs.
+	 */
+	nents = max_t(uint, 2 * sdiodev->rxglomsz,
 		      sdiodev->settings->bus.sdio.txglomsz);
 	nents += (nents >> 4) + 1;
+	sdiodev->rx_frags = !sdiodev->settings->bus.sdio.broken_sg_support &&
+			    nents <= sdiodev->max_segment_count;
+	if (!sdiodev->rx_frags) {
+		nents = max_t(uint, sdiodev->rxglomsz,
+			      sdiodev->settings->bus.sdio.txglomsz);
+		nents += (nents >> 4) + 1;
+	}
 
 	WARN_ON(nents > sdiodev->max_segment_count);
 
@@ -779,6 +811,7 @@ void brcmf_sdiod_sgtable_alloc(struct brcmf_sdio_dev *sdiodev)
 	if (err < 0) {
 		brcmf_err("allocation failed: disable scatter-gather");
 		sdiodev->sg_support = false;
+		sdiodev->rx_frags = false;
 	}
 
 	sdiodev->txglomsz = sdiodev->settings->bus.sdio.txglomsz;
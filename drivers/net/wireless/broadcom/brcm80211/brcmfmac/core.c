@@ -415,14 +415,39 @@ void brcmf_netif_rx(struct brcmf_if *ifp, struct sk_buff *skb)
 	ifp->ndev->stats.rx_packets++;
 
 	brcmf_dbg(DATA, "rx proto=0x%X\n", ntohs(skb->protocol));
-	if (in_interrupt())
-		netif_rx(skb);
-	else
-		/* If the receive is not processed inside an ISR,
-		 * the softirqd must be woken explicitly to service
-		 * the NET_RX_SOFTIRQ.  This is handled by netif_rx_ni().
+	skb_queue_tail(&ifp->rxq, skb);
+	if (in_interrupt()) {
+		napi_schedule(&ifp->napi);
+	} else {
+		/* If the receive is not processed inside an ISR, the
+		 * NET_RX_SOFTIRQ raised by scheduling napi must be run
+		 * explicitly. Buses delivering a batch of frames should
+		 * disable bh around it so the poll sees the whole batch.
 		 */
-		netif_rx_ni(skb);
+		local_bh_disable();
+		napi_schedule(&ifp->napi);
+		local_bh_enable();
+	}
+}
+
+static int brcmf_netif_napi_poll(struct napi_struct *napi, int budget)
+{
+	struct brcmf_if *ifp = container_of(napi, struct brcmf_if, napi);
+	struct sk_buff *skb;
+	int work_done = 0;
+
+	while (work_done < budget) {
+		skb = skb_dequeue(&ifp->rxq);
+		if (!skb)
+			break;
+		napi_gro_receive(napi, skb);
+		work_done++;
+	}
+
+	if (work_done < budget)
+		napi_complete_done(napi, work_done);
+
+	return work_done;
 }
 
 void brcmf_netif_mon_rx(struct brcmf_if *ifp, struct sk_buff *skb)
@@ -660,6 +685,7 @@ int brcmf_net_attach(struct brcmf_if *ifp, bool rtnl_locked)
 		goto fail;
 	}
 
+	napi_enable(&ifp->napi);
 	ndev->priv_destructor = brcmf_cfg80211_free_netdev;
 	brcmf_dbg(INFO, "%s: Broadcom Dongle Host Driver\n", ndev->name);
 	return 0;
@@ -672,7 +698,11 @@ int brcmf_net_attach(struct brcmf_if *ifp, bool rtnl_locked)
 
 static void brcmf_net_detach(struct net_device *ndev, bool rtnl_locked)
 {
+	struct brcmf_if *ifp = netdev_priv(ndev);
+
 	if (ndev->reg_state == NETREG_REGISTERED) {
+		napi_disable(&ifp->napi);
+		skb_queue_purge(&ifp->rxq);
 		if (rtnl_locked)
 			unregister_netdevice(ndev);
 		else
@@ -750,6 +780,7 @@ static int brcmf_net_p2p_attach(struct brcmf_if *ifp)
 		goto fail;
 	}
 
+	napi_enable(&ifp->napi);
 	brcmf_dbg(INFO, "%s: Broadcom Dongle Host Driver\n", ndev->name);
 
 	return 0;
@@ -804,6 +835,9 @@ struct brcmf_if *brcmf_add_if(struct brcmf_pub *drvr, s32 bsscfgidx, s32 ifidx,
 		ndev->needs_free_netdev = true;
 		ifp = netdev_priv(ndev);
 		ifp->ndev = ndev;
+		skb_queue_head_init(&ifp->rxq);
+		netif_napi_add(ndev, &ifp->napi, brcmf_netif_napi_poll,
+			       NAPI_POLL_WEIGHT);
 		/* store mapping ifidx to bsscfgidx */
 		if (drvr->if2bss[ifidx] == BRCMF_BSSIDX_INVALID)
 			drvr->if2bss[ifidx] = bsscfgidx;
@@ -165,6 +165,8 @@ enum brcmf_netif_stop_reason {
  * @ndev: associated network device.
  * @multicast_work: worker object for multicast provisioning.
  * @ndoffload_work: worker object for neighbor discovery offload configuration.
+ * @napi: napi context delivering received frames to the network stack.
+ * @rxq: received frames waiting for @napi.
  * @fws_desc: interface specific firmware-signalling descriptor.
  * @ifidx: interface index in device firmware.
  * @bsscfgidx: index of bss associated with this interface.
@@ -181,6 +183,8 @@ struct brcmf_if {
 	struct net_device *ndev;
 	struct work_struct multicast_work;
 	struct work_struct ndoffload_work;
+	struct napi_struct napi;
+	struct sk_buff_head rxq;
 	struct brcmf_fws_mac_descriptor *fws_desc;
 	int ifidx;
 	s32 bsscfgidx;
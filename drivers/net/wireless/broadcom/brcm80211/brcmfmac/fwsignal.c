@@ -1447,15 +1447,25 @@ static int brcmf_fws_txstatus_suppressed(struct brcmf_fws_info *fws, int fifo,
 	return ret;
 }
 
+/*
+ * Process the tx status of @compcnt packets starting at hanger slot @hslot.
+ * Called with the fws lock held. Credits picked up from the packets are
+ * returned per fifo once the whole batch is popped from the hanger. The
+ * completed packets are gathered on @done and must be passed to
+ * brcmf_fws_txs_complete() after the lock is released.
+ */
 static int
 brcmf_fws_txs_process(struct brcmf_fws_info *fws, u8 flags, u32 hslot,
-		      u32 genbit, u16 seq, u8 compcnt)
+		      u32 genbit, u16 seq, u8 compcnt,
+		      struct sk_buff_head *done)
 {
 	struct brcmf_pub *drvr = fws->drvr;
+	u8 credits[BRCMF_FWS_FIFO_COUNT] = {};
 	u32 fifo;
 	u8 cnt = 0;
 	int ret;
 	bool remove_from_hanger = true;
+	bool credited = false;
 	struct sk_buff *skb;
 	struct brcmf_skbuff_cb *skcb;
 	struct brcmf_fws_mac_descriptor *entry = NULL;
@@ -1504,21 +1514,23 @@ brcmf_fws_txs_process(struct brcmf_fws_info *fws, u8 flags, u32 hslot,
 		fifo = brcmf_skb_htod_tag_get_field(skb, FIFO);
 		if (fws->fcmode == BRCMF_FWS_FCMODE_IMPLIED_CREDIT ||
 		    (brcmf_skb_if_flags_get_field(skb, REQ_CREDIT)) ||
-		    flags == BRCMF_FWS_TXSTATUS_HOST_TOSSED) {
-			brcmf_fws_return_credits(fws, fifo, 1);
-			brcmf_fws_schedule_deq(fws);
-		}
+		    flags == BRCMF_FWS_TXSTATUS_HOST_TOSSED)
+			credits[fifo]++;
 		brcmf_fws_macdesc_return_req_credit(skb);
 
+		/* finalizing is done outside the lock */
+		if (remove_from_hanger) {
+			__skb_queue_tail(done, skb);
+			goto cont;
+		}
+
 		ret = brcmf_proto_hdrpull(fws->drvr, false, skb, &ifp);
 		if (ret) {
 			brcmu_pkt_buf_free_skb(skb);
 			goto cont;
 		}
-		if (!remove_from_hanger)
-			ret = brcmf_fws_txstatus_suppressed(fws, fifo, skb,
-							    genbit, seq);
-		if (remove_from_hanger || ret)
+		ret = brcmf_fws_txstatus_suppressed(fws, fifo, skb, genbit, seq);
+		if (ret)
 			brcmf_txfinalize(ifp, skb, true);
 
 cont:
@@ -1530,9 +1542,32 @@ brcmf_fws_txs_process(struct brcmf_fws_info *fws, u8 flags, u32 hslot,
 		cnt++;
 	}
 
+	for (fifo = 0; fifo < BRCMF_FWS_FIFO_COUNT; fifo++) {
+		if (!credits[fifo])
+			continue;
+		brcmf_fws_return_credits(fws, fifo, credits[fifo]);
+		credited = true;
+	}
+	if (credited)
+		brcmf_fws_schedule_deq(fws);
+
 	return 0;
 }
 
+static void brcmf_fws_txs_complete(struct brcmf_fws_info *fws,
+				   struct sk_buff_head *done)
+{
+	struct brcmf_if *ifp;
+	struct sk_buff *skb;
+
+	while ((skb = __skb_dequeue(done))) {
+		if (brcmf_proto_hdrpull(fws->drvr, false, skb, &ifp))
+			brcmu_pkt_buf_free_skb(skb);
+		else
+			brcmf_txfinalize(ifp, skb, true);
+	}
+}
+
 static int brcmf_fws_fifocreditback_indicate(struct brcmf_fws_info *fws,
 					     u8 *data)
 {
@@ -1566,6 +1601,7 @@ static int brcmf_fws_txstatus_indicate(struct brcmf_fws_info *fws, u8 type,
 	u16 seq;
 	u8 compcnt;
 	u8 compcnt_offset = BRCMF_FWS_TYPE_TXSTATUS_LEN;
+	struct sk_buff_head done;
 
 	memcpy(&status_le, data, sizeof(status_le));
 	status = le32_to_cpu(status_le);
@@ -1587,9 +1623,11 @@ static int brcmf_fws_txstatus_indicate(struct brcmf_fws_info *fws, u8 type,
 		compcnt = 1;
 	fws->stats.txs_indicate += compcnt;
 
+	__skb_queue_head_init(&done);
 	brcmf_fws_lock(fws);
-	brcmf_fws_txs_process(fws, flags, hslot, genbit, seq, compcnt);
+	brcmf_fws_txs_process(fws, flags, hslot, genbit, seq, compcnt, &done);
 	brcmf_fws_unlock(fws);
+	brcmf_fws_txs_complete(fws, &done);
 	return BRCMF_FWS_RET_OK_NOSCHEDULE;
 }
 
@@ -1995,6 +2033,7 @@ static void brcmf_fws_rollback_toq(struct brcmf_fws_info *fws,
 {
 	struct brcmf_pub *drvr = fws->drvr;
 	struct brcmf_fws_mac_descriptor *entry;
+	struct sk_buff_head done;
 	struct sk_buff *pktout;
 	int qidx, hslot;
 	int rc = 0;
@@ -2018,8 +2057,12 @@ static void brcmf_fws_rollback_toq(struct brcmf_fws_info *fws,
 	if (rc) {
 		fws->stats.rollback_failed++;
 		hslot = brcmf_skb_htod_tag_get_field(skb, HSLOT);
+		__skb_queue_head_init(&done);
 		brcmf_fws_txs_process(fws, BRCMF_FWS_TXSTATUS_HOST_TOSSED,
-				      hslot, 0, 0, 1);
+				      hslot, 0, 0, 1, &done);
+		brcmf_fws_unlock(fws);
+		brcmf_fws_txs_complete(fws, &done);
+		brcmf_fws_lock(fws);
 	} else {
 		fws->stats.rollback_success++;
 		brcmf_fws_return_credits(fws, fifo, 1);
@@ -2483,17 +2526,20 @@ bool brcmf_fws_fc_active(struct brcmf_fws_info *fws)
 
 void brcmf_fws_bustxfail(struct brcmf_fws_info *fws, struct sk_buff *skb)
 {
+	struct sk_buff_head done;
 	u32 hslot;
 
 	if (brcmf_skbcb(skb)->state == BRCMF_FWS_SKBSTATE_TIM) {
 		brcmu_pkt_buf_free_skb(skb);
 		return;
 	}
+	__skb_queue_head_init(&done);
 	brcmf_fws_lock(fws);
 	hslot = brcmf_skb_htod_tag_get_field(skb, HSLOT);
 	brcmf_fws_txs_process(fws, BRCMF_FWS_TXSTATUS_HOST_TOSSED, hslot, 0, 0,
-			      1);
+			      1, &done);
 	brcmf_fws_unlock(fws);
+	brcmf_fws_txs_complete(fws, &done);
 }
 
 void brcmf_fws_bus_blocked(struct brcmf_pub *drvr, bool flow_blocked)
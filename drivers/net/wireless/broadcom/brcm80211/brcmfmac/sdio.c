@@ -119,6 +119,12 @@ struct rte_console {
 
 #define BRCMF_FIRSTREAD	(1 << 6)
 
+/* Rx glom subframe bytes kept in the linear skb area, the rest of the
+ * subframe is read straight into a page fragment. Large enough for
+ * the SDPCM, BCDC and ethernet headers to be pulled without copying.
+ */
+#define BRCMF_RXGLOM_HDR_SPLIT	256
+
 #define BRCMF_CONSOLE	10	/* watchdog interval to poll console */
 
 /* SBSDIO_DEVICE_CTL */
@@ -517,6 +523,7 @@ struct brcmf_sdio {
 
 	u8 tx_hdrlen;		/* sdio bus header length for tx packet */
 	bool txglom;		/* host tx glomming enable flag */
+	uint txglom_cur;	/* current adaptive tx glom batch size */
 	u16 head_align;		/* buffer pointer alignment */
 	u16 sgentry_align;	/* scatter-gather buffer alignment */
 };
@@ -1474,6 +1481,41 @@ static void brcmf_sdio_hdpack(struct brcmf_sdio *bus, u8 *header,
 	trace_brcmf_sdpcm_hdr(SDPCM_TX + !!(bus->txglom), header);
 }
 
+static struct sk_buff *brcmf_sdio_rxglom_skb(struct brcmf_sdio *bus,
+					     u16 sublen)
+{
+	struct sk_buff *skb;
+	struct page *page;
+	uint hdrlen, fraglen;
+	void *frag;
+
+	hdrlen = ALIGN(BRCMF_RXGLOM_HDR_SPLIT, bus->sgentry_align);
+	if (!bus->sdiodev->rx_frags || sublen <= hdrlen)
+		hdrlen = sublen;
+
+	skb = brcmu_pkt_buf_get_skb(hdrlen + bus->sgentry_align);
+	if (!skb)
+		return NULL;
+
+	/* Adhere to start alignment requirements */
+	pkt_align(skb, hdrlen, bus->sgentry_align);
+	if (hdrlen == sublen)
+		return skb;
+
+	/* keep fragments cache line aligned, they are DMA targets */
+	fraglen = SKB_DATA_ALIGN(sublen - hdrlen);
+	frag = netdev_alloc_frag(fraglen);
+	if (!frag) {
+		brcmu_pkt_buf_free_skb(skb);
+		return NULL;
+	}
+	page = virt_to_head_page(frag);
+	skb_add_rx_frag(skb, 0, page, frag - page_address(page),
+			sublen - hdrlen, fraglen);
+
+	return skb;
+}
+
 static u8 brcmf_sdio_rxglom(struct brcmf_sdio *bus, u8 rxseq)
 {
 	u16 dlen, totlen;
@@ -1482,6 +1524,7 @@ static u8 brcmf_sdio_rxglom(struct brcmf_sdio *bus, u8 rxseq)
 	struct sk_buff *pfirst, *pnext;
 
 	int errcode;
+	bool event;
 	u8 doff;
 
 	struct brcmf_sdio_hdrinfo rd_new;
@@ -1515,6 +1558,12 @@ static u8 brcmf_sdio_rxglom(struct brcmf_sdio *bus, u8 rxseq)
 				pnext = NULL;
 				break;
 			}
+			if (num >= bus->sdiodev->rxglomsz) {
+				brcmf_err("descriptor exceeds %d subframes\n",
+					  bus->sdiodev->rxglomsz);
+				pnext = NULL;
+				break;
+			}
 			if (sublen % bus->sgentry_align) {
 				brcmf_err("sublen %d not multiple of %d\n",
 					  sublen, bus->sgentry_align);
@@ -1530,16 +1579,13 @@ static u8 brcmf_sdio_rxglom(struct brcmf_sdio *bus, u8 rxseq)
 			}
 
 			/* Allocate/chain packet for next subframe */
-			pnext = brcmu_pkt_buf_get_skb(sublen + bus->sgentry_align);
+			pnext = brcmf_sdio_rxglom_skb(bus, sublen);
 			if (pnext == NULL) {
 				brcmf_err("bcm_pkt_buf_get_skb failed, num %d len %d\n",
 					  num, sublen);
 				break;
 			}
 			skb_queue_tail(&bus->glom, pnext);
-
-			/* Adhere to start alignment requirements */
-			pkt_align(pnext, sublen, bus->sgentry_align);
 		}
 
 		/* If all allocations succeeded, save packet chain
@@ -1615,7 +1661,8 @@ static u8 brcmf_sdio_rxglom(struct brcmf_sdio *bus, u8 rxseq)
 		bus->cur_read.len = rd_new.len_nxtfrm << 4;
 
 		/* Remove superframe header, remember offset */
-		skb_pull(pfirst, rd_new.dat_offset);
+		if (!errcode && !pskb_pull(pfirst, rd_new.dat_offset))
+			errcode = -ENOMEM;
 		num = 0;
 
 		/* Validate all the subframe headers */
@@ -1624,6 +1671,13 @@ static u8 brcmf_sdio_rxglom(struct brcmf_sdio *bus, u8 rxseq)
 			if (errcode)
 				break;
 
+			/* subframe header must be linear for parsing */
+			if (!pskb_may_pull(pnext, min_t(uint, pnext->len,
+							SDPCM_HDRLEN))) {
+				errcode = -ENOMEM;
+				break;
+			}
+
 			rd_new.len = pnext->len;
 			rd_new.seq_num = rxseq++;
 			sdio_claim_host(bus->sdiodev->func1);
@@ -1649,19 +1703,21 @@ static u8 brcmf_sdio_rxglom(struct brcmf_sdio *bus, u8 rxseq)
 
 		/* Basic SD framing looks ok - process each packet (header) */
 
+		/* hand the subframes to napi as one batch */
+		local_bh_disable();
 		skb_queue_walk_safe(&bus->glom, pfirst, pnext) {
 			dptr = (u8 *) (pfirst->data);
 			sublen = get_unaligned_le16(dptr);
 			doff = brcmf_sdio_getdatoffset(&dptr[SDPCM_HWHDR_LEN]);
+			event = brcmf_sdio_fromevntchan(&dptr[SDPCM_HWHDR_LEN]);
 
 			brcmf_dbg_hex_dump(BRCMF_BYTES_ON() && BRCMF_DATA_ON(),
-					   dptr, pfirst->len,
+					   dptr, skb_headlen(pfirst),
 					   "Rx Subframe Data:\n");
 
-			__skb_trim(pfirst, sublen);
-			skb_pull(pfirst, doff);
-
-			if (pfirst->len == 0) {
+			/* subframes may carry their payload in a page frag */
+			if (pskb_trim(pfirst, sublen) ||
+			    !pskb_pull(pfirst, doff) || pfirst->len == 0) {
 				skb_unlink(pfirst, &bus->glom);
 				brcmu_pkt_buf_free_skb(pfirst);
 				continue;
@@ -1669,19 +1725,25 @@ static u8 brcmf_sdio_rxglom(struct brcmf_sdio *bus, u8 rxseq)
 
 			brcmf_dbg_hex_dump(BRCMF_GLOM_ON(),
 					   pfirst->data,
-					   min_t(int, pfirst->len, 32),
+					   min_t(int, skb_headlen(pfirst), 32),
 					   "subframe %d to stack, %p (%p/%d) nxt/lnk %p/%p\n",
 					   bus->glom.qlen, pfirst, pfirst->data,
 					   pfirst->len, pfirst->next,
 					   pfirst->prev);
 			skb_unlink(pfirst, &bus->glom);
-			if (brcmf_sdio_fromevntchan(&dptr[SDPCM_HWHDR_LEN]))
-				brcmf_rx_event(bus->sdiodev->dev, pfirst);
-			else
+			if (event) {
+				/* event parsing expects a linear buffer */
+				if (skb_linearize(pfirst))
+					brcmu_pkt_buf_free_skb(pfirst);
+				else
+					brcmf_rx_event(bus->sdiodev->dev,
+						       pfirst);
+			} else
 				brcmf_rx_frame(bus->sdiodev->dev, pfirst,
 					       false);
 			bus->sdcnt.rxglompkts++;
 		}
+		local_bh_enable();
 
 		bus->sdcnt.rxglomframes++;
 	}
@@ -2288,6 +2350,22 @@ static int brcmf_sdio_txpkt(struct brcmf_sdio *bus, struct sk_buff_head *pktq,
 	return ret;
 }
 
+/*
+ * Adapt the tx glom batch to the queue backlog. The batch doubles while
+ * full batches leave at least as many frames queued behind them and
+ * halves once the queue runs shallow, down to single frames. Batches cut
+ * short by the dongle window leave the size alone.
+ */
+static void brcmf_sdio_txglom_adapt(struct brcmf_sdio *bus, uint sent,
+				    uint backlog)
+{
+	if (sent >= bus->txglom_cur && backlog >= bus->txglom_cur)
+		bus->txglom_cur = min_t(uint, 2 * bus->txglom_cur,
+					bus->sdiodev->txglomsz);
+	else if (backlog < bus->txglom_cur / 2)
+		bus->txglom_cur = max_t(uint, bus->txglom_cur / 2, 1);
+}
+
 static uint brcmf_sdio_sendfromq(struct brcmf_sdio *bus, uint maxframes)
 {
 	struct sk_buff *pkt;
@@ -2295,7 +2373,7 @@ static uint brcmf_sdio_sendfromq(struct brcmf_sdio *bus, uint maxframes)
 	u32 intstat_addr = bus->sdio_core->base + SD_REG(intstatus);
 	u32 intstatus = 0;
 	int ret = 0, prec_out, i;
-	uint cnt = 0;
+	uint cnt = 0, qlen;
 	u8 tx_prec_map, pkt_num;
 
 	brcmf_dbg(TRACE, "Enter\n");
@@ -2305,11 +2383,11 @@ static uint brcmf_sdio_sendfromq(struct brcmf_sdio *bus, uint maxframes)
 	/* Send frames until the limit or some other event */
 	for (cnt = 0; (cnt < maxframes) && data_ok(bus);) {
 		pkt_num = 1;
+		qlen = brcmu_pktq_mlen(&bus->txq, ~bus->flowcontrol);
 		if (bus->txglom)
 			pkt_num = min_t(u8, bus->tx_max - bus->tx_seq,
-					bus->sdiodev->txglomsz);
-		pkt_num = min_t(u32, pkt_num,
-				brcmu_pktq_mlen(&bus->txq, ~bus->flowcontrol));
+					bus->txglom_cur);
+		pkt_num = min_t(u32, pkt_num, qlen);
 		__skb_queue_head_init(&pktq);
 		spin_lock_bh(&bus->txq_lock);
 		for (i = 0; i < pkt_num; i++) {
@@ -2326,6 +2404,8 @@ static uint brcmf_sdio_sendfromq(struct brcmf_sdio *bus, uint maxframes)
 		ret = brcmf_sdio_txpkt(bus, &pktq, SDPCM_DATA_CHANNEL);
 
 		cnt += i;
+		if (bus->txglom)
+			brcmf_sdio_txglom_adapt(bus, i, qlen - i);
 
 		/* In poll mode, need to check for other events */
 		if (!bus->intr) {
@@ -4312,6 +4392,7 @@ struct brcmf_sdio *brcmf_sdio_probe(struct brcmf_sdio_dev *sdiodev)
 	bus->rxbound = BRCMF_RXBOUND;
 	bus->txminmax = BRCMF_TXMINMAX;
 	bus->tx_seq = SDPCM_SEQ_WRAP - 1;
+	bus->txglom_cur = 1;
 
 	/* single-threaded workqueue */
 	wq = alloc_ordered_workqueue("brcmf_wq/%s", WQ_MEM_RECLAIM,
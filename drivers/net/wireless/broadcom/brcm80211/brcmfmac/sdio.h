@@ -180,10 +180,12 @@ struct brcmf_sdio_dev {
 	spinlock_t irq_en_lock;
 	bool irq_wake;			/* irq wake enable flags */
 	bool sg_support;
+	bool rx_frags;
 	uint max_request_size;
 	ushort max_segment_count;
 	uint max_segment_size;
 	uint txglomsz;
+	uint rxglomsz;
 	struct sg_table sgtable;
 	char fw_name[BRCMF_FW_NAME_LEN];
 	char nvram_name[BRCMF_FW_NAME_LEN];
@@ -123,6 +123,8 @@
 struct s3c64xx_spi_dma_data {
 	struct dma_chan *ch;
 	enum dma_transfer_direction direction;
+	/* Word size the channel is configured for, 0 if not configured */
+	unsigned int cfg_bpw;
 };
 
 /**
@@ -271,24 +273,31 @@ static void prepare_dma(struct s3c64xx_spi_dma_data *dma,
 	struct dma_slave_config config;
 	struct dma_async_tx_descriptor *desc;
 
-	memset(&config, 0, sizeof(config));
-
-	if (dma->direction == DMA_DEV_TO_MEM) {
+	if (dma->direction == DMA_DEV_TO_MEM)
 		sdd = container_of((void *)dma,
 			struct s3c64xx_spi_driver_data, rx_dma);
-		config.direction = dma->direction;
-		config.src_addr = sdd->sfr_start + S3C64XX_SPI_RX_DATA;
-		config.src_addr_width = sdd->cur_bpw / 8;
-		config.src_maxburst = 1;
-		dmaengine_slave_config(dma->ch, &config);
-	} else {
+	else
 		sdd = container_of((void *)dma,
 			struct s3c64xx_spi_driver_data, tx_dma);
+
+	/*
+	 * Only the word size can change between transfers, don't redo the
+	 * slave configuration for every transfer of a run of same-sized words.
+	 */
+	if (dma->cfg_bpw != sdd->cur_bpw) {
+		memset(&config, 0, sizeof(config));
 		config.direction = dma->direction;
-		config.dst_addr = sdd->sfr_start + S3C64XX_SPI_TX_DATA;
-		config.dst_addr_width = sdd->cur_bpw / 8;
-		config.dst_maxburst = 1;
+		if (dma->direction == DMA_DEV_TO_MEM) {
+			config.src_addr = sdd->sfr_start + S3C64XX_SPI_RX_DATA;
+			config.src_addr_width = sdd->cur_bpw / 8;
+			config.src_maxburst = 1;
+		} else {
+			config.dst_addr = sdd->sfr_start + S3C64XX_SPI_TX_DATA;
+			config.dst_addr_width = sdd->cur_bpw / 8;
+			config.dst_maxburst = 1;
+		}
 		dmaengine_slave_config(dma->ch, &config);
+		dma->cfg_bpw = sdd->cur_bpw;
 	}
 
 	desc = dmaengine_prep_slave_sg(dma->ch, sgt->sgl, sgt->nents,
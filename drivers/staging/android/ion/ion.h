@@ -265,6 +265,22 @@ size_t ion_heap_freelist_size(struct ion_heap *heap);
  * many systems
  */
 
+#define ION_PAGE_POOL_PCP_SIZE	8
+
+/**
+ * struct ion_page_pool_pcp - per-cpu magazine in front of a page pool
+ * @lock:		protects the magazine, normally only taken by its cpu
+ * @count:		number of pages in the magazine
+ * @high_count:		number of those pages that are highmem
+ * @pages:		the cached pages
+ */
+struct ion_page_pool_pcp {
+	spinlock_t lock;
+	int count;
+	int high_count;
+	struct page *pages[ION_PAGE_POOL_PCP_SIZE];
+};
+
 /**
  * struct ion_page_pool - pagepool struct
  * @high_count:		number of highmem items in the pool
@@ -276,6 +292,10 @@ size_t ion_heap_freelist_size(struct ion_heap *heap);
  * @gfp_mask:		gfp_mask to use from alloc
  * @order:		order of pages in the pool
  * @list:		plist node for list of pools
+ * @last_shrink:	jiffies at which the shrinker last took pages
+ * @pcp:		per-cpu magazines, the global lists are only used when
+ *			a magazine runs empty or overflows
+ * @pcp_max:		number of pages each magazine holds at most
  *
  * Allows you to keep a pool of pre allocated pages to use from your heap.
  * Keeping a pool of pages that is ready for dma, ie any cached mapping have
@@ -291,6 +311,9 @@ struct ion_page_pool {
 	gfp_t gfp_mask;
 	unsigned int order;
 	struct plist_node list;
+	unsigned long last_shrink;
+	struct ion_page_pool_pcp __percpu *pcp;
+	int pcp_max;
 };
 
 struct ion_page_pool *ion_page_pool_create(gfp_t gfp_mask, unsigned int order);
@@ -308,4 +331,22 @@ void ion_page_pool_free(struct ion_page_pool *pool, struct page *page);
 int ion_page_pool_shrink(struct ion_page_pool *pool, gfp_t gfp_mask,
 			 int nr_to_scan);
 
+/** ion_page_pool_count - number of pages cached in the pool
+ * @pool:		the pool
+ *
+ * returns the size of the pool in pages
+ */
+int ion_page_pool_count(struct ion_page_pool *pool);
+
+/** ion_page_pool_refill - tops up the pool with zeroed pages
+ * @pool:		the pool
+ * @nr_pages:		target size of the pool in pages
+ *
+ * Allocates without direct reclaim, and gives up as soon as an allocation
+ * fails or while the pool is backing off from a recent shrink.
+ *
+ * returns the number of pages added
+ */
+int ion_page_pool_refill(struct ion_page_pool *pool, int nr_pages);
+
 #endif /* _ION_H */
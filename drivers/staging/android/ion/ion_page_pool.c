@@ -5,13 +5,18 @@
  * Copyright (C) 2011 Google, Inc.
  */
 
+#include <linux/jiffies.h>
 #include <linux/list.h>
+#include <linux/percpu.h>
 #include <linux/slab.h>
 #include <linux/swap.h>
 #include <linux/sched/signal.h>
 
 #include "ion.h"
 
+/* refilling a pool waits this long after the shrinker took pages from it */
+#define ION_PAGE_POOL_REFILL_BACKOFF	(5 * HZ)
+
 static inline struct page *ion_page_pool_alloc_pages(struct ion_page_pool *pool)
 {
 	if (fatal_signal_pending(current))
@@ -25,9 +30,20 @@ static void ion_page_pool_free_pages(struct ion_page_pool *pool,
 	__free_pages(page, pool->order);
 }
 
-static void ion_page_pool_add(struct ion_page_pool *pool, struct page *page)
+/*
+ * Pages are accounted as reclaimable for as long as they sit in the pool,
+ * whether on the global lists or in a per-cpu magazine.
+ */
+static void ion_page_pool_account(struct ion_page_pool *pool,
+				  struct page *page, int sign)
+{
+	mod_node_page_state(page_pgdat(page), NR_KERNEL_MISC_RECLAIMABLE,
+			    sign * (1 << pool->order));
+}
+
+static void ion_page_pool_add_locked(struct ion_page_pool *pool,
+				     struct page *page)
 {
-	mutex_lock(&pool->mutex);
 	if (PageHighMem(page)) {
 		list_add_tail(&page->lru, &pool->high_items);
 		pool->high_count++;
@@ -35,9 +51,12 @@ static void ion_page_pool_add(struct ion_page_pool *pool, struct page *page)
 		list_add_tail(&page->lru, &pool->low_items);
 		pool->low_count++;
 	}
+}
 
-	mod_node_page_state(page_pgdat(page), NR_KERNEL_MISC_RECLAIMABLE,
-							1 << pool->order);
+static void ion_page_pool_add(struct ion_page_pool *pool, struct page *page)
+{
+	mutex_lock(&pool->mutex);
+	ion_page_pool_add_locked(pool, page);
 	mutex_unlock(&pool->mutex);
 }
 
@@ -56,44 +75,154 @@ static struct page *ion_page_pool_remove(struct ion_page_pool *pool, bool high)
 	}
 
 	list_del(&page->lru);
-	mod_node_page_state(page_pgdat(page), NR_KERNEL_MISC_RECLAIMABLE,
-							-(1 << pool->order));
 	return page;
 }
 
-struct page *ion_page_pool_alloc(struct ion_page_pool *pool)
+static struct page *ion_page_pool_pcp_get(struct ion_page_pool *pool)
 {
+	struct ion_page_pool_pcp *pcp = raw_cpu_ptr(pool->pcp);
 	struct page *page = NULL;
 
-	BUG_ON(!pool);
+	spin_lock(&pcp->lock);
+	if (pcp->count) {
+		page = pcp->pages[--pcp->count];
+		if (PageHighMem(page))
+			pcp->high_count--;
+	}
+	spin_unlock(&pcp->lock);
+
+	return page;
+}
+
+static bool ion_page_pool_pcp_put(struct ion_page_pool *pool,
+				  struct page *page)
+{
+	struct ion_page_pool_pcp *pcp = raw_cpu_ptr(pool->pcp);
+	bool ret = false;
+
+	spin_lock(&pcp->lock);
+	if (pcp->count < pool->pcp_max) {
+		pcp->pages[pcp->count++] = page;
+		if (PageHighMem(page))
+			pcp->high_count++;
+		ret = true;
+	}
+	spin_unlock(&pcp->lock);
+
+	return ret;
+}
+
+/*
+ * The local magazine is empty: take a batch from the global pool, keep
+ * the first page for the caller and stock the magazine with the rest.
+ */
+static struct page *ion_page_pool_pcp_fill(struct ion_page_pool *pool)
+{
+	struct page *batch[ION_PAGE_POOL_PCP_SIZE];
+	int want = pool->pcp_max / 2 + 1;
+	int i, n = 0;
+
+	mutex_lock(&pool->mutex);
+	while (n < want && (pool->high_count || pool->low_count))
+		batch[n++] = ion_page_pool_remove(pool, !!pool->high_count);
+	mutex_unlock(&pool->mutex);
+
+	for (i = 1; i < n; i++) {
+		if (!ion_page_pool_pcp_put(pool, batch[i]))
+			ion_page_pool_add(pool, batch[i]);
+	}
+
+	return n ? batch[0] : NULL;
+}
+
+/*
+ * The local magazine is full: move @page and half of the magazine back to
+ * the global pool in one go.
+ */
+static void ion_page_pool_pcp_spill(struct ion_page_pool *pool,
+				    struct page *page)
+{
+	struct ion_page_pool_pcp *pcp = raw_cpu_ptr(pool->pcp);
+	struct page *batch[ION_PAGE_POOL_PCP_SIZE];
+	int i, n = 0;
+
+	spin_lock(&pcp->lock);
+	while (pcp->count > pool->pcp_max / 2) {
+		batch[n] = pcp->pages[--pcp->count];
+		if (PageHighMem(batch[n]))
+			pcp->high_count--;
+		n++;
+	}
+	spin_unlock(&pcp->lock);
 
 	mutex_lock(&pool->mutex);
-	if (pool->high_count)
-		page = ion_page_pool_remove(pool, true);
-	else if (pool->low_count)
-		page = ion_page_pool_remove(pool, false);
+	ion_page_pool_add_locked(pool, page);
+	for (i = 0; i < n; i++)
+		ion_page_pool_add_locked(pool, batch[i]);
 	mutex_unlock(&pool->mutex);
+}
+
+/* move every cpu's magazine back to the global pool, for the shrinker */
+static void ion_page_pool_pcp_drain(struct ion_page_pool *pool)
+{
+	int cpu;
+
+	mutex_lock(&pool->mutex);
+	for_each_possible_cpu(cpu) {
+		struct ion_page_pool_pcp *pcp = per_cpu_ptr(pool->pcp, cpu);
+
+		spin_lock(&pcp->lock);
+		while (pcp->count)
+			ion_page_pool_add_locked(pool,
+						 pcp->pages[--pcp->count]);
+		pcp->high_count = 0;
+		spin_unlock(&pcp->lock);
+	}
+	mutex_unlock(&pool->mutex);
+}
+
+struct page *ion_page_pool_alloc(struct ion_page_pool *pool)
+{
+	struct page *page;
 
+	BUG_ON(!pool);
+
+	page = ion_page_pool_pcp_get(pool);
 	if (!page)
-		page = ion_page_pool_alloc_pages(pool);
+		page = ion_page_pool_pcp_fill(pool);
+	if (page) {
+		ion_page_pool_account(pool, page, -1);
+		return page;
+	}
 
-	return page;
+	return ion_page_pool_alloc_pages(pool);
 }
 
 void ion_page_pool_free(struct ion_page_pool *pool, struct page *page)
 {
 	BUG_ON(pool->order != compound_order(page));
 
-	ion_page_pool_add(pool, page);
+	ion_page_pool_account(pool, page, 1);
+	if (!ion_page_pool_pcp_put(pool, page))
+		ion_page_pool_pcp_spill(pool, page);
 }
 
 static int ion_page_pool_total(struct ion_page_pool *pool, bool high)
 {
 	int count = pool->low_count;
+	int cpu;
 
 	if (high)
 		count += pool->high_count;
 
+	for_each_possible_cpu(cpu) {
+		struct ion_page_pool_pcp *pcp = per_cpu_ptr(pool->pcp, cpu);
+
+		count += READ_ONCE(pcp->count);
+		if (!high)
+			count -= READ_ONCE(pcp->high_count);
+	}
+
 	return count << pool->order;
 }
 
@@ -111,6 +240,9 @@ int ion_page_pool_shrink(struct ion_page_pool *pool, gfp_t gfp_mask,
 	if (nr_to_scan == 0)
 		return ion_page_pool_total(pool, high);
 
+	pool->last_shrink = jiffies;
+	ion_page_pool_pcp_drain(pool);
+
 	while (freed < nr_to_scan) {
 		struct page *page;
 
@@ -124,6 +256,7 @@ int ion_page_pool_shrink(struct ion_page_pool *pool, gfp_t gfp_mask,
 			break;
 		}
 		mutex_unlock(&pool->mutex);
+		ion_page_pool_account(pool, page, -1);
 		ion_page_pool_free_pages(pool, page);
 		freed += (1 << pool->order);
 	}
@@ -131,18 +264,69 @@ int ion_page_pool_shrink(struct ion_page_pool *pool, gfp_t gfp_mask,
 	return freed;
 }
 
+int ion_page_pool_count(struct ion_page_pool *pool)
+{
+	int count;
+
+	mutex_lock(&pool->mutex);
+	count = ion_page_pool_total(pool, true);
+	mutex_unlock(&pool->mutex);
+
+	return count;
+}
+
+int ion_page_pool_refill(struct ion_page_pool *pool, int nr_pages)
+{
+	gfp_t gfp_mask = (pool->gfp_mask | __GFP_ZERO | __GFP_NOWARN |
+			  __GFP_NORETRY) & ~__GFP_DIRECT_RECLAIM;
+	int added = 0;
+
+	while (ion_page_pool_count(pool) < nr_pages) {
+		struct page *page;
+
+		if (time_before(jiffies, READ_ONCE(pool->last_shrink) +
+				ION_PAGE_POOL_REFILL_BACKOFF))
+			break;
+
+		page = alloc_pages(gfp_mask, pool->order);
+		if (!page)
+			break;
+		ion_page_pool_account(pool, page, 1);
+		ion_page_pool_add(pool, page);
+		added += 1 << pool->order;
+	}
+
+	return added;
+}
+
 struct ion_page_pool *ion_page_pool_create(gfp_t gfp_mask, unsigned int order)
 {
 	struct ion_page_pool *pool = kmalloc(sizeof(*pool), GFP_KERNEL);
+	int cpu;
 
 	if (!pool)
 		return NULL;
+	pool->pcp = alloc_percpu(struct ion_page_pool_pcp);
+	if (!pool->pcp) {
+		kfree(pool);
+		return NULL;
+	}
+	for_each_possible_cpu(cpu) {
+		struct ion_page_pool_pcp *pcp = per_cpu_ptr(pool->pcp, cpu);
+
+		spin_lock_init(&pcp->lock);
+		pcp->count = 0;
+		pcp->high_count = 0;
+	}
+	/* keep fewer of the bigger pages per cpu: 8, 4 and 2 for the heaps */
+	pool->pcp_max = max(ION_PAGE_POOL_PCP_SIZE >> (order / 4), 1);
 	pool->high_count = 0;
 	pool->low_count = 0;
 	INIT_LIST_HEAD(&pool->low_items);
 	INIT_LIST_HEAD(&pool->high_items);
 	pool->gfp_mask = gfp_mask | __GFP_COMP;
 	pool->order = order;
+	pool->last_shrink = jiffies - ION_PAGE_POOL_REFILL_BACKOFF;
 	mutex_init(&pool->mutex);
 	plist_node_init(&pool->list, order);
 
@@ -151,5 +335,6 @@ struct ion_page_pool *ion_page_pool_create(gfp_t gfp_mask, unsigned int order)
 
 void ion_page_pool_destroy(struct ion_page_pool *pool)
 {
+	free_percpu(pool->pcp);
 	kfree(pool);
 }
@@ -8,11 +8,15 @@
 #include <asm/page.h>
 #include <linux/dma-mapping.h>
 #include <linux/err.h>
+#include <linux/freezer.h>
 #include <linux/highmem.h>
+#include <linux/kthread.h>
 #include <linux/mm.h>
+#include <linux/moduleparam.h>
 #include <linux/scatterlist.h>
 #include <linux/slab.h>
 #include <linux/vmalloc.h>
+#include <uapi/linux/sched/types.h>
 
 #include "ion.h"
 
@@ -42,8 +46,91 @@ static inline unsigned int order_to_size(int order)
 struct ion_system_heap {
 	struct ion_heap heap;
 	struct ion_page_pool *pools[NUM_ORDERS];
+#ifdef CONFIG_ION_SYSTEM_HEAP_POOL_REFILL
+	wait_queue_head_t refill_wait;
+	struct task_struct *refill_task;
+#endif
 };
 
+#ifdef CONFIG_ION_SYSTEM_HEAP_POOL_REFILL
+/* per high-order pool watermarks, in pages */
+static int pool_refill_low = 1024;
+module_param(pool_refill_low, int, 0644);
+static int pool_refill_high = 4096;
+module_param(pool_refill_high, int, 0644);
+
+static bool ion_system_heap_refill_needed(struct ion_system_heap *heap)
+{
+	int i;
+
+	for (i = 0; i < NUM_ORDERS; i++) {
+		if (!orders[i])
+			continue;
+		if (ion_page_pool_count(heap->pools[i]) <
+		    READ_ONCE(pool_refill_low))
+			return true;
+	}
+	return false;
+}
+
+static int ion_system_heap_refill(void *data)
+{
+	struct ion_system_heap *heap = data;
+
+	set_freezable();
+
+	while (true) {
+		int i, added = 0;
+
+		wait_event_freezable(heap->refill_wait,
+				     ion_system_heap_refill_needed(heap));
+
+		for (i = 0; i < NUM_ORDERS; i++) {
+			if (!orders[i])
+				continue;
+			added += ion_page_pool_refill(heap->pools[i],
+						READ_ONCE(pool_refill_high));
+		}
+
+		/* out of memory or backing off, don't spin on the wakeups */
+		if (!added)
+			freezable_schedule_timeout_interruptible(HZ);
+	}
+
+	return 0;
+}
+
+static void ion_system_heap_init_refill(struct ion_system_heap *heap)
+{
+	struct sched_param param = { .sched_priority = 0 };
+
+	init_waitqueue_head(&heap->refill_wait);
+	heap->refill_task = kthread_run(ion_system_heap_refill, heap,
+					"%s_refill", heap->heap.name);
+	if (IS_ERR(heap->refill_task)) {
+		pr_err("%s: creating thread for pool refill failed\n",
+		       __func__);
+		heap->refill_task = NULL;
+		return;
+	}
+	sched_setscheduler(heap->refill_task, SCHED_IDLE, &param);
+}
+
+static void ion_system_heap_kick_refill(struct ion_system_heap *heap)
+{
+	if (heap->refill_task && ion_system_heap_refill_needed(heap))
+		wake_up(&heap->refill_wait);
+}
+#else
+static inline void ion_system_heap_init_refill(struct ion_system_heap *heap)
+{
+}
+
+static inline void ion_system_heap_kick_refill(struct ion_system_heap *heap)
+{
+}
+#endif
+
 static struct page *alloc_buffer_page(struct ion_system_heap *heap,
 				      struct ion_buffer *buffer,
 				      unsigned long order)
@@ -139,6 +226,7 @@ static int ion_system_heap_allocate(struct ion_heap *heap,
 	}
 
 	buffer->sg_table = table;
+	ion_system_heap_kick_refill(sys_heap);
 	return 0;
 
 free_table:
@@ -275,6 +363,8 @@ static int ion_system_heap_create(void)
 		return PTR_ERR(heap);
 	heap->name = "ion_system_heap";
 
+	ion_system_heap_init_refill(container_of(heap, struct ion_system_heap,
+						 heap));
 	ion_device_add_heap(heap);
 
 	return 0;
@@ -15,6 +15,7 @@
 
 #define pr_fmt(fmt) "Power allocator: " fmt
 
+#include <linux/ktime.h>
 #include <linux/rculist.h>
 #include <linux/slab.h>
 #include <linux/thermal.h>
@@ -70,6 +71,10 @@ static inline s64 div_frac(s64 x, s64 y)
  * @trip_max_desired_temperature:	last passive trip point of the thermal
  *					zone.  The temperature we are
  *					controlling for.
+ * @last_sample:	time of the previous run of the governor, 0 if none
+ * @sample_interval:	milliseconds between the previous and the current
+ *			run of the governor, 0 if unknown.  The interval
+ *			over which the last temperature change was seen.
  */
 struct power_allocator_params {
 	bool allocated_tzp;
@@ -77,6 +82,8 @@ struct power_allocator_params {
 	s32 prev_err;
 	int trip_switch_on;
 	int trip_max_desired_temperature;
+	ktime_t last_sample;
+	s64 sample_interval;
 };
 
 /**
@@ -171,6 +178,41 @@ static void estimate_pid_constants(struct thermal_zone_device *tz,
 	 */
 }
 
+/**
+ * predict_temperature() - temperature expected at the next sample
+ * @tz:	thermal zone we are operating in
+ *
+ * If the zone's predict_temp parameter is set and the zone is heating up,
+ * extrapolate the last rise of temperature one passive period ahead, so
+ * the budget is trimmed before the control temperature is overshot rather
+ * than after.  The rise is scaled from the interval it was measured over
+ * to the passive delay, but never beyond the rise itself, so an update
+ * coming in shortly after the previous one doesn't blow its noise up.  A
+ * falling temperature is not extrapolated: handing out power before the
+ * zone has actually cooled down only makes the controller oscillate.
+ *
+ * Return: the predicted temperature in millicelsius.
+ */
+static int predict_temperature(struct thermal_zone_device *tz)
+{
+	struct power_allocator_params *params = tz->governor_data;
+	s64 delta;
+
+	if (!tz->tzp->predict_temp || !params->sample_interval ||
+	    tz->last_temperature == THERMAL_TEMP_INVALID)
+		return tz->temperature;
+
+	delta = tz->temperature - tz->last_temperature;
+	if (delta <= 0)
+		return tz->temperature;
+
+	if (tz->passive_delay < params->sample_interval)
+		delta = div64_s64(delta * tz->passive_delay,
+				  params->sample_interval);
+
+	return tz->temperature + delta;
+}
+
 /**
  * pid_controller() - PID controller
  * @tz:	thermal zone we are operating in
@@ -185,7 +227,10 @@ static void estimate_pid_constants(struct thermal_zone_device *tz,
  * threshold below which we stop accumulating the error.  The
  * accumulated error is only valid if the requested power will make
  * the system warmer.  If the system is mostly idle, there's no point
- * in accumulating positive error.
+ * in accumulating positive error.  The proportional and integral
+ * terms take the error against the temperature predict_temperature()
+ * expects at the next sample, the derivative term keeps following the
+ * measured temperature.
  *
  * Return: The power budget for the next period.
  */
@@ -194,7 +239,7 @@ static u32 pid_controller(struct thermal_zone_device *tz,
 			  u32 max_allocatable_power)
 {
 	s64 p, i, d, power_range;
-	s32 err, max_power_frac;
+	s32 err, pred_err, max_power_frac;
 	u32 sustainable_power;
 	struct power_allocator_params *params = tz->governor_data;
 
@@ -211,9 +256,11 @@ static u32 pid_controller(struct thermal_zone_device *tz,
 
 	err = control_temp - tz->temperature;
 	err = int_to_frac(err);
+	pred_err = control_temp - predict_temperature(tz);
+	pred_err = int_to_frac(pred_err);
 
 	/* Calculate the proportional term */
-	p = mul_frac(err < 0 ? tz->tzp->k_po : tz->tzp->k_pu, err);
+	p = mul_frac(pred_err < 0 ? tz->tzp->k_po : tz->tzp->k_pu, pred_err);
 
 	/*
 	 * Calculate the integral term
@@ -223,12 +270,12 @@ static u32 pid_controller(struct thermal_zone_device *tz,
 	 */
 	i = mul_frac(tz->tzp->k_i, params->err_integral);
 
-	if (err < int_to_frac(tz->tzp->integral_cutoff)) {
-		s64 i_next = i + mul_frac(tz->tzp->k_i, err);
+	if (pred_err < int_to_frac(tz->tzp->integral_cutoff)) {
+		s64 i_next = i + mul_frac(tz->tzp->k_i, pred_err);
 
 		if (abs(i_next) < max_power_frac) {
 			i = i_next;
-			params->err_integral += err;
+			params->err_integral += pred_err;
 		}
 	}
 
@@ -250,7 +297,7 @@ static u32 pid_controller(struct thermal_zone_device *tz,
 
 	power_range = clamp(power_range, (s64)0, (s64)max_allocatable_power);
 
-	trace_thermal_power_allocator_pid(tz, frac_to_int(err),
+	trace_thermal_power_allocator_pid(tz, frac_to_int(pred_err),
 					  frac_to_int(params->err_integral),
 					  frac_to_int(p), frac_to_int(i),
 					  frac_to_int(d), power_range);
@@ -614,6 +661,7 @@ static int power_allocator_throttle(struct thermal_zone_device *tz, int trip)
 	int ret;
 	int switch_on_temp, control_temp;
 	struct power_allocator_params *params = tz->governor_data;
+	ktime_t now;
 
 	/*
 	 * We get called for every trip point but we only need to do
@@ -622,6 +670,11 @@ static int power_allocator_throttle(struct thermal_zone_device *tz, int trip)
 	if (trip != params->trip_max_desired_temperature)
 		return 0;
 
+	now = ktime_get();
+	params->sample_interval = params->last_sample ?
+				  ktime_ms_delta(now, params->last_sample) : 0;
+	params->last_sample = now;
+
 	ret = tz->ops->get_trip_temp(tz, params->trip_switch_on,
 				     &switch_on_temp);
 	if (!ret && (tz->temperature < switch_on_temp)) {
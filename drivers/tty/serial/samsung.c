@@ -356,7 +356,7 @@ static void s3c24xx_serial_start_tx(struct uart_port *port)
 }
 
 static void s3c24xx_uart_copy_rx_to_tty(struct s3c24xx_uart_port *ourport,
-		struct tty_port *tty, int count)
+		struct tty_port *tty, unsigned int offset, int count)
 {
 	struct s3c24xx_uart_dma *dma = ourport->dma;
 	int copied;
@@ -364,8 +364,8 @@ static void s3c24xx_uart_copy_rx_to_tty(struct s3c24xx_uart_port *ourport,
 	if (!count)
 		return;
 
-	dma_sync_single_for_cpu(ourport->port.dev, dma->rx_addr,
-				dma->rx_size, DMA_FROM_DEVICE);
+	dma_sync_single_for_cpu(ourport->port.dev, dma->rx_addr + offset,
+				dma->rx_size / 2, DMA_FROM_DEVICE);
 
 	ourport->port.icount.rx += count;
 	if (!tty) {
@@ -373,7 +373,7 @@ static void s3c24xx_uart_copy_rx_to_tty(struct s3c24xx_uart_port *ourport,
 		return;
 	}
 	copied = tty_insert_flip_string(tty,
-			((unsigned char *)(ourport->dma->rx_buf)), count);
+			((unsigned char *)(dma->rx_buf + offset)), count);
 	if (copied != count) {
 		WARN_ON(1);
 		dev_err(ourport->port.dev, "RxData copy to tty layer failed\n");
@@ -406,7 +406,8 @@ static void s3c24xx_serial_stop_rx(struct uart_port *port)
 			dma_status == DMA_PAUSED) {
 			received = dma->rx_bytes_requested - state.residue;
 			dmaengine_terminate_all(dma->rx_chan);
-			s3c24xx_uart_copy_rx_to_tty(ourport, t, received);
+			s3c24xx_uart_copy_rx_to_tty(ourport, t,
+						    dma->rx_offset, received);
 		}
 	}
 }
@@ -452,6 +453,7 @@ static void s3c24xx_serial_rx_dma_complete(void *args)
 
 	struct dma_tx_state state;
 	unsigned long flags;
+	unsigned int offset = dma->rx_offset;
 	int received;
 
 	dmaengine_tx_status(dma->rx_chan,  dma->rx_cookie, &state);
@@ -460,29 +462,38 @@ static void s3c24xx_serial_rx_dma_complete(void *args)
 
 	spin_lock_irqsave(&port->lock, flags);
 
+	/*
+	 * The FIFO keeps filling while the data is handed to the tty layer,
+	 * and at a few Mbaud it overflows within that time. So get the next
+	 * transfer going into the other half of the buffer first.
+	 */
+	s3c64xx_start_rx_dma(ourport);
+
 	if (received)
-		s3c24xx_uart_copy_rx_to_tty(ourport, t, received);
+		s3c24xx_uart_copy_rx_to_tty(ourport, t, offset, received);
 
 	if (tty) {
 		tty_flip_buffer_push(t);
 		tty_kref_put(tty);
 	}
 
-	s3c64xx_start_rx_dma(ourport);
-
 	spin_unlock_irqrestore(&port->lock, flags);
 }
 
 static void s3c64xx_start_rx_dma(struct s3c24xx_uart_port *ourport)
 {
 	struct s3c24xx_uart_dma *dma = ourport->dma;
+	size_t size = dma->rx_size / 2;
 
-	dma_sync_single_for_device(ourport->port.dev, dma->rx_addr,
-				dma->rx_size, DMA_FROM_DEVICE);
+	dma->rx_offset = dma->rx_offset ? 0 : size;
+
+	dma_sync_single_for_device(ourport->port.dev,
+				dma->rx_addr + dma->rx_offset, size,
+				DMA_FROM_DEVICE);
 
 	dma->rx_desc = dmaengine_prep_slave_single(dma->rx_chan,
-				dma->rx_addr, dma->rx_size, DMA_DEV_TO_MEM,
-				DMA_PREP_INTERRUPT);
+				dma->rx_addr + dma->rx_offset, size,
+				DMA_DEV_TO_MEM, DMA_PREP_INTERRUPT);
 	if (!dma->rx_desc) {
 		dev_err(ourport->port.dev, "Unable to get desc for Rx\n");
 		return;
@@ -490,7 +501,7 @@ static void s3c64xx_start_rx_dma(struct s3c24xx_uart_port *ourport)
 
 	dma->rx_desc->callback = s3c24xx_serial_rx_dma_complete;
 	dma->rx_desc->callback_param = ourport;
-	dma->rx_bytes_requested = dma->rx_size;
+	dma->rx_bytes_requested = size;
 
 	dma->rx_cookie = dmaengine_submit(dma->rx_desc);
 	dma_async_issue_pending(dma->rx_chan);
@@ -572,7 +583,8 @@ static irqreturn_t s3c24xx_serial_rx_chars_dma(void *dev_id)
 		dmaengine_tx_status(dma->rx_chan, dma->rx_cookie, &state);
 		dmaengine_terminate_all(dma->rx_chan);
 		received = dma->rx_bytes_requested - state.residue;
-		s3c24xx_uart_copy_rx_to_tty(ourport, t, received);
+		s3c24xx_uart_copy_rx_to_tty(ourport, t, dma->rx_offset,
+					    received);
 
 		enable_rx_pio(ourport);
 	}
@@ -906,7 +918,7 @@ static int s3c24xx_serial_request_dma(struct s3c24xx_uart_port *p)
 
 	dmaengine_slave_config(dma->tx_chan, &dma->tx_conf);
 
-	/* RX buffer */
+	/* RX buffer, used as two halves by alternating transfers */
 	dma->rx_size = PAGE_SIZE;
 
 	dma->rx_buf = kmalloc(dma->rx_size, GFP_KERNEL);
@@ -57,6 +57,8 @@ struct s3c24xx_uart_dma {
 	dma_cookie_t			tx_cookie;
 
 	char				*rx_buf;
+	/* Half of rx_buf the running RX transfer writes to */
+	unsigned int			rx_offset;
 
 	dma_addr_t			tx_transfer_addr;
 
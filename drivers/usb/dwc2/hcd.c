@@ -2735,14 +2735,24 @@ enum dwc2_transaction_type dwc2_hcd_select_transactions(
 			hsotg->available_host_channels--;
 		}
 		qh = list_entry(qh_ptr, struct dwc2_qh, qh_list_entry);
-		if (dwc2_assign_and_init_hc(hsotg, qh))
-			break;
+		qh_ptr = qh_ptr->next;
+
+		/*
+		 * A free channel was available, so a failure here is
+		 * specific to this QH. Give the channel back and let the
+		 * QHs behind it in the schedule have a go instead of
+		 * stalling all of them.
+		 */
+		if (dwc2_assign_and_init_hc(hsotg, qh)) {
+			if (hsotg->params.uframe_sched)
+				hsotg->available_host_channels++;
+			continue;
+		}
 
 		/*
 		 * Move the QH from the periodic ready schedule to the
 		 * periodic assigned schedule
 		 */
-		qh_ptr = qh_ptr->next;
 		list_move_tail(&qh->qh_list_entry,
 			       &hsotg->periodic_sched_assigned);
 		ret_val = DWC2_TRANSACTION_PERIODIC;
@@ -2769,14 +2779,18 @@ enum dwc2_transaction_type dwc2_hcd_select_transactions(
 			hsotg->available_host_channels--;
 		}
 
-		if (dwc2_assign_and_init_hc(hsotg, qh))
-			break;
+		qh_ptr = qh_ptr->next;
+
+		if (dwc2_assign_and_init_hc(hsotg, qh)) {
+			if (hsotg->params.uframe_sched)
+				hsotg->available_host_channels++;
+			continue;
+		}
 
 		/*
 		 * Move the QH from the non-periodic inactive schedule to the
 		 * non-periodic active schedule
 		 */
-		qh_ptr = qh_ptr->next;
 		list_move_tail(&qh->qh_list_entry,
 			       &hsotg->non_periodic_sched_active);
 
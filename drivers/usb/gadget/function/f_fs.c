@@ -15,6 +15,7 @@
 /* #define VERBOSE_DEBUG */
 
 #include <linux/blkdev.h>
+#include <linux/dma-mapping.h>
 #include <linux/pagemap.h>
 #include <linux/export.h>
 #include <linux/hid.h>
@@ -225,6 +226,10 @@ struct ffs_io_data {
 	struct sg_table sgt;
 	bool use_sg;
 
+	/* user pages the request is DMAed to or from directly, if any */
+	struct page **pages;
+	unsigned int n_pages;
+
 	struct ffs_data *ffs;
 };
 
@@ -801,8 +806,78 @@ static inline void *ffs_alloc_buffer(struct ffs_io_data *io_data,
 	return kmalloc(data_len, GFP_KERNEL);
 }
 
+/*
+ * Large transfers on a controller with scatter-gather support do not need
+ * the bounce buffer when the user buffer is a single segment covering the
+ * whole request: pin its pages and let the controller DMA to or from them
+ * directly.
+ */
+static int ffs_pin_user_buffer(struct ffs_io_data *io_data, size_t data_len)
+{
+	unsigned long align = dma_get_cache_alignment() - 1;
+	struct page **pages;
+	unsigned int n_pages, i;
+	unsigned long start;
+	size_t offset;
+	ssize_t len;
+	int ret = -EFAULT;
+
+	if (!iter_is_iovec(&io_data->data) || io_data->data.nr_segs != 1)
+		return -EINVAL;
+
+	/*
+	 * On non-coherent platforms the cache maintenance done for the DMA
+	 * works on whole cache lines: a buffer sharing a line with unrelated
+	 * user data could have that data corrupted, or, for reads, see stale
+	 * bytes. Leave such buffers to the bounce buffer.
+	 */
+	start = (unsigned long)io_data->data.iov->iov_base +
+		io_data->data.iov_offset;
+	if ((start | data_len) & align)
+		return -EINVAL;
+
+	len = iov_iter_get_pages_alloc(&io_data->data, &pages, data_len,
+				       &offset);
+	if (len < 0)
+		return len;
+
+	n_pages = DIV_ROUND_UP(offset + len, PAGE_SIZE);
+	if (len == data_len)
+		ret = sg_alloc_table_from_pages(&io_data->sgt, pages, n_pages,
+						offset, data_len, GFP_KERNEL);
+	if (ret) {
+		for (i = 0; i < n_pages; i++)
+			put_page(pages[i]);
+		kvfree(pages);
+		return ret;
+	}
+
+	io_data->pages = pages;
+	io_data->n_pages = n_pages;
+	return 0;
+}
+
+static void ffs_unpin_user_buffer(struct ffs_io_data *io_data)
+{
+	unsigned int i;
+
+	sg_free_table(&io_data->sgt);
+	for (i = 0; i < io_data->n_pages; i++) {
+		if (io_data->read)
+			set_page_dirty_lock(io_data->pages[i]);
+		put_page(io_data->pages[i]);
+	}
+	kvfree(io_data->pages);
+	io_data->pages = NULL;
+}
+
 static inline void ffs_free_buffer(struct ffs_io_data *io_data)
 {
+	if (io_data->pages) {
+		ffs_unpin_user_buffer(io_data);
+		return;
+	}
+
 	if (!io_data->buf)
 		return;
 
@@ -822,7 +897,7 @@ static void ffs_user_copy_worker(struct work_struct *work)
 					 io_data->req->actual;
 	bool kiocb_has_eventfd = io_data->kiocb->ki_flags & IOCB_EVENTFD;
 
-	if (io_data->read && ret > 0) {
+	if (io_data->read && ret > 0 && !io_data->pages) {
 		mm_segment_t oldfs = get_fs();
 
 		set_fs(USER_DS);
@@ -1015,15 +1090,23 @@ static ssize_t ffs_epfile_io(struct file *file, struct ffs_io_data *io_data)
 		io_data->use_sg = gadget->sg_supported && data_len > PAGE_SIZE;
 		spin_unlock_irq(&epfile->ffs->eps_lock);
 
-		data = ffs_alloc_buffer(io_data, data_len);
-		if (unlikely(!data)) {
-			ret = -ENOMEM;
-			goto error_mutex;
-		}
-		if (!io_data->read &&
-		    !copy_from_iter_full(data, data_len, &io_data->data)) {
-			ret = -EFAULT;
-			goto error_mutex;
+		if (io_data->use_sg &&
+		    data_len == iov_iter_count(&io_data->data) &&
+		    !ffs_pin_user_buffer(io_data, data_len)) {
+			if (!io_data->read)
+				iov_iter_advance(&io_data->data, data_len);
+		} else {
+			data = ffs_alloc_buffer(io_data, data_len);
+			if (unlikely(!data)) {
+				ret = -ENOMEM;
+				goto error_mutex;
+			}
+			if (!io_data->read &&
+			    !copy_from_iter_full(data, data_len,
+						 &io_data->data)) {
+				ret = -EFAULT;
+				goto error_mutex;
+			}
 		}
 	}
 
@@ -1087,13 +1170,17 @@ static ssize_t ffs_epfile_io(struct file *file, struct ffs_io_data *io_data)
 			interrupted = ep->status < 0;
 		}
 
-		if (interrupted)
+		if (interrupted) {
 			ret = -EINTR;
-		else if (io_data->read && ep->status > 0)
+		} else if (io_data->read && ep->status > 0 && io_data->pages) {
+			iov_iter_advance(&io_data->data, ep->status);
+			ret = ep->status;
+		} else if (io_data->read && ep->status > 0) {
 			ret = __ffs_epfile_read_data(epfile, data, ep->status,
 						     &io_data->data);
-		else
+		} else {
 			ret = ep->status;
+		}
 		goto error_mutex;
 	} else if (!(req = usb_ep_alloc_request(ep->ep, GFP_ATOMIC))) {
 		ret = -ENOMEM;
@@ -64,6 +64,14 @@ struct eth_dev {
 
 	struct sk_buff_head	rx_frames;
 
+	/* frames handed from rx_complete() to eth_poll() */
+	struct sk_buff_head	rx_napi_frames;
+	struct napi_struct	napi;
+
+	/* framing statistics, see eth_get_ethtool_stats() */
+	unsigned long		rx_transfers, rx_datagrams;
+	unsigned long		tx_transfers, tx_datagrams;
+
 	unsigned		qmult;
 
 	unsigned		header_len;
@@ -154,9 +162,48 @@ static void eth_get_drvinfo(struct net_device *net, struct ethtool_drvinfo *p)
  *   - ... probably more ethtool ops
  */
 
+/*
+ * With NCM and RNDIS one USB transfer can carry several ethernet frames;
+ * comparing the transfer and datagram counts shows how well that
+ * aggregation works in each direction.
+ */
+static const char eth_stats_strings[][ETH_GSTRING_LEN] = {
+	"rx_transfers",
+	"rx_datagrams",
+	"tx_transfers",
+	"tx_datagrams",
+};
+
+static int eth_get_sset_count(struct net_device *net, int sset)
+{
+	if (sset != ETH_SS_STATS)
+		return -EOPNOTSUPP;
+	return ARRAY_SIZE(eth_stats_strings);
+}
+
+static void eth_get_strings(struct net_device *net, u32 sset, u8 *data)
+{
+	if (sset == ETH_SS_STATS)
+		memcpy(data, eth_stats_strings, sizeof(eth_stats_strings));
+}
+
+static void eth_get_ethtool_stats(struct net_device *net,
+				  struct ethtool_stats *stats, u64 *data)
+{
+	struct eth_dev *dev = netdev_priv(net);
+
+	data[0] = READ_ONCE(dev->rx_transfers);
+	data[1] = READ_ONCE(dev->rx_datagrams);
+	data[2] = READ_ONCE(dev->tx_transfers);
+	data[3] = READ_ONCE(dev->tx_datagrams);
+}
+
 static const struct ethtool_ops ops = {
 	.get_drvinfo = eth_get_drvinfo,
 	.get_link = ethtool_op_get_link,
+	.get_sset_count = eth_get_sset_count,
+	.get_strings = eth_get_strings,
+	.get_ethtool_stats = eth_get_ethtool_stats,
 };
 
 static void defer_kevent(struct eth_dev *dev, int flag)
@@ -261,6 +308,7 @@ static void rx_complete(struct usb_ep *ep, struct usb_request *req)
 	/* normal completion */
 	case 0:
 		skb_put(skb, req->actual);
+		dev->rx_transfers++;
 
 		if (dev->unwrap) {
 			unsigned long	flags;
@@ -291,17 +339,26 @@ static void rx_complete(struct usb_ep *ep, struct usb_request *req)
 				dev_kfree_skb_any(skb2);
 				goto next_frame;
 			}
+			if (!netif_running(dev->net)) {
+				dev_kfree_skb_any(skb2);
+				goto next_frame;
+			}
 			skb2->protocol = eth_type_trans(skb2, dev->net);
 			dev->net->stats.rx_packets++;
 			dev->net->stats.rx_bytes += skb2->len;
+			dev->rx_datagrams++;
 
 			/* no buffer copies needed, unless hardware can't
-			 * use skb buffers.
+			 * use skb buffers.  This runs in the UDC's irq
+			 * handler, so defer the frames to NAPI, where GRO
+			 * can merge the frames of a multi-datagram transfer.
 			 */
-			status = netif_rx(skb2);
+			skb_queue_tail(&dev->rx_napi_frames, skb2);
 next_frame:
 			skb2 = skb_dequeue(&dev->rx_frames);
 		}
+		if (!skb_queue_empty(&dev->rx_napi_frames))
+			napi_schedule(&dev->napi);
 		break;
 
 	/* software-driven interface shutdown */
@@ -540,6 +597,9 @@ static netdev_tx_t eth_start_xmit(struct sk_buff *skb,
 	 * or the hardware can't use skb buffers.
 	 * or there's not enough space for extra headers we need
 	 */
+	if (skb)
+		dev->tx_datagrams++;
+
 	if (dev->wrap) {
 		unsigned long	flags;
 
@@ -589,6 +649,7 @@ static netdev_tx_t eth_start_xmit(struct sk_buff *skb,
 	case 0:
 		netif_trans_update(net);
 		atomic_inc(&dev->tx_qlen);
+		dev->tx_transfers++;
 	}
 
 	if (retval) {
@@ -607,6 +668,27 @@ static netdev_tx_t eth_start_xmit(struct sk_buff *skb,
 
 /*-------------------------------------------------------------------------*/
 
+static int eth_poll(struct napi_struct *napi, int budget)
+{
+	struct eth_dev	*dev = container_of(napi, struct eth_dev, napi);
+	struct sk_buff	*skb;
+	int		work = 0;
+
+	while (work < budget) {
+		skb = skb_dequeue(&dev->rx_napi_frames);
+		if (!skb)
+			break;
+		napi_gro_receive(napi, skb);
+		work++;
+	}
+
+	if (work < budget && napi_complete_done(napi, work) &&
+	    !skb_queue_empty(&dev->rx_napi_frames))
+		napi_schedule(napi);
+
+	return work;
+}
+
 static void eth_start(struct eth_dev *dev, gfp_t gfp_flags)
 {
 	DBG(dev, "%s\n", __func__);
@@ -625,6 +707,7 @@ static int eth_open(struct net_device *net)
 	struct gether	*link;
 
 	DBG(dev, "%s\n", __func__);
+	napi_enable(&dev->napi);
 	if (netif_carrier_ok(dev->net))
 		eth_start(dev, GFP_KERNEL);
 
@@ -644,6 +727,8 @@ static int eth_stop(struct net_device *net)
 
 	VDBG(dev, "%s\n", __func__);
 	netif_stop_queue(net);
+	napi_disable(&dev->napi);
+	skb_queue_purge(&dev->rx_napi_frames);
 
 	DBG(dev, "stop stats: rx/tx %ld/%ld, errs %ld/%ld\n",
 		dev->net->stats.rx_packets, dev->net->stats.tx_packets,
@@ -718,7 +803,26 @@ static int get_ether_addr_str(u8 dev_addr[ETH_ALEN], char *str, int len)
 	return 18;
 }
 
+static int eth_init(struct net_device *net)
+{
+	struct eth_dev	*dev = netdev_priv(net);
+
+	skb_queue_head_init(&dev->rx_napi_frames);
+	netif_napi_add(net, &dev->napi, eth_poll, NAPI_POLL_WEIGHT);
+	return 0;
+}
+
+static void eth_uninit(struct net_device *net)
+{
+	struct eth_dev	*dev = netdev_priv(net);
+
+	netif_napi_del(&dev->napi);
+	skb_queue_purge(&dev->rx_napi_frames);
+}
+
 static const struct net_device_ops eth_netdev_ops = {
+	.ndo_init		= eth_init,
+	.ndo_uninit		= eth_uninit,
 	.ndo_open		= eth_open,
 	.ndo_stop		= eth_stop,
 	.ndo_start_xmit		= eth_start_xmit,
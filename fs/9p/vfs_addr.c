@@ -20,6 +20,7 @@
 #include <linux/sched.h>
 #include <linux/uio.h>
 #include <linux/bvec.h>
+#include <linux/slab.h>
 #include <net/9p/9p.h>
 #include <net/9p/client.h>
 
@@ -85,6 +86,88 @@ static int v9fs_vfs_readpage(struct file *filp, struct page *page)
 	return v9fs_fid_readpage(filp->private_data, page);
 }
 
+/**
+ * v9fs_fid_readpages - read runs of contiguous pages with one 9P read each
+ *
+ * @fid: fid being read
+ * @mapping: the address space
+ * @pages: list of pages to read, as handed to ->readpages()
+ * @max_pages: the most pages to read with one p9_client_read()
+ *
+ * Pages left on @pages on return are released by the caller.
+ */
+
+static int v9fs_fid_readpages(struct p9_fid *fid, struct address_space *mapping,
+			      struct list_head *pages, unsigned int max_pages)
+{
+	struct inode *inode = mapping->host;
+	gfp_t gfp = readahead_gfp_mask(mapping);
+	struct bio_vec *bvecs;
+	struct iov_iter to;
+	unsigned int nr, i;
+	int retval, err;
+
+	bvecs = kmalloc_array(max_pages, sizeof(*bvecs), GFP_KERNEL);
+	if (!bvecs)
+		return -ENOMEM;
+
+	while (!list_empty(pages)) {
+		struct page *page;
+		pgoff_t next = 0;
+
+		/* gather a run of consecutive pages into the page cache */
+		nr = 0;
+		while (nr < max_pages && !list_empty(pages)) {
+			page = lru_to_page(pages);
+			if (nr && page->index != next)
+				break;
+			list_del(&page->lru);
+			if (add_to_page_cache_lru(page, mapping, page->index,
+						  gfp)) {
+				put_page(page);
+				if (nr)
+					break;
+				continue;
+			}
+			bvecs[nr].bv_page = page;
+			bvecs[nr].bv_offset = 0;
+			bvecs[nr].bv_len = PAGE_SIZE;
+			next = page->index + 1;
+			nr++;
+		}
+		if (!nr)
+			continue;
+
+		iov_iter_bvec(&to, READ, bvecs, nr, nr * PAGE_SIZE);
+		retval = p9_client_read(fid, page_offset(bvecs[0].bv_page),
+					&to, &err);
+
+		for (i = 0; i < nr; i++) {
+			page = bvecs[i].bv_page;
+			if (err) {
+				v9fs_uncache_page(inode, page);
+			} else {
+				int done = clamp(retval - (int)(i * PAGE_SIZE),
+						 0, (int)PAGE_SIZE);
+
+				zero_user(page, done, PAGE_SIZE - done);
+				flush_dcache_page(page);
+				SetPageUptodate(page);
+				v9fs_readpage_to_fscache(inode, page);
+			}
+			unlock_page(page);
+			put_page(page);
+		}
+		if (err) {
+			kfree(bvecs);
+			return err;
+		}
+	}
+
+	kfree(bvecs);
+	return 0;
+}
+
 /**
  * v9fs_vfs_readpages - read a set of pages from 9P
  *
@@ -100,6 +183,7 @@ static int v9fs_vfs_readpages(struct file *filp, struct address_space *mapping,
 {
 	int ret = 0;
 	struct inode *inode;
+	unsigned int max_pages;
 
 	inode = mapping->host;
 	p9_debug(P9_DEBUG_VFS, "inode: %p file: %p\n", inode, filp);
@@ -108,8 +192,13 @@ static int v9fs_vfs_readpages(struct file *filp, struct address_space *mapping,
 	if (ret == 0)
 		return ret;
 
-	ret = read_cache_pages(mapping, pages, v9fs_fid_readpage,
-			filp->private_data);
+	max_pages = v9fs_inode2v9ses(inode)->maxdata >> PAGE_SHIFT;
+	if (max_pages > 1)
+		ret = v9fs_fid_readpages(filp->private_data, mapping, pages,
+					 min(max_pages, nr_pages));
+	else
+		ret = read_cache_pages(mapping, pages, v9fs_fid_readpage,
+				filp->private_data);
 	p9_debug(P9_DEBUG_VFS, "  = %d\n", ret);
 	return ret;
 }
@@ -76,8 +76,10 @@ v9fs_fill_super(struct super_block *sb, struct v9fs_session_info *v9ses,
 	if (ret)
 		return ret;
 
+	/* let readahead fill whole 9P reads when msize is large */
 	if (v9ses->cache)
-		sb->s_bdi->ra_pages = VM_READAHEAD_PAGES;
+		sb->s_bdi->ra_pages = max_t(unsigned long, VM_READAHEAD_PAGES,
+					    v9ses->maxdata >> PAGE_SHIFT);
 
 	sb->s_flags |= SB_ACTIVE | SB_DIRSYNC;
 	if (!v9ses->cache)
@@ -29,6 +29,13 @@
 
 #define AFS_CELL_MAX_ADDRS 15
 
+/*
+ * Readahead window.  Each readahead batch turns into a single FetchData call
+ * that we have to wait for, so it needs to be large enough to cover the
+ * round trip to the fileserver on a fast link.
+ */
+#define AFS_READAHEAD_SIZE	(1024 * 1024)
+
 struct pagevec;
 struct afs_call;
 
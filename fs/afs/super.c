@@ -442,7 +442,7 @@ static int afs_fill_super(struct super_block *sb, struct afs_fs_context *ctx)
 	ret = super_setup_bdi(sb);
 	if (ret)
 		return ret;
-	sb->s_bdi->ra_pages	= VM_READAHEAD_PAGES;
+	sb->s_bdi->ra_pages	= AFS_READAHEAD_SIZE / PAGE_SIZE;
 
 	/* allocate the root inode and dentry */
 	if (as->dyn_root) {
@@ -675,6 +675,92 @@ static int cachefiles_read_backing_file(struct cachefiles_object *object,
 	goto out;
 }
 
+/*
+ * State for finding out which pages of a backing file hold data.
+ *
+ * Extents are looked up with SEEK_DATA/SEEK_HOLE, which reports errors and
+ * covers many pages per call; the last one found is remembered so that a run
+ * of pages needs only a couple of seeks.  If the backing file can't be opened
+ * or seeked, we fall back to probing each page with bmap().
+ */
+struct cachefiles_probe {
+	struct inode	*inode;
+	struct file	*file;
+	loff_t		from;		/* [from, data) is a hole */
+	loff_t		data;		/* [data, hole) holds data */
+	loff_t		hole;
+	unsigned	shift;		/* shift required to use bmap */
+};
+
+static void cachefiles_probe_init(struct cachefiles_probe *probe,
+				  struct cachefiles_cache *cache,
+				  struct cachefiles_object *object)
+{
+	struct path path = {
+		.mnt	= cache->mnt,
+		.dentry	= object->backer,
+	};
+
+	probe->inode = d_backing_inode(object->backer);
+	probe->shift = PAGE_SHIFT - probe->inode->i_sb->s_blocksize_bits;
+	probe->from = probe->data = probe->hole = -1;
+	probe->file = dentry_open(&path, O_RDONLY | O_LARGEFILE,
+				  cache->cache_cred);
+	if (IS_ERR(probe->file))
+		probe->file = NULL;
+}
+
+static void cachefiles_probe_end(struct cachefiles_probe *probe)
+{
+	if (probe->file)
+		fput(probe->file);
+}
+
+/*
+ * we assume the absence or presence of the first block is a good enough
+ * indication for the page as a whole
+ */
+static bool cachefiles_probe_page(struct cachefiles_probe *probe,
+				  pgoff_t index)
+{
+	loff_t pos = (loff_t)index << PAGE_SHIFT;
+	sector_t block0, block;
+
+	if (probe->file) {
+		if (pos < probe->from || pos >= probe->hole) {
+			loff_t data, hole = LLONG_MAX;
+
+			data = vfs_llseek(probe->file, pos, SEEK_DATA);
+			if (data == -ENXIO)
+				data = LLONG_MAX;
+			else if (data >= 0)
+				hole = vfs_llseek(probe->file, data, SEEK_HOLE);
+			if (data < 0 || hole < 0) {
+				fput(probe->file);
+				probe->file = NULL;
+				goto use_bmap;
+			}
+			probe->from = pos;
+			probe->data = data;
+			probe->hole = hole;
+		}
+		_debug("%llx -> %s", (unsigned long long) pos,
+		       pos >= probe->data ? "data" : "hole");
+		return pos >= probe->data;
+	}
+
+use_bmap:
+	block0 = index;
+	block0 <<= probe->shift;
+
+	block = probe->inode->i_mapping->a_ops->bmap(probe->inode->i_mapping,
+						     block0);
+	_debug("%llx -> %llx",
+	       (unsigned long long) block0,
+	       (unsigned long long) block);
+	return block != 0;
+}
+
 /*
  * read a list of pages from the cache or allocate blocks in which to store
  * them
@@ -686,11 +772,12 @@ int cachefiles_read_or_alloc_pages(struct fscache_retrieval *op,
 {
 	struct cachefiles_object *object;
 	struct cachefiles_cache *cache;
+	struct cachefiles_probe probe;
 	struct list_head backpages;
 	struct pagevec pagevec;
 	struct inode *inode;
 	struct page *page, *_n;
-	unsigned shift, nrbackpages;
+	unsigned nrbackpages;
 	int ret, ret2, space;
 
 	object = container_of(op->op.object,
@@ -714,10 +801,8 @@ int cachefiles_read_or_alloc_pages(struct fscache_retrieval *op,
 	ASSERT(inode->i_mapping->a_ops->bmap);
 	ASSERT(inode->i_mapping->a_ops->readpages);
 
-	/* calculate the shift required to use bmap */
-	shift = PAGE_SHIFT - inode->i_sb->s_blocksize_bits;
-
 	pagevec_init(&pagevec);
+	cachefiles_probe_init(&probe, cache, object);
 
 	op->op.flags &= FSCACHE_OP_KEEP_FLAGS;
 	op->op.flags |= FSCACHE_OP_ASYNC;
@@ -727,28 +812,13 @@ int cachefiles_read_or_alloc_pages(struct fscache_retrieval *op,
 	nrbackpages = 0;
 
 	ret = space ? -ENODATA : -ENOBUFS;
-	list_for_each_entry_safe(page, _n, pages, lru) {
-		sector_t block0, block;
-
-		/* we assume the absence or presence of the first block is a
-		 * good enough indication for the page as a whole
-		 * - TODO: don't use bmap() for this as it is _not_ actually
-		 *   good enough for this as it doesn't indicate errors, but
-		 *   it's all we've got for the moment
-		 */
-		block0 = page->index;
-		block0 <<= shift;
-
-		block = inode->i_mapping->a_ops->bmap(inode->i_mapping,
-						      block0);
-		_debug("%llx -> %llx",
-		       (unsigned long long) block0,
-		       (unsigned long long) block);
-
-		if (block) {
+	/* walk the pages in ascending index order so that the probe's cached
+	 * extent can answer for runs of them */
+	list_for_each_entry_safe_reverse(page, _n, pages, lru) {
+		if (cachefiles_probe_page(&probe, page->index)) {
 			/* we have data - add it to the list to give to the
 			 * backing fs */
-			list_move(&page->lru, &backpages);
+			list_move_tail(&page->lru, &backpages);
 			(*nr_pages)--;
 			nrbackpages++;
 		} else if (space && pagevec_add(&pagevec, page) == 0) {
@@ -760,6 +830,8 @@ int cachefiles_read_or_alloc_pages(struct fscache_retrieval *op,
 		}
 	}
 
+	cachefiles_probe_end(&probe);
+
 	if (pagevec_count(&pagevec) > 0)
 		fscache_mark_pages_cached(op, &pagevec);
 
@@ -4012,9 +4012,10 @@ void ceph_handle_caps(struct ceph_mds_session *session,
 	/*
 	 * send any cap release message to try to move things
 	 * along for the mds (who clearly thinks we still have this
-	 * cap).
+	 * cap).  These tend to come in bursts, so let the releases
+	 * for a burst go out together.
 	 */
-	ceph_flush_cap_releases(mdsc, session);
+	ceph_queue_cap_releases(mdsc, session);
 	goto done;
 
 bad:
@@ -906,6 +906,70 @@ static void ceph_aio_retry_work(struct work_struct *work)
 	kfree(aio_work);
 }
 
+/*
+ * Wait for the oldest in-flight request of a synchronous direct read or
+ * write and account for it.  Requests cover consecutive file ranges and are
+ * completed in submission order, starting at *done.  A NULL @done
+ * waits for the request and throws its result away.
+ *
+ * Returns the number of bytes the request completed, or a negative error.
+ */
+static ssize_t ceph_direct_wait_one(struct inode *inode,
+				    struct list_head *inflight, loff_t *done,
+				    bool write, bool should_dirty)
+{
+	struct ceph_osd_request *req;
+	struct ceph_osd_data *osd_data;
+	ssize_t len;
+	loff_t size;
+	int ret;
+
+	req = list_first_entry(inflight, struct ceph_osd_request,
+			       r_private_item);
+	list_del_init(&req->r_private_item);
+	osd_data = osd_req_op_extent_osd_data(req, 0);
+	len = osd_data->bvec_pos.iter.bi_size;
+
+	ret = ceph_osdc_wait_request(req->r_osdc, req);
+	if (!done)
+		goto out;
+
+	size = i_size_read(inode);
+	if (!write) {
+		if (ret == -ENOENT)
+			ret = 0;
+		if (ret >= 0 && ret < len && *done + ret < size) {
+			struct iov_iter i;
+			int zlen = min_t(size_t, len - ret,
+					 size - *done - ret);
+
+			iov_iter_bvec(&i, READ, osd_data->bvec_pos.bvecs,
+				      osd_data->num_bvecs, len);
+			iov_iter_advance(&i, ret);
+			iov_iter_zero(zlen, &i);
+			ret += zlen;
+		}
+		if (ret >= 0)
+			len = ret;
+	}
+
+out:
+	put_bvecs(osd_data->bvec_pos.bvecs, osd_data->num_bvecs,
+		  should_dirty);
+	ceph_osdc_put_request(req);
+	if (ret < 0 || !done)
+		return ret;
+
+	*done += len;
+	if (write && *done > size) {
+		if (ceph_inode_set_size(inode, *done))
+			ceph_check_caps(ceph_inode(inode),
+					CHECK_CAPS_AUTHONLY,
+					NULL);
+	}
+	return len;
+}
+
 static ssize_t
 ceph_direct_read_write(struct kiocb *iocb, struct iov_iter *iter,
 		       struct ceph_snap_context *snapc,
@@ -919,12 +983,15 @@ ceph_direct_read_write(struct kiocb *iocb, struct iov_iter *iter,
 	struct ceph_osd_request *req;
 	struct bio_vec *bvecs;
 	struct ceph_aio_request *aio_req = NULL;
+	LIST_HEAD(inflight);
+	unsigned int nr_inflight = 0;
 	int num_pages = 0;
 	int flags;
 	int ret;
 	struct timespec64 mtime = current_time(inode);
 	size_t count = iov_iter_count(iter);
 	loff_t pos = iocb->ki_pos;
+	loff_t done = pos;
 	bool write = iov_iter_rw(iter) == WRITE;
 	bool should_dirty = !write && iter_is_iovec(iter);
 
@@ -1032,45 +1099,60 @@ ceph_direct_read_write(struct kiocb *iocb, struct iov_iter *iter,
 			continue;
 		}
 
+		/*
+		 * Each request covers at most one object, so keep several of
+		 * them in flight to spread a large I/O over the OSDs holding
+		 * its objects.  Requests complete straight into the caller's
+		 * pages and are accounted in order as they finish.
+		 */
 		ret = ceph_osdc_start_request(req->r_osdc, req, false);
-		if (!ret)
-			ret = ceph_osdc_wait_request(&fsc->client->osdc, req);
-
-		size = i_size_read(inode);
-		if (!write) {
-			if (ret == -ENOENT)
-				ret = 0;
-			if (ret >= 0 && ret < len && pos + ret < size) {
-				struct iov_iter i;
-				int zlen = min_t(size_t, len - ret,
-						 size - pos - ret);
-
-				iov_iter_bvec(&i, READ, bvecs, num_pages, len);
-				iov_iter_advance(&i, ret);
-				iov_iter_zero(zlen, &i);
-				ret += zlen;
-			}
-			if (ret >= 0)
-				len = ret;
+		if (ret) {
+			iov_iter_revert(iter, len);
+			put_bvecs(bvecs, num_pages, should_dirty);
+			ceph_osdc_put_request(req);
+			break;
 		}
+		list_add_tail(&req->r_private_item, &inflight);
+		nr_inflight++;
+		pos += len;
 
-		put_bvecs(bvecs, num_pages, should_dirty);
-		ceph_osdc_put_request(req);
-		if (ret < 0)
+		/* Don't read ahead past EOF; it would only be zero-filled. */
+		if (!write && pos >= i_size_read(inode))
 			break;
 
-		pos += len;
-		if (!write && pos >= size)
-			break;
+		if (nr_inflight < fsc->mount_options->max_inflight)
+			continue;
 
-		if (write && pos > size) {
-			if (ceph_inode_set_size(inode, pos))
-				ceph_check_caps(ceph_inode(inode),
-						CHECK_CAPS_AUTHONLY,
-						NULL);
+		len = ceph_direct_wait_one(inode, &inflight, &done, write,
+					   should_dirty);
+		nr_inflight--;
+		if (len < 0) {
+			ret = len;
+			break;
 		}
+		if (!write && done >= i_size_read(inode))
+			break;
 	}
 
+	/*
+	 * Reap what is still in flight.  Once one request has failed or hit
+	 * EOF, later ones no longer count towards the result.
+	 */
+	while (nr_inflight) {
+		bool counted = ret >= 0 &&
+			       (write || done < i_size_read(inode));
+		ssize_t len;
+
+		len = ceph_direct_wait_one(inode, &inflight,
+					   counted ? &done : NULL,
+					   write, should_dirty);
+		if (counted && len < 0)
+			ret = len;
+		nr_inflight--;
+	}
+	if (!aio_req && pos > done)
+		iov_iter_revert(iter, pos - done);
+
 	if (aio_req) {
 		LIST_HEAD(osd_reqs);
 
@@ -1099,9 +1181,9 @@ ceph_direct_read_write(struct kiocb *iocb, struct iov_iter *iter,
 		return -EIOCBQUEUED;
 	}
 
-	if (ret != -EOLDSNAPC && pos > iocb->ki_pos) {
-		ret = pos - iocb->ki_pos;
-		iocb->ki_pos = pos;
+	if (ret != -EOLDSNAPC && done > iocb->ki_pos) {
+		ret = done - iocb->ki_pos;
+		iocb->ki_pos = done;
 	}
 	return ret;
 }
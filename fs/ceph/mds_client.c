@@ -647,7 +647,7 @@ static struct ceph_mds_session *register_session(struct ceph_mds_client *mdsc,
 	s->s_cap_reconnect = 0;
 	s->s_cap_iterator = NULL;
 	INIT_LIST_HEAD(&s->s_cap_releases);
-	INIT_WORK(&s->s_cap_release_work, ceph_cap_release_work);
+	INIT_DELAYED_WORK(&s->s_cap_release_work, ceph_cap_release_work);
 
 	INIT_LIST_HEAD(&s->s_cap_flushing);
 
@@ -676,6 +676,9 @@ static void __unregister_session(struct ceph_mds_client *mdsc,
 	mdsc->sessions[s->s_mds] = NULL;
 	s->s_state = 0;
 	ceph_con_close(&s->s_con);
+	/* drop the ref held by a cap release flush that never ran */
+	if (cancel_delayed_work(&s->s_cap_release_work))
+		ceph_put_mds_session(s);
 	ceph_put_mds_session(s);
 	atomic_dec(&mdsc->num_sessions);
 }
@@ -1932,7 +1935,8 @@ static void ceph_send_cap_releases(struct ceph_mds_client *mdsc,
 static void ceph_cap_release_work(struct work_struct *work)
 {
 	struct ceph_mds_session *session =
-		container_of(work, struct ceph_mds_session, s_cap_release_work);
+		container_of(to_delayed_work(work), struct ceph_mds_session,
+			     s_cap_release_work);
 
 	mutex_lock(&session->s_mutex);
 	if (session->s_state == CEPH_MDS_SESSION_OPEN ||
@@ -1949,12 +1953,34 @@ void ceph_flush_cap_releases(struct ceph_mds_client *mdsc,
 		return;
 
 	get_session(session);
-	if (queue_work(mdsc->fsc->cap_wq,
-		       &session->s_cap_release_work)) {
+	if (!mod_delayed_work(mdsc->fsc->cap_wq,
+			      &session->s_cap_release_work, 0)) {
 		dout("cap release work queued\n");
 	} else {
+		/* it was already pending and holds a session ref */
 		ceph_put_mds_session(session);
-		dout("failed to queue cap release work\n");
+		dout("cap release work moved up\n");
+	}
+}
+
+/*
+ * Like ceph_flush_cap_releases(), but give more releases a short while to
+ * accumulate before sending, so that they share messages.
+ */
+void ceph_queue_cap_releases(struct ceph_mds_client *mdsc,
+			     struct ceph_mds_session *session)
+{
+	if (mdsc->stopping)
+		return;
+
+	get_session(session);
+	if (queue_delayed_work(mdsc->fsc->cap_wq,
+			       &session->s_cap_release_work,
+			       CEPH_CAP_RELEASE_DELAY)) {
+		dout("cap release work queued\n");
+	} else {
+		ceph_put_mds_session(session);
+		dout("cap release work already pending\n");
 	}
 }
 
@@ -1969,6 +1995,8 @@ void __ceph_queue_cap_release(struct ceph_mds_session *session,
 
 	if (!(session->s_num_cap_releases % CEPH_CAPS_PER_RELEASE))
 		ceph_flush_cap_releases(session->s_mdsc, session);
+	else
+		ceph_queue_cap_releases(session->s_mdsc, session);
 }
 
 static void ceph_cap_reclaim_work(struct work_struct *work)
@@ -139,6 +139,12 @@ struct ceph_mds_reply_info_parsed {
 				sizeof(struct ceph_mds_cap_release)) /	\
 			        sizeof(struct ceph_mds_cap_item))
 
+/*
+ * Partial batches of cap releases are held back this long, so that a burst
+ * of releases goes out in as few messages as possible.
+ */
+#define CEPH_CAP_RELEASE_DELAY	(HZ / 20)
+
 
 /*
  * state associated with each MDS<->client session
@@ -181,7 +187,7 @@ struct ceph_mds_session {
 	int		  s_cap_reconnect;
 	int		  s_readonly;
 	struct list_head  s_cap_releases; /* waiting cap_release messages */
-	struct work_struct s_cap_release_work;
+	struct delayed_work s_cap_release_work;
 
 	/* protected by mutex */
 	struct list_head  s_cap_flushing;     /* inodes w/ flushing caps */
@@ -488,6 +494,8 @@ extern void __ceph_queue_cap_release(struct ceph_mds_session *session,
 				    struct ceph_cap *cap);
 extern void ceph_flush_cap_releases(struct ceph_mds_client *mdsc,
 				    struct ceph_mds_session *session);
+extern void ceph_queue_cap_releases(struct ceph_mds_client *mdsc,
+				    struct ceph_mds_session *session);
 extern void ceph_queue_cap_reclaim_work(struct ceph_mds_client *mdsc);
 extern void ceph_reclaim_caps_nr(struct ceph_mds_client *mdsc, int nr);
 extern int ceph_iterate_session_caps(struct ceph_mds_session *session,
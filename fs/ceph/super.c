@@ -138,6 +138,7 @@ enum {
 	Opt_readdir_max_entries,
 	Opt_readdir_max_bytes,
 	Opt_congestion_kb,
+	Opt_max_inflight,
 	Opt_last_int,
 	/* int args above */
 	Opt_snapdirname,
@@ -181,6 +182,7 @@ static match_table_t fsopt_tokens = {
 	{Opt_readdir_max_entries, "readdir_max_entries=%d"},
 	{Opt_readdir_max_bytes, "readdir_max_bytes=%d"},
 	{Opt_congestion_kb, "write_congestion_kb=%d"},
+	{Opt_max_inflight, "max_inflight=%d"},
 	/* int args above */
 	{Opt_snapdirname, "snapdirname=%s"},
 	{Opt_mds_namespace, "mds_namespace=%s"},
@@ -309,6 +311,11 @@ static int parse_fsopt_token(char *c, void *private)
 			return -EINVAL;
 		fsopt->congestion_kb = intval;
 		break;
+	case Opt_max_inflight:
+		if (intval < 1 || intval > CEPH_MAX_INFLIGHT_MAX)
+			return -EINVAL;
+		fsopt->max_inflight = intval;
+		break;
 	case Opt_dirstat:
 		fsopt->flags |= CEPH_MOUNT_OPT_DIRSTAT;
 		break;
@@ -471,6 +478,7 @@ static int parse_mount_options(struct ceph_mount_options **pfsopt,
 	fsopt->caps_wanted_delay_max = CEPH_CAPS_WANTED_DELAY_MAX_DEFAULT;
 	fsopt->max_readdir = CEPH_MAX_READDIR_DEFAULT;
 	fsopt->max_readdir_bytes = CEPH_MAX_READDIR_BYTES_DEFAULT;
+	fsopt->max_inflight = CEPH_MAX_INFLIGHT_DEFAULT;
 	fsopt->congestion_kb = default_congestion_kb();
 
 	/*
@@ -596,6 +604,8 @@ static int ceph_show_options(struct seq_file *m, struct dentry *root)
 		seq_printf(m, ",readdir_max_entries=%d", fsopt->max_readdir);
 	if (fsopt->max_readdir_bytes != CEPH_MAX_READDIR_BYTES_DEFAULT)
 		seq_printf(m, ",readdir_max_bytes=%d", fsopt->max_readdir_bytes);
+	if (fsopt->max_inflight != CEPH_MAX_INFLIGHT_DEFAULT)
+		seq_printf(m, ",max_inflight=%d", fsopt->max_inflight);
 	if (strcmp(fsopt->snapdir_name, CEPH_SNAPDIRNAME_DEFAULT))
 		seq_show_option(m, "snapdirname", fsopt->snapdir_name);
 
@@ -60,6 +60,8 @@
 #define CEPH_MAX_READDIR_DEFAULT        1024
 #define CEPH_MAX_READDIR_BYTES_DEFAULT  (512*1024)
 #define CEPH_SNAPDIRNAME_DEFAULT        ".snap"
+#define CEPH_MAX_INFLIGHT_DEFAULT       16
+#define CEPH_MAX_INFLIGHT_MAX           256
 
 /*
  * Delay telling the MDS we no longer want caps, in case we reopen
@@ -82,6 +84,7 @@ struct ceph_mount_options {
 	int caps_max;
 	int max_readdir;       /* max readdir result (entires) */
 	int max_readdir_bytes; /* max readdir result (bytes) */
+	int max_inflight;      /* max osd requests in flight per direct io */
 
 	/*
 	 * everything above this point can be memcmp'd; everything below
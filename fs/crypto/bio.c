@@ -24,17 +24,47 @@
 #include <linux/module.h>
 #include <linux/bio.h>
 #include <linux/namei.h>
+#include <linux/slab.h>
 #include "fscrypt_private.h"
 
-static void __fscrypt_decrypt_bio(struct bio *bio, bool done)
+/*
+ * Completed read bios with more than this many pages have their decryption
+ * split into batches of this many pages, each queued as its own work item so
+ * that the unbound fscrypt_read_workqueue can decrypt them on several CPUs.
+ */
+#define FSCRYPT_DECRYPT_BATCH_PAGES	16
+
+struct fscrypt_decrypt_batch {
+	struct work_struct work;
+	struct fscrypt_decrypt_split *split;
+	unsigned int first;
+	unsigned int nr;
+};
+
+struct fscrypt_decrypt_split {
+	struct fscrypt_ctx *ctx;
+	atomic_t remaining;
+	struct fscrypt_decrypt_batch batch[];
+};
+
+/* Decrypt segments [first, first + nr) of @bio */
+static void __fscrypt_decrypt_bio(struct bio *bio, bool done,
+				  unsigned int first, unsigned int nr)
 {
 	struct bio_vec *bv;
 	struct bvec_iter_all iter_all;
+	unsigned int i = 0;
 
 	bio_for_each_segment_all(bv, bio, iter_all) {
 		struct page *page = bv->bv_page;
-		int ret = fscrypt_decrypt_pagecache_blocks(page, bv->bv_len,
-							   bv->bv_offset);
+		int ret;
+
+		if (i++ < first)
+			continue;
+		if (!nr--)
+			break;
+		ret = fscrypt_decrypt_pagecache_blocks(page, bv->bv_len,
+						       bv->bv_offset);
 		if (ret)
 			SetPageError(page);
 		else if (done)
@@ -46,7 +76,7 @@ static void __fscrypt_decrypt_bio(struct bio *bio, bool done)
 
 void fscrypt_decrypt_bio(struct bio *bio)
 {
-	__fscrypt_decrypt_bio(bio, false);
+	__fscrypt_decrypt_bio(bio, false, 0, UINT_MAX);
 }
 EXPORT_SYMBOL(fscrypt_decrypt_bio);
 
@@ -55,15 +85,84 @@ static void completion_pages(struct work_struct *work)
 	struct fscrypt_ctx *ctx = container_of(work, struct fscrypt_ctx, work);
 	struct bio *bio = ctx->bio;
 
-	__fscrypt_decrypt_bio(bio, true);
+	__fscrypt_decrypt_bio(bio, true, 0, UINT_MAX);
 	fscrypt_release_ctx(ctx);
 	bio_put(bio);
 }
 
+static void completion_pages_batch(struct work_struct *work)
+{
+	struct fscrypt_decrypt_batch *batch =
+		container_of(work, struct fscrypt_decrypt_batch, work);
+	struct fscrypt_decrypt_split *split = batch->split;
+	struct fscrypt_ctx *ctx = split->ctx;
+	struct bio *bio = ctx->bio;
+
+	__fscrypt_decrypt_bio(bio, true, batch->first, batch->nr);
+	if (atomic_dec_and_test(&split->remaining)) {
+		kfree(split);
+		fscrypt_release_ctx(ctx);
+		bio_put(bio);
+	}
+}
+
+static unsigned int fscrypt_bio_nr_segments(struct bio *bio)
+{
+	struct bio_vec *bv;
+	struct bvec_iter_all iter_all;
+	unsigned int nr = 0;
+
+	bio_for_each_segment_all(bv, bio, iter_all)
+		nr++;
+	return nr;
+}
+
+/*
+ * Queue the decryption of a large bio as several batches.  Returns false if
+ * the bio is small enough to be decrypted by one work item, or if we couldn't
+ * allocate the batches, in which case the caller decrypts it in one go.
+ */
+static bool fscrypt_enqueue_decrypt_batches(struct fscrypt_ctx *ctx,
+					    struct bio *bio)
+{
+	struct fscrypt_decrypt_split *split;
+	unsigned int nr_segs, nr_batches, i;
+
+	if (num_online_cpus() == 1)
+		return false;
+	nr_segs = fscrypt_bio_nr_segments(bio);
+	if (nr_segs <= FSCRYPT_DECRYPT_BATCH_PAGES)
+		return false;
+	nr_batches = DIV_ROUND_UP(nr_segs, FSCRYPT_DECRYPT_BATCH_PAGES);
+
+	/* We're usually called from bio completion, so we can't sleep here */
+	split = kmalloc(struct_size(split, batch, nr_batches), GFP_ATOMIC);
+	if (!split)
+		return false;
+
+	split->ctx = ctx;
+	atomic_set(&split->remaining, nr_batches);
+	for (i = 0; i < nr_batches; i++) {
+		struct fscrypt_decrypt_batch *batch = &split->batch[i];
+
+		INIT_WORK(&batch->work, completion_pages_batch);
+		batch->split = split;
+		batch->first = i * FSCRYPT_DECRYPT_BATCH_PAGES;
+		batch->nr = min_t(unsigned int, FSCRYPT_DECRYPT_BATCH_PAGES,
+				  nr_segs - batch->first);
+	}
+	/* @split can't be freed before its last batch has been queued */
+	for (i = 0; i < nr_batches; i++)
+		fscrypt_enqueue_decrypt_work(&split->batch[i].work);
+	return true;
+}
+
 void fscrypt_enqueue_decrypt_bio(struct fscrypt_ctx *ctx, struct bio *bio)
 {
-	INIT_WORK(&ctx->work, completion_pages);
 	ctx->bio = bio;
+	if (fscrypt_enqueue_decrypt_batches(ctx, bio))
+		return;
+	INIT_WORK(&ctx->work, completion_pages);
 	fscrypt_enqueue_decrypt_work(&ctx->work);
 }
 EXPORT_SYMBOL(fscrypt_enqueue_decrypt_bio);
@@ -73,48 +172,79 @@ int fscrypt_zeroout_range(const struct inode *inode, pgoff_t lblk,
 {
 	const unsigned int blockbits = inode->i_blkbits;
 	const unsigned int blocksize = 1 << blockbits;
-	struct page *ciphertext_page;
+	const unsigned int blocks_per_page_bits = PAGE_SHIFT - blockbits;
+	const unsigned int blocks_per_page = 1 << blocks_per_page_bits;
+	struct page *pages[16]; /* write up to 16 pages at a time */
+	unsigned int nr_pages;
+	unsigned int i;
+	unsigned int offset;
 	struct bio *bio;
-	int ret, err = 0;
+	int ret, err;
+
+	if (len == 0)
+		return 0;
+
+	BUILD_BUG_ON(ARRAY_SIZE(pages) > BIO_MAX_PAGES);
+	nr_pages = min_t(unsigned int, ARRAY_SIZE(pages),
+			 (len + blocks_per_page - 1) >> blocks_per_page_bits);
 
-	ciphertext_page = fscrypt_alloc_bounce_page(GFP_NOWAIT);
-	if (!ciphertext_page)
+	/*
+	 * We need at least one page for ciphertext.  Allocate the first one
+	 * from the mempool with __GFP_DIRECT_RECLAIM set, so that it can't
+	 * fail.  The others only help performance, and waiting on the mempool
+	 * for them could deadlock, so they are allowed to fail.
+	 */
+	for (i = 0; i < nr_pages; i++) {
+		pages[i] = fscrypt_alloc_bounce_page(i == 0 ? GFP_NOFS :
+						     GFP_NOWAIT | __GFP_NOWARN);
+		if (!pages[i])
+			break;
+	}
+	nr_pages = i;
+	if (WARN_ON(nr_pages == 0))
 		return -ENOMEM;
 
-	while (len--) {
-		err = fscrypt_crypt_block(inode, FS_ENCRYPT, lblk,
-					  ZERO_PAGE(0), ciphertext_page,
-					  blocksize, 0, GFP_NOFS);
-		if (err)
-			goto errout;
+	/* This always succeeds since __GFP_DIRECT_RECLAIM is set. */
+	bio = bio_alloc(GFP_NOFS, nr_pages);
 
-		bio = bio_alloc(GFP_NOWAIT, 1);
-		if (!bio) {
-			err = -ENOMEM;
-			goto errout;
-		}
+	do {
 		bio_set_dev(bio, inode->i_sb->s_bdev);
 		bio->bi_iter.bi_sector = pblk << (blockbits - 9);
 		bio_set_op_attrs(bio, REQ_OP_WRITE, 0);
-		ret = bio_add_page(bio, ciphertext_page, blocksize, 0);
-		if (WARN_ON(ret != blocksize)) {
-			/* should never happen! */
-			bio_put(bio);
-			err = -EIO;
-			goto errout;
-		}
+
+		i = 0;
+		offset = 0;
+		do {
+			err = fscrypt_crypt_block(inode, FS_ENCRYPT, lblk,
+						  ZERO_PAGE(0), pages[i],
+						  blocksize, offset, GFP_NOFS);
+			if (err)
+				goto out;
+			lblk++;
+			pblk++;
+			len--;
+			offset += blocksize;
+			if (offset == PAGE_SIZE || len == 0) {
+				ret = bio_add_page(bio, pages[i++], offset, 0);
+				if (WARN_ON(ret != offset)) {
+					/* should never happen! */
+					err = -EIO;
+					goto out;
+				}
+				offset = 0;
+			}
+		} while (i != nr_pages && len != 0);
+
 		err = submit_bio_wait(bio);
-		if (err == 0 && bio->bi_status)
-			err = -EIO;
-		bio_put(bio);
 		if (err)
-			goto errout;
-		lblk++;
-		pblk++;
-	}
+			goto out;
+		bio_reset(bio);
+	} while (len != 0);
 	err = 0;
-errout:
-	fscrypt_free_bounce_page(ciphertext_page);
+out:
+	bio_put(bio);
+	for (i = 0; i < nr_pages; i++)
+		fscrypt_free_bounce_page(pages[i]);
 	return err;
 }
 EXPORT_SYMBOL(fscrypt_zeroout_range);
@@ -1487,8 +1487,8 @@ static void send_to_sock(struct connection *con)
 {
 	int ret = 0;
 	const int msg_flags = MSG_DONTWAIT | MSG_NOSIGNAL;
-	struct writequeue_entry *e;
-	int len, offset;
+	struct writequeue_entry *e, *next;
+	int len, offset, flags;
 	int count = 0;
 
 	mutex_lock(&con->sock_mutex);
@@ -1505,12 +1505,24 @@ static void send_to_sock(struct connection *con)
 		len = e->len;
 		offset = e->offset;
 		BUG_ON(len == 0 && e->users == 0);
+
+		/* If more data is already queued behind this entry, let the
+		 * socket coalesce it into full segments instead of pushing
+		 * out a short one for every page.
+		 */
+		flags = msg_flags;
+		if (e->list.next != &con->writequeue) {
+			next = list_entry(e->list.next,
+					  struct writequeue_entry, list);
+			if (next->len)
+				flags |= MSG_MORE;
+		}
 		spin_unlock(&con->writequeue_lock);
 
 		ret = 0;
 		if (len) {
 			ret = kernel_sendpage(con->sock, e->page, offset, len,
-					      msg_flags);
+					      flags);
 			if (ret == -EAGAIN || ret == 0) {
 				if (ret == -EAGAIN &&
 				    test_bit(SOCKWQ_ASYNC_NOSPACE, &con->sock->flags) &&
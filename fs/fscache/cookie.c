@@ -11,6 +11,8 @@
 #define FSCACHE_DEBUG_LEVEL COOKIE
 #include <linux/module.h>
 #include <linux/slab.h>
+#include <linux/hash.h>
+#include <linux/jhash.h>
 #include "internal.h"
 
 struct kmem_cache *fscache_cookie_jar;
@@ -74,10 +76,8 @@ void fscache_free_cookie(struct fscache_cookie *cookie)
 static int fscache_set_key(struct fscache_cookie *cookie,
 			   const void *index_key, size_t index_key_len)
 {
-	unsigned long long h;
 	u32 *buf;
 	int bufs;
-	int i;
 
 	bufs = DIV_ROUND_UP(index_key_len, sizeof(*buf));
 
@@ -92,16 +92,14 @@ static int fscache_set_key(struct fscache_cookie *cookie,
 
 	memcpy(buf, index_key, index_key_len);
 
-	/* Calculate a hash and combine this with the length in the first word
-	 * or first half word
+	/* Hash the key, seeded with the parent, length and type.  Summing the
+	 * words, as we used to, put keys that differ only in the order of
+	 * their words (as network filehandles often do) into the same bucket.
+	 * The tail of the buffer is zeroed, so whole words can be hashed.
 	 */
-	h = (unsigned long)cookie->parent;
-	h += index_key_len + cookie->type;
-
-	for (i = 0; i < bufs; i++)
-		h += buf[i];
-
-	cookie->key_hash = h ^ (h >> 32);
+	cookie->key_hash = jhash2(buf, bufs,
+				  hash_ptr(cookie->parent, 32) ^
+				  (index_key_len << 8) ^ cookie->type);
 	return 0;
 }
 
@@ -204,10 +202,12 @@ struct fscache_cookie *fscache_hash_cookie(struct fscache_cookie *candidate)
 
 	hlist_bl_lock(h);
 	hlist_bl_for_each_entry(cursor, p, h, hash_link) {
+		fscache_stat(&fscache_n_cookie_hash_probe);
 		if (fscache_compare_cookie(candidate, cursor) == 0)
 			goto collision;
 	}
 
+	fscache_stat(&fscache_n_cookie_hash_insert);
 	__set_bit(FSCACHE_COOKIE_ACQUIRED, &candidate->flags);
 	fscache_cookie_get(candidate->parent, fscache_cookie_get_acquire_parent);
 	atomic_inc(&candidate->parent->n_children);
@@ -226,6 +226,7 @@ struct fscache_cookie *fscache_hash_cookie(struct fscache_cookie *candidate)
 		return NULL;
 	}
 
+	fscache_stat(&fscache_n_cookie_hash_reacquire);
 	fscache_cookie_get(cursor, fscache_cookie_get_reacquire);
 	hlist_bl_unlock(h);
 	return cursor;
@@ -239,6 +239,9 @@ extern atomic_t fscache_n_relinquishes_retire;
 extern atomic_t fscache_n_cookie_index;
 extern atomic_t fscache_n_cookie_data;
 extern atomic_t fscache_n_cookie_special;
+extern atomic_t fscache_n_cookie_hash_insert;
+extern atomic_t fscache_n_cookie_hash_reacquire;
+extern atomic_t fscache_n_cookie_hash_probe;
 
 extern atomic_t fscache_n_object_alloc;
 extern atomic_t fscache_n_object_no_alloc;
@@ -92,6 +92,9 @@ atomic_t fscache_n_relinquishes_retire;
 atomic_t fscache_n_cookie_index;
 atomic_t fscache_n_cookie_data;
 atomic_t fscache_n_cookie_special;
+atomic_t fscache_n_cookie_hash_insert;
+atomic_t fscache_n_cookie_hash_reacquire;
+atomic_t fscache_n_cookie_hash_probe;
 
 atomic_t fscache_n_object_alloc;
 atomic_t fscache_n_object_no_alloc;
@@ -143,6 +146,11 @@ int fscache_stats_show(struct seq_file *m, void *v)
 		   atomic_read(&fscache_n_cookie_data),
 		   atomic_read(&fscache_n_cookie_special));
 
+	seq_printf(m, "CkHash : ins=%u rac=%u prb=%u\n",
+		   atomic_read(&fscache_n_cookie_hash_insert),
+		   atomic_read(&fscache_n_cookie_hash_reacquire),
+		   atomic_read(&fscache_n_cookie_hash_probe));
+
 	seq_printf(m, "Objects: alc=%u nal=%u avl=%u ded=%u\n",
 		   atomic_read(&fscache_n_object_alloc),
 		   atomic_read(&fscache_n_object_no_alloc),
@@ -809,6 +809,20 @@ static void fuse_copy_finish(struct fuse_copy_state *cs)
 	cs->pg = NULL;
 }
 
+/*
+ * Prepare for copying the next request or reply of a batch: hand back the
+ * part of the userspace buffer that fuse_copy_fill() took but that wasn't
+ * used, and forget about the previous request, which may be gone by now.
+ */
+static void fuse_copy_next(struct fuse_copy_state *cs)
+{
+	if (!cs->pipebufs && cs->len) {
+		iov_iter_revert(cs->iter, cs->len);
+		cs->len = 0;
+	}
+	cs->req = NULL;
+}
+
 /*
  * Get another pagefull of userspace buffer, and map it to kernel
  * address space, and lock request
@@ -1304,9 +1318,13 @@ __releases(fiq->waitq.lock)
  * was an error during the copying then it's finished by calling
  * request_end().  Otherwise add it to the processing list, and set
  * the 'sent' flag.
+ *
+ * With @batch set this never blocks, and returns 0 unless there is a
+ * request pending that fits into @nbytes.
  */
 static ssize_t fuse_dev_do_read(struct fuse_dev *fud, struct file *file,
-				struct fuse_copy_state *cs, size_t nbytes)
+				struct fuse_copy_state *cs, size_t nbytes,
+				bool batch)
 {
 	ssize_t err;
 	struct fuse_conn *fc = fud->fc;
@@ -1319,6 +1337,18 @@ static ssize_t fuse_dev_do_read(struct fuse_dev *fud, struct file *file,
 
  restart:
 	spin_lock(&fiq->waitq.lock);
+	if (batch) {
+		/* Interrupts and forgets are left for the next read */
+		err = 0;
+		if (!fiq->connected || !list_empty(&fiq->interrupts) ||
+		    forget_pending(fiq) || list_empty(&fiq->pending))
+			goto err_unlock;
+
+		req = list_entry(fiq->pending.next, struct fuse_req, list);
+		if (req->in.h.len > nbytes)
+			goto err_unlock;
+	}
+
 	err = -EAGAIN;
 	if ((file->f_flags & O_NONBLOCK) && fiq->connected &&
 	    !request_pending(fiq))
@@ -1429,6 +1459,7 @@ static ssize_t fuse_dev_read(struct kiocb *iocb, struct iov_iter *to)
 	struct fuse_copy_state cs;
 	struct file *file = iocb->ki_filp;
 	struct fuse_dev *fud = fuse_get_dev(file);
+	ssize_t ret, total;
 
 	if (!fud)
 		return -EPERM;
@@ -1438,7 +1469,20 @@ static ssize_t fuse_dev_read(struct kiocb *iocb, struct iov_iter *to)
 
 	fuse_copy_init(&cs, 1, to);
 
-	return fuse_dev_do_read(fud, file, &cs, iov_iter_count(to));
+	ret = fuse_dev_do_read(fud, file, &cs, iov_iter_count(to), false);
+	if (ret <= 0 || !fud->fc->batch_io)
+		return ret;
+
+	/* Fill the rest of the buffer with whatever else is pending */
+	total = 0;
+	do {
+		total += ret;
+		fuse_copy_next(&cs);
+		ret = fuse_dev_do_read(fud, file, &cs, iov_iter_count(to),
+				       true);
+	} while (ret > 0);
+
+	return total;
 }
 
 static ssize_t fuse_dev_splice_read(struct file *in, loff_t *ppos,
@@ -1462,7 +1506,7 @@ static ssize_t fuse_dev_splice_read(struct file *in, loff_t *ppos,
 	fuse_copy_init(&cs, 1, NULL);
 	cs.pipebufs = bufs;
 	cs.pipe = pipe;
-	ret = fuse_dev_do_read(fud, in, &cs, len);
+	ret = fuse_dev_do_read(fud, in, &cs, len, false);
 	if (ret < 0)
 		goto out;
 
@@ -1914,9 +1958,13 @@ static int copy_out_args(struct fuse_copy_state *cs, struct fuse_out *out,
  * list by the unique ID found in the header.  If found, then remove
  * it from the list and copy the rest of the buffer to the request.
  * The request is finished by calling request_end()
+ *
+ * With @batch set the message may be followed by others, and only the part of
+ * @nbytes that its header covers is consumed.
  */
 static ssize_t fuse_dev_do_write(struct fuse_dev *fud,
-				 struct fuse_copy_state *cs, size_t nbytes)
+				 struct fuse_copy_state *cs, size_t nbytes,
+				 bool batch)
 {
 	int err;
 	struct fuse_conn *fc = fud->fc;
@@ -1933,6 +1981,8 @@ static ssize_t fuse_dev_do_write(struct fuse_dev *fud,
 		goto copy_finish;
 
 	err = -EINVAL;
+	if (batch && oh.len >= sizeof(oh) && oh.len < nbytes)
+		nbytes = oh.len;
 	if (oh.len != nbytes)
 		goto copy_finish;
 
@@ -2013,6 +2063,7 @@ static ssize_t fuse_dev_write(struct kiocb *iocb, struct iov_iter *from)
 {
 	struct fuse_copy_state cs;
 	struct fuse_dev *fud = fuse_get_dev(iocb->ki_filp);
+	ssize_t ret, total;
 
 	if (!fud)
 		return -EPERM;
@@ -2022,7 +2073,20 @@ static ssize_t fuse_dev_write(struct kiocb *iocb, struct iov_iter *from)
 
 	fuse_copy_init(&cs, 0, from);
 
-	return fuse_dev_do_write(fud, &cs, iov_iter_count(from));
+	if (!fud->fc->batch_io)
+		return fuse_dev_do_write(fud, &cs, iov_iter_count(from), false);
+
+	total = 0;
+	while (iov_iter_count(from)) {
+		ret = fuse_dev_do_write(fud, &cs, iov_iter_count(from), true);
+		if (ret < 0)
+			return total ? total : ret;
+
+		total += ret;
+		fuse_copy_next(&cs);
+	}
+
+	return total;
 }
 
 static ssize_t fuse_dev_splice_write(struct pipe_inode_info *pipe,
@@ -2097,7 +2161,7 @@ static ssize_t fuse_dev_splice_write(struct pipe_inode_info *pipe,
 	if (flags & SPLICE_F_MOVE)
 		cs.move_pages = 1;
 
-	ret = fuse_dev_do_write(fud, &cs, len);
+	ret = fuse_dev_do_write(fud, &cs, len, false);
 
 	pipe_lock(pipe);
 out_free:
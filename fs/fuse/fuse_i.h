@@ -697,6 +697,12 @@ struct fuse_conn {
 	/** Filesystem is fully reponsible for page cache invalidation. */
 	unsigned explicit_inval_data:1;
 
+	/**
+	 * Several requests per device read, several replies per write.
+	 * Asked for by the server with the batch_io mount option.
+	 */
+	unsigned batch_io:1;
+
 	/** Does the filesystem support readdirplus? */
 	unsigned do_readdirplus:1;
 
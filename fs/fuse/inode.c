@@ -70,6 +70,7 @@ struct fuse_mount_data {
 	unsigned group_id_present:1;
 	unsigned default_permissions:1;
 	unsigned allow_other:1;
+	unsigned batch_io:1;
 	unsigned max_read;
 	unsigned blksize;
 };
@@ -451,6 +452,7 @@ enum {
 	OPT_ALLOW_OTHER,
 	OPT_MAX_READ,
 	OPT_BLKSIZE,
+	OPT_BATCH_IO,
 	OPT_ERR
 };
 
@@ -463,6 +465,7 @@ static const match_table_t tokens = {
 	{OPT_ALLOW_OTHER,		"allow_other"},
 	{OPT_MAX_READ,			"max_read=%u"},
 	{OPT_BLKSIZE,			"blksize=%u"},
+	{OPT_BATCH_IO,			"batch_io"},
 	{OPT_ERR,			NULL}
 };
 
@@ -549,6 +552,10 @@ static int parse_fuse_opt(char *opt, struct fuse_mount_data *d, int is_bdev,
 			d->blksize = value;
 			break;
 
+		case OPT_BATCH_IO:
+			d->batch_io = 1;
+			break;
+
 		default:
 			return 0;
 		}
@@ -576,6 +583,8 @@ static int fuse_show_options(struct seq_file *m, struct dentry *root)
 		seq_printf(m, ",max_read=%u", fc->max_read);
 	if (sb->s_bdev && sb->s_blocksize != FUSE_DEFAULT_BLKSIZE)
 		seq_printf(m, ",blksize=%lu", sb->s_blocksize);
+	if (fc->batch_io)
+		seq_puts(m, ",batch_io");
 	return 0;
 }
 
@@ -1161,6 +1170,7 @@ static int fuse_fill_super(struct super_block *sb, void *data, int silent)
 
 	fc->default_permissions = d.default_permissions;
 	fc->allow_other = d.allow_other;
+	fc->batch_io = d.batch_io;
 	fc->user_id = d.user_id;
 	fc->group_id = d.group_id;
 	fc->max_read = max_t(unsigned, 4096, d.max_read);
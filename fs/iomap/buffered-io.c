@@ -734,6 +734,103 @@ iomap_write_end(struct inode *inode, loff_t pos, unsigned len,
 	return ret;
 }
 
+/*
+ * Maximum number of pages iomap_write_batch() locks and copies into at once.
+ */
+#define IOMAP_WRITE_BATCH	16
+
+static bool
+iomap_write_can_batch(struct iomap *iomap)
+{
+	return iomap->type != IOMAP_INLINE &&
+		!(iomap->flags & IOMAP_F_BUFFER_HEAD) &&
+		!iomap->page_ops;
+}
+
+/*
+ * Write a run of up to IOMAP_WRITE_BATCH pages: fault in the user buffer
+ * once, lock all the pages in index order, copy into them in one pass and
+ * only then update i_size and unlock them.  Returns the number of bytes
+ * written, or 0 if nothing could be done, in which case the caller falls
+ * back to writing a single page.
+ */
+static loff_t
+iomap_write_batch(struct inode *inode, loff_t pos, loff_t length,
+		struct iov_iter *i, unsigned flags, struct iomap *iomap)
+{
+	struct page *pages[IOMAP_WRITE_BATCH];
+	loff_t old_size = inode->i_size, p;
+	size_t bytes, len, copied = 0;
+	int nr = 0, n;
+
+	bytes = min_t(loff_t, length, iov_iter_count(i));
+	bytes = min_t(size_t, bytes,
+			IOMAP_WRITE_BATCH * PAGE_SIZE - offset_in_page(pos));
+
+	if (unlikely(iov_iter_fault_in_readable(i, bytes)))
+		return 0;
+
+	if (fatal_signal_pending(current))
+		return -EINTR;
+
+	for (p = pos; p < pos + bytes; p += len) {
+		struct page *page;
+
+		len = min_t(loff_t, PAGE_SIZE - offset_in_page(p),
+				pos + bytes - p);
+		page = grab_cache_page_write_begin(inode->i_mapping,
+				p >> PAGE_SHIFT, flags);
+		if (!page)
+			break;
+		if (__iomap_write_begin(inode, p, len, page, iomap)) {
+			unlock_page(page);
+			put_page(page);
+			break;
+		}
+		pages[nr++] = page;
+	}
+	bytes = p - pos;
+
+	for (n = 0, p = pos; n < nr; n++, p += len) {
+		size_t done;
+
+		len = min_t(loff_t, PAGE_SIZE - offset_in_page(p),
+				pos + bytes - p);
+		if (mapping_writably_mapped(inode->i_mapping))
+			flush_dcache_page(pages[n]);
+
+		done = iov_iter_copy_from_user_atomic(pages[n], i,
+				offset_in_page(p), len);
+
+		flush_dcache_page(pages[n]);
+
+		done = __iomap_write_end(inode, p, len, done, pages[n], iomap);
+		iov_iter_advance(i, done);
+		copied += done;
+		if (done < len)
+			break;
+	}
+
+	/*
+	 * As in iomap_write_end(), update the in-memory inode size before
+	 * unlocking the pages.
+	 */
+	if (pos + copied > old_size) {
+		i_size_write(inode, pos + copied);
+		iomap->flags |= IOMAP_F_SIZE_CHANGED;
+	}
+	for (n = 0; n < nr; n++) {
+		unlock_page(pages[n]);
+		put_page(pages[n]);
+	}
+
+	if (old_size < pos)
+		pagecache_isize_extended(inode, old_size, pos);
+	if (copied < bytes)
+		iomap_write_failed(inode, pos + copied, bytes - copied);
+	return copied;
+}
+
 static loff_t
 iomap_write_actor(struct inode *inode, loff_t pos, loff_t length, void *data,
 		struct iomap *iomap)
@@ -752,6 +849,31 @@ iomap_write_actor(struct inode *inode, loff_t pos, loff_t length, void *data,
 		offset = offset_in_page(pos);
 		bytes = min_t(unsigned long, PAGE_SIZE - offset,
 						iov_iter_count(i));
+
+		/*
+		 * Large writes that span several pages go through
+		 * iomap_write_batch(); anything it couldn't write is retried
+		 * a page at a time below.
+		 */
+		if (iomap_write_can_batch(iomap) && bytes < length &&
+		    bytes < iov_iter_count(i)) {
+			loff_t ret = iomap_write_batch(inode, pos, length, i,
+					flags, iomap);
+
+			if (ret < 0) {
+				status = ret;
+				break;
+			}
+			if (ret > 0) {
+				pos += ret;
+				written += ret;
+				length -= ret;
+				cond_resched();
+				balance_dirty_pages_ratelimited(
+						inode->i_mapping);
+				continue;
+			}
+		}
 again:
 		if (bytes > length)
 			bytes = length;
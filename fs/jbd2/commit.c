@@ -790,6 +790,8 @@ void jbd2_journal_commit_transaction(journal_t *journal)
 
 	blk_finish_plug(&plug);
 
+	stats.run.rs_committing = jiffies;
+
 	/* Lo and behold: we have just managed to send a transaction to
            the log.  Before we can commit it, wait for the IO so far to
            complete.  Control buffers being written are on the
@@ -888,6 +890,9 @@ void jbd2_journal_commit_transaction(journal_t *journal)
 	if (err)
 		jbd2_journal_abort(journal, err);
 
+	stats.run.rs_committing = jbd2_time_diff(stats.run.rs_committing,
+						 jiffies);
+
 	/*
 	 * Now disk caches for filesystem device are flushed so we are safe to
 	 * erase checkpointed transactions from the log by updating journal
@@ -1138,6 +1143,7 @@ void jbd2_journal_commit_transaction(journal_t *journal)
 	journal->j_stats.run.rs_locked += stats.run.rs_locked;
 	journal->j_stats.run.rs_flushing += stats.run.rs_flushing;
 	journal->j_stats.run.rs_logging += stats.run.rs_logging;
+	journal->j_stats.run.rs_committing += stats.run.rs_committing;
 	journal->j_stats.run.rs_handle_count += stats.run.rs_handle_count;
 	journal->j_stats.run.rs_blocks += stats.run.rs_blocks;
 	journal->j_stats.run.rs_blocks_logged += stats.run.rs_blocks_logged;
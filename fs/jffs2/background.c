@@ -22,8 +22,25 @@
 #include "nodelist.h"
 
 
+/* Upper bound on GC passes run back to back when free space is short */
+#define JFFS2_GC_BURST_PASSES	16
+
 static int jffs2_garbage_collect_thread(void *);
 
+/* Free blocks have dropped to the point where writers will soon have to
+ * do GC themselves in jffs2_reserve_space(); get ahead of them. */
+static int jffs2_gc_should_burst(struct jffs2_sb_info *c)
+{
+	int ret;
+
+	spin_lock(&c->erase_completion_lock);
+	ret = c->nr_free_blocks + c->nr_erasing_blocks < c->resv_blocks_gctrigger &&
+		jffs2_thread_should_wake(c);
+	spin_unlock(&c->erase_completion_lock);
+
+	return ret;
+}
+
 void jffs2_garbage_collect_trigger(struct jffs2_sb_info *c)
 {
 	assert_spin_locked(&c->erase_completion_lock);
@@ -76,6 +93,7 @@ static int jffs2_garbage_collect_thread(void *_c)
 {
 	struct jffs2_sb_info *c = _c;
 	sigset_t hupmask;
+	int i, ret;
 
 	siginitset(&hupmask, sigmask(SIGHUP));
 	allow_signal(SIGKILL);
@@ -151,10 +169,24 @@ static int jffs2_garbage_collect_thread(void *_c)
 		/* We don't want SIGHUP to interrupt us. STOP and KILL are OK though. */
 		sigprocmask(SIG_BLOCK, &hupmask, NULL);
 
-		jffs2_dbg(1, "%s(): pass\n", __func__);
-		if (jffs2_garbage_collect_pass(c) == -ENOSPC) {
-			pr_notice("No space for garbage collection. Aborting GC thread\n");
-			goto die;
+		/* The 50ms delay above keeps us out of the way of userspace
+		 * when there's no hurry. When free space is short, though,
+		 * moving a single node per delay just means that writers end
+		 * up stalled in jffs2_reserve_space() doing the GC themselves.
+		 * So keep going for a burst of passes while it's still urgent;
+		 * the nodes we move are accumulated in the write buffer and
+		 * go out to flash as full pages rather than one per wakeup. */
+		for (i = 0; i < JFFS2_GC_BURST_PASSES; i++) {
+			jffs2_dbg(1, "%s(): pass\n", __func__);
+			ret = jffs2_garbage_collect_pass(c);
+			if (ret == -ENOSPC) {
+				pr_notice("No space for garbage collection. Aborting GC thread\n");
+				goto die;
+			}
+			if (ret || signal_pending(current) || freezing(current) ||
+			    kthread_should_stop() || !jffs2_gc_should_burst(c))
+				break;
+			cond_resched();
 		}
 	}
  die:
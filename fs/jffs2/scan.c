@@ -492,11 +492,15 @@ static int jffs2_scan_eraseblock (struct jffs2_sb_info *c, struct jffs2_eraseblo
 				sumlen = c->sector_size - je32_to_cpu(sm->offset);
 			}
 		} else {
-			/* If NAND flash, read a whole page of it. Else just the end */
+			/* If NAND flash, read a whole page of it. Else read as
+			   much of the end as the previous block's summary took,
+			   so that the marker and (usually) the summary itself
+			   arrive in one read */
 			if (c->wbuf_pagesize)
 				buf_len = c->wbuf_pagesize;
 			else
-				buf_len = sizeof(*sm);
+				buf_len = clamp_t(uint32_t, s->scan_sumlen,
+						  sizeof(*sm), buf_size);
 
 			/* Read as much as we want into the _end_ of the preallocated buffer */
 			err = jffs2_fill_scan_buf(c, buf + buf_size - buf_len, 
@@ -514,6 +518,8 @@ static int jffs2_scan_eraseblock (struct jffs2_sb_info *c, struct jffs2_eraseblo
 				if (sumlen > c->sector_size)
 					goto full_scan;
 
+				s->scan_sumlen = sumlen;
+
 				/* Now, make sure the summary itself is available */
 				if (sumlen > buf_size) {
 					/* Need to kmalloc for this. */
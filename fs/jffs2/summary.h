@@ -157,6 +157,8 @@ struct jffs2_summary
 	union jffs2_sum_mem *sum_list_tail;
 
 	jint32_t *sum_buf;	/* buffer for writing out summary */
+
+	uint32_t scan_sumlen;	/* size of the last summary found at mount */
 };
 
 /* Summary marker is stored at the end of every sumarized erase block */
@@ -763,39 +763,67 @@ static int nilfs_ioctl_mark_blocks_dirty(struct the_nilfs *nilfs,
 	struct nilfs_bmap *bmap = NILFS_I(nilfs->ns_dat)->i_bmap;
 	struct nilfs_bdesc *bdescs = buf;
 	struct buffer_head *bh;
-	int ret, i;
+	__u64 blocknr;
+	int ret, i, j, n;
 
-	for (i = 0; i < nmembs; i++) {
+	for (i = 0; i < nmembs; i += n) {
 		/* XXX: use macro or inline func to check liveness */
-		ret = nilfs_bmap_lookup_at_level(bmap,
-						 bdescs[i].bd_offset,
-						 bdescs[i].bd_level + 1,
-						 &bdescs[i].bd_blocknr);
+		if (bdescs[i].bd_level == 0) {
+			/*
+			 * DAT data blocks of a segment are usually handed to
+			 * us in runs of consecutive offsets; resolve each run
+			 * with a single walk of the DAT bmap instead of one
+			 * lookup per block.
+			 */
+			for (n = 1; i + n < nmembs &&
+				     bdescs[i + n].bd_level == 0 &&
+				     bdescs[i + n].bd_offset ==
+				     bdescs[i].bd_offset + n; n++)
+				;
+			ret = nilfs_bmap_lookup_contig(bmap,
+						       bdescs[i].bd_offset,
+						       &blocknr, n);
+			if (ret > 0) {
+				n = ret;
+				for (j = 0; j < n; j++)
+					bdescs[i + j].bd_blocknr = blocknr + j;
+			}
+		} else {
+			n = 1;
+			ret = nilfs_bmap_lookup_at_level(bmap,
+							 bdescs[i].bd_offset,
+							 bdescs[i].bd_level + 1,
+							 &bdescs[i].bd_blocknr);
+		}
 		if (ret < 0) {
 			if (ret != -ENOENT)
 				return ret;
+			n = 1;
 			bdescs[i].bd_blocknr = 0;
 		}
-		if (bdescs[i].bd_blocknr != bdescs[i].bd_oblocknr)
-			/* skip dead block */
-			continue;
-		if (bdescs[i].bd_level == 0) {
-			ret = nilfs_mdt_get_block(nilfs->ns_dat,
-						  bdescs[i].bd_offset,
-						  false, NULL, &bh);
-			if (unlikely(ret)) {
-				WARN_ON(ret == -ENOENT);
-				return ret;
-			}
-			mark_buffer_dirty(bh);
-			nilfs_mdt_mark_dirty(nilfs->ns_dat);
-			put_bh(bh);
-		} else {
-			ret = nilfs_bmap_mark(bmap, bdescs[i].bd_offset,
-					      bdescs[i].bd_level);
-			if (ret < 0) {
-				WARN_ON(ret == -ENOENT);
-				return ret;
+
+		for (j = i; j < i + n; j++) {
+			if (bdescs[j].bd_blocknr != bdescs[j].bd_oblocknr)
+				/* skip dead block */
+				continue;
+			if (bdescs[j].bd_level == 0) {
+				ret = nilfs_mdt_get_block(nilfs->ns_dat,
+							  bdescs[j].bd_offset,
+							  false, NULL, &bh);
+				if (unlikely(ret)) {
+					WARN_ON(ret == -ENOENT);
+					return ret;
+				}
+				mark_buffer_dirty(bh);
+				nilfs_mdt_mark_dirty(nilfs->ns_dat);
+				put_bh(bh);
+			} else {
+				ret = nilfs_bmap_mark(bmap, bdescs[j].bd_offset,
+						      bdescs[j].bd_level);
+				if (ret < 0) {
+					WARN_ON(ret == -ENOENT);
+					return ret;
+				}
 			}
 		}
 	}
@@ -238,6 +238,15 @@ nilfs_segbuf_fill_in_super_root_crc(struct nilfs_segment_buffer *segbuf,
 	raw_sr->sr_sum = cpu_to_le32(crc);
 }
 
+static void nilfs_segbuf_add_checksums(struct nilfs_segment_buffer *segbuf,
+				       u32 seed)
+{
+	if (segbuf->sb_super_root)
+		nilfs_segbuf_fill_in_super_root_crc(segbuf, seed);
+	nilfs_segbuf_fill_in_segsum_crc(segbuf, seed);
+	nilfs_segbuf_fill_in_data_crc(segbuf, seed);
+}
+
 static void nilfs_release_buffers(struct list_head *list)
 {
 	struct buffer_head *bh, *n;
@@ -279,12 +288,22 @@ void nilfs_truncate_logs(struct list_head *logs,
 	}
 }
 
+/**
+ * nilfs_write_logs - add checksums on the logs and submit them
+ * @logs: list of segment buffers storing target logs
+ * @nilfs: nilfs object
+ *
+ * The checksums of each log are computed just before the log is
+ * submitted, so that the CRC calculation on a log overlaps with the
+ * write of the logs preceding it.
+ */
 int nilfs_write_logs(struct list_head *logs, struct the_nilfs *nilfs)
 {
 	struct nilfs_segment_buffer *segbuf;
 	int ret = 0;
 
 	list_for_each_entry(segbuf, logs, sb_list) {
+		nilfs_segbuf_add_checksums(segbuf, nilfs->ns_crc_seed);
 		ret = nilfs_segbuf_write(segbuf, nilfs);
 		if (ret)
 			break;
@@ -305,23 +324,6 @@ int nilfs_wait_on_logs(struct list_head *logs)
 	return ret;
 }
 
-/**
- * nilfs_add_checksums_on_logs - add checksums on the logs
- * @logs: list of segment buffers storing target logs
- * @seed: checksum seed value
- */
-void nilfs_add_checksums_on_logs(struct list_head *logs, u32 seed)
-{
-	struct nilfs_segment_buffer *segbuf;
-
-	list_for_each_entry(segbuf, logs, sb_list) {
-		if (segbuf->sb_super_root)
-			nilfs_segbuf_fill_in_super_root_crc(segbuf, seed);
-		nilfs_segbuf_fill_in_segsum_crc(segbuf, seed);
-		nilfs_segbuf_fill_in_data_crc(segbuf, seed);
-	}
-}
-
 /*
  * BIO operations
  */
@@ -906,6 +906,11 @@ static int show_smap(struct seq_file *m, void *v)
 	return 0;
 }
 
+/*
+ * Monitoring tools poll this for many processes; they can keep the file
+ * open and pread() it at offset 0 to get fresh totals, so keep the per-read
+ * work down to the page table walk itself.
+ */
 static int show_smaps_rollup(struct seq_file *m, void *v)
 {
 	struct proc_maps_private *priv = m->private;
@@ -931,8 +936,6 @@ static int show_smaps_rollup(struct seq_file *m, void *v)
 	if (ret)
 		goto out_put_mm;
 
-	hold_task_mempolicy(priv);
-
 	for (vma = priv->mm->mmap; vma; vma = vma->vm_next) {
 		smap_gather_stats(vma, &mss);
 		last_vma_end = vma->vm_end;
@@ -945,7 +948,6 @@ static int show_smaps_rollup(struct seq_file *m, void *v)
 
 	__show_smap(m, &mss, true);
 
-	release_task_mempolicy(priv);
 	up_read(&mm->mmap_sem);
 
 out_put_mm:
@@ -49,9 +49,15 @@ static inline size_t buffer_start(struct persistent_ram_zone *prz)
 	return atomic_read(&prz->buffer->start);
 }
 
-/* increase and wrap the start pointer, returning the old value */
-static size_t buffer_start_add(struct persistent_ram_zone *prz, size_t a)
+/*
+ * Reserve room for a write of @a bytes: increase the size counter until it
+ * hits the max size, then increase and wrap the start pointer, returning
+ * its old value.  Both are updated in one critical section so that writers
+ * to a shared zone only take the zone lock once per record.
+ */
+static size_t buffer_reserve(struct persistent_ram_zone *prz, size_t a)
 {
+	size_t size;
 	int old;
 	int new;
 	unsigned long flags = 0;
@@ -59,6 +65,14 @@ static size_t buffer_start_add(struct persistent_ram_zone *prz, size_t a)
 	if (!(prz->flags & PRZ_FLAG_NO_LOCK))
 		raw_spin_lock_irqsave(&prz->buffer_lock, flags);
 
+	size = atomic_read(&prz->buffer->size);
+	if (size != prz->buffer_size) {
+		size += a;
+		if (size > prz->buffer_size)
+			size = prz->buffer_size;
+		atomic_set(&prz->buffer->size, size);
+	}
+
 	old = atomic_read(&prz->buffer->start);
 	new = old + a;
 	while (unlikely(new >= prz->buffer_size))
@@ -71,30 +85,6 @@ static size_t buffer_start_add(struct persistent_ram_zone *prz, size_t a)
 	return old;
 }
 
-/* increase the size counter until it hits the max size */
-static void buffer_size_add(struct persistent_ram_zone *prz, size_t a)
-{
-	size_t old;
-	size_t new;
-	unsigned long flags = 0;
-
-	if (!(prz->flags & PRZ_FLAG_NO_LOCK))
-		raw_spin_lock_irqsave(&prz->buffer_lock, flags);
-
-	old = atomic_read(&prz->buffer->size);
-	if (old == prz->buffer_size)
-		goto exit;
-
-	new = old + a;
-	if (new > prz->buffer_size)
-		new = prz->buffer_size;
-	atomic_set(&prz->buffer->size, new);
-
-exit:
-	if (!(prz->flags & PRZ_FLAG_NO_LOCK))
-		raw_spin_unlock_irqrestore(&prz->buffer_lock, flags);
-}
-
 static void notrace persistent_ram_encode_rs8(struct persistent_ram_zone *prz,
 	uint8_t *data, size_t len, uint8_t *ecc)
 {
@@ -324,9 +314,7 @@ int notrace persistent_ram_write(struct persistent_ram_zone *prz,
 		c = prz->buffer_size;
 	}
 
-	buffer_size_add(prz, c);
-
-	start = buffer_start_add(prz, c);
+	start = buffer_reserve(prz, c);
 
 	rem = prz->buffer_size - start;
 	if (unlikely(rem < c)) {
@@ -355,9 +343,7 @@ int notrace persistent_ram_write_user(struct persistent_ram_zone *prz,
 		c = prz->buffer_size;
 	}
 
-	buffer_size_add(prz, c);
-
-	start = buffer_start_add(prz, c);
+	start = buffer_reserve(prz, c);
 
 	rem = prz->buffer_size - start;
 	if (unlikely(rem < c)) {
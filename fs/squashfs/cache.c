@@ -19,6 +19,12 @@
  * To avoid out of memory and fragmentation issues with vmalloc the cache
  * uses sequences of kmalloced PAGE_SIZE buffers.
  *
+ * The metadata cache is shrinkable.  It starts out with a small number of
+ * resident entries and grows on demand up to its maximum size, and a
+ * shrinker frees the buffers of unused entries above the minimum size when
+ * memory gets tight.  Inodes, directories and the block lists of large files
+ * then stay decompressed in memory while there is memory to spare.
+ *
  * It should be noted that the cache is not used for file datablocks, these
  * are decompressed and cached in the page-cache in the normal way.  The
  * cache is only used to temporarily cache fragment and metadata blocks
@@ -39,12 +45,58 @@
 #include <linux/spinlock.h>
 #include <linux/wait.h>
 #include <linux/pagemap.h>
+#include <linux/shrinker.h>
 
 #include "squashfs_fs.h"
 #include "squashfs_fs_sb.h"
 #include "squashfs.h"
 #include "page_actor.h"
 
+/*
+ * Allocate buffers for a cache entry.
+ */
+static int squashfs_cache_entry_alloc(struct squashfs_cache *cache,
+	struct squashfs_cache_entry *entry)
+{
+	int j;
+
+	entry->data = kcalloc(cache->pages, sizeof(void *), GFP_KERNEL);
+	if (entry->data == NULL)
+		return -ENOMEM;
+
+	for (j = 0; j < cache->pages; j++) {
+		entry->data[j] = kmalloc(PAGE_SIZE, GFP_KERNEL);
+		if (entry->data[j] == NULL)
+			return -ENOMEM;
+	}
+
+	entry->actor = squashfs_page_actor_init(entry->data, cache->pages, 0);
+	if (entry->actor == NULL)
+		return -ENOMEM;
+
+	return 0;
+}
+
+
+/*
+ * Free the buffers of a cache entry.
+ */
+static void squashfs_cache_entry_free(struct squashfs_cache *cache,
+	struct squashfs_cache_entry *entry)
+{
+	int j;
+
+	if (entry->data) {
+		for (j = 0; j < cache->pages; j++)
+			kfree(entry->data[j]);
+		kfree(entry->data);
+	}
+	kfree(entry->actor);
+	entry->data = NULL;
+	entry->actor = NULL;
+}
+
+
 /*
  * Look-up block in cache, and increment usage count.  If not in cache, read
  * and decompress it from disk.
@@ -54,6 +106,8 @@ struct squashfs_cache_entry *squashfs_cache_get(struct super_block *sb,
 {
 	int i, n;
 	struct squashfs_cache_entry *entry;
+	struct squashfs_cache_entry spare = {};
+	bool grow = true;
 
 	spin_lock(&cache->lock);
 
@@ -68,8 +122,39 @@ struct squashfs_cache_entry *squashfs_cache_get(struct super_block *sb,
 
 		if (n == cache->entries) {
 			/*
-			 * Block not in cache, if all cache entries are used
-			 * go to sleep waiting for one to become available.
+			 * Block not in cache.  If the cache has not grown to
+			 * its maximum size allocate buffers for another entry.
+			 * This drops the lock, so look the block up again.
+			 */
+			if (grow && spare.data == NULL &&
+					cache->resident < cache->entries) {
+				spin_unlock(&cache->lock);
+				if (squashfs_cache_entry_alloc(cache, &spare)) {
+					squashfs_cache_entry_free(cache, &spare);
+					grow = false;
+				}
+				spin_lock(&cache->lock);
+				continue;
+			}
+
+			if (spare.data && cache->resident < cache->entries) {
+				/* Install the new buffers in an empty entry */
+				for (i = 0; cache->entry[i].data; i++)
+					;
+
+				entry = &cache->entry[i];
+				entry->data = spare.data;
+				entry->actor = spare.actor;
+				spare.data = NULL;
+				spare.actor = NULL;
+				cache->resident++;
+				cache->unused++;
+				goto fill;
+			}
+
+			/*
+			 * If all cache entries are used go to sleep waiting
+			 * for one to become available.
 			 */
 			if (cache->unused == 0) {
 				cache->num_waiters++;
@@ -87,14 +172,15 @@ struct squashfs_cache_entry *squashfs_cache_get(struct super_block *sb,
 			 */
 			i = cache->next_blk;
 			for (n = 0; n < cache->entries; n++) {
-				if (cache->entry[i].refcount == 0)
+				if (cache->entry[i].data &&
+						cache->entry[i].refcount == 0)
 					break;
 				i = (i + 1) % cache->entries;
 			}
 
 			cache->next_blk = (i + 1) % cache->entries;
 			entry = &cache->entry[i];
-
+fill:
 			/*
 			 * Initialise chosen cache entry, and fill it in from
 			 * disk.
@@ -157,6 +243,8 @@ struct squashfs_cache_entry *squashfs_cache_get(struct super_block *sb,
 	}
 
 out:
+	squashfs_cache_entry_free(cache, &spare);
+
 	TRACE("Got %s %d, start block %lld, refcount %d, error %d\n",
 		cache->name, i, entry->block, entry->refcount, entry->error);
 
@@ -191,24 +279,70 @@ void squashfs_cache_put(struct squashfs_cache_entry *entry)
 	spin_unlock(&cache->lock);
 }
 
+/*
+ * Number of unused entries the shrinker can free, the cache never shrinks
+ * below its minimum size.
+ */
+static unsigned long squashfs_cache_count(struct shrinker *shrink,
+	struct shrink_control *sc)
+{
+	struct squashfs_cache *cache = container_of(shrink,
+		struct squashfs_cache, shrinker);
+	int count = min(READ_ONCE(cache->unused),
+		READ_ONCE(cache->resident) - cache->min_entries);
+
+	return count > 0 ? count : 0;
+}
+
+
+/*
+ * Free the buffers of unused entries, starting with the next entry the
+ * round-robin strategy would have evicted.
+ */
+static unsigned long squashfs_cache_scan(struct shrinker *shrink,
+	struct shrink_control *sc)
+{
+	struct squashfs_cache *cache = container_of(shrink,
+		struct squashfs_cache, shrinker);
+	unsigned long freed = 0;
+	int i, n;
+
+	spin_lock(&cache->lock);
+	for (i = cache->next_blk, n = 0; n < cache->entries &&
+			freed < sc->nr_to_scan &&
+			cache->resident > cache->min_entries; n++) {
+		struct squashfs_cache_entry *entry = &cache->entry[i];
+
+		if (entry->data && entry->refcount == 0) {
+			squashfs_cache_entry_free(cache, entry);
+			entry->block = SQUASHFS_INVALID_BLK;
+			cache->resident--;
+			cache->unused--;
+			freed++;
+		}
+		i = (i + 1) % cache->entries;
+	}
+	spin_unlock(&cache->lock);
+
+	return freed ? freed : SHRINK_STOP;
+}
+
+
 /*
  * Delete cache reclaiming all kmalloced buffers.
  */
 void squashfs_cache_delete(struct squashfs_cache *cache)
 {
-	int i, j;
+	int i;
 
 	if (cache == NULL)
 		return;
 
-	for (i = 0; i < cache->entries; i++) {
-		if (cache->entry[i].data) {
-			for (j = 0; j < cache->pages; j++)
-				kfree(cache->entry[i].data[j]);
-			kfree(cache->entry[i].data);
-		}
-		kfree(cache->entry[i].actor);
-	}
+	if (cache->min_entries < cache->entries)
+		unregister_shrinker(&cache->shrinker);
+
+	for (i = 0; i < cache->entries; i++)
+		squashfs_cache_entry_free(cache, &cache->entry[i]);
 
 	kfree(cache->entry);
 	kfree(cache);
@@ -216,15 +350,18 @@ void squashfs_cache_delete(struct squashfs_cache *cache)
 
 
 /*
- * Initialise cache allocating the specified number of entries, each of
- * size block_size.  To avoid vmalloc fragmentation issues each entry
- * is allocated as a sequence of kmalloced PAGE_SIZE buffers.
+ * Initialise cache with room for max_entries entries, each of size
+ * block_size, allocating min_entries of them up front.  The remaining
+ * entries are allocated on demand, and freed again by a shrinker.  To avoid
+ * vmalloc fragmentation issues each entry is allocated as a sequence of
+ * kmalloced PAGE_SIZE buffers.
  */
-struct squashfs_cache *squashfs_cache_init(char *name, int entries,
-	int block_size)
+struct squashfs_cache *squashfs_cache_init_shrinkable(char *name,
+	int min_entries, int max_entries, int block_size)
 {
-	int i, j;
+	int i;
 	struct squashfs_cache *cache = kzalloc(sizeof(*cache), GFP_KERNEL);
+	int entries = max_entries;
 
 	if (cache == NULL) {
 		ERROR("Failed to allocate %s cache\n", name);
@@ -239,7 +376,9 @@ struct squashfs_cache *squashfs_cache_init(char *name, int entries,
 
 	cache->curr_blk = 0;
 	cache->next_blk = 0;
-	cache->unused = entries;
+	cache->unused = min_entries;
+	cache->resident = min_entries;
+	cache->min_entries = min_entries;
 	cache->entries = entries;
 	cache->block_size = block_size;
 	cache->pages = block_size >> PAGE_SHIFT;
@@ -255,24 +394,21 @@ struct squashfs_cache *squashfs_cache_init(char *name, int entries,
 		init_waitqueue_head(&cache->entry[i].wait_queue);
 		entry->cache = cache;
 		entry->block = SQUASHFS_INVALID_BLK;
-		entry->data = kcalloc(cache->pages, sizeof(void *), GFP_KERNEL);
-		if (entry->data == NULL) {
+		if (i >= min_entries)
+			continue;
+
+		if (squashfs_cache_entry_alloc(cache, entry)) {
 			ERROR("Failed to allocate %s cache entry\n", name);
 			goto cleanup;
 		}
+	}
 
-		for (j = 0; j < cache->pages; j++) {
-			entry->data[j] = kmalloc(PAGE_SIZE, GFP_KERNEL);
-			if (entry->data[j] == NULL) {
-				ERROR("Failed to allocate %s buffer\n", name);
-				goto cleanup;
-			}
-		}
-
-		entry->actor = squashfs_page_actor_init(entry->data,
-						cache->pages, 0);
-		if (entry->actor == NULL) {
-			ERROR("Failed to allocate %s cache entry\n", name);
+	if (min_entries < entries) {
+		cache->shrinker.count_objects = squashfs_cache_count;
+		cache->shrinker.scan_objects = squashfs_cache_scan;
+		cache->shrinker.seeks = DEFAULT_SEEKS;
+		if (register_shrinker(&cache->shrinker)) {
+			ERROR("Failed to register %s cache shrinker\n", name);
 			goto cleanup;
 		}
 	}
@@ -280,11 +416,24 @@ struct squashfs_cache *squashfs_cache_init(char *name, int entries,
 	return cache;
 
 cleanup:
+	cache->min_entries = entries;
 	squashfs_cache_delete(cache);
 	return NULL;
 }
 
 
+/*
+ * Initialise cache allocating the specified number of entries, each of
+ * size block_size.
+ */
+struct squashfs_cache *squashfs_cache_init(char *name, int entries,
+	int block_size)
+{
+	return squashfs_cache_init_shrinkable(name, entries, entries,
+		block_size);
+}
+
+
 /*
  * Copy up to length bytes from cache entry to buffer starting at offset bytes
  * into the cache entry.  If there's not length bytes then copy the number of
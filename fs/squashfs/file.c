@@ -34,6 +34,7 @@
 #include <linux/string.h>
 #include <linux/pagemap.h>
 #include <linux/mutex.h>
+#include <linux/workqueue.h>
 
 #include "squashfs_fs.h"
 #include "squashfs_fs_sb.h"
@@ -494,7 +495,120 @@ static int squashfs_readpage(struct file *file, struct page *page)
 	return 0;
 }
 
+/*
+ * Readahead.  The readahead pages are added to the page cache and grouped
+ * by datablock, then every datablock is read by its own work item on the
+ * unbound read workqueue.  The reads of consecutive blocks are issued
+ * together, and with one of the parallel decompressors the blocks are
+ * decompressed on several CPUs at once.  Pages in fragments, sparse blocks
+ * and anything going wrong on the way are left to squashfs_readpage().
+ */
+struct squashfs_readahead {
+	struct work_struct	work;
+	struct inode		*inode;
+	u64			block;
+	int			bsize;
+	int			expected;
+	int			start_index;
+	int			pages;
+	struct page		*page[];
+};
+
+static void squashfs_readahead_work(struct work_struct *work)
+{
+	struct squashfs_readahead *ra = container_of(work,
+		struct squashfs_readahead, work);
+
+	squashfs_readahead_block(ra->inode, ra->page, ra->start_index,
+		ra->pages, ra->block, ra->bsize, ra->expected);
+	kfree(ra);
+}
+
+static struct squashfs_readahead *squashfs_readahead_init(struct inode *inode,
+	int index)
+{
+	struct squashfs_sb_info *msblk = inode->i_sb->s_fs_info;
+	int shift = msblk->block_log - PAGE_SHIFT;
+	int file_end = i_size_read(inode) >> msblk->block_log;
+	int last_page = (i_size_read(inode) - 1) >> PAGE_SHIFT;
+	struct squashfs_readahead *ra;
+	int start_index = index << shift;
+	int end_index = start_index | ((1 << shift) - 1);
+	u64 block = 0;
+	int bsize;
+
+	if (index == file_end && squashfs_i(inode)->fragment_block !=
+					SQUASHFS_INVALID_BLK)
+		return NULL;
+
+	bsize = read_blocklist(inode, index, &block);
+	if (bsize <= 0)
+		return NULL;
+
+	if (end_index > last_page)
+		end_index = last_page;
+
+	ra = kzalloc(struct_size(ra, page, end_index - start_index + 1),
+		GFP_KERNEL);
+	if (ra == NULL)
+		return NULL;
+
+	INIT_WORK(&ra->work, squashfs_readahead_work);
+	ra->inode = inode;
+	ra->block = block;
+	ra->bsize = bsize;
+	ra->expected = index == file_end ?
+			(i_size_read(inode) & (msblk->block_size - 1)) :
+			 msblk->block_size;
+	ra->start_index = start_index;
+	ra->pages = end_index - start_index + 1;
+	return ra;
+}
+
+static int squashfs_readpages(struct file *file, struct address_space *mapping,
+	struct list_head *pages, unsigned int nr_pages)
+{
+	struct inode *inode = mapping->host;
+	struct squashfs_sb_info *msblk = inode->i_sb->s_fs_info;
+	int shift = msblk->block_log - PAGE_SHIFT;
+	struct squashfs_readahead *ra = NULL;
+	struct page *page;
+	int index;
+
+	/* Readahead pages come in ascending index order */
+	while (!list_empty(pages)) {
+		page = lru_to_page(pages);
+		list_del(&page->lru);
+		if (add_to_page_cache_lru(page, mapping, page->index,
+				readahead_gfp_mask(mapping)))
+			goto next;
+
+		index = page->index >> shift;
+		if (ra == NULL || (ra->start_index >> shift) != index) {
+			/* The previous datablock is complete, start it */
+			if (ra)
+				queue_work(msblk->read_wq, &ra->work);
+			ra = squashfs_readahead_init(inode, index);
+		}
+
+		if (ra && page->index - ra->start_index < ra->pages) {
+			/* The work item owns a reference until it is done */
+			get_page(page);
+			ra->page[page->index - ra->start_index] = page;
+		} else
+			squashfs_readpage(file, page);
+next:
+		put_page(page);
+	}
+
+	if (ra)
+		queue_work(msblk->read_wq, &ra->work);
+
+	return 0;
+}
+
 
 const struct address_space_operations squashfs_aops = {
-	.readpage = squashfs_readpage
+	.readpage = squashfs_readpage,
+	.readpages = squashfs_readpages
 };
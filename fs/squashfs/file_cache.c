@@ -34,3 +34,34 @@ int squashfs_readpage_block(struct page *page, u64 block, int bsize, int expecte
 	squashfs_cache_put(buffer);
 	return res;
 }
+
+/* Read a datablock for readahead and memcopy it into the readahead pages */
+int squashfs_readahead_block(struct inode *inode, struct page **page,
+	int start_index, int pages, u64 block, int bsize, int expected)
+{
+	struct squashfs_cache_entry *buffer = squashfs_get_datablock(
+		inode->i_sb, block, bsize);
+	int i, res = buffer->error;
+
+	if (res)
+		ERROR("Unable to read page, block %llx, size %x\n", block,
+			bsize);
+
+	for (i = 0; i < pages; i++) {
+		int avail = clamp_t(int, expected - i * PAGE_SIZE, 0, PAGE_SIZE);
+
+		if (page[i] == NULL)
+			continue;
+
+		if (res)
+			SetPageError(page[i]);
+		else
+			squashfs_fill_page(page[i], buffer, i * PAGE_SIZE,
+				avail);
+		unlock_page(page[i]);
+		put_page(page[i]);
+	}
+
+	squashfs_cache_put(buffer);
+	return res;
+}
@@ -18,47 +18,35 @@
 #include "squashfs.h"
 #include "page_actor.h"
 
-static int squashfs_read_cache(struct page *target_page, u64 block, int bsize,
-	int pages, struct page **page, int bytes);
-
-/* Read separately compressed datablock directly into page cache */
-int squashfs_readpage_block(struct page *target_page, u64 block, int bsize,
-	int expected)
+static int squashfs_read_cache(struct inode *inode, struct page *target_page,
+	u64 block, int bsize, int pages, struct page **page, int bytes);
 
+/*
+ * Decompress a datablock into the page cache pages covering it.  Slots of
+ * page[] that are already filled hold locked pages owned by the caller, the
+ * rest are grabbed here.  All pages but target_page are unlocked and released
+ * when done, target_page is dealt with by the caller.
+ */
+static int squashfs_read_block_pages(struct inode *inode,
+	struct page *target_page, struct page **page, int start_index,
+	int pages, u64 block, int bsize, int expected)
 {
-	struct inode *inode = target_page->mapping->host;
-	struct squashfs_sb_info *msblk = inode->i_sb->s_fs_info;
-
-	int file_end = (i_size_read(inode) - 1) >> PAGE_SHIFT;
-	int mask = (1 << (msblk->block_log - PAGE_SHIFT)) - 1;
-	int start_index = target_page->index & ~mask;
-	int end_index = start_index | mask;
-	int i, n, pages, missing_pages, bytes, res = -ENOMEM;
-	struct page **page;
+	int i, n, missing_pages, bytes, res = -ENOMEM;
 	struct squashfs_page_actor *actor;
 	void *pageaddr;
 
-	if (end_index > file_end)
-		end_index = file_end;
-
-	pages = end_index - start_index + 1;
-
-	page = kmalloc_array(pages, sizeof(void *), GFP_KERNEL);
-	if (page == NULL)
-		return res;
-
 	/*
 	 * Create a "page actor" which will kmap and kunmap the
 	 * page cache pages appropriately within the decompressor
 	 */
 	actor = squashfs_page_actor_init_special(page, pages, 0);
 	if (actor == NULL)
-		goto out;
+		goto mark_errored;
 
 	/* Try to grab all the pages covered by the Squashfs block */
 	for (missing_pages = 0, i = 0, n = start_index; i < pages; i++, n++) {
-		page[i] = (n == target_page->index) ? target_page :
-			grab_cache_page_nowait(target_page->mapping, n);
+		if (page[i] == NULL)
+			page[i] = grab_cache_page_nowait(inode->i_mapping, n);
 
 		if (page[i] == NULL) {
 			missing_pages++;
@@ -67,7 +55,8 @@ int squashfs_readpage_block(struct page *target_page, u64 block, int bsize,
 
 		if (PageUptodate(page[i])) {
 			unlock_page(page[i]);
-			put_page(page[i]);
+			if (page[i] != target_page)
+				put_page(page[i]);
 			page[i] = NULL;
 			missing_pages++;
 		}
@@ -81,8 +70,8 @@ int squashfs_readpage_block(struct page *target_page, u64 block, int bsize,
 		 * squashfs_readpage also trying to grab them.  Fall back to
 		 * using an intermediate buffer.
 		 */
-		res = squashfs_read_cache(target_page, block, bsize, pages,
-							page, expected);
+		res = squashfs_read_cache(inode, target_page, block, bsize,
+							pages, page, expected);
 		if (res < 0)
 			goto mark_errored;
 
@@ -117,7 +106,6 @@ int squashfs_readpage_block(struct page *target_page, u64 block, int bsize,
 	}
 
 	kfree(actor);
-	kfree(page);
 
 	return 0;
 
@@ -136,15 +124,56 @@ int squashfs_readpage_block(struct page *target_page, u64 block, int bsize,
 
 out:
 	kfree(actor);
+	return res;
+}
+
+/* Read separately compressed datablock directly into page cache */
+int squashfs_readpage_block(struct page *target_page, u64 block, int bsize,
+	int expected)
+
+{
+	struct inode *inode = target_page->mapping->host;
+	struct squashfs_sb_info *msblk = inode->i_sb->s_fs_info;
+
+	int file_end = (i_size_read(inode) - 1) >> PAGE_SHIFT;
+	int mask = (1 << (msblk->block_log - PAGE_SHIFT)) - 1;
+	int start_index = target_page->index & ~mask;
+	int end_index = start_index | mask;
+	int pages, res;
+	struct page **page;
+
+	if (end_index > file_end)
+		end_index = file_end;
+
+	pages = end_index - start_index + 1;
+
+	page = kcalloc(pages, sizeof(void *), GFP_KERNEL);
+	if (page == NULL)
+		return -ENOMEM;
+
+	page[target_page->index - start_index] = target_page;
+	res = squashfs_read_block_pages(inode, target_page, page, start_index,
+		pages, block, bsize, expected);
+
 	kfree(page);
 	return res;
 }
 
+/*
+ * Read a datablock for readahead.  page[] holds the locked readahead pages
+ * of the block, which are all unlocked and released when done.
+ */
+int squashfs_readahead_block(struct inode *inode, struct page **page,
+	int start_index, int pages, u64 block, int bsize, int expected)
+{
+	return squashfs_read_block_pages(inode, NULL, page, start_index, pages,
+		block, bsize, expected);
+}
+
 
-static int squashfs_read_cache(struct page *target_page, u64 block, int bsize,
-	int pages, struct page **page, int bytes)
+static int squashfs_read_cache(struct inode *i, struct page *target_page,
+	u64 block, int bsize, int pages, struct page **page, int bytes)
 {
-	struct inode *i = target_page->mapping->host;
 	struct squashfs_cache_entry *buffer = squashfs_get_datablock(i->i_sb,
 						 block, bsize);
 	int res = buffer->error, n, offset = 0;
@@ -21,9 +21,12 @@ struct squashfs_cache {
 	int			unused;
 	int			block_size;
 	int			pages;
+	int			resident;
+	int			min_entries;
 	spinlock_t		lock;
 	wait_queue_head_t	wait_queue;
 	struct squashfs_cache_entry *entry;
+	struct shrinker		shrinker;
 };
 
 struct squashfs_cache_entry {
@@ -47,6 +50,7 @@ struct squashfs_sb_info {
 	struct squashfs_cache			*block_cache;
 	struct squashfs_cache			*fragment_cache;
 	struct squashfs_cache			*read_page;
+	struct workqueue_struct			*read_wq;
 	int					next_meta_index;
 	__le64					*id_table;
 	__le64					*fragment_index;
@@ -25,6 +25,7 @@
 #include <linux/module.h>
 #include <linux/magic.h>
 #include <linux/xattr.h>
+#include <linux/workqueue.h>
 
 #include "squashfs_fs.h"
 #include "squashfs_fs_sb.h"
@@ -188,8 +189,9 @@ static int squashfs_fill_super(struct super_block *sb, void *data, int silent)
 
 	err = -ENOMEM;
 
-	msblk->block_cache = squashfs_cache_init("metadata",
-			SQUASHFS_CACHED_BLKS, SQUASHFS_METADATA_SIZE);
+	msblk->block_cache = squashfs_cache_init_shrinkable("metadata",
+			SQUASHFS_CACHED_BLKS, SQUASHFS_META_CACHE_BLKS,
+			SQUASHFS_METADATA_SIZE);
 	if (msblk->block_cache == NULL)
 		goto failed_mount;
 
@@ -201,6 +203,14 @@ static int squashfs_fill_super(struct super_block *sb, void *data, int silent)
 		goto failed_mount;
 	}
 
+	/* Datablocks read ahead are read and decompressed in parallel */
+	msblk->read_wq = alloc_workqueue("squashfs_read",
+		WQ_UNBOUND | WQ_MEM_RECLAIM, 0);
+	if (msblk->read_wq == NULL) {
+		ERROR("Failed to allocate read workqueue\n");
+		goto failed_mount;
+	}
+
 	msblk->stream = squashfs_decompressor_setup(sb, flags);
 	if (IS_ERR(msblk->stream)) {
 		err = PTR_ERR(msblk->stream);
@@ -322,6 +332,8 @@ static int squashfs_fill_super(struct super_block *sb, void *data, int silent)
 	return 0;
 
 failed_mount:
+	if (msblk->read_wq)
+		destroy_workqueue(msblk->read_wq);
 	squashfs_cache_delete(msblk->block_cache);
 	squashfs_cache_delete(msblk->fragment_cache);
 	squashfs_cache_delete(msblk->read_page);
@@ -370,6 +382,7 @@ static void squashfs_put_super(struct super_block *sb)
 {
 	if (sb->s_fs_info) {
 		struct squashfs_sb_info *sbi = sb->s_fs_info;
+		destroy_workqueue(sbi->read_wq);
 		squashfs_cache_delete(sbi->block_cache);
 		squashfs_cache_delete(sbi->fragment_cache);
 		squashfs_cache_delete(sbi->read_page);
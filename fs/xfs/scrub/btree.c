@@ -578,6 +578,43 @@ xchk_btree_block_keys(
 		xchk_btree_set_corrupt(bs->sc, cur, 1);
 }
 
+/*
+ * Start readahead of every child block of a node that we're about to
+ * descend into.  The walk below visits the children one at a time, so
+ * without this each block costs us a synchronous read.  Pointers that
+ * don't look sane are skipped here and flagged when we get to them.
+ */
+STATIC void
+xchk_btree_readahead_children(
+	struct xchk_btree	*bs,
+	int			level,
+	struct xfs_btree_block	*block)
+{
+	struct xfs_btree_cur	*cur = bs->cur;
+	struct xfs_mount	*mp = cur->bc_mp;
+	union xfs_btree_ptr	*pp;
+	int			numrecs = be16_to_cpu(block->bb_numrecs);
+	int			i;
+
+	for (i = 1; i <= numrecs; i++) {
+		pp = xfs_btree_ptr_addr(cur, i, block);
+		if (cur->bc_flags & XFS_BTREE_LONG_PTRS) {
+			if (!xfs_btree_check_lptr(cur, be64_to_cpu(pp->l),
+					level))
+				continue;
+			xfs_btree_reada_bufl(mp, be64_to_cpu(pp->l), 1,
+					cur->bc_ops->buf_ops);
+		} else {
+			if (!xfs_btree_check_sptr(cur, be32_to_cpu(pp->s),
+					level))
+				continue;
+			xfs_btree_reada_bufs(mp, cur->bc_private.a.agno,
+					be32_to_cpu(pp->s), 1,
+					cur->bc_ops->buf_ops);
+		}
+	}
+}
+
 /*
  * Visit all nodes and leaves of a btree.  Check that all pointers and
  * records are in order, that the keys reflect the records, and use a callback
@@ -634,6 +671,8 @@ xchk_btree(
 		goto out;
 
 	cur->bc_ptrs[level] = 1;
+	if (level > 0)
+		xchk_btree_readahead_children(&bs, level, block);
 
 	while (level < cur->bc_nlevels) {
 		block = xfs_btree_get_block(cur, level, &bp);
@@ -689,6 +728,8 @@ xchk_btree(
 			goto out;
 
 		cur->bc_ptrs[level] = 1;
+		if (level > 0)
+			xchk_btree_readahead_children(&bs, level, block);
 	}
 
 out:
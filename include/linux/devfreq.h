@@ -119,6 +119,8 @@ struct devfreq_dev_profile {
  * @nb:		notifier block used to notify devfreq object that it should
  *		reevaluate operable frequencies. Devfreq users may use
  *		devfreq.nb to the corresponding register notifier call chain.
+ * @nb_min:	notifier block for DEV_PM_QOS_MIN_FREQUENCY changes on the
+ *		parent device.
  * @work:	delayed work for load monitoring.
  * @previous_freq:	previously configured frequency value.
  * @data:	Private data of the governor. The devfreq framework does not
@@ -154,6 +156,7 @@ struct devfreq {
 	const struct devfreq_governor *governor;
 	char governor_name[DEVFREQ_NAME_LEN];
 	struct notifier_block nb;
+	struct notifier_block nb_min;
 	struct delayed_work work;
 
 	unsigned long previous_freq;
@@ -42,6 +42,17 @@ struct dma_buf_ops {
 	  */
 	bool cache_sgt_mapping;
 
+	/**
+	 * @skip_redundant_cpu_sync:
+	 *
+	 * If true the framework tracks whether a device could have touched
+	 * the buffer since the last CPU access and whether the CPU wrote to
+	 * it, and leaves out @begin_cpu_access and @end_cpu_access calls
+	 * that would not change anything. Only exporters whose CPU access
+	 * callbacks do nothing but cache maintenance may set this.
+	 */
+	bool skip_redundant_cpu_sync;
+
 	/**
 	 * @attach:
 	 *
@@ -283,6 +294,7 @@ struct dma_buf_ops {
  * @poll: for userspace poll support
  * @cb_excl: for userspace poll support
  * @cb_shared: for userspace poll support
+ * @sync: CPU access tracking for &dma_buf_ops.skip_redundant_cpu_sync
  *
  * This represents a shared buffer, created by calling dma_buf_export(). The
  * userspace representation is a normal file descriptor, which can be created by
@@ -317,6 +329,21 @@ struct dma_buf {
 
 		__poll_t active;
 	} cb_excl, cb_shared;
+
+	struct dma_buf_sync_state {
+		/* protects the fields below */
+		spinlock_t lock;
+		/* number of device mappings currently set up */
+		unsigned int dev_mappings;
+		/* bumped whenever a device mapping is set up or torn down */
+		unsigned long dev_gen;
+		/* @dev_gen when the CPU view was last made coherent */
+		unsigned long cpu_gen;
+		/* the CPU may have written since the last end_cpu_access */
+		bool cpu_dirty;
+		unsigned long done;
+		unsigned long skipped;
+	} sync;
 };
 
 /**
@@ -731,6 +731,7 @@ struct transaction_run_stats_s {
 	unsigned long		rs_locked;
 	unsigned long		rs_flushing;
 	unsigned long		rs_logging;
+	unsigned long		rs_committing;
 
 	__u32			rs_handle_count;
 	__u32			rs_blocks;
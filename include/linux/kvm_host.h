@@ -475,6 +475,8 @@ struct kvm {
 	struct kvm_coalesced_mmio_ring *coalesced_mmio_ring;
 	spinlock_t ring_lock;
 	struct list_head coalesced_zones;
+	struct eventfd_ctx *coalesced_mmio_eventfd;
+	u32 coalesced_mmio_watermark;
 #endif
 
 	struct mutex irq_lock;
@@ -237,6 +237,51 @@ struct mmc_part {
 #define MMC_BLK_DATA_AREA_RPMB	(1<<3)
 };
 
+/*
+ * Packed write statistics
+ */
+struct mmc_packed_stats {
+	unsigned long		cmds;		/* packed commands issued */
+	unsigned long		reqs;		/* requests sent packed */
+	unsigned long		blocks;		/* data blocks sent packed */
+	unsigned long		single;		/* packs flushed with one request */
+	unsigned long		failed;		/* packed commands retried unpacked */
+};
+
+/*
+ * Block request latency, per command class and stage
+ */
+enum mmc_lat_class {
+	MMC_LAT_READ,
+	MMC_LAT_WRITE,
+	MMC_LAT_DISCARD,
+	MMC_LAT_FLUSH,
+	MMC_LAT_RPMB,
+	MMC_LAT_CLASS_MAX,
+};
+
+enum mmc_lat_stage {
+	MMC_LAT_ISSUE,		/* dispatched until handed to the host */
+	MMC_LAT_BUSY,		/* handed to the host until done by the card */
+	MMC_LAT_COMPLETE,	/* done until completed to the block layer */
+	MMC_LAT_STAGE_MAX,
+};
+
+/* Bucket n counts latencies below 2^n us, the last one everything above */
+#define MMC_LAT_BUCKETS		20
+
+struct mmc_lat_hist {
+	unsigned long		buckets[MMC_LAT_BUCKETS];
+	unsigned long		count;
+	u64			total_us;
+	u64			max_us;
+};
+
+struct mmc_lat_stats {
+	spinlock_t		lock;
+	struct mmc_lat_hist	hist[MMC_LAT_CLASS_MAX][MMC_LAT_STAGE_MAX];
+};
+
 /*
  * MMC device
  */
@@ -309,6 +354,11 @@ struct mmc_card {
 
 	unsigned int		bouncesz;	/* Bounce buffer size */
 	struct workqueue_struct *complete_wq;	/* Private workqueue */
+
+	u32			packed_max_reqs;	/* Most writes in a packed command, <2 disables packing */
+	u32			packed_max_sectors;	/* Largest write considered for packing */
+	struct mmc_packed_stats	packed_stats;
+	struct mmc_lat_stats	lat_stats;		/* Block request latency */
 };
 
 static inline bool mmc_large_sector(struct mmc_card *card)
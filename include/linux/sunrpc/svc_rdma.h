@@ -173,6 +173,9 @@ extern int svc_rdma_send_write_chunk(struct svcxprt_rdma *rdma,
 extern int svc_rdma_send_reply_chunk(struct svcxprt_rdma *rdma,
 				     __be32 *rp_ch, bool writelist,
 				     struct xdr_buf *xdr);
+extern int svc_rdma_send_write_reply_chunks(struct svcxprt_rdma *rdma,
+					    __be32 *wr_ch, __be32 *rp_ch,
+					    struct xdr_buf *xdr, int *wr_len);
 
 /* svc_rdma_sendto.c */
 extern void svc_rdma_send_ctxts_destroy(struct svcxprt_rdma *rdma);
@@ -317,6 +317,12 @@ struct thermal_zone_params {
 	/* threshold below which the error is no longer accumulated */
 	s32 integral_cutoff;
 
+	/*
+	 * non-zero to have the power allocator act on the temperature
+	 * extrapolated to its next sample while the zone is heating up
+	 */
+	s32 predict_temp;
+
 	/*
 	 * @slope:	slope of a linear temperature adjustment curve.
 	 * 		Used by thermal zone drivers.
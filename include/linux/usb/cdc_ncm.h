@@ -68,6 +68,9 @@
 /* Default value for MaxDatagramSize */
 #define	CDC_NCM_MAX_DATAGRAM_SIZE		8192	/* bytes */
 
+/* Received datagrams shorter than this are copied out of the NTB */
+#define	CDC_NCM_RX_COPYBREAK			1024	/* bytes */
+
 /*
  * Maximum amount of datagrams in NCM Datagram Pointer Table, not counting
  * the last NULL entry.
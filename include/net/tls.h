@@ -157,7 +157,6 @@ struct tls_sw_context_tx {
 	struct list_head tx_list;
 	atomic_t encrypt_pending;
 	int async_notify;
-	int async_capable;
 
 #define BIT_TX_SCHEDULED	0
 #define BIT_TX_CLOSING		1
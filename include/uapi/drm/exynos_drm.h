@@ -131,8 +131,22 @@ struct drm_exynos_g2d_set_cmdlist {
 	__u64					user_data;
 };
 
+/*
+ * Priority class of an exec. Pending execs of a higher class are started
+ * first; within a class they run in submission order. G2D_PRIORITY_HIGH
+ * needs CAP_SYS_NICE or DRM master.
+ */
+enum drm_exynos_g2d_priority {
+	G2D_PRIORITY_NORMAL,
+	G2D_PRIORITY_HIGH,
+	G2D_PRIORITY_LOW,
+	G2D_PRIORITY_NUM,
+};
+
 struct drm_exynos_g2d_exec {
 	__u64					async;
+	__u32					priority;
+	__u32					reserved;
 };
 
 /* Exynos DRM IPP v2 API */
@@ -348,6 +362,44 @@ struct drm_exynos_ioctl_ipp_commit {
 	__u64 user_data;
 };
 
+#define DRM_EXYNOS_IPP_CHAIN_MAX	4
+
+/**
+ * A single stage of an IPP chain.
+ *
+ * @ipp_id: id of IPP module to run the stage
+ * @params_size: size of parameters array (in bytes)
+ * @params_ptr: pointer to parameters array of drm_exynos_ipp_task_*
+ *		structures
+ */
+struct drm_exynos_ipp_chain_stage {
+	__u32 ipp_id;
+	__u32 params_size;
+	__u64 params_ptr;
+};
+
+/**
+ * Perform image processing on a chain of IPP modules, each stage being
+ * started as soon as the previous one finishes.
+ *
+ * The destination of every stage but the last one is a buffer owned by the
+ * kernel, which is then used as the source of the next stage. Its format,
+ * size and pitch are taken from the destination buffer parameters of the
+ * stage, whose gem_id fields must be 0. Source buffer parameters of all but
+ * the first stage are ignored.
+ *
+ * @flags: bitmask of drm_exynos_ipp_flag values
+ * @num_stages: number of stages (2 to DRM_EXYNOS_IPP_CHAIN_MAX)
+ * @stages_ptr: pointer to array of drm_exynos_ipp_chain_stage structures
+ * @user_data: (optional) data for drm event sent after the last stage
+ */
+struct drm_exynos_ioctl_ipp_chain_commit {
+	__u32 flags;
+	__u32 num_stages;
+	__u64 stages_ptr;
+	__u64 user_data;
+};
+
 #define DRM_EXYNOS_GEM_CREATE		0x00
 #define DRM_EXYNOS_GEM_MAP		0x01
 /* Reserved 0x03 ~ 0x05 for exynos specific gem ioctl */
@@ -365,6 +417,7 @@ struct drm_exynos_ioctl_ipp_commit {
 #define DRM_EXYNOS_IPP_GET_CAPS		0x41
 #define DRM_EXYNOS_IPP_GET_LIMITS	0x42
 #define DRM_EXYNOS_IPP_COMMIT		0x43
+#define DRM_EXYNOS_IPP_CHAIN_COMMIT	0x44
 
 #define DRM_IOCTL_EXYNOS_GEM_CREATE		DRM_IOWR(DRM_COMMAND_BASE + \
 		DRM_EXYNOS_GEM_CREATE, struct drm_exynos_gem_create)
@@ -393,6 +446,9 @@ struct drm_exynos_ioctl_ipp_commit {
 		struct drm_exynos_ioctl_ipp_get_limits)
 #define DRM_IOCTL_EXYNOS_IPP_COMMIT		DRM_IOWR(DRM_COMMAND_BASE + \
 		DRM_EXYNOS_IPP_COMMIT, struct drm_exynos_ioctl_ipp_commit)
+#define DRM_IOCTL_EXYNOS_IPP_CHAIN_COMMIT	DRM_IOWR(DRM_COMMAND_BASE + \
+		DRM_EXYNOS_IPP_CHAIN_COMMIT, \
+		struct drm_exynos_ioctl_ipp_chain_commit)
 
 /* EXYNOS specific events */
 #define DRM_EXYNOS_G2D_EVENT		0x80000000
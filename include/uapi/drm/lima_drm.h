@@ -118,6 +118,65 @@ struct drm_lima_gem_submit {
 	__u32 in_sync[2];  /* in, drm_syncobj handle used to wait before start this task */
 };
 
+#define LIMA_SUBMIT_BATCH_MAX 32
+
+/**
+ * submit several tasks to GPU at once
+ *
+ * Tasks are queued in array order as with separate submits. In addition
+ * each PP task waits for the closest GP task before it in the array, so
+ * a frame's GP and PP tasks can be queued together without syncobjs while
+ * the GP task of the next frame still overlaps the PP task of this one.
+ * On return nr_submits holds the number of tasks actually queued.
+ */
+struct drm_lima_gem_submit_batch {
+	__u32 nr_submits;  /* in/out, array length of submits field */
+	__u32 flags;       /* in, must be zero */
+	__u64 submits;     /* in, array of drm_lima_gem_submit */
+};
+
+#define LIMA_PERFCNT_L2_MAX       3
+#define LIMA_PERFCNT_PP_MAX       8
+#define LIMA_PERFCNT_RING_SAMPLES 256
+
+/* counter values of one task, units not present read as zero */
+struct drm_lima_perfcnt_sample {
+	__u32 seqno;       /* fence seqno of the task on its pipe */
+	__u32 pipe;        /* LIMA_PIPE_GP/PP */
+	__u32 l2[LIMA_PERFCNT_L2_MAX][2];
+	__u32 gp[2];
+	__u32 pp[LIMA_PERFCNT_PP_MAX][2];
+};
+
+/*
+ * layout of the perfcnt buffer, head counts the samples written so far
+ * and sample n lives in samples[n % LIMA_PERFCNT_RING_SAMPLES], older
+ * samples are overwritten when user does not keep up
+ */
+struct drm_lima_perfcnt_ring {
+	__u32 head;
+	__u32 _pad;
+	struct drm_lima_perfcnt_sample samples[LIMA_PERFCNT_RING_SAMPLES];
+};
+
+/**
+ * start/stop sampling of GP, PP and L2 cache counters for each task
+ *
+ * Only one file can sample at a time. On enable a buffer holding a
+ * drm_lima_perfcnt_ring is created and returned as a GEM handle, map
+ * it with DRM_IOCTL_LIMA_GEM_INFO and mmap.
+ *
+ * The interface is not stable yet and returns -ENOSYS unless the module
+ * is loaded with unstable_ioctls=1.
+ */
+struct drm_lima_perfcnt_enable {
+	__u32 enable;      /* in, 1 to start, 0 to stop */
+	__u32 handle;      /* out, GEM handle of the sample ring */
+	__u32 l2_src[2];   /* in, L2 cache counter event sources */
+	__u32 gp_src[2];   /* in, GP counter event sources */
+	__u32 pp_src[2];   /* in, PP counter event sources */
+};
+
 #define LIMA_GEM_WAIT_READ   0x01
 #define LIMA_GEM_WAIT_WRITE  0x02
 
@@ -153,6 +212,8 @@ struct drm_lima_ctx_free {
 #define DRM_LIMA_GEM_WAIT    0x04
 #define DRM_LIMA_CTX_CREATE  0x05
 #define DRM_LIMA_CTX_FREE    0x06
+#define DRM_LIMA_GEM_SUBMIT_BATCH 0x07
+#define DRM_LIMA_PERFCNT_ENABLE   0x08
 
 #define DRM_IOCTL_LIMA_GET_PARAM DRM_IOWR(DRM_COMMAND_BASE + DRM_LIMA_GET_PARAM, struct drm_lima_get_param)
 #define DRM_IOCTL_LIMA_GEM_CREATE DRM_IOWR(DRM_COMMAND_BASE + DRM_LIMA_GEM_CREATE, struct drm_lima_gem_create)
@@ -161,6 +222,8 @@ struct drm_lima_ctx_free {
 #define DRM_IOCTL_LIMA_GEM_WAIT DRM_IOW(DRM_COMMAND_BASE + DRM_LIMA_GEM_WAIT, struct drm_lima_gem_wait)
 #define DRM_IOCTL_LIMA_CTX_CREATE DRM_IOR(DRM_COMMAND_BASE + DRM_LIMA_CTX_CREATE, struct drm_lima_ctx_create)
 #define DRM_IOCTL_LIMA_CTX_FREE DRM_IOW(DRM_COMMAND_BASE + DRM_LIMA_CTX_FREE, struct drm_lima_ctx_free)
+#define DRM_IOCTL_LIMA_GEM_SUBMIT_BATCH DRM_IOWR(DRM_COMMAND_BASE + DRM_LIMA_GEM_SUBMIT_BATCH, struct drm_lima_gem_submit_batch)
+#define DRM_IOCTL_LIMA_PERFCNT_ENABLE DRM_IOWR(DRM_COMMAND_BASE + DRM_LIMA_PERFCNT_ENABLE, struct drm_lima_perfcnt_enable)
 
 #if defined(__cplusplus)
 }
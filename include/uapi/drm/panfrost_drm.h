@@ -82,11 +82,19 @@ struct drm_panfrost_wait_bo {
 	__s64 timeout_ns;	/* absolute */
 };
 
+/* Valid flags to pass to drm_panfrost_create_bo */
+#define PANFROST_BO_NOEXEC	1
+#define PANFROST_BO_HEAP	2
+
 /**
  * struct drm_panfrost_create_bo - ioctl argument for creating Panfrost BOs.
  *
- * There are currently no values for the flags argument, but it may be
- * used in a future extension.
+ * PANFROST_BO_NOEXEC maps the BO non-executable for the GPU.
+ *
+ * PANFROST_BO_HEAP reserves GPU address space for the BO without backing
+ * it. Memory is added in 2MB chunks as the GPU faults on it, so a tiler
+ * heap can be given a worst-case size without paying for it up front.
+ * Heap BOs must also be PANFROST_BO_NOEXEC and cannot be mmapped.
  */
 struct drm_panfrost_create_bo {
 	__u32 size;
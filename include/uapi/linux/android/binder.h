@@ -36,6 +36,7 @@ enum {
 	BINDER_TYPE_FD		= B_PACK_CHARS('f', 'd', '*', B_TYPE_LARGE),
 	BINDER_TYPE_FDA		= B_PACK_CHARS('f', 'd', 'a', B_TYPE_LARGE),
 	BINDER_TYPE_PTR		= B_PACK_CHARS('p', 't', '*', B_TYPE_LARGE),
+	BINDER_TYPE_FILE_PAGES	= B_PACK_CHARS('f', 'p', '*', B_TYPE_LARGE),
 };
 
 enum {
@@ -49,6 +50,14 @@ enum {
 	 * context
 	 */
 	FLAT_BINDER_FLAG_TXN_SECURITY_CTX = 0x1000,
+
+	/**
+	 * @FLAT_BINDER_FLAG_INHERIT_RT: whether the node inherits RT policy
+	 *
+	 * Only when set, calls from real-time callers into this node will
+	 * run with the caller's real-time scheduling policy and priority.
+	 */
+	FLAT_BINDER_FLAG_INHERIT_RT = 0x800,
 };
 
 #ifdef BINDER_IPC_32BIT
@@ -168,6 +177,31 @@ struct binder_fd_array_object {
 	binder_size_t			parent_offset;
 };
 
+/* struct binder_file_pages_object - object describing a sealed memfd range
+ * @hdr:		common header structure
+ * @fd:			memfd holding the data
+ * @buffer:		filled in by the driver with the address of the data
+ *			in the target
+ * @length:		length of the data
+ * @offset:		page aligned offset of the data in @fd
+ *
+ * A binder_file_pages object hands a large payload to the target
+ * without copying it: the page cache pages of @fd are mapped read-only
+ * into the target's binder buffer. @fd must be a memfd sealed with
+ * F_SEAL_WRITE and F_SEAL_SHRINK so the sender can no longer change the
+ * data once it is sent. The payload is placed at the next page boundary
+ * of the extra buffers area, so the sender must reserve length rounded
+ * up to a page plus one more page for alignment in extra_buffers_size.
+ * The pages are released together with the transaction buffer.
+ */
+struct binder_file_pages_object {
+	struct binder_object_header	hdr;
+	__u32				fd;
+	binder_uintptr_t		buffer;
+	binder_size_t			length;
+	binder_size_t			offset;
+};
+
 /*
  * On 64-bit platforms where user code may run in 32-bits the driver must
  * translate the buffer (and local binder) addresses appropriately.
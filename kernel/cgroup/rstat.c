@@ -3,6 +3,12 @@
 
 #include <linux/sched/cputime.h>
 
+/*
+ * cpu.stat readers are served without a flush if @cgrp's subtree was
+ * flushed less than this long ago.
+ */
+#define CGROUP_BSTAT_STALE_MS	10
+
 static DEFINE_SPINLOCK(cgroup_rstat_lock);
 static DEFINE_PER_CPU(raw_spinlock_t, cgroup_rstat_cpu_lock);
 
@@ -152,6 +158,7 @@ static struct cgroup *cgroup_rstat_cpu_pop_updated(struct cgroup *pos,
 static void cgroup_rstat_flush_locked(struct cgroup *cgrp, bool may_sleep)
 	__releases(&cgroup_rstat_lock) __acquires(&cgroup_rstat_lock)
 {
+	unsigned long start = jiffies;
 	int cpu;
 
 	lockdep_assert_held(&cgroup_rstat_lock);
@@ -159,8 +166,20 @@ static void cgroup_rstat_flush_locked(struct cgroup *cgrp, bool may_sleep)
 	for_each_possible_cpu(cpu) {
 		raw_spinlock_t *cpu_lock = per_cpu_ptr(&cgroup_rstat_cpu_lock,
 						       cpu);
+		struct cgroup_rstat_cpu *rstatc = cgroup_rstat_cpu(cgrp, cpu);
 		struct cgroup *pos = NULL;
 
+		/*
+		 * Nothing in @cgrp's subtree, @cgrp included, was updated on
+		 * @cpu: no children are queued and @cgrp itself isn't linked
+		 * on its parent's updated list.  Racing with a concurrent
+		 * cgroup_rstat_updated() here is no different from that
+		 * update arriving after the flush.
+		 */
+		if (READ_ONCE(rstatc->updated_children) == cgrp &&
+		    !READ_ONCE(rstatc->updated_next))
+			continue;
+
 		raw_spin_lock(cpu_lock);
 		while ((pos = cgroup_rstat_cpu_pop_updated(pos, cgrp, cpu))) {
 			struct cgroup_subsys_state *css;
@@ -184,6 +203,8 @@ static void cgroup_rstat_flush_locked(struct cgroup *cgrp, bool may_sleep)
 			spin_lock_irq(&cgroup_rstat_lock);
 		}
 	}
+
+	cgrp->rstat_flush_time = start;
 }
 
 /**
@@ -240,6 +261,21 @@ void cgroup_rstat_flush_hold(struct cgroup *cgrp)
 	cgroup_rstat_flush_locked(cgrp, true);
 }
 
+/*
+ * Like cgroup_rstat_flush_hold() but, for frequent readers which can live
+ * with slightly old numbers, skip the flush if @cgrp's subtree has been
+ * flushed within the last CGROUP_BSTAT_STALE_MS.
+ */
+static void cgroup_rstat_flush_hold_lazy(struct cgroup *cgrp)
+	__acquires(&cgroup_rstat_lock)
+{
+	might_sleep();
+	spin_lock_irq(&cgroup_rstat_lock);
+	if (time_after_eq(jiffies, cgrp->rstat_flush_time +
+			  msecs_to_jiffies(CGROUP_BSTAT_STALE_MS)))
+		cgroup_rstat_flush_locked(cgrp, true);
+}
+
 /**
  * cgroup_rstat_flush_release - release cgroup_rstat_flush_hold()
  */
@@ -268,6 +304,9 @@ int cgroup_rstat_init(struct cgroup *cgrp)
 		u64_stats_init(&rstatc->bsync);
 	}
 
+	cgrp->rstat_flush_time = jiffies -
+				 msecs_to_jiffies(CGROUP_BSTAT_STALE_MS);
+
 	return 0;
 }
 
@@ -403,7 +442,7 @@ void cgroup_base_stat_cputime_show(struct seq_file *seq)
 	if (!cgroup_parent(cgrp))
 		return;
 
-	cgroup_rstat_flush_hold(cgrp);
+	cgroup_rstat_flush_hold_lazy(cgrp);
 	usage = cgrp->bstat.cputime.sum_exec_runtime;
 	cputime_adjust(&cgrp->bstat.cputime, &cgrp->prev_cputime, &utime, &stime);
 	cgroup_rstat_flush_release();
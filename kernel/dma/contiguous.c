@@ -23,6 +23,9 @@
 #include <linux/sizes.h>
 #include <linux/dma-contiguous.h>
 #include <linux/cma.h>
+#include <linux/debugfs.h>
+#include <linux/ktime.h>
+#include <linux/log2.h>
 
 #ifdef CONFIG_CMA_SIZE_MBYTES
 #define CMA_SIZE_MBYTES CONFIG_CMA_SIZE_MBYTES
@@ -177,6 +180,79 @@ int __init dma_contiguous_reserve_area(phys_addr_t size, phys_addr_t base,
 	return 0;
 }
 
+#ifdef CONFIG_DEBUG_FS
+/*
+ * Latency of cma_alloc() as seen by DMA users, which is dominated by page
+ * migration out of the area, in power-of-two millisecond buckets: <1ms,
+ * <2ms, <4ms, ... <512ms, >=512ms.
+ */
+#define CMA_LAT_BUCKETS	11
+
+static atomic_long_t cma_alloc_lat[CMA_LAT_BUCKETS];
+static atomic_long_t cma_alloc_failed;
+static atomic64_t cma_alloc_max_us;
+
+static void dma_contiguous_account(s64 us, struct page *page)
+{
+	unsigned long ms = us > 0 ? us / USEC_PER_MSEC : 0;
+	s64 max = atomic64_read(&cma_alloc_max_us);
+	int b = ms ? min(ilog2(ms) + 1, CMA_LAT_BUCKETS - 1) : 0;
+
+	atomic_long_inc(&cma_alloc_lat[b]);
+	if (!page)
+		atomic_long_inc(&cma_alloc_failed);
+
+	while (us > max) {
+		s64 old = atomic64_cmpxchg(&cma_alloc_max_us, max, us);
+
+		if (old == max)
+			break;
+		max = old;
+	}
+}
+
+static int dma_contiguous_latency_show(struct seq_file *m, void *v)
+{
+	unsigned int lo = 0, i;
+
+	for (i = 0; i < CMA_LAT_BUCKETS - 1; i++) {
+		seq_printf(m, "%u-%u ms: %ld\n", lo, 1U << i,
+			   atomic_long_read(&cma_alloc_lat[i]));
+		lo = 1U << i;
+	}
+	seq_printf(m, ">=%u ms: %ld\n", lo,
+		   atomic_long_read(&cma_alloc_lat[i]));
+	seq_printf(m, "max: %lld us\n", atomic64_read(&cma_alloc_max_us));
+	seq_printf(m, "failed: %ld\n", atomic_long_read(&cma_alloc_failed));
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(dma_contiguous_latency);
+
+static int __init dma_contiguous_debugfs_init(void)
+{
+	struct dentry *root = debugfs_create_dir("dma_contiguous", NULL);
+
+	debugfs_create_file("alloc_latency", 0400, root, NULL,
+			    &dma_contiguous_latency_fops);
+	return 0;
+}
+late_initcall(dma_contiguous_debugfs_init);
+#else
+static inline void dma_contiguous_account(s64 us, struct page *page) { }
+#endif
+
+static struct page *dma_contiguous_cma_alloc(struct cma *cma, size_t count,
+					     unsigned int align, bool no_warn)
+{
+	ktime_t start = ktime_get();
+	struct page *page;
+
+	page = cma_alloc(cma, count, align, no_warn);
+	dma_contiguous_account(ktime_us_delta(ktime_get(), start), page);
+
+	return page;
+}
+
 /**
  * dma_alloc_from_contiguous() - allocate pages from contiguous area
  * @dev:   Pointer to device for which the allocation is performed.
@@ -195,7 +271,8 @@ struct page *dma_alloc_from_contiguous(struct device *dev, size_t count,
 	if (align > CONFIG_CMA_ALIGNMENT)
 		align = CONFIG_CMA_ALIGNMENT;
 
-	return cma_alloc(dev_get_cma_area(dev), count, align, no_warn);
+	return dma_contiguous_cma_alloc(dev_get_cma_area(dev), count, align,
+					no_warn);
 }
 
 /**
@@ -244,7 +321,8 @@ struct page *dma_alloc_contiguous(struct device *dev, size_t size, gfp_t gfp)
 		size_t align = get_order(size);
 		size_t cma_align = min_t(size_t, align, CONFIG_CMA_ALIGNMENT);
 
-		page = cma_alloc(cma, count, cma_align, gfp & __GFP_NOWARN);
+		page = dma_contiguous_cma_alloc(cma, count, cma_align,
+						gfp & __GFP_NOWARN);
 	}
 
 	return page;
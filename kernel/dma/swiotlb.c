@@ -30,6 +30,7 @@
 #include <linux/pfn.h>
 #include <linux/types.h>
 #include <linux/ctype.h>
+#include <linux/log2.h>
 #include <linux/highmem.h>
 #include <linux/gfp.h>
 #include <linux/scatterlist.h>
@@ -76,17 +77,29 @@ phys_addr_t io_tlb_start, io_tlb_end;
  */
 static unsigned long io_tlb_nslabs;
 
-/*
- * The number of used IO TLB block
- */
-static unsigned long io_tlb_used;
-
 /*
  * This is a free list describing the number of free entries available from
  * each index
  */
 static unsigned int *io_tlb_list;
-static unsigned int io_tlb_index;
+
+/*
+ * The slabs are split into io_tlb_nareas equal areas, each a whole number
+ * of IO_TLB_SEGSIZE segments, with their own lock, search index and count
+ * of used slots.  A mapping is allocated from the area of the current CPU
+ * first and only falls back to the other areas when that one is full.
+ */
+#define IO_TLB_MAX_AREAS	64
+
+struct io_tlb_area {
+	spinlock_t lock;
+	unsigned int index;	/* next slot to search from, area relative */
+	unsigned long used;	/* used slots in the area */
+} ____cacheline_aligned_in_smp;
+
+static struct io_tlb_area io_tlb_areas[IO_TLB_MAX_AREAS];
+static unsigned int io_tlb_nareas = 1;
+static unsigned long io_tlb_area_nslabs;
 
 /*
  * Max segment that we can provide which (if pages are contingous) will
@@ -101,11 +114,6 @@ unsigned int max_segment;
 #define INVALID_PHYS_ADDR (~(phys_addr_t)0)
 static phys_addr_t *io_tlb_orig_addr;
 
-/*
- * Protect the above data structures in the map and unmap calls
- */
-static DEFINE_SPINLOCK(io_tlb_lock);
-
 static int late_alloc;
 
 static int __init
@@ -162,6 +170,38 @@ unsigned long swiotlb_size_or_default(void)
 	return size ? size : (IO_TLB_DEFAULT_SIZE);
 }
 
+static unsigned long io_tlb_used(void)
+{
+	unsigned long used = 0;
+	unsigned int i;
+
+	for (i = 0; i < io_tlb_nareas; i++)
+		used += READ_ONCE(io_tlb_areas[i].used);
+	return used;
+}
+
+/*
+ * Pick as many areas as there are possible CPUs, but no more than the
+ * slabs can be divided into whole segments.
+ */
+static void swiotlb_init_areas(void)
+{
+	unsigned int i, nareas;
+
+	nareas = min_t(unsigned int, roundup_pow_of_two(num_possible_cpus()),
+		       IO_TLB_MAX_AREAS);
+	while (nareas > 1 && io_tlb_nslabs % (nareas * IO_TLB_SEGSIZE))
+		nareas >>= 1;
+
+	io_tlb_nareas = nareas;
+	io_tlb_area_nslabs = io_tlb_nslabs / nareas;
+	for (i = 0; i < nareas; i++) {
+		spin_lock_init(&io_tlb_areas[i].lock);
+		io_tlb_areas[i].index = 0;
+		io_tlb_areas[i].used = 0;
+	}
+}
+
 void swiotlb_print_info(void)
 {
 	unsigned long bytes = io_tlb_nslabs << IO_TLB_SHIFT;
@@ -229,7 +269,7 @@ int __init swiotlb_init_with_tbl(char *tlb, unsigned long nslabs, int verbose)
 		io_tlb_list[i] = IO_TLB_SEGSIZE - OFFSET(i, IO_TLB_SEGSIZE);
 		io_tlb_orig_addr[i] = INVALID_PHYS_ADDR;
 	}
-	io_tlb_index = 0;
+	swiotlb_init_areas();
 
 	if (verbose)
 		swiotlb_print_info();
@@ -360,7 +400,7 @@ swiotlb_late_init_with_tbl(char *tlb, unsigned long nslabs)
 		io_tlb_list[i] = IO_TLB_SEGSIZE - OFFSET(i, IO_TLB_SEGSIZE);
 		io_tlb_orig_addr[i] = INVALID_PHYS_ADDR;
 	}
-	io_tlb_index = 0;
+	swiotlb_init_areas();
 
 	swiotlb_print_info();
 
@@ -442,20 +482,88 @@ static void swiotlb_bounce(phys_addr_t orig_addr, phys_addr_t tlb_addr,
 	}
 }
 
+/*
+ * Find @nslots contiguous free slots in area @area_index.  Returns the slot
+ * index relative to io_tlb_start, or -1 if the area has no room.
+ */
+static int swiotlb_area_find_slots(unsigned int area_index,
+				   unsigned int nslots, unsigned int stride,
+				   unsigned long offset_slots,
+				   unsigned long max_slots)
+{
+	struct io_tlb_area *area = &io_tlb_areas[area_index];
+	unsigned int start = area_index * io_tlb_area_nslabs;
+	unsigned int end = start + io_tlb_area_nslabs;
+	unsigned int index, wrap;
+	unsigned long flags;
+	int i;
+
+	spin_lock_irqsave(&area->lock, flags);
+
+	if (unlikely(nslots > io_tlb_area_nslabs - area->used))
+		goto not_found;
+
+	index = ALIGN(start + area->index, stride);
+	if (index >= end)
+		index = start;
+	wrap = index;
+
+	do {
+		while (iommu_is_span_boundary(index, nslots, offset_slots,
+					      max_slots)) {
+			index += stride;
+			if (index >= end)
+				index = start;
+			if (index == wrap)
+				goto not_found;
+		}
+
+		/*
+		 * If we find a slot that indicates we have 'nslots' number of
+		 * contiguous buffers, we allocate the buffers from that slot
+		 * and mark the entries as '0' indicating unavailable.
+		 */
+		if (io_tlb_list[index] >= nslots) {
+			int count = 0;
+
+			for (i = index; i < (int) (index + nslots); i++)
+				io_tlb_list[i] = 0;
+			for (i = index - 1; (OFFSET(i, IO_TLB_SEGSIZE) != IO_TLB_SEGSIZE - 1) && io_tlb_list[i]; i--)
+				io_tlb_list[i] = ++count;
+
+			/*
+			 * Update the indices to avoid searching in the next
+			 * round.
+			 */
+			area->index = ((index + nslots) < end
+				       ? (index + nslots - start) : 0);
+			area->used += nslots;
+
+			spin_unlock_irqrestore(&area->lock, flags);
+			return index;
+		}
+		index += stride;
+		if (index >= end)
+			index = start;
+	} while (index != wrap);
+
+not_found:
+	spin_unlock_irqrestore(&area->lock, flags);
+	return -1;
+}
+
 phys_addr_t swiotlb_tbl_map_single(struct device *hwdev,
 				   dma_addr_t tbl_dma_addr,
 				   phys_addr_t orig_addr, size_t size,
 				   enum dma_data_direction dir,
 				   unsigned long attrs)
 {
-	unsigned long flags;
 	phys_addr_t tlb_addr;
-	unsigned int nslots, stride, index, wrap;
-	int i;
+	unsigned int nslots, stride, start, area_index;
+	int i, index;
 	unsigned long mask;
 	unsigned long offset_slots;
 	unsigned long max_slots;
-	unsigned long tmp_io_tlb_used;
 
 	if (no_iotlb_memory)
 		panic("Can not allocate SWIOTLB buffer earlier and can't now provide you with the DMA bounce buffer");
@@ -491,67 +599,26 @@ phys_addr_t swiotlb_tbl_map_single(struct device *hwdev,
 
 	/*
 	 * Find suitable number of IO TLB entries size that will fit this
-	 * request and allocate a buffer from that IO TLB pool.
+	 * request and allocate a buffer from that IO TLB pool, starting with
+	 * this CPU's area.
 	 */
-	spin_lock_irqsave(&io_tlb_lock, flags);
-
-	if (unlikely(nslots > io_tlb_nslabs - io_tlb_used))
-		goto not_found;
-
-	index = ALIGN(io_tlb_index, stride);
-	if (index >= io_tlb_nslabs)
-		index = 0;
-	wrap = index;
-
+	start = raw_smp_processor_id() & (io_tlb_nareas - 1);
+	area_index = start;
 	do {
-		while (iommu_is_span_boundary(index, nslots, offset_slots,
-					      max_slots)) {
-			index += stride;
-			if (index >= io_tlb_nslabs)
-				index = 0;
-			if (index == wrap)
-				goto not_found;
-		}
-
-		/*
-		 * If we find a slot that indicates we have 'nslots' number of
-		 * contiguous buffers, we allocate the buffers from that slot
-		 * and mark the entries as '0' indicating unavailable.
-		 */
-		if (io_tlb_list[index] >= nslots) {
-			int count = 0;
-
-			for (i = index; i < (int) (index + nslots); i++)
-				io_tlb_list[i] = 0;
-			for (i = index - 1; (OFFSET(i, IO_TLB_SEGSIZE) != IO_TLB_SEGSIZE - 1) && io_tlb_list[i]; i--)
-				io_tlb_list[i] = ++count;
-			tlb_addr = io_tlb_start + (index << IO_TLB_SHIFT);
-
-			/*
-			 * Update the indices to avoid searching in the next
-			 * round.
-			 */
-			io_tlb_index = ((index + nslots) < io_tlb_nslabs
-					? (index + nslots) : 0);
-
+		index = swiotlb_area_find_slots(area_index, nslots, stride,
+						offset_slots, max_slots);
+		if (index >= 0)
 			goto found;
-		}
-		index += stride;
-		if (index >= io_tlb_nslabs)
-			index = 0;
-	} while (index != wrap);
-
-not_found:
-	tmp_io_tlb_used = io_tlb_used;
+		if (++area_index >= io_tlb_nareas)
+			area_index = 0;
+	} while (area_index != start);
 
-	spin_unlock_irqrestore(&io_tlb_lock, flags);
 	if (!(attrs & DMA_ATTR_NO_WARN) && printk_ratelimit())
 		dev_warn(hwdev, "swiotlb buffer is full (sz: %zd bytes), total %lu (slots), used %lu (slots)\n",
-			 size, io_tlb_nslabs, tmp_io_tlb_used);
+			 size, io_tlb_nslabs, io_tlb_used());
 	return (phys_addr_t)DMA_MAPPING_ERROR;
 found:
-	io_tlb_used += nslots;
-	spin_unlock_irqrestore(&io_tlb_lock, flags);
+	tlb_addr = io_tlb_start + ((phys_addr_t)index << IO_TLB_SHIFT);
 
 	/*
 	 * Save away the mapping from the original address to the DMA address.
@@ -577,6 +644,7 @@ void swiotlb_tbl_unmap_single(struct device *hwdev, phys_addr_t tlb_addr,
 	unsigned long flags;
 	int i, count, nslots = ALIGN(size, 1 << IO_TLB_SHIFT) >> IO_TLB_SHIFT;
 	int index = (tlb_addr - io_tlb_start) >> IO_TLB_SHIFT;
+	struct io_tlb_area *area = &io_tlb_areas[index / io_tlb_area_nslabs];
 	phys_addr_t orig_addr = io_tlb_orig_addr[index];
 
 	/*
@@ -593,7 +661,7 @@ void swiotlb_tbl_unmap_single(struct device *hwdev, phys_addr_t tlb_addr,
 	 * While returning the entries to the free list, we merge the entries
 	 * with slots below and above the pool being returned.
 	 */
-	spin_lock_irqsave(&io_tlb_lock, flags);
+	spin_lock_irqsave(&area->lock, flags);
 	{
 		count = ((index + nslots) < ALIGN(index + 1, IO_TLB_SEGSIZE) ?
 			 io_tlb_list[index + nslots] : 0);
@@ -612,9 +680,9 @@ void swiotlb_tbl_unmap_single(struct device *hwdev, phys_addr_t tlb_addr,
 		for (i = index - 1; (OFFSET(i, IO_TLB_SEGSIZE) != IO_TLB_SEGSIZE -1) && io_tlb_list[i]; i--)
 			io_tlb_list[i] = ++count;
 
-		io_tlb_used -= nslots;
+		area->used -= nslots;
 	}
-	spin_unlock_irqrestore(&io_tlb_lock, flags);
+	spin_unlock_irqrestore(&area->lock, flags);
 }
 
 void swiotlb_tbl_sync_single(struct device *hwdev, phys_addr_t tlb_addr,
@@ -696,13 +764,35 @@ bool is_swiotlb_active(void)
 
 #ifdef CONFIG_DEBUG_FS
 
+static int io_tlb_used_get(void *data, u64 *val)
+{
+	*val = io_tlb_used();
+	return 0;
+}
+DEFINE_DEBUGFS_ATTRIBUTE(fops_io_tlb_used, io_tlb_used_get, NULL, "%llu\n");
+
+static int io_tlb_areas_show(struct seq_file *m, void *v)
+{
+	unsigned int i;
+
+	seq_printf(m, "# area slots used (%lu slots per area)\n",
+		   io_tlb_area_nslabs);
+	for (i = 0; i < io_tlb_nareas; i++)
+		seq_printf(m, "%u %lu\n", i, READ_ONCE(io_tlb_areas[i].used));
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(io_tlb_areas);
+
 static int __init swiotlb_create_debugfs(void)
 {
 	struct dentry *root;
 
 	root = debugfs_create_dir("swiotlb", NULL);
 	debugfs_create_ulong("io_tlb_nslabs", 0400, root, &io_tlb_nslabs);
-	debugfs_create_ulong("io_tlb_used", 0400, root, &io_tlb_used);
+	debugfs_create_file_unsafe("io_tlb_used", 0400, root, NULL,
+				   &fops_io_tlb_used);
+	debugfs_create_file("io_tlb_areas", 0400, root, NULL,
+			    &io_tlb_areas_fops);
 	return 0;
 }
 
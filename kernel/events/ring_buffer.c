@@ -300,6 +300,46 @@ void perf_output_end(struct perf_output_handle *handle)
 	rcu_read_unlock();
 }
 
+/*
+ * Bracket a burst of records written to @event's buffer, such as a drain of
+ * the PMU's sample buffer from its interrupt handler.
+ *
+ * This takes an outer nesting level on the buffer, so the records written in
+ * between are reserved and filled as usual but perf_output_end() does not
+ * publish ->data_head or check the wakeup watermark for each of them. Both
+ * are done once, from perf_output_batch_end().
+ *
+ * Returns false, and must then not be paired with perf_output_batch_end(),
+ * when the event has no buffer.
+ */
+bool perf_output_batch_begin(struct perf_output_handle *handle,
+			     struct perf_event *event)
+{
+	struct ring_buffer *rb;
+
+	rcu_read_lock();
+	if (event->parent)
+		event = event->parent;
+
+	rb = rcu_dereference(event->rb);
+	if (unlikely(!rb)) {
+		rcu_read_unlock();
+		return false;
+	}
+
+	handle->rb    = rb;
+	handle->event = event;
+	perf_output_get_handle(handle);
+
+	return true;
+}
+
+void perf_output_batch_end(struct perf_output_handle *handle)
+{
+	perf_output_put_handle(handle);
+	rcu_read_unlock();
+}
+
 static void
 ring_buffer_init(struct ring_buffer *rb, long watermark, int flags)
 {
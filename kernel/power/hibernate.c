@@ -36,6 +36,7 @@
 
 
 static int nocompress;
+static int hib_lz4;
 static int noresume;
 static int nohibernate;
 static int resume_wait;
@@ -741,6 +742,8 @@ int hibernate(void)
 			flags |= SF_NOCOMPRESS_MODE;
 		else
 		        flags |= SF_CRC32_MODE;
+		if (!nocompress && hib_lz4)
+			flags |= SF_COMPRESSION_LZ4;
 
 		pm_pr_dbg("Writing image.\n");
 		error = swsusp_write(flags);
@@ -1192,6 +1195,9 @@ static int __init hibernate_setup(char *str)
 		noresume = 1;
 	} else if (!strncmp(str, "nocompress", 10)) {
 		nocompress = 1;
+	} else if (IS_ENABLED(CONFIG_HIBERNATION_COMP_LZ4)
+		   && !strncmp(str, "lz4", 3)) {
+		hib_lz4 = 1;
 	} else if (!strncmp(str, "no", 2)) {
 		noresume = 1;
 		nohibernate = 1;
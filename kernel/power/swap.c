@@ -25,6 +25,7 @@
 #include <linux/pm.h>
 #include <linux/slab.h>
 #include <linux/lzo.h>
+#include <linux/lz4.h>
 #include <linux/vmalloc.h>
 #include <linux/cpumask.h>
 #include <linux/atomic.h>
@@ -515,6 +516,10 @@ static int swap_writer_finish(struct swap_map_handle *handle,
 			             LZO_HEADER, PAGE_SIZE)
 #define LZO_CMP_SIZE	(LZO_CMP_PAGES * PAGE_SIZE)
 
+/* Compression workspace, large enough for either LZO or LZ4. */
+#define LZO_WRK_SIZE	(LZ4_MEM_COMPRESS > LZO1X_1_MEM_COMPRESS ? \
+			 LZ4_MEM_COMPRESS : LZO1X_1_MEM_COMPRESS)
+
 /* Maximum number of threads for compression/decompression. */
 #define LZO_THREADS	3
 
@@ -522,6 +527,57 @@ static int swap_writer_finish(struct swap_map_handle *handle,
 #define LZO_MIN_RD_PAGES	1024
 #define LZO_MAX_RD_PAGES	8192
 
+/*
+ * The compressed image is LZ4 rather than LZO (SF_COMPRESSION_LZ4). The
+ * buffers and the on-disk layout are the same for both, sized for LZO's
+ * larger worst case.
+ */
+static bool hib_use_lz4;
+
+#ifdef CONFIG_HIBERNATION_COMP_LZ4
+static int hib_lz4_compress(const unsigned char *src, size_t src_len,
+			    unsigned char *dst, size_t *dst_len, void *wrk)
+{
+	int len;
+
+	BUILD_BUG_ON(LZ4_COMPRESSBOUND(LZO_UNC_SIZE) >
+		     lzo1x_worst_compress(LZO_UNC_SIZE));
+
+	len = LZ4_compress_default(src, dst, src_len,
+				   LZ4_COMPRESSBOUND(LZO_UNC_SIZE), wrk);
+	if (len <= 0)
+		return -1;
+
+	*dst_len = len;
+	return 0;
+}
+
+static int hib_lz4_decompress(const unsigned char *src, size_t src_len,
+			      unsigned char *dst, size_t *dst_len)
+{
+	int len;
+
+	len = LZ4_decompress_safe(src, dst, src_len, *dst_len);
+	if (len < 0)
+		return -1;
+
+	*dst_len = len;
+	return 0;
+}
+#else
+static int hib_lz4_compress(const unsigned char *src, size_t src_len,
+			    unsigned char *dst, size_t *dst_len, void *wrk)
+{
+	return -1;
+}
+
+static int hib_lz4_decompress(const unsigned char *src, size_t src_len,
+			      unsigned char *dst, size_t *dst_len)
+{
+	return -1;
+}
+#endif
+
 
 /**
  *	save_image - save the suspend image data
@@ -626,7 +682,7 @@ struct cmp_data {
 	size_t cmp_len;                           /* compressed length */
 	unsigned char unc[LZO_UNC_SIZE];          /* uncompressed buffer */
 	unsigned char cmp[LZO_CMP_SIZE];          /* compressed buffer */
-	unsigned char wrk[LZO1X_1_MEM_COMPRESS];  /* compression workspace */
+	unsigned char wrk[LZO_WRK_SIZE];          /* compression workspace */
 };
 
 /**
@@ -648,9 +704,14 @@ static int lzo_compress_threadfn(void *data)
 		}
 		atomic_set(&d->ready, 0);
 
-		d->ret = lzo1x_1_compress(d->unc, d->unc_len,
-		                          d->cmp + LZO_HEADER, &d->cmp_len,
-		                          d->wrk);
+		if (hib_use_lz4)
+			d->ret = hib_lz4_compress(d->unc, d->unc_len,
+						  d->cmp + LZO_HEADER,
+						  &d->cmp_len, d->wrk);
+		else
+			d->ret = lzo1x_1_compress(d->unc, d->unc_len,
+						  d->cmp + LZO_HEADER,
+						  &d->cmp_len, d->wrk);
 		atomic_set(&d->stop, 1);
 		wake_up(&d->done);
 	}
@@ -906,6 +967,7 @@ int swsusp_write(unsigned int flags)
 	unsigned long pages;
 	int error;
 
+	hib_use_lz4 = flags & SF_COMPRESSION_LZ4;
 	pages = snapshot_get_image_size();
 	error = get_swap_writer(&handle);
 	if (error) {
@@ -1133,8 +1195,14 @@ static int lzo_decompress_threadfn(void *data)
 		atomic_set(&d->ready, 0);
 
 		d->unc_len = LZO_UNC_SIZE;
-		d->ret = lzo1x_decompress_safe(d->cmp + LZO_HEADER, d->cmp_len,
-		                               d->unc, &d->unc_len);
+		if (hib_use_lz4)
+			d->ret = hib_lz4_decompress(d->cmp + LZO_HEADER,
+						    d->cmp_len, d->unc,
+						    &d->unc_len);
+		else
+			d->ret = lzo1x_decompress_safe(d->cmp + LZO_HEADER,
+						       d->cmp_len, d->unc,
+						       &d->unc_len);
 		if (clean_pages_on_decompress)
 			flush_icache_range((unsigned long)d->unc,
 					   (unsigned long)d->unc + d->unc_len);
@@ -1486,6 +1554,13 @@ int swsusp_read(unsigned int *flags_p)
 	error = get_swap_reader(&handle, flags_p);
 	if (error)
 		goto end;
+	hib_use_lz4 = *flags_p & SF_COMPRESSION_LZ4;
+	if (hib_use_lz4 && !IS_ENABLED(CONFIG_HIBERNATION_COMP_LZ4)) {
+		pr_err("Image is LZ4 compressed, but LZ4 support is not built in\n");
+		error = -EINVAL;
+		swap_reader_finish(&handle);
+		goto end;
+	}
 	if (!error)
 		error = swap_read_page(&handle, header, NULL);
 	if (!error) {
@@ -2593,19 +2593,241 @@ void call_rcu(struct rcu_head *head, rcu_callback_t func)
 }
 EXPORT_SYMBOL_GPL(call_rcu);
 
+/* Maximum number of jiffies to wait before draining a kfree_rcu() batch. */
+#define KFREE_DRAIN_JIFFIES (HZ / 50)
+
+/*
+ * A page worth of pointers to objects queued by kfree_rcu(), freed with
+ * a single kfree_bulk() call once a grace period has elapsed.
+ */
+struct kfree_rcu_bulk_data {
+	unsigned long nr_records;
+	struct kfree_rcu_bulk_data *next;
+	void *records[];
+};
+
+#define KFREE_BULK_MAX_ENTR \
+	((PAGE_SIZE - sizeof(struct kfree_rcu_bulk_data)) / sizeof(void *))
+
+/*
+ * struct kfree_rcu_cpu - batch up kfree_rcu() requests for RCU grace period
+ * @bhead: Bulk pages of pointers not yet waiting for a grace period
+ * @bcached: Spare bulk page, kept to avoid page allocator round trips
+ * @head: Objects that did not fit in a bulk page, chained through rcu_head
+ * @bhead_free: Bulk pages waiting for a grace period
+ * @head_free: rcu_head chained objects waiting for a grace period
+ * @rcu_work: Queued once the batch is detached, runs after a grace period
+ * @lock: Synchronize access to this structure
+ * @monitor_work: Drain the pending batch after KFREE_DRAIN_JIFFIES
+ * @monitor_todo: Tracks whether a @monitor_work is pending
+ * @initialized: The @lock and the works have been initialized
+ *
+ * Only one batch per cpu waits for a grace period at a time.  Requests
+ * queued meanwhile accumulate in @bhead and @head, and are detached by
+ * the monitor once the batch in flight has been freed.
+ */
+struct kfree_rcu_cpu {
+	struct kfree_rcu_bulk_data *bhead;
+	struct kfree_rcu_bulk_data *bcached;
+	struct rcu_head *head;
+	struct kfree_rcu_bulk_data *bhead_free;
+	struct rcu_head *head_free;
+	struct rcu_work rcu_work;
+	spinlock_t lock;
+	struct delayed_work monitor_work;
+	bool monitor_todo;
+	bool initialized;
+};
+
+static DEFINE_PER_CPU(struct kfree_rcu_cpu, krc);
+
+/*
+ * This function is invoked in workqueue context after a grace period.
+ * It frees all the objects queued on ->bhead_free and ->head_free.
+ */
+static void kfree_rcu_work(struct work_struct *work)
+{
+	unsigned long flags;
+	struct rcu_head *head, *next;
+	struct kfree_rcu_bulk_data *bhead, *bnext;
+	struct kfree_rcu_cpu *krcp;
+
+	krcp = container_of(to_rcu_work(work), struct kfree_rcu_cpu, rcu_work);
+	spin_lock_irqsave(&krcp->lock, flags);
+	head = krcp->head_free;
+	krcp->head_free = NULL;
+	bhead = krcp->bhead_free;
+	krcp->bhead_free = NULL;
+	spin_unlock_irqrestore(&krcp->lock, flags);
+
+	/* The lists are now private, so traverse them locklessly. */
+	for (; bhead; bhead = bnext) {
+		bnext = bhead->next;
+
+		rcu_lock_acquire(&rcu_callback_map);
+		kfree_bulk(bhead->nr_records, bhead->records);
+		rcu_lock_release(&rcu_callback_map);
+
+		if (cmpxchg(&krcp->bcached, NULL, bhead))
+			free_page((unsigned long)bhead);
+
+		cond_resched_tasks_rcu_qs();
+	}
+
+	for (; head; head = next) {
+		next = head->next;
+		debug_rcu_head_unqueue(head);
+		WARN_ON_ONCE(!__rcu_reclaim(rcu_state.name, head));
+		cond_resched_tasks_rcu_qs();
+	}
+}
+
+/*
+ * Detach the pending requests and hand them to a grace period.  Return
+ * false if the previous batch is still waiting, in which case the caller
+ * needs to retry later.
+ */
+static bool queue_kfree_rcu_work(struct kfree_rcu_cpu *krcp)
+{
+	lockdep_assert_held(&krcp->lock);
+
+	if (krcp->bhead_free || krcp->head_free)
+		return false;
+
+	krcp->bhead_free = krcp->bhead;
+	krcp->bhead = NULL;
+	krcp->head_free = krcp->head;
+	krcp->head = NULL;
+	queue_rcu_work(system_wq, &krcp->rcu_work);
+	return true;
+}
+
+/*
+ * This function is invoked after the KFREE_DRAIN_JIFFIES timeout.
+ */
+static void kfree_rcu_monitor(struct work_struct *work)
+{
+	unsigned long flags;
+	struct kfree_rcu_cpu *krcp = container_of(work, struct kfree_rcu_cpu,
+						  monitor_work.work);
+
+	spin_lock_irqsave(&krcp->lock, flags);
+	if (krcp->monitor_todo) {
+		krcp->monitor_todo = !queue_kfree_rcu_work(krcp);
+		if (krcp->monitor_todo)
+			schedule_delayed_work(&krcp->monitor_work,
+					      KFREE_DRAIN_JIFFIES);
+	}
+	spin_unlock_irqrestore(&krcp->lock, flags);
+}
+
+/*
+ * Record the object in a bulk page.  Return false if no page could be
+ * had, in which case the caller chains it through its rcu_head instead.
+ */
+static bool kfree_call_rcu_add_ptr_to_bulk(struct kfree_rcu_cpu *krcp,
+					   struct rcu_head *head,
+					   rcu_callback_t func)
+{
+	struct kfree_rcu_bulk_data *bnode;
+
+	/* Object debugging tracks the rcu_head, so keep it queued. */
+	if (IS_ENABLED(CONFIG_DEBUG_OBJECTS_RCU_HEAD))
+		return false;
+
+	if (!krcp->bhead || krcp->bhead->nr_records == KFREE_BULK_MAX_ENTR) {
+		bnode = xchg(&krcp->bcached, NULL);
+		if (!bnode)
+			bnode = (struct kfree_rcu_bulk_data *)
+				__get_free_page(GFP_NOWAIT | __GFP_NOWARN);
+		if (!bnode)
+			return false;
+
+		bnode->nr_records = 0;
+		bnode->next = krcp->bhead;
+		krcp->bhead = bnode;
+	}
+
+	krcp->bhead->records[krcp->bhead->nr_records++] =
+		(void *)head - (unsigned long)func;
+	return true;
+}
+
 /*
- * Queue an RCU callback for lazy invocation after a grace period.
- * This will likely be later named something like "call_rcu_lazy()",
- * but this change will require some way of tagging the lazy RCU
- * callbacks in the list of pending callbacks. Until then, this
- * function may only be called from __kfree_rcu().
+ * Queue a request for lazy invocation of kfree() after a grace period.
+ *
+ * Each kfree_call_rcu() request is added to a batch.  The batch will be
+ * drained every KFREE_DRAIN_JIFFIES number of jiffies.  All the objects
+ * in the batch will be freed in workqueue context, mostly with
+ * kfree_bulk().  This allows us to amortize the grace period and the
+ * freeing over a large number of objects instead of running one RCU
+ * callback per object from rcu_do_batch().
+ *
+ * This function may only be called from __kfree_rcu().
  */
 void kfree_call_rcu(struct rcu_head *head, rcu_callback_t func)
 {
-	__call_rcu(head, func, -1, 1);
+	unsigned long flags;
+	struct kfree_rcu_cpu *krcp;
+
+	local_irq_save(flags);	/* For safely calling this_cpu_ptr(). */
+	krcp = this_cpu_ptr(&krc);
+	if (krcp->initialized)
+		spin_lock(&krcp->lock);
+
+	/* Queue the object but don't yet schedule the batch. */
+	if (debug_rcu_head_queue(head)) {
+		/* Probable double kfree_rcu(), just leak. */
+		WARN_ONCE(1, "%s(): Double-freed call. rcu_head %p\n",
+			  __func__, head);
+		goto unlock_return;
+	}
+
+	if (!krcp->initialized ||
+	    !kfree_call_rcu_add_ptr_to_bulk(krcp, head, func)) {
+		head->func = func;
+		head->next = krcp->head;
+		krcp->head = head;
+	}
+
+	/* Set timer to drain after KFREE_DRAIN_JIFFIES. */
+	if (rcu_scheduler_active == RCU_SCHEDULER_RUNNING &&
+	    !krcp->monitor_todo) {
+		krcp->monitor_todo = true;
+		schedule_delayed_work(&krcp->monitor_work, KFREE_DRAIN_JIFFIES);
+	}
+
+unlock_return:
+	if (krcp->initialized)
+		spin_unlock(&krcp->lock);
+	local_irq_restore(flags);
 }
 EXPORT_SYMBOL_GPL(kfree_call_rcu);
 
+/*
+ * Start draining the batches queued before the scheduler and the
+ * workqueues were usable.
+ */
+void __init kfree_rcu_scheduler_running(void)
+{
+	int cpu;
+	unsigned long flags;
+
+	for_each_online_cpu(cpu) {
+		struct kfree_rcu_cpu *krcp = per_cpu_ptr(&krc, cpu);
+
+		spin_lock_irqsave(&krcp->lock, flags);
+		if ((!krcp->bhead && !krcp->head) || krcp->monitor_todo) {
+			spin_unlock_irqrestore(&krcp->lock, flags);
+			continue;
+		}
+		krcp->monitor_todo = true;
+		schedule_delayed_work_on(cpu, &krcp->monitor_work,
+					 KFREE_DRAIN_JIFFIES);
+		spin_unlock_irqrestore(&krcp->lock, flags);
+	}
+}
+
 /*
  * During early boot, any blocking grace-period wait automatically
  * implies a grace period.  Later on, this is never the case for PREEMPT.
@@ -3204,6 +3426,20 @@ static int rcu_pm_notify(struct notifier_block *self,
 	return NOTIFY_OK;
 }
 
+static void __init kfree_rcu_batch_init(void)
+{
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		struct kfree_rcu_cpu *krcp = per_cpu_ptr(&krc, cpu);
+
+		spin_lock_init(&krcp->lock);
+		INIT_RCU_WORK(&krcp->rcu_work, kfree_rcu_work);
+		INIT_DELAYED_WORK(&krcp->monitor_work, kfree_rcu_monitor);
+		krcp->initialized = true;
+	}
+}
+
 /*
  * Spawn the kthreads that handle RCU's grace periods.
  */
@@ -3461,6 +3697,8 @@ void __init rcu_init(void)
 
 	rcu_early_boot_tests();
 
+	kfree_rcu_batch_init();
+
 	rcu_bootup_announce();
 	rcu_init_geometry();
 	rcu_init_one();
@@ -123,6 +123,23 @@ static unsigned long quarantine_batch_size;
  */
 #define QUARANTINE_FRACTION 32
 
+/*
+ * Upper bound on the global queue set with "kasan_quarantine=<size>", for
+ * running with less memory overhead at the cost of a shorter use-after-free
+ * detection window.  0 leaves only the per-cpu queues.
+ */
+static unsigned long quarantine_limit = ULONG_MAX;
+
+static int __init kasan_quarantine_setup(char *str)
+{
+	if (!str)
+		return -EINVAL;
+
+	quarantine_limit = memparse(str, &str);
+	return 0;
+}
+early_param("kasan_quarantine", kasan_quarantine_setup);
+
 static struct kmem_cache *qlink_to_cache(struct qlist_node *qlink)
 {
 	return virt_to_head_page(qlink)->slab_cache;
@@ -242,6 +259,8 @@ void quarantine_reduce(void)
 	percpu_quarantines = QUARANTINE_PERCPU_SIZE * num_online_cpus();
 	new_quarantine_size = (total_size < percpu_quarantines) ?
 		0 : total_size - percpu_quarantines;
+	new_quarantine_size = min_t(size_t, new_quarantine_size,
+				    quarantine_limit);
 	WRITE_ONCE(quarantine_max_size, new_quarantine_size);
 	/* Aim at consuming at most 1/2 of slots in quarantine. */
 	WRITE_ONCE(quarantine_batch_size, max((size_t)QUARANTINE_PERCPU_SIZE,
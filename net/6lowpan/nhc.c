@@ -14,6 +14,10 @@
 
 static struct rb_root rb_root = RB_ROOT;
 static struct lowpan_nhc *lowpan_nexthdr_nhcs[NEXTHDR_MAX + 1];
+/* nhcs with a single id byte indexed by every byte value they match, so
+ * the receive path avoids the rb_root walk for the common encodings
+ */
+static struct lowpan_nhc *lowpan_nhcid_nhcs[U8_MAX + 1];
 static DEFINE_SPINLOCK(lowpan_nhc_lock);
 
 static int lowpan_nhc_insert(struct lowpan_nhc *nhc)
@@ -58,17 +62,49 @@ static void lowpan_nhc_remove(struct lowpan_nhc *nhc)
 	rb_erase(&nhc->node, &rb_root);
 }
 
+static void lowpan_nhcid_insert(struct lowpan_nhc *nhc)
+{
+	int i;
+
+	if (nhc->idlen != 1)
+		return;
+
+	for (i = 0; i <= U8_MAX; i++) {
+		if ((i & nhc->idmask[0]) == nhc->id[0] &&
+		    !lowpan_nhcid_nhcs[i])
+			lowpan_nhcid_nhcs[i] = nhc;
+	}
+}
+
+static void lowpan_nhcid_remove(struct lowpan_nhc *nhc)
+{
+	int i;
+
+	for (i = 0; i <= U8_MAX; i++) {
+		if (lowpan_nhcid_nhcs[i] == nhc)
+			lowpan_nhcid_nhcs[i] = NULL;
+	}
+}
+
 static struct lowpan_nhc *lowpan_nhc_by_nhcid(const struct sk_buff *skb)
 {
 	struct rb_node *node = rb_root.rb_node;
 	const u8 *nhcid_skb_ptr = skb->data;
+	struct lowpan_nhc *nhc;
+
+	if (unlikely(!skb->len))
+		return NULL;
+
+	nhc = lowpan_nhcid_nhcs[nhcid_skb_ptr[0]];
+	if (nhc)
+		return nhc;
 
 	while (node) {
-		struct lowpan_nhc *nhc = rb_entry(node, struct lowpan_nhc,
-						  node);
 		u8 nhcid_skb_ptr_masked[LOWPAN_NHC_MAX_ID_LEN];
 		int result, i;
 
+		nhc = rb_entry(node, struct lowpan_nhc, node);
+
 		if (nhcid_skb_ptr + nhc->idlen > skb->data + skb->len)
 			return NULL;
 
@@ -214,6 +250,7 @@ int lowpan_nhc_add(struct lowpan_nhc *nhc)
 		goto out;
 
 	lowpan_nexthdr_nhcs[nhc->nexthdr] = nhc;
+	lowpan_nhcid_insert(nhc);
 out:
 	spin_unlock_bh(&lowpan_nhc_lock);
 	return ret;
@@ -225,6 +262,7 @@ void lowpan_nhc_del(struct lowpan_nhc *nhc)
 	spin_lock_bh(&lowpan_nhc_lock);
 
 	lowpan_nhc_remove(nhc);
+	lowpan_nhcid_remove(nhc);
 	lowpan_nexthdr_nhcs[nhc->nexthdr] = NULL;
 
 	spin_unlock_bh(&lowpan_nhc_lock);
@@ -360,8 +360,15 @@ void br_fdb_cleanup(struct work_struct *work)
 	}
 	rcu_read_unlock();
 
-	/* Cleanup minimum 10 milliseconds apart */
-	work_delay = max_t(unsigned long, work_delay, msecs_to_jiffies(10));
+	/* Cleanup minimum 10 milliseconds apart, and no more often than
+	 * 1/64 of the ageing time. With many entries learnt at different
+	 * times there is almost always one about to expire, and rescanning
+	 * the whole table for each of them costs far more than letting
+	 * entries live slightly past their ageing time.
+	 */
+	work_delay = max_t(unsigned long, work_delay,
+			   max_t(unsigned long, msecs_to_jiffies(10),
+				 delay / 64));
 	mod_delayed_work(system_long_wq, &br->gc_work, work_delay);
 }
 
@@ -166,6 +166,7 @@ struct net_bridge_vlan {
  */
 struct net_bridge_vlan_group {
 	struct rhashtable		vlan_hash;
+	struct net_bridge_vlan __rcu * __rcu *vlan_array;
 	struct rhashtable		tunnel_hash;
 	struct list_head		vlan_list;
 	u16				num_vlans;
@@ -34,6 +34,46 @@ static struct net_bridge_vlan *br_vlan_lookup(struct rhashtable *tbl, u16 vid)
 	return rhashtable_lookup_fast(tbl, &vid, br_vlan_rht_params);
 }
 
+/* Groups with at least this many vlans, typically trunk ports, also get a
+ * vid indexed array so that the per-packet lookup does not hash.
+ */
+#define BR_VLAN_ARRAY_MIN	16
+
+/* Must be protected by RTNL. */
+static void br_vlan_array_add(struct net_bridge_vlan_group *vg,
+			      struct net_bridge_vlan *v)
+{
+	struct net_bridge_vlan __rcu **arr = rtnl_dereference(vg->vlan_array);
+	struct net_bridge_vlan *tmp;
+
+	if (arr) {
+		rcu_assign_pointer(arr[v->vid], v);
+		return;
+	}
+
+	if (atomic_read(&vg->vlan_hash.nelems) < BR_VLAN_ARRAY_MIN)
+		return;
+
+	/* Best effort, lookups keep using the hash without it */
+	arr = kvcalloc(VLAN_N_VID, sizeof(*arr), GFP_KERNEL);
+	if (!arr)
+		return;
+
+	list_for_each_entry(tmp, &vg->vlan_list, vlist)
+		RCU_INIT_POINTER(arr[tmp->vid], tmp);
+	rcu_assign_pointer(vg->vlan_array, arr);
+}
+
+/* Must be protected by RTNL. */
+static void br_vlan_array_del(struct net_bridge_vlan_group *vg,
+			      struct net_bridge_vlan *v)
+{
+	struct net_bridge_vlan __rcu **arr = rtnl_dereference(vg->vlan_array);
+
+	if (arr)
+		RCU_INIT_POINTER(arr[v->vid], NULL);
+}
+
 static bool __vlan_add_pvid(struct net_bridge_vlan_group *vg, u16 vid)
 {
 	if (vg->pvid == vid)
@@ -187,6 +227,7 @@ static void br_vlan_put_master(struct net_bridge_vlan *masterv)
 
 	vg = br_vlan_group(masterv->br);
 	if (refcount_dec_and_test(&masterv->refcnt)) {
+		br_vlan_array_del(vg, masterv);
 		rhashtable_remove_fast(&vg->vlan_hash,
 				       &masterv->vnode, br_vlan_rht_params);
 		__vlan_del_list(masterv);
@@ -295,6 +336,7 @@ static int __vlan_add(struct net_bridge_vlan *v, u16 flags,
 		goto out_fdb_insert;
 
 	__vlan_add_list(v);
+	br_vlan_array_add(vg, v);
 	__vlan_add_flags(v, flags);
 
 	if (p)
@@ -360,6 +402,7 @@ static int __vlan_del(struct net_bridge_vlan *v)
 
 	if (masterv != v) {
 		vlan_tunnel_info_del(vg, v);
+		br_vlan_array_del(vg, v);
 		rhashtable_remove_fast(&vg->vlan_hash, &v->vnode,
 				       br_vlan_rht_params);
 		__vlan_del_list(v);
@@ -375,6 +418,7 @@ static int __vlan_del(struct net_bridge_vlan *v)
 static void __vlan_group_free(struct net_bridge_vlan_group *vg)
 {
 	WARN_ON(!list_empty(&vg->vlan_list));
+	kvfree(rtnl_dereference(vg->vlan_array));
 	rhashtable_destroy(&vg->vlan_hash);
 	vlan_tunnel_deinit(vg);
 	kfree(vg);
@@ -724,9 +768,22 @@ void br_vlan_flush(struct net_bridge *br)
 
 struct net_bridge_vlan *br_vlan_find(struct net_bridge_vlan_group *vg, u16 vid)
 {
+	struct net_bridge_vlan __rcu **arr;
+	struct net_bridge_vlan *v;
+
 	if (!vg)
 		return NULL;
 
+	/* Like rhashtable_lookup_fast(), callers need not hold RCU */
+	rcu_read_lock();
+	arr = rcu_dereference(vg->vlan_array);
+	if (arr && likely(vid < VLAN_N_VID)) {
+		v = rcu_dereference(arr[vid]);
+		rcu_read_unlock();
+		return v;
+	}
+	rcu_read_unlock();
+
 	return br_vlan_lookup(&vg->vlan_hash, vid);
 }
 
@@ -1127,6 +1184,7 @@ int nbp_vlan_init(struct net_bridge_port *p, struct netlink_ext_ack *extack)
 	rhashtable_destroy(&vg->vlan_hash);
 err_rhtbl:
 err_vlan_enabled:
+	kvfree(rcu_dereference_raw(vg->vlan_array));
 	kfree(vg);
 
 	goto out;
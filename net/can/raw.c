@@ -120,6 +120,7 @@ static void raw_rcv(struct sk_buff *oskb, void *data)
 	struct sock *sk = (struct sock *)data;
 	struct raw_sock *ro = raw_sk(sk);
 	struct sockaddr_can *addr;
+	struct uniqframe *uniq;
 	struct sk_buff *skb;
 	unsigned int *pflags;
 
@@ -132,20 +133,20 @@ static void raw_rcv(struct sk_buff *oskb, void *data)
 		return;
 
 	/* eliminate multiple filter matches for the same skb */
-	if (this_cpu_ptr(ro->uniq)->skb == oskb &&
-	    this_cpu_ptr(ro->uniq)->skbcnt == can_skb_prv(oskb)->skbcnt) {
+	uniq = this_cpu_ptr(ro->uniq);
+	if (uniq->skb == oskb && uniq->skbcnt == can_skb_prv(oskb)->skbcnt) {
 		if (ro->join_filters) {
-			this_cpu_inc(ro->uniq->join_rx_count);
+			uniq->join_rx_count++;
 			/* drop frame until all enabled filters matched */
-			if (this_cpu_ptr(ro->uniq)->join_rx_count < ro->count)
+			if (uniq->join_rx_count < ro->count)
 				return;
 		} else {
 			return;
 		}
 	} else {
-		this_cpu_ptr(ro->uniq)->skb = oskb;
-		this_cpu_ptr(ro->uniq)->skbcnt = can_skb_prv(oskb)->skbcnt;
-		this_cpu_ptr(ro->uniq)->join_rx_count = 1;
+		uniq->skb = oskb;
+		uniq->skbcnt = can_skb_prv(oskb)->skbcnt;
+		uniq->join_rx_count = 1;
 		/* drop first frame to check all enabled filters? */
 		if (ro->join_filters && ro->count > 1)
 			return;
@@ -523,19 +523,20 @@ static int ceph_tcp_recvmsg(struct socket *sock, void *buf, size_t len)
 	return r;
 }
 
-static int ceph_tcp_recvpage(struct socket *sock, struct page *page,
-		     int page_offset, size_t length)
-{
-	struct bio_vec bvec = {
-		.bv_page = page,
-		.bv_offset = page_offset,
-		.bv_len = length
-	};
+/* max number of data pieces received with one recvmsg() */
+#define CEPH_MSG_RECV_BVECS	16
+
+/*
+ * Receive directly into up to @nr_bvecs pieces of message data with a
+ * single recvmsg() call.
+ */
+static int ceph_tcp_recvpages(struct socket *sock, struct bio_vec *bvecs,
+			      int nr_bvecs, size_t length)
+{
 	struct msghdr msg = { .msg_flags = MSG_DONTWAIT | MSG_NOSIGNAL };
 	int r;
 
-	BUG_ON(page_offset + length > PAGE_SIZE);
-	iov_iter_bvec(&msg.msg_iter, READ, &bvec, 1, length);
+	iov_iter_bvec(&msg.msg_iter, READ, bvecs, nr_bvecs, length);
 	r = sock_recvmsg(sock, &msg, msg.msg_flags);
 	if (r == -EAGAIN)
 		r = 0;
@@ -2316,15 +2317,50 @@ static int read_partial_message_section(struct ceph_connection *con,
 	return 1;
 }
 
+/*
+ * Gather up to @nr_bvecs of the next pieces of message data, without
+ * moving @cursor.  Returns the number of bytes they cover.
+ */
+static size_t ceph_msg_data_peek_bvecs(struct ceph_msg_data_cursor *cursor,
+				       struct bio_vec *bvecs, int *nr_bvecs)
+{
+	struct ceph_msg_data_cursor peek = *cursor;
+	size_t page_offset;
+	size_t length;
+	size_t total = 0;
+	int nr = 0;
+
+	while (peek.total_resid && nr < *nr_bvecs) {
+		if (!peek.resid) {
+			ceph_msg_data_advance(&peek, 0);
+			continue;
+		}
+
+		bvecs[nr].bv_page = ceph_msg_data_next(&peek, &page_offset,
+						       &length, NULL);
+		bvecs[nr].bv_offset = page_offset;
+		bvecs[nr].bv_len = length;
+		total += length;
+		nr++;
+		ceph_msg_data_advance(&peek, length);
+	}
+
+	*nr_bvecs = nr;
+	return total;
+}
+
 static int read_partial_msg_data(struct ceph_connection *con)
 {
 	struct ceph_msg *msg = con->in_msg;
 	struct ceph_msg_data_cursor *cursor = &msg->cursor;
 	bool do_datacrc = !ceph_test_opt(from_msgr(con->msgr), NOCRC);
+	struct bio_vec bvecs[CEPH_MSG_RECV_BVECS];
 	struct page *page;
 	size_t page_offset;
 	size_t length;
+	size_t left;
 	u32 crc = 0;
+	int nr_bvecs;
 	int ret;
 
 	if (!msg->num_data_items)
@@ -2338,8 +2374,13 @@ static int read_partial_msg_data(struct ceph_connection *con)
 			continue;
 		}
 
-		page = ceph_msg_data_next(cursor, &page_offset, &length, NULL);
-		ret = ceph_tcp_recvpage(con->sock, page, page_offset, length);
+		/*
+		 * Receive into several pieces at once rather than taking
+		 * the socket lock and walking the receive queue per page.
+		 */
+		nr_bvecs = ARRAY_SIZE(bvecs);
+		length = ceph_msg_data_peek_bvecs(cursor, bvecs, &nr_bvecs);
+		ret = ceph_tcp_recvpages(con->sock, bvecs, nr_bvecs, length);
 		if (ret <= 0) {
 			if (do_datacrc)
 				con->in_data_crc = crc;
@@ -2347,9 +2388,21 @@ static int read_partial_msg_data(struct ceph_connection *con)
 			return ret;
 		}
 
-		if (do_datacrc)
-			crc = ceph_crc32c_page(crc, page, page_offset, ret);
-		ceph_msg_data_advance(cursor, (size_t)ret);
+		for (left = ret; left; left -= length) {
+			if (!cursor->resid) {
+				ceph_msg_data_advance(cursor, 0);
+				length = 0;
+				continue;
+			}
+
+			page = ceph_msg_data_next(cursor, &page_offset,
+						  &length, NULL);
+			length = min(length, left);
+			if (do_datacrc)
+				crc = ceph_crc32c_page(crc, page, page_offset,
+						       length);
+			ceph_msg_data_advance(cursor, length);
+		}
 	}
 	if (do_datacrc)
 		con->in_data_crc = crc;
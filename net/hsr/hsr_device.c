@@ -429,11 +429,13 @@ int hsr_dev_finalize(struct net_device *hsr_dev, struct net_device *slave[2],
 	struct hsr_priv *hsr;
 	struct hsr_port *port;
 	struct hsr_port *tmp;
-	int res;
+	int res, i;
 
 	hsr = netdev_priv(hsr_dev);
 	INIT_LIST_HEAD(&hsr->ports);
 	INIT_LIST_HEAD(&hsr->node_db);
+	for (i = 0; i < ARRAY_SIZE(hsr->node_hash); i++)
+		INIT_HLIST_HEAD(&hsr->node_hash[i]);
 	INIT_LIST_HEAD(&hsr->self_node_db);
 
 	ether_addr_copy(hsr_dev->dev_addr, slave[0]->dev_addr);
@@ -14,12 +14,11 @@
 #include <linux/etherdevice.h>
 #include <linux/slab.h>
 #include <linux/rculist.h>
+#include <linux/jhash.h>
 #include "hsr_main.h"
 #include "hsr_framereg.h"
 #include "hsr_netlink.h"
 
-/*	TODO: use hash lists for mac addresses (linux/jhash.h)?    */
-
 /* seq_nr_after(a, b) - return true if a is after (higher in sequence than) b,
  * false otherwise.
  */
@@ -57,14 +56,22 @@ bool hsr_addr_is_self(struct hsr_priv *hsr, unsigned char *addr)
 	return false;
 }
 
+static struct hlist_head *hsr_node_hash(struct hsr_priv *hsr,
+					const unsigned char addr[ETH_ALEN])
+{
+	u32 hash = jhash(addr, ETH_ALEN, 0);
+
+	return &hsr->node_hash[hash & (ARRAY_SIZE(hsr->node_hash) - 1)];
+}
+
 /* Search for mac entry. Caller must hold rcu read lock.
  */
-static struct hsr_node *find_node_by_addr_A(struct list_head *node_db,
+static struct hsr_node *find_node_by_addr_A(struct hsr_priv *hsr,
 					    const unsigned char addr[ETH_ALEN])
 {
 	struct hsr_node *node;
 
-	list_for_each_entry_rcu(node, node_db, mac_list) {
+	hlist_for_each_entry_rcu(node, hsr_node_hash(hsr, addr), hash_list) {
 		if (ether_addr_equal(node->macaddress_A, addr))
 			return node;
 	}
@@ -72,6 +79,13 @@ static struct hsr_node *find_node_by_addr_A(struct list_head *node_db,
 	return NULL;
 }
 
+static void hsr_del_node(struct hsr_node *node)
+{
+	hlist_del_rcu(&node->hash_list);
+	list_del_rcu(&node->mac_list);
+	kfree_rcu(node, rcu_head);
+}
+
 /* Helper for device init; the self_node_db is used in hsr_rcv() to recognize
  * frames from self that's been looped over the HSR ring.
  */
@@ -130,7 +144,7 @@ void hsr_del_nodes(struct list_head *node_db)
  * seq_out is used to initialize filtering of outgoing duplicate frames
  * originating from the newly added node.
  */
-struct hsr_node *hsr_add_node(struct list_head *node_db, unsigned char addr[],
+struct hsr_node *hsr_add_node(struct hsr_priv *hsr, unsigned char addr[],
 			      u16 seq_out)
 {
 	struct hsr_node *node;
@@ -152,7 +166,8 @@ struct hsr_node *hsr_add_node(struct list_head *node_db, unsigned char addr[],
 	for (i = 0; i < HSR_PT_PORTS; i++)
 		node->seq_out[i] = seq_out;
 
-	list_add_tail_rcu(&node->mac_list, node_db);
+	list_add_tail_rcu(&node->mac_list, &hsr->node_db);
+	hlist_add_head_rcu(&node->hash_list, hsr_node_hash(hsr, addr));
 
 	return node;
 }
@@ -172,6 +187,11 @@ struct hsr_node *hsr_get_node(struct hsr_port *port, struct sk_buff *skb,
 
 	ethhdr = (struct ethhdr *)skb_mac_header(skb);
 
+	node = find_node_by_addr_A(port->hsr, ethhdr->h_source);
+	if (node)
+		return node;
+
+	/* Frames sent from a node's B interface, or from a new node */
 	list_for_each_entry_rcu(node, node_db, mac_list) {
 		if (ether_addr_equal(node->macaddress_A, ethhdr->h_source))
 			return node;
@@ -196,7 +216,7 @@ struct hsr_node *hsr_get_node(struct hsr_port *port, struct sk_buff *skb,
 		seq_out = HSR_SEQNR_START;
 	}
 
-	return hsr_add_node(node_db, ethhdr->h_source, seq_out);
+	return hsr_add_node(port->hsr, ethhdr->h_source, seq_out);
 }
 
 /* Use the Supervision frame's info about an eventual macaddress_B for merging
@@ -208,8 +228,8 @@ void hsr_handle_sup_frame(struct sk_buff *skb, struct hsr_node *node_curr,
 {
 	struct ethhdr *ethhdr;
 	struct hsr_node *node_real;
+	struct hsr_priv *hsr = port_rcv->hsr;
 	struct hsr_sup_payload *hsr_sp;
-	struct list_head *node_db;
 	int i;
 
 	ethhdr = (struct ethhdr *)skb_mac_header(skb);
@@ -227,11 +247,10 @@ void hsr_handle_sup_frame(struct sk_buff *skb, struct hsr_node *node_curr,
 	hsr_sp = (struct hsr_sup_payload *)skb->data;
 
 	/* Merge node_curr (registered on macaddress_B) into node_real */
-	node_db = &port_rcv->hsr->node_db;
-	node_real = find_node_by_addr_A(node_db, hsr_sp->macaddress_A);
+	node_real = find_node_by_addr_A(hsr, hsr_sp->macaddress_A);
 	if (!node_real)
 		/* No frame received from AddrA of this node yet */
-		node_real = hsr_add_node(node_db, hsr_sp->macaddress_A,
+		node_real = hsr_add_node(hsr, hsr_sp->macaddress_A,
 					 HSR_SEQNR_START - 1);
 	if (!node_real)
 		goto done; /* No mem */
@@ -252,8 +271,7 @@ void hsr_handle_sup_frame(struct sk_buff *skb, struct hsr_node *node_curr,
 	}
 	node_real->addr_B_port = port_rcv->type;
 
-	list_del_rcu(&node_curr->mac_list);
-	kfree_rcu(node_curr, rcu_head);
+	hsr_del_node(node_curr);
 
 done:
 	skb_push(skb, sizeof(struct hsrv1_ethhdr_sp));
@@ -297,8 +315,7 @@ void hsr_addr_subst_dest(struct hsr_node *node_src, struct sk_buff *skb,
 	if (!is_unicast_ether_addr(eth_hdr(skb)->h_dest))
 		return;
 
-	node_dst = find_node_by_addr_A(&port->hsr->node_db,
-				       eth_hdr(skb)->h_dest);
+	node_dst = find_node_by_addr_A(port->hsr, eth_hdr(skb)->h_dest);
 	if (!node_dst) {
 		WARN_ONCE(1, "%s: Unknown node\n", __func__);
 		return;
@@ -416,9 +433,8 @@ void hsr_prune_nodes(struct timer_list *t)
 		if (time_is_before_jiffies(timestamp +
 				msecs_to_jiffies(HSR_NODE_FORGET_TIME))) {
 			hsr_nl_nodedown(hsr, node->macaddress_A);
-			list_del_rcu(&node->mac_list);
-			/* Note that we need to free this entry later: */
-			kfree_rcu(node, rcu_head);
+			/* Note that this frees the entry later: */
+			hsr_del_node(node);
 		}
 	}
 	rcu_read_unlock();
@@ -464,7 +480,7 @@ int hsr_get_node_data(struct hsr_priv *hsr,
 	unsigned long tdiff;
 
 	rcu_read_lock();
-	node = find_node_by_addr_A(&hsr->node_db, addr);
+	node = find_node_by_addr_A(hsr, addr);
 	if (!node) {
 		rcu_read_unlock();
 		return -ENOENT;	/* No such entry */
@@ -14,7 +14,7 @@ struct hsr_node;
 
 void hsr_del_self_node(struct list_head *self_node_db);
 void hsr_del_nodes(struct list_head *node_db);
-struct hsr_node *hsr_add_node(struct list_head *node_db, unsigned char addr[],
+struct hsr_node *hsr_add_node(struct hsr_priv *hsr, unsigned char addr[],
 			      u16 seq_out);
 struct hsr_node *hsr_get_node(struct hsr_port *port, struct sk_buff *skb,
 			      bool is_sup);
@@ -51,6 +51,7 @@ int hsr_get_node_data(struct hsr_priv *hsr,
 
 struct hsr_node {
 	struct list_head	mac_list;
+	struct hlist_node	hash_list;	/* node_hash, by macaddress_A */
 	unsigned char		macaddress_A[ETH_ALEN];
 	unsigned char		macaddress_B[ETH_ALEN];
 	/* Local slave through which AddrB frames are received from this node */
@@ -31,6 +31,9 @@
  */
 #define PRUNE_PERIOD			 3000 /* ms */
 
+/* Buckets of the hash of known nodes by macaddress_A */
+#define HSR_NODE_HASH_BITS		    8
+
 #define HSR_TLV_ANNOUNCE		   22
 #define HSR_TLV_LIFE_CHECK		   23
 
@@ -154,6 +157,7 @@ struct hsr_priv {
 	struct rcu_head		rcu_head;
 	struct list_head	ports;
 	struct list_head	node_db;	/* Known HSR nodes */
+	struct hlist_head	node_hash[1 << HSR_NODE_HASH_BITS];
 	struct list_head	self_node_db;	/* MACs of slaves */
 	struct timer_list	announce_timer;	/* Supervision frame dispatch */
 	struct timer_list	prune_timer;
@@ -627,15 +627,15 @@ static void get_old_counters(const struct xt_table_info *t,
 	struct arpt_entry *iter;
 	unsigned int cpu, i;
 
-	for_each_possible_cpu(cpu) {
-		i = 0;
-		xt_entry_foreach(iter, t->entries, t->size) {
+	i = 0;
+	xt_entry_foreach(iter, t->entries, t->size) {
+		for_each_possible_cpu(cpu) {
 			struct xt_counters *tmp;
 
 			tmp = xt_get_per_cpu_counter(&iter->counters, cpu);
 			ADD_COUNTER(counters[i], tmp->bcnt, tmp->pcnt);
-			++i;
 		}
+		++i;
 		cond_resched();
 	}
 }
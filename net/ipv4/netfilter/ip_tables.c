@@ -773,16 +773,19 @@ static void get_old_counters(const struct xt_table_info *t,
 	struct ipt_entry *iter;
 	unsigned int cpu, i;
 
-	for_each_possible_cpu(cpu) {
-		i = 0;
-		xt_entry_foreach(iter, t->entries, t->size) {
+	/* The table is no longer live, so there is no need to snapshot per
+	 * cpu. Walk the rule blob once and fold all cpus into each rule's
+	 * counter instead of walking the whole blob once per cpu.
+	 */
+	i = 0;
+	xt_entry_foreach(iter, t->entries, t->size) {
+		for_each_possible_cpu(cpu) {
 			const struct xt_counters *tmp;
 
 			tmp = xt_get_per_cpu_counter(&iter->counters, cpu);
 			ADD_COUNTER(counters[i], tmp->bcnt, tmp->pcnt);
-			++i; /* macro does multi eval of i */
 		}
-
+		++i; /* macro does multi eval of i */
 		cond_resched();
 	}
 }
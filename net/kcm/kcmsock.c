@@ -428,6 +428,29 @@ static void psock_write_space(struct sock *sk)
 
 static void unreserve_psock(struct kcm_sock *kcm);
 
+/* Pick the available psock with the least data queued on its lower socket
+ * so a slow connection does not build up a backlog while others sit idle.
+ * mux lock held.
+ */
+static struct kcm_psock *kcm_pick_avail_psock(struct kcm_mux *mux)
+{
+	struct kcm_psock *psock, *best = NULL;
+	int best_queued = INT_MAX;
+
+	list_for_each_entry(psock, &mux->psocks_avail, psock_avail_list) {
+		int queued = READ_ONCE(psock->sk->sk_wmem_queued);
+
+		if (queued < best_queued) {
+			best = psock;
+			best_queued = queued;
+			if (!queued)
+				break;
+		}
+	}
+
+	return best;
+}
+
 /* kcm sock is locked. */
 static struct kcm_psock *reserve_psock(struct kcm_sock *kcm)
 {
@@ -458,10 +481,8 @@ static struct kcm_psock *reserve_psock(struct kcm_sock *kcm)
 		return kcm->tx_psock;
 	}
 
-	if (!list_empty(&mux->psocks_avail)) {
-		psock = list_first_entry(&mux->psocks_avail,
-					 struct kcm_psock,
-					 psock_avail_list);
+	psock = kcm_pick_avail_psock(mux);
+	if (psock) {
 		list_del(&psock->psock_avail_list);
 		if (kcm->tx_wait) {
 			list_del(&kcm->wait_psock_list);
@@ -457,7 +457,19 @@ static void __ip_vs_conn_put_timer(struct ip_vs_conn *cp)
 {
 	unsigned long t = (cp->flags & IP_VS_CONN_F_ONE_PACKET) ?
 		0 : cp->timeout;
-	mod_timer(&cp->timer, jiffies+t);
+	unsigned long expires = jiffies + t;
+	unsigned long pending = READ_ONCE(cp->timer.expires);
+
+	/* Re-arming takes the timer base lock for every packet of a busy
+	 * connection. Skip it while the pending expiry trails the wanted one
+	 * by less than 1/64 of the timeout; the wheel is not more precise
+	 * than that for long timeouts anyway. An earlier expiry, e.g. after
+	 * a state change, is always applied.
+	 */
+	if (!timer_pending(&cp->timer) ||
+	    time_before(expires, pending) ||
+	    time_after(expires, pending + (t >> 6)))
+		mod_timer(&cp->timer, expires);
 
 	__ip_vs_conn_put(cp);
 }
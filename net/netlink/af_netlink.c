@@ -1995,12 +1995,17 @@ static int netlink_recvmsg(struct socket *sock, struct msghdr *msg, size_t len,
 
 	skb_free_datagram(sk, skb);
 
-	if (nlk->cb_running &&
-	    atomic_read(&sk->sk_rmem_alloc) <= sk->sk_rcvbuf / 2) {
+	/* Refill the receive queue up to half of the receive buffer rather
+	 * than by a single skb, so that a reader using a large rcvbuf and
+	 * recvmmsg() can pull many dump skbs per system call.
+	 */
+	while (nlk->cb_running &&
+	       atomic_read(&sk->sk_rmem_alloc) <= sk->sk_rcvbuf / 2) {
 		ret = netlink_dump(sk);
 		if (ret) {
 			sk->sk_err = -ret;
 			sk->sk_error_report(sk);
+			break;
 		}
 	}
 
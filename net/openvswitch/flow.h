@@ -167,6 +167,10 @@ struct sw_flow_mask {
 	int ref_count;
 	struct rcu_head rcu;
 	struct list_head list;
+	unsigned long __percpu *hits;	/* Lookups that matched via the mask. */
+	unsigned long last_hits;	/* Sum of 'hits' at last rebalance. */
+	unsigned long hits_delta;	/* Hits during last rebalance interval. */
+	int rebalance_idx;		/* Position before the last rebalance. */
 	struct sw_flow_key_range range;
 	struct sw_flow_key key;
 };
@@ -29,6 +29,7 @@
 #include <linux/icmp.h>
 #include <linux/icmpv6.h>
 #include <linux/rculist.h>
+#include <linux/sort.h>
 #include <net/ip.h>
 #include <net/ipv6.h>
 #include <net/ndisc.h>
@@ -180,6 +181,7 @@ int ovs_flow_tbl_init(struct flow_table *table)
 	rcu_assign_pointer(table->ti, ti);
 	rcu_assign_pointer(table->ufid_ti, ufid_ti);
 	INIT_LIST_HEAD(&table->mask_list);
+	RCU_INIT_POINTER(table->mask_array, NULL);
 	table->last_rehash = jiffies;
 	table->count = 0;
 	table->ufid_count = 0;
@@ -243,6 +245,7 @@ void ovs_flow_tbl_destroy(struct flow_table *table)
 	struct table_instance *ti = rcu_dereference_raw(table->ti);
 	struct table_instance *ufid_ti = rcu_dereference_raw(table->ufid_ti);
 
+	kfree(rcu_dereference_raw(table->mask_array));
 	table_instance_destroy(ti, ufid_ti, false);
 }
 
@@ -448,15 +451,26 @@ struct sw_flow *ovs_flow_tbl_lookup_stats(struct flow_table *tbl,
 				    u32 *n_mask_hit)
 {
 	struct table_instance *ti = rcu_dereference_ovsl(tbl->ti);
+	struct mask_array *ma = rcu_dereference_ovsl(tbl->mask_array);
 	struct sw_flow_mask *mask;
 	struct sw_flow *flow;
+	int i;
 
 	*n_mask_hit = 0;
-	list_for_each_entry_rcu(mask, &tbl->mask_list, list) {
+	if (!ma)
+		return NULL;
+
+	for (i = 0; i < ma->count; i++) {
+		mask = READ_ONCE(ma->masks[i]);
+		if (unlikely(!mask))
+			continue;
+
 		(*n_mask_hit)++;
 		flow = masked_flow_lookup(ti, key, mask);
-		if (flow)  /* Found */
+		if (flow) { /* Found */
+			this_cpu_inc(*mask->hits);
 			return flow;
+		}
 	}
 	return NULL;
 }
@@ -543,6 +557,139 @@ static struct table_instance *table_instance_expand(struct table_instance *ti,
 	return table_instance_rehash(ti, ti->n_buckets * 2, ufid);
 }
 
+static void mask_free_rcu(struct rcu_head *rcu)
+{
+	struct sw_flow_mask *mask = container_of(rcu, struct sw_flow_mask, rcu);
+
+	free_percpu(mask->hits);
+	kfree(mask);
+}
+
+static unsigned long mask_hits(const struct sw_flow_mask *mask)
+{
+	unsigned long hits = 0;
+	int cpu;
+
+	for_each_possible_cpu(cpu)
+		hits += *per_cpu_ptr(mask->hits, cpu);
+
+	return hits;
+}
+
+/* Allocate a mask array holding the masks of 'old', in the same order and
+ * without holes, with room for 'extra' more.
+ */
+static struct mask_array *tbl_mask_array_copy(const struct mask_array *old,
+					      int extra)
+{
+	int i, size = (old ? old->count : 0) + extra;
+	struct mask_array *new;
+
+	new = kmalloc(struct_size(new, masks, size), GFP_KERNEL);
+	if (!new)
+		return NULL;
+
+	new->count = 0;
+	for (i = 0; old && i < old->count; i++) {
+		if (old->masks[i])
+			new->masks[new->count++] = old->masks[i];
+	}
+
+	return new;
+}
+
+/* Must be called with OVS mutex held. */
+static void tbl_mask_array_replace(struct flow_table *tbl,
+				   struct mask_array *new)
+{
+	struct mask_array *old = ovsl_dereference(tbl->mask_array);
+
+	rcu_assign_pointer(tbl->mask_array, new);
+	if (old)
+		kfree_rcu(old, rcu);
+}
+
+/* Must be called with OVS mutex held. */
+static void tbl_mask_array_del(struct flow_table *tbl,
+			       struct sw_flow_mask *mask)
+{
+	struct mask_array *ma = ovsl_dereference(tbl->mask_array);
+	struct mask_array *new;
+	int i;
+
+	for (i = 0; i < ma->count; i++) {
+		if (ma->masks[i] == mask) {
+			WRITE_ONCE(ma->masks[i], NULL);
+			break;
+		}
+	}
+
+	/* Compact the array. If that fails, lookups skip the hole. */
+	new = tbl_mask_array_copy(ma, 0);
+	if (new)
+		tbl_mask_array_replace(tbl, new);
+}
+
+static int mask_cmp_hits(const void *a, const void *b)
+{
+	const struct sw_flow_mask *ma = *(struct sw_flow_mask * const *)a;
+	const struct sw_flow_mask *mb = *(struct sw_flow_mask * const *)b;
+
+	if (ma->hits_delta != mb->hits_delta)
+		return ma->hits_delta > mb->hits_delta ? -1 : 1;
+
+	/* Keep the current order of equally hit masks. */
+	return ma->rebalance_idx - mb->rebalance_idx;
+}
+
+/* Reorder the masks so that the ones that matched most packets since the
+ * last call are tried first. Must be called with OVS mutex held.
+ */
+void ovs_flow_masks_rebalance(struct flow_table *table)
+{
+	struct mask_array *ma = ovsl_dereference(table->mask_array);
+	struct sw_flow_mask *prev = NULL;
+	struct mask_array *new;
+	bool sorted = true;
+	int i;
+
+	if (!ma)
+		return;
+
+	for (i = 0; i < ma->count; i++) {
+		struct sw_flow_mask *mask = ma->masks[i];
+		unsigned long hits;
+
+		if (!mask) {
+			/* Republish to get rid of the hole. */
+			sorted = false;
+			continue;
+		}
+
+		hits = mask_hits(mask);
+		mask->hits_delta = hits - mask->last_hits;
+		mask->last_hits = hits;
+		mask->rebalance_idx = i;
+
+		if (prev && mask_cmp_hits(&prev, &mask) > 0)
+			sorted = false;
+		prev = mask;
+	}
+
+	/* Order unchanged, keep the current array. */
+	if (sorted)
+		return;
+
+	new = tbl_mask_array_copy(ma, 0);
+	if (!new)
+		return;
+
+	sort(new->masks, new->count, sizeof(new->masks[0]),
+	     mask_cmp_hits, NULL);
+
+	tbl_mask_array_replace(table, new);
+}
+
 /* Remove 'mask' from the mask list, if it is not needed any more. */
 static void flow_mask_remove(struct flow_table *tbl, struct sw_flow_mask *mask)
 {
@@ -555,8 +702,9 @@ static void flow_mask_remove(struct flow_table *tbl, struct sw_flow_mask *mask)
 		mask->ref_count--;
 
 		if (!mask->ref_count) {
+			tbl_mask_array_del(tbl, mask);
 			list_del_rcu(&mask->list);
-			kfree_rcu(mask, rcu);
+			call_rcu(&mask->rcu, mask_free_rcu);
 		}
 	}
 }
@@ -586,8 +734,17 @@ static struct sw_flow_mask *mask_alloc(void)
 	struct sw_flow_mask *mask;
 
 	mask = kmalloc(sizeof(*mask), GFP_KERNEL);
-	if (mask)
-		mask->ref_count = 1;
+	if (!mask)
+		return NULL;
+
+	mask->hits = alloc_percpu(unsigned long);
+	if (!mask->hits) {
+		kfree(mask);
+		return NULL;
+	}
+	mask->ref_count = 1;
+	mask->last_hits = 0;
+	mask->hits_delta = 0;
 
 	return mask;
 }
@@ -625,13 +782,25 @@ static int flow_mask_insert(struct flow_table *tbl, struct sw_flow *flow,
 	struct sw_flow_mask *mask;
 	mask = flow_mask_find(tbl, new);
 	if (!mask) {
+		struct mask_array *ma;
+
 		/* Allocate a new mask if none exsits. */
 		mask = mask_alloc();
 		if (!mask)
 			return -ENOMEM;
+
+		ma = tbl_mask_array_copy(ovsl_dereference(tbl->mask_array), 1);
+		if (!ma) {
+			free_percpu(mask->hits);
+			kfree(mask);
+			return -ENOMEM;
+		}
+
 		mask->key = new->key;
 		mask->range = new->range;
+		ma->masks[ma->count++] = mask;
 		list_add_rcu(&mask->list, &tbl->mask_list);
+		tbl_mask_array_replace(tbl, ma);
 	} else {
 		BUG_ON(!mask->ref_count);
 		mask->ref_count++;
@@ -31,10 +31,20 @@ struct table_instance {
 	bool keep_flows;
 };
 
+/* Masks in lookup order. Entries are only ever cleared in place, to
+ * NULL, so RCU readers must skip holes.
+ */
+struct mask_array {
+	struct rcu_head rcu;
+	int count;
+	struct sw_flow_mask *masks[];
+};
+
 struct flow_table {
 	struct table_instance __rcu *ti;
 	struct table_instance __rcu *ufid_ti;
 	struct list_head mask_list;
+	struct mask_array __rcu *mask_array;
 	unsigned long last_rehash;
 	unsigned int count;
 	unsigned int ufid_count;
@@ -57,6 +67,7 @@ int ovs_flow_tbl_insert(struct flow_table *table, struct sw_flow *flow,
 			const struct sw_flow_mask *mask);
 void ovs_flow_tbl_remove(struct flow_table *table, struct sw_flow *flow);
 int  ovs_flow_tbl_num_masks(const struct flow_table *table);
+void ovs_flow_masks_rebalance(struct flow_table *table);
 struct sw_flow *ovs_flow_tbl_dump_next(struct table_instance *table,
 				       u32 *bucket, u32 *idx);
 struct sw_flow *ovs_flow_tbl_lookup_stats(struct flow_table *,
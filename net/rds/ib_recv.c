@@ -242,6 +242,14 @@ void rds_ib_recv_clear_ring(struct rds_ib_connection *ic)
 		rds_ib_recv_clear_one(ic, &ic->i_recvs[i]);
 }
 
+/* Incs and frags are mostly touched from the receive completion path, which
+ * runs on the HCA's completion vector. Keep them on the HCA's node.
+ */
+static int rds_ib_recv_alloc_node(struct rds_ib_connection *ic)
+{
+	return ic->rds_ibdev ? rdsibdev_to_node(ic->rds_ibdev) : NUMA_NO_NODE;
+}
+
 static struct rds_ib_incoming *rds_ib_refill_one_inc(struct rds_ib_connection *ic,
 						     gfp_t slab_mask)
 {
@@ -259,7 +267,8 @@ static struct rds_ib_incoming *rds_ib_refill_one_inc(struct rds_ib_connection *i
 			rds_ib_stats_inc(s_ib_rx_alloc_limit);
 			return NULL;
 		}
-		ibinc = kmem_cache_alloc(rds_ib_incoming_slab, slab_mask);
+		ibinc = kmem_cache_alloc_node(rds_ib_incoming_slab, slab_mask,
+					      rds_ib_recv_alloc_node(ic));
 		if (!ibinc) {
 			atomic_dec(&rds_ib_allocation);
 			return NULL;
@@ -285,7 +294,8 @@ static struct rds_page_frag *rds_ib_refill_one_frag(struct rds_ib_connection *ic
 		atomic_sub(RDS_FRAG_SIZE / SZ_1K, &ic->i_cache_allocs);
 		rds_ib_stats_add(s_ib_recv_added_to_cache, RDS_FRAG_SIZE);
 	} else {
-		frag = kmem_cache_alloc(rds_ib_frag_slab, slab_mask);
+		frag = kmem_cache_alloc_node(rds_ib_frag_slab, slab_mask,
+					     rds_ib_recv_alloc_node(ic));
 		if (!frag)
 			return NULL;
 
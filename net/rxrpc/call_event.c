@@ -158,10 +158,11 @@ static void rxrpc_resend(struct rxrpc_call *call, unsigned long now_j)
 {
 	struct sk_buff *skb;
 	unsigned long resend_at;
-	rxrpc_seq_t cursor, seq, top;
+	rxrpc_seq_t cursor, seq, next, top;
 	ktime_t now, max_age, oldest, ack_ts, timeout, min_timeo;
 	int ix;
 	u8 annotation, anno_type, retrans = 0, unacked = 0;
+	bool more;
 
 	_enter("{%d,%d}", call->tx_hard_ack, call->tx_top);
 
@@ -254,11 +255,24 @@ static void rxrpc_resend(struct rxrpc_call *call, unsigned long now_j)
 		if (anno_type != RXRPC_TX_ANNO_RETRANS)
 			continue;
 
+		/* Only the last packet of the burst needs to ask for an ACK;
+		 * one ACK covers the whole window and asking for one per
+		 * packet just has the peer flood us with them.
+		 */
+		more = false;
+		for (next = seq + 1; before_eq(next, top); next++) {
+			if ((call->rxtx_annotations[next & RXRPC_RXTX_BUFF_MASK] &
+			     RXRPC_TX_ANNO_MASK) == RXRPC_TX_ANNO_RETRANS) {
+				more = true;
+				break;
+			}
+		}
+
 		skb = call->rxtx_buffer[ix];
 		rxrpc_get_skb(skb, rxrpc_skb_tx_got);
 		spin_unlock_bh(&call->lock);
 
-		if (rxrpc_send_data_packet(call, skb, true) < 0) {
+		if (rxrpc_send_data_packet(call, skb, true, more) < 0) {
 			rxrpc_free_skb(skb, rxrpc_skb_tx_freed);
 			return;
 		}
@@ -319,9 +319,11 @@ int rxrpc_send_abort_packet(struct rxrpc_call *call)
 
 /*
  * send a packet through the transport endpoint
+ * - @more indicates that further retransmissions will immediately follow
+ *   this one, in which case only the last of them needs to solicit an ACK
  */
 int rxrpc_send_data_packet(struct rxrpc_call *call, struct sk_buff *skb,
-			   bool retrans)
+			   bool retrans, bool more)
 {
 	struct rxrpc_connection *conn = call->conn;
 	struct rxrpc_wire_header whdr;
@@ -376,7 +378,7 @@ int rxrpc_send_data_packet(struct rxrpc_call *call, struct sk_buff *skb,
 	     rxrpc_to_server(sp)
 	     ) &&
 	    (test_and_clear_bit(RXRPC_CALL_EV_ACK_LOST, &call->events) ||
-	     retrans ||
+	     (retrans && !more) ||
 	     call->cong_mode == RXRPC_CALL_SLOW_START ||
 	     (call->peer->rtt_usage < 3 && sp->hdr.seq & 1) ||
 	     ktime_before(ktime_add_ms(call->peer->rtt_last_req, 1000),
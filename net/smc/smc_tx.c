@@ -265,17 +265,18 @@ int smcd_tx_ism_write(struct smc_connection *conn, void *data, size_t len,
 	return rc;
 }
 
-/* sndbuf consumer: actual data transfer of one target chunk with RDMA write */
-static int smc_tx_rdma_write(struct smc_connection *conn, int peer_rmbe_offset,
-			     int num_sges, struct ib_rdma_wr *rdma_wr)
+/* sndbuf consumer: prepare the RDMA write of one target chunk */
+static void smc_tx_rdma_write_prep(struct smc_connection *conn,
+				   int peer_rmbe_offset, int num_sges,
+				   struct ib_rdma_wr *rdma_wr)
 {
 	struct smc_link_group *lgr = conn->lgr;
 	struct smc_link *link;
-	int rc;
 
 	link = &lgr->lnk[SMC_SINGLE_LINK];
 	rdma_wr->wr.wr_id = smc_wr_tx_get_next_wr_id(link);
 	rdma_wr->wr.num_sge = num_sges;
+	rdma_wr->wr.next = NULL;
 	rdma_wr->remote_addr =
 		lgr->rtokens[conn->rtoken_idx][SMC_SINGLE_LINK].dma_addr +
 		/* RMBE within RMB */
@@ -283,6 +284,19 @@ static int smc_tx_rdma_write(struct smc_connection *conn, int peer_rmbe_offset,
 		/* offset within RMBE */
 		peer_rmbe_offset;
 	rdma_wr->rkey = lgr->rtokens[conn->rtoken_idx][SMC_SINGLE_LINK].rkey;
+}
+
+/* sndbuf consumer: actual data transfer of the prepared (chained) target
+ * chunks with RDMA write
+ */
+static int smc_tx_rdma_write(struct smc_connection *conn,
+			     struct ib_rdma_wr *rdma_wr)
+{
+	struct smc_link_group *lgr = conn->lgr;
+	struct smc_link *link;
+	int rc;
+
+	link = &lgr->lnk[SMC_SINGLE_LINK];
 	rc = ib_post_send(link->roce_qp, &rdma_wr->wr, NULL);
 	if (rc) {
 		conn->local_tx_ctrl.conn_state_flags.peer_conn_abort = 1;
@@ -319,7 +333,6 @@ static int smcr_tx_rdma_writes(struct smc_connection *conn, size_t len,
 	int sent_count = src_off;
 	int srcchunk, dstchunk;
 	int num_sges;
-	int rc;
 
 	for (dstchunk = 0; dstchunk < 2; dstchunk++) {
 		struct ib_sge *sge =
@@ -341,12 +354,13 @@ static int smcr_tx_rdma_writes(struct smc_connection *conn, size_t len,
 			src_len = dst_len - src_len; /* remainder */
 			src_len_sum += src_len;
 		}
-		rc = smc_tx_rdma_write(conn, dst_off, num_sges,
+		smc_tx_rdma_write_prep(conn, dst_off, num_sges,
 				       &wr_rdma_buf->wr_tx_rdma[dstchunk]);
-		if (rc)
-			return rc;
 		if (dst_len_sum == len)
 			break; /* either on 1st or 2nd iteration */
+		/* chain the 2nd write to the 1st, both go out with one post */
+		wr_rdma_buf->wr_tx_rdma[dstchunk].wr.next =
+			&wr_rdma_buf->wr_tx_rdma[dstchunk + 1].wr;
 		/* prepare next (== 2nd) iteration */
 		dst_off = 0; /* modulo offset in RMBE ring buffer */
 		dst_len = len - dst_len; /* remainder */
@@ -355,7 +369,7 @@ static int smcr_tx_rdma_writes(struct smc_connection *conn, size_t len,
 				sent_count);
 		src_len_sum = src_len;
 	}
-	return 0;
+	return smc_tx_rdma_write(conn, &wr_rdma_buf->wr_tx_rdma[0]);
 }
 
 /* SMC-D helper for smc_tx_rdma_writes() */
@@ -299,8 +299,12 @@ static int __strp_recv(read_descriptor_t *desc, struct sk_buff *orig_skb,
 
 		eaten += (cand_len - extra);
 
-		/* Hurray, we have a new message! */
-		cancel_delayed_work(&strp->msg_timer_work);
+		/* Hurray, we have a new message! The assembly timer is only
+		 * armed once a message spans more than one receive, so a
+		 * message parsed entirely from this skb has nothing to cancel.
+		 */
+		if (stm->accum_len)
+			cancel_delayed_work(&strp->msg_timer_work);
 		strp->skb_head = NULL;
 		strp->need_bytes = 0;
 		STRP_STATS_INCR(strp->stats.msgs);
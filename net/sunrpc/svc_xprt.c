@@ -46,6 +46,9 @@ static LIST_HEAD(svc_xprt_class_list);
 /* SMP locking strategy:
  *
  *	svc_pool->sp_lock protects most of the fields of that pool.
+ *	svc_pool->sp_new_sockets is a lockless list, so that enqueueing
+ *	a transport doesn't take sp_lock; it is moved over to sp_sockets
+ *	under sp_lock by the consumers.
  *	svc_serv->sv_lock protects sv_tempsocks, sv_permsocks, sv_tmpcnt.
  *	when both need to be taken (rare), svc_serv->sv_lock is first.
  *	The "service mutex" protects svc_serv->sv_nrthread.
@@ -416,10 +419,8 @@ void svc_xprt_do_enqueue(struct svc_xprt *xprt)
 
 	atomic_long_inc(&pool->sp_stats.packets);
 
-	spin_lock_bh(&pool->sp_lock);
-	list_add_tail(&xprt->xpt_ready, &pool->sp_sockets);
-	pool->sp_stats.sockets_queued++;
-	spin_unlock_bh(&pool->sp_lock);
+	llist_add(&xprt->xpt_ready_new, &pool->sp_new_sockets);
+	atomic_long_inc(&pool->sp_stats.sockets_queued);
 
 	/* find a thread for this xprt */
 	rcu_read_lock();
@@ -453,6 +454,27 @@ void svc_xprt_enqueue(struct svc_xprt *xprt)
 }
 EXPORT_SYMBOL_GPL(svc_xprt_enqueue);
 
+static bool svc_pool_has_sockets(struct svc_pool *pool)
+{
+	return !list_empty(&pool->sp_sockets) ||
+	       !llist_empty(&pool->sp_new_sockets);
+}
+
+/*
+ * Move the transports enqueued since the last call to the tail of
+ * sp_sockets, oldest first.  Caller holds sp_lock.
+ */
+static void svc_pool_collect_sockets(struct svc_pool *pool)
+{
+	struct llist_node *first;
+	struct svc_xprt *xprt, *tmp;
+
+	first = llist_del_all(&pool->sp_new_sockets);
+	first = llist_reverse_order(first);
+	llist_for_each_entry_safe(xprt, tmp, first, xpt_ready_new)
+		list_add_tail(&xprt->xpt_ready, &pool->sp_sockets);
+}
+
 /*
  * Dequeue the first transport, if there is one.
  */
@@ -460,10 +482,12 @@ static struct svc_xprt *svc_xprt_dequeue(struct svc_pool *pool)
 {
 	struct svc_xprt	*xprt = NULL;
 
-	if (list_empty(&pool->sp_sockets))
+	if (!svc_pool_has_sockets(pool))
 		goto out;
 
 	spin_lock_bh(&pool->sp_lock);
+	if (list_empty(&pool->sp_sockets))
+		svc_pool_collect_sockets(pool);
 	if (likely(!list_empty(&pool->sp_sockets))) {
 		xprt = list_first_entry(&pool->sp_sockets,
 					struct svc_xprt, xpt_ready);
@@ -682,7 +706,7 @@ rqst_should_sleep(struct svc_rqst *rqstp)
 		return false;
 
 	/* was a socket queued? */
-	if (!list_empty(&pool->sp_sockets))
+	if (svc_pool_has_sockets(pool))
 		return false;
 
 	/* are we shutting down? */
@@ -1087,6 +1111,7 @@ static struct svc_xprt *svc_dequeue_net(struct svc_serv *serv, struct net *net)
 		pool = &serv->sv_pools[i];
 
 		spin_lock_bh(&pool->sp_lock);
+		svc_pool_collect_sockets(pool);
 		list_for_each_entry_safe(xprt, tmp, &pool->sp_sockets, xpt_ready) {
 			if (xprt->xpt_net != net)
 				continue;
@@ -1409,7 +1434,7 @@ static int svc_pool_stats_show(struct seq_file *m, void *p)
 	seq_printf(m, "%u %lu %lu %lu %lu\n",
 		pool->sp_id,
 		(unsigned long)atomic_long_read(&pool->sp_stats.packets),
-		pool->sp_stats.sockets_queued,
+		(unsigned long)atomic_long_read(&pool->sp_stats.sockets_queued),
 		(unsigned long)atomic_long_read(&pool->sp_stats.threads_woken),
 		(unsigned long)atomic_long_read(&pool->sp_stats.threads_timedout));
 
@@ -538,6 +538,39 @@ int svc_rdma_send_write_chunk(struct svcxprt_rdma *rdma, __be32 *wr_ch,
 	return ret;
 }
 
+/* Construct RDMA Writes for the parts of @xdr that go in the Reply chunk.
+ * Returns the number of bytes consumed, or a negative errno.
+ */
+static int svc_rdma_build_reply_chunk(struct svc_rdma_write_info *info,
+				      bool writelist, struct xdr_buf *xdr)
+{
+	int consumed, ret;
+
+	ret = svc_rdma_send_xdr_kvec(info, &xdr->head[0]);
+	if (ret < 0)
+		return ret;
+	consumed = xdr->head[0].iov_len;
+
+	/* Send the page list in the Reply chunk only if the
+	 * client did not provide Write chunks.
+	 */
+	if (!writelist && xdr->page_len) {
+		ret = svc_rdma_send_xdr_pagelist(info, xdr);
+		if (ret < 0)
+			return ret;
+		consumed += xdr->page_len;
+	}
+
+	if (xdr->tail[0].iov_len) {
+		ret = svc_rdma_send_xdr_kvec(info, &xdr->tail[0]);
+		if (ret < 0)
+			return ret;
+		consumed += xdr->tail[0].iov_len;
+	}
+
+	return consumed;
+}
+
 /**
  * svc_rdma_send_reply_chunk - Write all segments in the Reply chunk
  * @rdma: controlling RDMA transport
@@ -562,37 +595,97 @@ int svc_rdma_send_reply_chunk(struct svcxprt_rdma *rdma, __be32 *rp_ch,
 	if (!info)
 		return -ENOMEM;
 
-	ret = svc_rdma_send_xdr_kvec(info, &xdr->head[0]);
+	consumed = svc_rdma_build_reply_chunk(info, writelist, xdr);
+	if (consumed < 0) {
+		ret = consumed;
+		goto out_err;
+	}
+
+	ret = svc_rdma_post_chunk_ctxt(&info->wi_cc);
 	if (ret < 0)
 		goto out_err;
-	consumed = xdr->head[0].iov_len;
 
-	/* Send the page list in the Reply chunk only if the
-	 * client did not provide Write chunks.
-	 */
-	if (!writelist && xdr->page_len) {
-		ret = svc_rdma_send_xdr_pagelist(info, xdr);
+	trace_svcrdma_encode_reply(consumed);
+	return consumed;
+
+out_err:
+	svc_rdma_write_info_free(info);
+	return ret;
+}
+
+/**
+ * svc_rdma_send_write_reply_chunks - Write a Write chunk and the Reply chunk
+ * @rdma: controlling RDMA transport
+ * @wr_ch: Write chunk provided by client
+ * @rp_ch: Reply chunk provided by client
+ * @xdr: xdr_buf containing an RPC Reply
+ * @wr_len: OUT: number of bytes the Write chunk consumed
+ *
+ * Like calling svc_rdma_send_write_chunk() and then
+ * svc_rdma_send_reply_chunk(), but all RDMA Writes for both chunks
+ * are posted as one WR chain with a single signaled completion.
+ *
+ * Returns a non-negative number of bytes the Reply chunk consumed, or
+ * one of the negative errnos returned by svc_rdma_send_reply_chunk().
+ */
+int svc_rdma_send_write_reply_chunks(struct svcxprt_rdma *rdma,
+				     __be32 *wr_ch, __be32 *rp_ch,
+				     struct xdr_buf *xdr, int *wr_len)
+{
+	struct svc_rdma_write_info *winfo, *rinfo;
+	int consumed, ret;
+
+	winfo = svc_rdma_write_info_alloc(rdma, wr_ch);
+	if (!winfo)
+		return -ENOMEM;
+	rinfo = svc_rdma_write_info_alloc(rdma, rp_ch);
+	if (!rinfo) {
+		ret = -ENOMEM;
+		goto out_winfo;
+	}
+
+	if (xdr->page_len) {
+		ret = svc_rdma_send_xdr_pagelist(winfo, xdr);
 		if (ret < 0)
 			goto out_err;
-		consumed += xdr->page_len;
+	}
+	consumed = svc_rdma_build_reply_chunk(rinfo, true, xdr);
+	if (consumed < 0) {
+		ret = consumed;
+		goto out_err;
 	}
 
-	if (xdr->tail[0].iov_len) {
-		ret = svc_rdma_send_xdr_kvec(info, &xdr->tail[0]);
+	if (winfo->wi_cc.cc_sqecount + rinfo->wi_cc.cc_sqecount <=
+	    rdma->sc_sq_depth) {
+		/* The Reply chunk's completion now releases both chunks */
+		list_splice_tail_init(&winfo->wi_cc.cc_rwctxts,
+				      &rinfo->wi_cc.cc_rwctxts);
+		rinfo->wi_cc.cc_sqecount += winfo->wi_cc.cc_sqecount;
+		svc_rdma_write_info_free(winfo);
+	} else if (winfo->wi_cc.cc_sqecount) {
+		/* Too big for one chain, post them one after the other */
+		ret = svc_rdma_post_chunk_ctxt(&winfo->wi_cc);
 		if (ret < 0)
 			goto out_err;
-		consumed += xdr->tail[0].iov_len;
+	} else {
+		svc_rdma_write_info_free(winfo);
 	}
 
-	ret = svc_rdma_post_chunk_ctxt(&info->wi_cc);
-	if (ret < 0)
-		goto out_err;
+	ret = svc_rdma_post_chunk_ctxt(&rinfo->wi_cc);
+	if (ret < 0) {
+		svc_rdma_write_info_free(rinfo);
+		return ret;
+	}
 
+	trace_svcrdma_encode_write(xdr->page_len);
 	trace_svcrdma_encode_reply(consumed);
+	*wr_len = xdr->page_len;
 	return consumed;
 
 out_err:
-	svc_rdma_write_info_free(info);
+	svc_rdma_write_info_free(rinfo);
+out_winfo:
+	svc_rdma_write_info_free(winfo);
 	return ret;
 }
 
@@ -852,14 +852,23 @@ int svc_rdma_sendto(struct svc_rqst *rqstp)
 	*p++ = xdr_zero;
 	*p   = xdr_zero;
 
-	if (wr_lst) {
+	if (wr_lst && rp_ch) {
+		int wr_len;
+
+		/* XXX: Presume the client sent only one Write chunk */
+		ret = svc_rdma_send_write_reply_chunks(rdma, wr_lst, rp_ch,
+						       xdr, &wr_len);
+		if (ret < 0)
+			goto err2;
+		svc_rdma_xdr_encode_write_list(rdma_resp, wr_lst, wr_len);
+		svc_rdma_xdr_encode_reply_chunk(rdma_resp, rp_ch, ret);
+	} else if (wr_lst) {
 		/* XXX: Presume the client sent only one Write chunk */
 		ret = svc_rdma_send_write_chunk(rdma, wr_lst, xdr);
 		if (ret < 0)
 			goto err2;
 		svc_rdma_xdr_encode_write_list(rdma_resp, wr_lst, ret);
-	}
-	if (rp_ch) {
+	} else if (rp_ch) {
 		ret = svc_rdma_send_reply_chunk(rdma, rp_ch, wr_lst, xdr);
 		if (ret < 0)
 			goto err2;
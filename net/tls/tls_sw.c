@@ -737,7 +737,6 @@ static int tls_push_record(struct sock *sk, int flags,
 				tls_merge_open_record(sk, rec, tmp, orig_end);
 			}
 		}
-		ctx->async_capable = 1;
 		return rc;
 	} else if (split) {
 		msg_pl = &tmp->msg_plaintext;
@@ -873,13 +872,26 @@ static int tls_sw_push_pending_record(struct sock *sk, int flags)
 				   &copied, flags);
 }
 
+static int tls_sw_wait_encrypt(struct tls_sw_context_tx *ctx)
+{
+	smp_store_mb(ctx->async_notify, true);
+
+	if (atomic_read(&ctx->encrypt_pending))
+		crypto_wait_req(-EINPROGRESS, &ctx->async_wait);
+	else
+		reinit_completion(&ctx->async_wait.completion);
+
+	WRITE_ONCE(ctx->async_notify, false);
+
+	return ctx->async_wait.err;
+}
+
 int tls_sw_sendmsg(struct sock *sk, struct msghdr *msg, size_t size)
 {
 	long timeo = sock_sndtimeo(sk, msg->msg_flags & MSG_DONTWAIT);
 	struct tls_context *tls_ctx = tls_get_ctx(sk);
 	struct tls_prot_info *prot = &tls_ctx->prot_info;
 	struct tls_sw_context_tx *ctx = tls_sw_ctx_tx(tls_ctx);
-	bool async_capable = ctx->async_capable;
 	unsigned char record_type = TLS_RECORD_TYPE_DATA;
 	bool is_kvec = iov_iter_is_kvec(&msg->msg_iter);
 	bool eor = !(msg->msg_flags & MSG_MORE);
@@ -963,7 +975,11 @@ int tls_sw_sendmsg(struct sock *sk, struct msghdr *msg, size_t size)
 			full_record = true;
 		}
 
-		if (!is_kvec && (full_record || eor) && !async_capable) {
+		/* Zero-copy records may be encrypted asynchronously as well:
+		 * all of them are waited for below before returning, so the
+		 * user pages stay valid while several records are in flight.
+		 */
+		if (!is_kvec && (full_record || eor)) {
 			u32 first = msg_pl->sg.end;
 
 			ret = sk_msg_zerocopy_from_iter(sk, &msg->msg_iter,
@@ -1065,17 +1081,9 @@ int tls_sw_sendmsg(struct sock *sk, struct msghdr *msg, size_t size)
 	if (!num_async) {
 		goto send_end;
 	} else if (num_zc) {
-		/* Wait for pending encryptions to get completed */
-		smp_store_mb(ctx->async_notify, true);
-
-		if (atomic_read(&ctx->encrypt_pending))
-			crypto_wait_req(-EINPROGRESS, &ctx->async_wait);
-		else
-			reinit_completion(&ctx->async_wait.completion);
-
-		WRITE_ONCE(ctx->async_notify, false);
-
-		if (ctx->async_wait.err) {
+		/* Wait for pending encryptions to get completed, once */
+		num_zc = 0;
+		if (tls_sw_wait_encrypt(ctx)) {
 			ret = ctx->async_wait.err;
 			copied = 0;
 		}
@@ -1088,6 +1096,12 @@ int tls_sw_sendmsg(struct sock *sk, struct msghdr *msg, size_t size)
 	}
 
 send_end:
+	/* Zero-copy records still being encrypted point at the user pages,
+	 * which must not be released to the caller on the error paths either.
+	 */
+	if (num_async && num_zc)
+		tls_sw_wait_encrypt(ctx);
+
 	ret = sk_stream_error(sk, msg->msg_flags, ret);
 
 	release_sock(sk);
@@ -1361,10 +1375,18 @@ static int decrypt_internal(struct sock *sk, struct sk_buff *skb,
 	int iv_offset = 0;
 
 	if (*zc && (out_iov || out_sg)) {
-		if (out_iov)
-			n_sgout = iov_iter_npages(out_iov, INT_MAX) + 1;
-		else
+		if (out_iov) {
+			struct iov_iter rec_iov = *out_iov;
+
+			/* Only the pages backing this record are mapped, so
+			 * size sgout by them rather than by the whole user
+			 * buffer, which may be arbitrarily large.
+			 */
+			iov_iter_truncate(&rec_iov, data_len);
+			n_sgout = iov_iter_npages(&rec_iov, INT_MAX) + 1;
+		} else {
 			n_sgout = sg_nents(out_sg);
+		}
 		n_sgin = skb_nsg(skb, rxm->offset + prot->prepend_size,
 				 rxm->full_len - prot->prepend_size);
 	} else {
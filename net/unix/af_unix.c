@@ -1767,10 +1767,11 @@ static int unix_dgram_sendmsg(struct socket *sock, struct msghdr *msg,
 	return err;
 }
 
-/* We use paged skbs for stream sockets, and limit occupancy to 32768
- * bytes, and a minimum of a full page.
+/* We use paged skbs for stream sockets, and limit occupancy to 65536
+ * bytes, and a minimum of a full page. 64KB still fits in MAX_SKB_FRAGS
+ * order-0 pages on 4KB page systems, so the order-0 fallback keeps working.
  */
-#define UNIX_SKB_FRAGS_SZ (PAGE_SIZE << get_order(32768))
+#define UNIX_SKB_FRAGS_SZ (PAGE_SIZE << get_order(65536))
 
 static int unix_stream_sendmsg(struct socket *sock, struct msghdr *msg,
 			       size_t len)
@@ -20,6 +20,8 @@
 #include <linux/skbuff.h>
 #include <linux/percpu.h>
 #include <linux/list.h>
+#include <linux/jhash.h>
+#include <linux/mm.h>
 #include <net/sock.h>
 #include <linux/un.h>
 #include <net/af_unix.h>
@@ -31,9 +33,10 @@
 #include "avc_ss.h"
 #include "classmap.h"
 
-#define AVC_CACHE_SLOTS			512
-#define AVC_DEF_CACHE_THRESHOLD		512
+#define AVC_CACHE_MIN_SLOTS		512
+#define AVC_CACHE_MAX_SLOTS		8192
 #define AVC_CACHE_RECLAIM		16
+#define AVC_PCPU_ENTRIES		16
 
 #ifdef CONFIG_SECURITY_SELINUX_AVC_STATS
 #define avc_cache_stats_incr(field)	this_cpu_inc(avc_cache_stats.field)
@@ -66,13 +69,27 @@ struct avc_xperms_node {
 };
 
 struct avc_cache {
-	struct hlist_head	slots[AVC_CACHE_SLOTS]; /* head for avc_node->list */
-	spinlock_t		slots_lock[AVC_CACHE_SLOTS]; /* lock for writes */
+	struct hlist_head	*slots; /* head for avc_node->list */
+	spinlock_t		*slots_lock; /* lock for writes */
+	unsigned int		nr_slots;	/* power of two */
 	atomic_t		lru_hint;	/* LRU hint for reclaim scan */
 	atomic_t		active_nodes;
+	atomic_t		generation;	/* see avc_pcpu_lookup() */
 	u32			latest_notif;	/* latest revocation notification */
 };
 
+struct avc_pcpu_entry {
+	u32			ssid;
+	u32			tsid;
+	u16			tclass;
+	unsigned int		generation;
+	struct av_decision	avd;
+};
+
+struct avc_pcpu_cache {
+	struct avc_pcpu_entry	entries[AVC_PCPU_ENTRIES];
+};
+
 struct avc_callback_node {
 	int (*callback) (u32 event);
 	u32 events;
@@ -89,18 +106,40 @@ struct selinux_avc {
 };
 
 static struct selinux_avc selinux_avc;
+static DEFINE_PER_CPU(struct avc_pcpu_cache, avc_pcpu_cache);
 
+/*
+ * The hash table is sized at boot, with two slots per megabyte of memory,
+ * so that big systems with many domains and types get short chains. The
+ * default cache threshold keeps the average chain length at one.
+ */
 void selinux_avc_init(struct selinux_avc **avc)
 {
+	struct avc_cache *cache = &selinux_avc.avc_cache;
+	unsigned long slots;
 	int i;
 
-	selinux_avc.avc_cache_threshold = AVC_DEF_CACHE_THRESHOLD;
-	for (i = 0; i < AVC_CACHE_SLOTS; i++) {
-		INIT_HLIST_HEAD(&selinux_avc.avc_cache.slots[i]);
-		spin_lock_init(&selinux_avc.avc_cache.slots_lock[i]);
+	slots = totalram_pages() >> (20 - PAGE_SHIFT - 1);
+	slots = clamp_t(unsigned long, slots, AVC_CACHE_MIN_SLOTS,
+			AVC_CACHE_MAX_SLOTS);
+	cache->nr_slots = rounddown_pow_of_two(slots);
+
+	cache->slots = kvcalloc(cache->nr_slots, sizeof(*cache->slots),
+				GFP_KERNEL);
+	cache->slots_lock = kvcalloc(cache->nr_slots,
+				     sizeof(*cache->slots_lock), GFP_KERNEL);
+	if (!cache->slots || !cache->slots_lock)
+		panic("SELinux: unable to allocate the AVC hash table\n");
+
+	selinux_avc.avc_cache_threshold = cache->nr_slots;
+	for (i = 0; i < cache->nr_slots; i++) {
+		INIT_HLIST_HEAD(&cache->slots[i]);
+		spin_lock_init(&cache->slots_lock[i]);
 	}
-	atomic_set(&selinux_avc.avc_cache.active_nodes, 0);
-	atomic_set(&selinux_avc.avc_cache.lru_hint, 0);
+	atomic_set(&cache->active_nodes, 0);
+	atomic_set(&cache->lru_hint, 0);
+	/* zeroed per-cpu entries must never look valid */
+	atomic_set(&cache->generation, 1);
 	*avc = &selinux_avc;
 }
 
@@ -121,9 +160,16 @@ static struct kmem_cache *avc_xperms_data_cachep;
 static struct kmem_cache *avc_xperms_decision_cachep;
 static struct kmem_cache *avc_xperms_cachep;
 
-static inline int avc_hash(u32 ssid, u32 tsid, u16 tclass)
+static inline u32 avc_hash_key(u32 ssid, u32 tsid, u16 tclass)
+{
+	return jhash_3words(ssid, tsid, tclass, 0);
+}
+
+static inline int avc_hash(struct selinux_avc *avc,
+			   u32 ssid, u32 tsid, u16 tclass)
 {
-	return (ssid ^ (tsid<<2) ^ (tclass<<4)) & (AVC_CACHE_SLOTS - 1);
+	return avc_hash_key(ssid, tsid, tclass) &
+		(avc->avc_cache.nr_slots - 1);
 }
 
 /**
@@ -157,7 +203,7 @@ int avc_get_hash_stats(struct selinux_avc *avc, char *page)
 
 	slots_used = 0;
 	max_chain_len = 0;
-	for (i = 0; i < AVC_CACHE_SLOTS; i++) {
+	for (i = 0; i < avc->avc_cache.nr_slots; i++) {
 		head = &avc->avc_cache.slots[i];
 		if (!hlist_empty(head)) {
 			slots_used++;
@@ -174,7 +220,7 @@ int avc_get_hash_stats(struct selinux_avc *avc, char *page)
 	return scnprintf(page, PAGE_SIZE, "entries: %d\nbuckets used: %d/%d\n"
 			 "longest chain: %d\n",
 			 atomic_read(&avc->avc_cache.active_nodes),
-			 slots_used, AVC_CACHE_SLOTS, max_chain_len);
+			 slots_used, avc->avc_cache.nr_slots, max_chain_len);
 }
 
 /*
@@ -450,12 +496,23 @@ static void avc_node_kill(struct selinux_avc *avc, struct avc_node *node)
 	atomic_dec(&avc->avc_cache.active_nodes);
 }
 
+/*
+ * Invalidate all per-cpu copies of cached decisions. Must be called after
+ * the hash table itself has been updated.
+ */
+static inline void avc_bump_generation(struct selinux_avc *avc)
+{
+	smp_mb__before_atomic();
+	atomic_inc(&avc->avc_cache.generation);
+}
+
 static void avc_node_replace(struct selinux_avc *avc,
 			     struct avc_node *new, struct avc_node *old)
 {
 	hlist_replace_rcu(&old->list, &new->list);
 	call_rcu(&old->rhead, avc_node_free);
 	atomic_dec(&avc->avc_cache.active_nodes);
+	avc_bump_generation(avc);
 }
 
 static inline int avc_reclaim_node(struct selinux_avc *avc)
@@ -466,9 +523,9 @@ static inline int avc_reclaim_node(struct selinux_avc *avc)
 	struct hlist_head *head;
 	spinlock_t *lock;
 
-	for (try = 0, ecx = 0; try < AVC_CACHE_SLOTS; try++) {
+	for (try = 0, ecx = 0; try < avc->avc_cache.nr_slots; try++) {
 		hvalue = atomic_inc_return(&avc->avc_cache.lru_hint) &
-			(AVC_CACHE_SLOTS - 1);
+			(avc->avc_cache.nr_slots - 1);
 		head = &avc->avc_cache.slots[hvalue];
 		lock = &avc->avc_cache.slots_lock[hvalue];
 
@@ -527,7 +584,7 @@ static inline struct avc_node *avc_search_node(struct selinux_avc *avc,
 	int hvalue;
 	struct hlist_head *head;
 
-	hvalue = avc_hash(ssid, tsid, tclass);
+	hvalue = avc_hash(avc, ssid, tsid, tclass);
 	head = &avc->avc_cache.slots[hvalue];
 	hlist_for_each_entry_rcu(node, head, list) {
 		if (ssid == node->ae.ssid &&
@@ -568,6 +625,81 @@ static struct avc_node *avc_lookup(struct selinux_avc *avc,
 	return NULL;
 }
 
+/*
+ * Per-cpu front cache
+ *
+ * Each cpu keeps copies of its most recent decisions in a small
+ * direct-mapped array, so that a task checking the same few permissions
+ * over and over does not walk the shared hash chains. A copy is valid only
+ * while the generation it was taken at is current: replacing a node and
+ * flushing the cache bump the generation and thereby drop every copy.
+ *
+ * The generation has to be sampled before the decision is looked up or
+ * computed, so that a concurrent update always leaves the copy stale.
+ * Entries are only accessed from task context with preemption disabled,
+ * which keeps an interrupt from seeing a half-written one.
+ */
+static inline unsigned int avc_generation(struct selinux_avc *avc)
+{
+	return atomic_read_acquire(&avc->avc_cache.generation);
+}
+
+static inline struct avc_pcpu_entry *avc_pcpu_entry(u32 ssid, u32 tsid,
+						    u16 tclass)
+{
+	unsigned int idx = avc_hash_key(ssid, tsid, tclass) &
+			   (AVC_PCPU_ENTRIES - 1);
+
+	return &this_cpu_ptr(&avc_pcpu_cache)->entries[idx];
+}
+
+static bool avc_pcpu_lookup(struct selinux_avc *avc, unsigned int generation,
+			    u32 ssid, u32 tsid, u16 tclass,
+			    struct av_decision *avd)
+{
+	struct avc_pcpu_entry *entry;
+	bool hit = false;
+
+	if (!in_task())
+		return false;
+
+	preempt_disable();
+	entry = avc_pcpu_entry(ssid, tsid, tclass);
+	if (entry->ssid != ssid || entry->tsid != tsid ||
+	    entry->tclass != tclass) {
+		avc_cache_stats_incr(pcpu_conflicts);
+	} else if (entry->generation != generation) {
+		avc_cache_stats_incr(pcpu_stale);
+	} else {
+		memcpy(avd, &entry->avd, sizeof(*avd));
+		avc_cache_stats_incr(lookups);
+		avc_cache_stats_incr(pcpu_hits);
+		hit = true;
+	}
+	preempt_enable();
+
+	return hit;
+}
+
+static void avc_pcpu_store(unsigned int generation,
+			   u32 ssid, u32 tsid, u16 tclass,
+			   const struct av_decision *avd)
+{
+	struct avc_pcpu_entry *entry;
+
+	if (!in_task())
+		return;
+
+	preempt_disable();
+	entry = avc_pcpu_entry(ssid, tsid, tclass);
+	entry->ssid = ssid;
+	entry->tsid = tsid;
+	entry->tclass = tclass;
+	entry->generation = generation;
+	memcpy(&entry->avd, avd, sizeof(entry->avd));
+	preempt_enable();
+}
+
 static int avc_latest_notif_update(struct selinux_avc *avc,
 				   int seqno, int is_insert)
 {
@@ -627,7 +759,7 @@ static struct avc_node *avc_insert(struct selinux_avc *avc,
 		spinlock_t *lock;
 		int rc = 0;
 
-		hvalue = avc_hash(ssid, tsid, tclass);
+		hvalue = avc_hash(avc, ssid, tsid, tclass);
 		avc_node_populate(node, ssid, tsid, tclass, avd);
 		rc = avc_xperms_populate(node, xp_node);
 		if (rc) {
@@ -875,7 +1007,7 @@ static int avc_update_node(struct selinux_avc *avc,
 	}
 
 	/* Lock the target slot */
-	hvalue = avc_hash(ssid, tsid, tclass);
+	hvalue = avc_hash(avc, ssid, tsid, tclass);
 
 	head = &avc->avc_cache.slots[hvalue];
 	lock = &avc->avc_cache.slots_lock[hvalue];
@@ -956,7 +1088,7 @@ static void avc_flush(struct selinux_avc *avc)
 	unsigned long flag;
 	int i;
 
-	for (i = 0; i < AVC_CACHE_SLOTS; i++) {
+	for (i = 0; i < avc->avc_cache.nr_slots; i++) {
 		head = &avc->avc_cache.slots[i];
 		lock = &avc->avc_cache.slots_lock[i];
 
@@ -971,6 +1103,8 @@ static void avc_flush(struct selinux_avc *avc)
 		rcu_read_unlock();
 		spin_unlock_irqrestore(lock, flag);
 	}
+
+	avc_bump_generation(avc);
 }
 
 /**
@@ -1013,11 +1147,16 @@ struct avc_node *avc_compute_av(struct selinux_state *state,
 				u16 tclass, struct av_decision *avd,
 				struct avc_xperms_node *xp_node)
 {
+	struct avc_node *node;
+
 	rcu_read_unlock();
 	INIT_LIST_HEAD(&xp_node->xpd_head);
 	security_compute_av(state, ssid, tsid, tclass, avd, &xp_node->xp);
 	rcu_read_lock();
-	return avc_insert(state->avc, ssid, tsid, tclass, avd, xp_node);
+	node = avc_insert(state->avc, ssid, tsid, tclass, avd, xp_node);
+	if (!node)
+		avc_cache_stats_incr(uncached);
+	return node;
 }
 
 static noinline int avc_denied(struct selinux_state *state,
@@ -1150,6 +1289,7 @@ inline int avc_has_perm_noaudit(struct selinux_state *state,
 {
 	struct avc_node *node;
 	struct avc_xperms_node xp_node;
+	unsigned int generation;
 	int rc = 0;
 	u32 denied;
 
@@ -1158,12 +1298,21 @@ inline int avc_has_perm_noaudit(struct selinux_state *state,
 
 	rcu_read_lock();
 
+	generation = avc_generation(state->avc);
+	if (avc_pcpu_lookup(state->avc, generation, ssid, tsid, tclass, avd))
+		goto check;
+
 	node = avc_lookup(state->avc, ssid, tsid, tclass);
 	if (unlikely(!node))
 		node = avc_compute_av(state, ssid, tsid, tclass, avd, &xp_node);
 	else
 		memcpy(avd, &node->ae.avd, sizeof(*avd));
 
+	/* a decision that did not make it into the cache may be stale */
+	if (node)
+		avc_pcpu_store(generation, ssid, tsid, tclass, avd);
+
+check:
 	denied = requested & ~(avd->allowed);
 	if (unlikely(denied))
 		rc = avc_denied(state, ssid, tsid, tclass, requested, 0, 0,
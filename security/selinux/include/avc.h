@@ -39,6 +39,10 @@ struct avc_cache_stats {
 	unsigned int allocations;
 	unsigned int reclaims;
 	unsigned int frees;
+	unsigned int pcpu_hits;		/* served by the per-cpu cache */
+	unsigned int pcpu_stale;	/* per-cpu copy invalidated */
+	unsigned int pcpu_conflicts;	/* per-cpu slot holds another key */
+	unsigned int uncached;		/* computed, but not inserted */
 };
 
 /*
@@ -27,7 +27,8 @@ static const struct snd_pcm_hardware idma_hardware = {
 		    SNDRV_PCM_INFO_MMAP |
 		    SNDRV_PCM_INFO_MMAP_VALID |
 		    SNDRV_PCM_INFO_PAUSE |
-		    SNDRV_PCM_INFO_RESUME,
+		    SNDRV_PCM_INFO_RESUME |
+		    SNDRV_PCM_INFO_NO_PERIOD_WAKEUP,
 	.buffer_bytes_max = MAX_IDMA_BUFFER,
 	.period_bytes_min = 128,
 	.period_bytes_max = MAX_IDMA_PERIOD,
@@ -89,9 +90,15 @@ static int idma_enqueue(struct snd_pcm_substream *substream)
 			I2SSIZE_TRNMSK) << I2SSIZE_SHIFT);
 	writel(val, idma.regs + I2SSIZE);
 
-	val = readl(idma.regs + I2SAHB);
-	val |= AHB_INTENLVL0;
-	writel(val, idma.regs + I2SAHB);
+	/*
+	 * The position is read back from I2STRNCNT, so an application that
+	 * schedules itself off a timer needs no period interrupts at all.
+	 */
+	if (!runtime->no_period_wakeup) {
+		val = readl(idma.regs + I2SAHB);
+		val |= AHB_INTENLVL0;
+		writel(val, idma.regs + I2SAHB);
+	}
 
 	return 0;
 }
@@ -106,7 +113,7 @@ static void idma_setcallbk(struct snd_pcm_substream *substream,
 	spin_unlock(&prtd->lock);
 }
 
-static void idma_control(int op)
+static void idma_control(int op, bool period_irq)
 {
 	u32 val = readl(idma.regs + I2SAHB);
 
@@ -114,7 +121,9 @@ static void idma_control(int op)
 
 	switch (op) {
 	case LPAM_DMA_START:
-		val |= (AHB_INTENLVL0 | AHB_DMAEN);
+		val |= AHB_DMAEN;
+		if (period_irq)
+			val |= AHB_INTENLVL0;
 		break;
 	case LPAM_DMA_STOP:
 		val &= ~(AHB_INTENLVL0 | AHB_DMAEN);
@@ -177,7 +186,7 @@ static int idma_prepare(struct snd_pcm_substream *substream)
 	prtd->pos = prtd->start;
 
 	/* flush the DMA channel */
-	idma_control(LPAM_DMA_STOP);
+	idma_control(LPAM_DMA_STOP, false);
 	idma_enqueue(substream);
 
 	return 0;
@@ -195,14 +204,15 @@ static int idma_trigger(struct snd_pcm_substream *substream, int cmd)
 	case SNDRV_PCM_TRIGGER_START:
 	case SNDRV_PCM_TRIGGER_PAUSE_RELEASE:
 		prtd->state |= ST_RUNNING;
-		idma_control(LPAM_DMA_START);
+		idma_control(LPAM_DMA_START,
+			     !substream->runtime->no_period_wakeup);
 		break;
 
 	case SNDRV_PCM_TRIGGER_SUSPEND:
 	case SNDRV_PCM_TRIGGER_STOP:
 	case SNDRV_PCM_TRIGGER_PAUSE_PUSH:
 		prtd->state &= ~ST_RUNNING;
-		idma_control(LPAM_DMA_STOP);
+		idma_control(LPAM_DMA_STOP, false);
 		break;
 
 	default:
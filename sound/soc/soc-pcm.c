@@ -2188,6 +2188,19 @@ int dpcm_be_dai_hw_params(struct snd_soc_pcm_runtime *fe, int stream)
 			}
 		}
 
+		/*
+		 * A BE shared by several FEs is already set up if another FE
+		 * got there first with the same (fixed-up) params, don't
+		 * reprogram the DAIs and codec for nothing.
+		 */
+		if (be->dpcm[stream].state == SND_SOC_DPCM_STATE_HW_PARAMS &&
+		    !memcmp(&be->dpcm[stream].hw_params, &dpcm->hw_params,
+			    sizeof(struct snd_pcm_hw_params))) {
+			dev_dbg(be->dev, "ASoC: hw_params BE %s unchanged\n",
+				be->dai_link->name);
+			continue;
+		}
+
 		/* copy the fixed-up hw params for BE dai */
 		memcpy(&be->dpcm[stream].hw_params, &dpcm->hw_params,
 		       sizeof(struct snd_pcm_hw_params));
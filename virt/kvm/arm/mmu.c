@@ -1661,6 +1661,42 @@ static bool fault_supports_stage2_huge_mapping(struct kvm_memory_slot *memslot,
 	       (hva & ~(map_size - 1)) + map_size <= uaddr_end;
 }
 
+/*
+ * While dirty logging is active, a block that has already been split into
+ * a table by an earlier write fault must stay split: putting a read-only
+ * block mapping back would throw away the writable ptes established so far
+ * and make every page in the block fault again on the next write.
+ *
+ * Anything smaller than a PUD block is checked at PMD level, which also
+ * covers pages that transparent_hugepage_adjust() would turn into a block.
+ */
+static bool stage2_block_is_split(struct kvm *kvm, phys_addr_t addr,
+				  unsigned long map_size)
+{
+	pud_t *pudp;
+	pmd_t *pmdp;
+	bool split = false;
+
+	spin_lock(&kvm->mmu_lock);
+	pudp = stage2_get_pud(kvm, NULL, addr);
+	if (!pudp || !stage2_pud_present(kvm, *pudp))
+		goto out;
+
+	if (map_size == PUD_SIZE) {
+		split = !stage2_pud_huge(kvm, *pudp);
+		goto out;
+	}
+
+	if (stage2_pud_huge(kvm, *pudp))
+		goto out;
+
+	pmdp = stage2_pmd_offset(kvm, pudp, addr);
+	split = pmd_present(*pmdp) && !pmd_thp_or_huge(*pmdp);
+out:
+	spin_unlock(&kvm->mmu_lock);
+	return split;
+}
+
 static int user_mem_abort(struct kvm_vcpu *vcpu, phys_addr_t fault_ipa,
 			  struct kvm_memory_slot *memslot, unsigned long hva,
 			  unsigned long fault_status)
@@ -1697,7 +1733,9 @@ static int user_mem_abort(struct kvm_vcpu *vcpu, phys_addr_t fault_ipa,
 	}
 
 	vma_pagesize = vma_kernel_pagesize(vma);
-	if (logging_active ||
+	if ((logging_active &&
+	     (write_fault || stage2_block_is_split(kvm, fault_ipa,
+						   vma_pagesize))) ||
 	    !fault_supports_stage2_huge_mapping(memslot, hva, vma_pagesize)) {
 		force_pte = true;
 		vma_pagesize = PAGE_SIZE;
@@ -1746,9 +1784,12 @@ static int user_mem_abort(struct kvm_vcpu *vcpu, phys_addr_t fault_ipa,
 		flags |= KVM_S2PTE_FLAG_IS_IOMAP;
 	} else if (logging_active) {
 		/*
-		 * Faults on pages in a memslot with logging enabled
+		 * Write faults on pages in a memslot with logging enabled
 		 * should not be mapped with huge pages (it introduces churn
-		 * and performance degradation), so force a pte mapping.
+		 * and performance degradation), so force a pte mapping and
+		 * dissolve any block that still covers the page. Read and
+		 * exec faults may keep using read-only block mappings, so
+		 * that a block is only split once the guest writes to it.
 		 */
 		flags |= KVM_S2_FLAG_LOGGING_ACTIVE;
 
@@ -11,6 +11,7 @@
 
 #include <kvm/iodev.h>
 
+#include <linux/eventfd.h>
 #include <linux/kvm_host.h>
 #include <linux/slab.h>
 #include <linux/kvm.h>
@@ -86,6 +87,24 @@ static int coalesced_mmio_write(struct kvm_vcpu *vcpu,
 	ring->coalesced_mmio[ring->last].pio = dev->zone.pio;
 	smp_wmb();
 	ring->last = (ring->last + 1) % KVM_COALESCED_MMIO_MAX;
+
+	/*
+	 * Let userspace drain the ring from another thread, instead of
+	 * waiting for the next exit. Only the entry that takes the ring to
+	 * the watermark signals, so a consumer that is already behind does
+	 * not get woken up again for every write.
+	 */
+	if (dev->kvm->coalesced_mmio_eventfd) {
+		/* ring->first is written by userspace */
+		u32 first = READ_ONCE(ring->first);
+		u32 used = (ring->last - first + KVM_COALESCED_MMIO_MAX) %
+			   KVM_COALESCED_MMIO_MAX;
+
+		if (first < KVM_COALESCED_MMIO_MAX &&
+		    used == dev->kvm->coalesced_mmio_watermark)
+			eventfd_signal(dev->kvm->coalesced_mmio_eventfd, 1);
+	}
+
 	spin_unlock(&dev->kvm->ring_lock);
 	return 0;
 }
@@ -131,10 +150,44 @@ int kvm_coalesced_mmio_init(struct kvm *kvm)
 
 void kvm_coalesced_mmio_free(struct kvm *kvm)
 {
+	if (kvm->coalesced_mmio_eventfd)
+		eventfd_ctx_put(kvm->coalesced_mmio_eventfd);
 	if (kvm->coalesced_mmio_ring)
 		free_page((unsigned long)kvm->coalesced_mmio_ring);
 }
 
+/*
+ * A negative fd removes the eventfd. A zero watermark picks half of the
+ * ring.
+ */
+int kvm_vm_ioctl_coalesced_mmio_eventfd(struct kvm *kvm, int fd,
+					u32 watermark)
+{
+	struct eventfd_ctx *eventfd = NULL, *old;
+
+	if (watermark >= KVM_COALESCED_MMIO_MAX)
+		return -EINVAL;
+	if (!watermark)
+		watermark = KVM_COALESCED_MMIO_MAX / 2;
+
+	if (fd >= 0) {
+		eventfd = eventfd_ctx_fdget(fd);
+		if (IS_ERR(eventfd))
+			return PTR_ERR(eventfd);
+	}
+
+	spin_lock(&kvm->ring_lock);
+	old = kvm->coalesced_mmio_eventfd;
+	kvm->coalesced_mmio_eventfd = eventfd;
+	kvm->coalesced_mmio_watermark = watermark;
+	spin_unlock(&kvm->ring_lock);
+
+	if (old)
+		eventfd_ctx_put(old);
+
+	return 0;
+}
+
 int kvm_vm_ioctl_register_coalesced_mmio(struct kvm *kvm,
 					 struct kvm_coalesced_mmio_zone *zone)
 {
@@ -3151,6 +3151,7 @@ static long kvm_vm_ioctl_check_extension_generic(struct kvm *kvm, long arg)
 	case KVM_CAP_COALESCED_MMIO:
 		return KVM_COALESCED_MMIO_PAGE_OFFSET;
 	case KVM_CAP_COALESCED_PIO:
+	case KVM_CAP_COALESCED_MMIO_EVENTFD:
 		return 1;
 #endif
 #ifdef CONFIG_HAVE_KVM_IRQ_ROUTING
@@ -3185,6 +3186,14 @@ static int kvm_vm_ioctl_enable_cap_generic(struct kvm *kvm,
 			return -EINVAL;
 		kvm->manual_dirty_log_protect = cap->args[0];
 		return 0;
+#endif
+#ifdef CONFIG_KVM_MMIO
+	case KVM_CAP_COALESCED_MMIO_EVENTFD:
+		if (cap->flags || cap->args[1] > U32_MAX)
+			return -EINVAL;
+		return kvm_vm_ioctl_coalesced_mmio_eventfd(kvm,
+							   (int)cap->args[0],
+							   cap->args[1]);
 #endif
 	default:
 		return kvm_vm_ioctl_enable_cap(kvm, cap);